@@ -37,6 +37,8 @@
 #include "pydebug.h"
 // #include "bytesobject.h"
 #include "unicodeobject.h"
+#include "bytearrayobject.h"
+#include "memoryobject.h"
 #include "longobject.h"
 #include "longintrepr.h"
 #include "boolobject.h"
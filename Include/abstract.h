@@ -310,7 +310,34 @@ PyAPI_FUNC(int) PyObject_DelItemString(PyObject *o, const char *key);
 PyAPI_FUNC(int) PyObject_DelItem(PyObject *o, PyObject *key);
 
 
-  /* === New Buffer API ============================================ */
+/* === New Buffer API ============================================ */
+
+/* Return 1 if the getbuffer function is available, otherwise return 0. */
+PyAPI_FUNC(int) PyObject_CheckBuffer(PyObject *obj);
+
+/* Fill in view with the bytes of obj, which keeps them in place until
+   PyBuffer_Release(view).  flags is PyBUF_SIMPLE, or PyBUF_WRITABLE to
+   ask for a buffer that can be written to.
+
+   Returns -1 and raises an error on failure and returns 0 on success. */
+PyAPI_FUNC(int) PyObject_GetBuffer(PyObject *obj, Py_buffer *view,
+                                   int flags);
+
+/* Releases a Py_buffer obtained from PyObject_GetBuffer(). */
+PyAPI_FUNC(void) PyBuffer_Release(Py_buffer *view);
+
+/* Return 1 if the memory defined by the view is contiguous in order
+   fort ('C', 'F' or 'A'), else 0.  Buffers are one-dimensional runs of
+   bytes, so this is always 1. */
+PyAPI_FUNC(int) PyBuffer_IsContiguous(const Py_buffer *view, char fort);
+
+/* Fills in a buffer-info structure for an exporter that shares the len
+   bytes at buf.
+
+   Returns 0 on success and -1 (with raising an error) on error. */
+PyAPI_FUNC(int) PyBuffer_FillInfo(Py_buffer *view, PyObject *o, void *buf,
+                                  Py_ssize_t len, int readonly,
+                                  int flags);
 
 /* Takes an arbitrary object and returns the result of calling
    obj.__format__(format_spec). */
@@ -939,6 +966,13 @@ PyAPI_FUNC(int) _PyObject_HasLen(PyObject *o);
    value.  If one of the calls fails, this function returns -1. */
 PyAPI_FUNC(Py_ssize_t) PyObject_LengthHint(PyObject *o, Py_ssize_t);
 
+/* Number of items to presize a container with for the items of o, from
+   PyObject_LengthHint(o, 0).  *exact is set to 1 if it is the real number
+   of items (len(o), or the hint of a builtin iterator), and to 0 for a
+   __length_hint__() which may be a guess.  A hint which fails counts as
+   0; -1 is only returned on MemoryError or a non-Exception error. */
+PyAPI_FUNC(Py_ssize_t) _PyObject_PresizeHint(PyObject *o, int *exact);
+
 /* ==== Iterators ================================================ */
 
 #define PyIter_Check(obj) \
@@ -0,0 +1,27 @@
+/* ByteArray object interface */
+
+#ifndef Py_BYTEARRAYOBJECT_H
+#define Py_BYTEARRAYOBJECT_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* A bytearray is a mutable sequence of bytes.  It exports its bytes with
+   the buffer protocol, so that memoryview and FileIO.readinto() can use
+   them in place; it cannot be resized while a buffer is exported. */
+
+PyAPI_DATA(PyTypeObject) PyByteArray_Type;
+
+PyAPI_FUNC(int) PyByteArray_Check(PyObject *);
+PyAPI_FUNC(int) PyByteArray_CheckExact(PyObject *);
+
+PyAPI_FUNC(PyObject *) PyByteArray_FromObject(PyObject *);
+PyAPI_FUNC(PyObject *) PyByteArray_FromStringAndSize(const char *, Py_ssize_t);
+PyAPI_FUNC(Py_ssize_t) PyByteArray_Size(PyObject *);
+PyAPI_FUNC(char *) PyByteArray_AsString(PyObject *);
+PyAPI_FUNC(int) PyByteArray_Resize(PyObject *, Py_ssize_t);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* !Py_BYTEARRAYOBJECT_H */
@@ -17,6 +17,8 @@ PyAPI_FUNC(const char *) PyEval_GetFuncDesc(PyObject *);
 
 PyAPI_FUNC(PyObject *) PyEval_EvalFrame(PyFrameObject *);
 PyAPI_FUNC(PyObject *) PyEval_EvalFrameEx(PyFrameObject *f, int exc);
+
+PyAPI_FUNC(void) PyEval_SetProfile(Py_tracefunc, PyObject *);
   
 /* Masks and values used by FORMAT_VALUE opcode. */
 #define FVC_MASK      0x3
@@ -24,6 +24,10 @@ PyAPI_FUNC(PyCodeObject *) PyNode_Compile(struct _node *, const char *);
 #define PyCF_IGNORE_COOKIE 0x0800
 #define PyCF_TYPE_COMMENTS 0x1000
 #define PyCF_ALLOW_TOP_LEVEL_AWAIT 0x2000
+/* Private: the source is a module body run by import in a fresh module
+   namespace, so the optimizer may fold builtins it does not rebind.
+   compile() rejects it, being outside PyCF_COMPILE_MASK. */
+#define _PyCF_FOLD_BUILTINS 0x4000
 #define PyCF_COMPILE_MASK (PyCF_ONLY_AST | PyCF_ALLOW_TOP_LEVEL_AWAIT | \
                            PyCF_TYPE_COMMENTS | PyCF_DONT_IMPLY_DEDENT)
 
@@ -86,6 +90,10 @@ PyAPI_FUNC(int) PyCompile_OpcodeStackEffectWithJump(int opcode, int oparg, int j
 typedef struct {
     int optimize;
     int ff_features;
+    /* Set by _PyAST_Optimize() */
+    int shadowed_builtins;  /* foldable builtins which the module rebinds */
+    int in_function;        /* folding a function body */
+    int in_loop;            /* folding a loop body of the current block */
 } _PyASTOptimizeState;
 
 PyAPI_FUNC(int) _PyAST_Optimize(struct _mod *, _PyASTOptimizeState *state);
@@ -90,6 +90,12 @@ PyObject *_PyDict_NewKeysForClass(void);
 PyAPI_FUNC(PyObject *) PyObject_GenericGetDict(PyObject *, void *);
 
 PyAPI_FUNC(PyObject *) _PyDict_NewPresized(Py_ssize_t minused);
+PyAPI_FUNC(int) _PyDict_Reserve(PyObject *mp, Py_ssize_t n, int exact);
+PyAPI_FUNC(int) _PyDict_Next(PyObject *mp, Py_ssize_t *pos, PyObject **key,
+                             PyObject **value, Py_hash_t *hash);
+PyAPI_FUNC(int) _PyDict_Contains_KnownHash(PyObject *mp, PyObject *key,
+                                           Py_hash_t hash);
+PyAPI_FUNC(PyObject *) _PyDictKeys_GetDict(PyObject *view);
   
   Py_ssize_t _PyDict_KeysSize(PyObject *keys);
   
@@ -186,7 +186,47 @@ typedef struct {
        variable.
        If set to -1 (default), it is set to !Py_UnbufferedStdioFlag. */
     int buffered_stdio;
-  
+
+    /* If non-zero, store the code objects of imported modules in the code
+       cache (see Python/codecache.c).
+
+       Set to 0 by the -B command line option and by the
+       PYTHONDONTWRITEBYTECODE environment variable. */
+    int write_bytecode;
+
+    /* Code cache directory: -X pycache_prefix=PATH and PYTHONPYCACHEPREFIX.
+       If NULL, use $XDG_CACHE_HOME/python-codecache or
+       ~/.cache/python-codecache. */
+    char *pycache_prefix;
+
+    /* If non-zero, print the time spent in each import and initialization
+       phase (-X importtime, PYTHONPROFILEIMPORTTIME) to stderr, or to
+       import_time_file if set (-X importtime=PATH). */
+    int import_time;
+    char *import_time_file;
+
+    /* If non-zero, a module-level "import x" binds a placeholder and x is
+       only imported when the name is first used (-X lazy_imports,
+       PYTHONLAZYIMPORTS). */
+    int lazy_imports;
+
+    /* If non-zero, import the modules of Python/frozen.c from the code
+       linked into the interpreter rather than from Lib/.
+
+       Set to 0 by -X frozen_modules=off. */
+    int use_frozen_modules;
+
+    /* -X options: "-X name" and "-X name=value" command line options */
+    PyStringList xoptions;
+
+    /* If non-zero, give each code object its own native trampoline in front
+       of the eval loop and describe it in /tmp/perf-PID.map, so that Linux
+       perf can attribute samples to Python functions.
+
+       Set to 1 by -X perf and by the PYTHONPERFSUPPORT=1 environment
+       variable. */
+    int perf_profiling;
+
     /* --- Path configuration inputs ------------ */
 
     /* If greater than 0, suppress _PyPathConfig_Calculate() warnings on Unix.
@@ -195,6 +235,14 @@ typedef struct {
        If set to -1 (default), inherit !Py_FrozenFlag value. */
     int pathconfig_warnings;
 
+    /* If non-zero, store the computed path configuration in a cache file
+       next to the executable and reuse it while the executable is unchanged
+       (see Modules/getpath.c), rather than searching the landmarks again.
+
+       Set to 1 by -X pathconfig_cache and by the PYTHONPATHCONFIGCACHE=1
+       environment variable. */
+    int pathconfig_cache;
+
     char *pythonpath_env; /* PYTHONPATH environment variable */
     char *home;          /* PYTHONHOME environment variable,
                                see also Py_SetPythonHome(). */
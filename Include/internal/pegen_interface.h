@@ -34,6 +34,13 @@ PyAPI_FUNC(mod_ty) PyPegen_ASTFromFilename(
     int mode,
     PyCompilerFlags *flags);
 
+/* Memoization statistics of the parser, since the last clear: the number
+   of memo lookups and hits, and the list of the number of tokens skipped
+   by the hits, indexed by rule type. */
+PyAPI_FUNC(void) _PyPegen_clear_memo_statistics(void);
+PyAPI_FUNC(PyObject *) _PyPegen_get_memo_statistics(void);
+PyAPI_FUNC(void) _PyPegen_get_memo_hits(long *lookups, long *hits);
+
 
 #ifdef __cplusplus
 }
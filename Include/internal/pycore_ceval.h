@@ -31,7 +31,25 @@ extern PyObject *_PyEval_EvalCode(
     PyObject *const *defs, Py_ssize_t defcount,
     PyObject *kwdefs, PyObject *closure,
     PyObject *name, PyObject *qualname);
-  
+
+#ifdef Py_OPCODE_STATS
+/* Per-opcode execution counts, see Misc/SpecialBuilds.txt */
+extern void _PyEval_SetOpcodeStats(int enabled, int cycles);
+extern void _PyEval_ClearOpcodeStats(void);
+extern PyObject *_PyEval_GetOpcodeStats(void);
+#endif
+
+/* Linux perf trampolines (Python/perf_trampoline.c) */
+#if defined(__linux__) && (defined(__x86_64__) || defined(__aarch64__))
+#  define PY_HAVE_PERF_TRAMPOLINE
+#endif
+
+extern int _PyPerfTrampoline_SetActive(PyInterpreterState *interp, int active);
+extern int _PyPerfTrampoline_IsActive(void);
+extern void _PyPerfTrampoline_RegisterCode(PyCodeObject *co,
+                                           PyObject *qualname);
+extern void _PyPerfTrampoline_Fini(void);
+
 #ifdef __cplusplus
 }
 #endif
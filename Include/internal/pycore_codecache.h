@@ -0,0 +1,29 @@
+#ifndef Py_INTERNAL_CODECACHE_H
+#define Py_INTERNAL_CODECACHE_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef Py_BUILD_CORE
+#  error "this header requires Py_BUILD_CORE define"
+#endif
+
+/* Serialize a code object, or any of the constants a code object may
+   hold, into a str; and back. */
+extern PyObject *_PyCodeCache_Dumps(PyObject *v);
+extern PyObject *_PyCodeCache_Loads(const char *data, Py_ssize_t size);
+
+/* On-disk cache of the code objects of imported modules, keyed by the
+   source path and validated against the source mtime and size. */
+extern PyObject *_PyCodeCache_Load(
+    const char *filename,
+    const struct _Py_stat_struct *st);
+extern void _PyCodeCache_Store(
+    const char *filename,
+    const struct _Py_stat_struct *st,
+    PyObject *code);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* !Py_INTERNAL_CODECACHE_H */
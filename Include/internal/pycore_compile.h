@@ -0,0 +1,40 @@
+#ifndef Py_INTERNAL_COMPILE_H
+#define Py_INTERNAL_COMPILE_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef Py_BUILD_CORE
+#  error "this header requires Py_BUILD_CORE define"
+#endif
+
+/* Time spent in each stage of compiling source code, collected while
+   sys._set_compile_stats(True) is on (see Tools/scripts/compile_benchmark.py).
+   Tokenizing is timed by a separate pass over the source, since the
+   parser pulls tokens as it goes: PARSE includes that work again. */
+typedef enum {
+    _PyCompile_TOKENIZE,
+    _PyCompile_PARSE,
+    _PyCompile_OPTIMIZE,
+    _PyCompile_SYMTABLE,
+    _PyCompile_CODEGEN,         /* compiler_mod(), including ASSEMBLE */
+    _PyCompile_ASSEMBLE,
+    _PyCompile_NSTAGES
+} _PyCompile_Stage;
+
+extern int _PyCompile_stats_enabled;
+
+/* Return the start time to pass to _PyCompile_StageEnd() */
+extern int64_t _PyCompile_StageStart(void);
+extern void _PyCompile_StageEnd(_PyCompile_Stage stage, int64_t start);
+
+/* Turn the statistics on or off; both reset them */
+extern void _PyCompile_SetStats(int enabled);
+
+/* Return {stage name: seconds}, with "calls" the number of compilations */
+extern PyObject *_PyCompile_GetStats(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* !Py_INTERNAL_COMPILE_H */
@@ -7,7 +7,23 @@ extern "C" {
 #ifndef Py_BUILD_CORE
 #  error "Py_BUILD_CORE must be defined to include this header"
 #endif
-  
+
+/* Source file memory-mapped by _Py_MapSourceFile() */
+typedef struct {
+    const char *text;       /* NUL-terminated source text */
+    Py_ssize_t size;        /* Length of text */
+    void *addr;             /* mmap() address and length */
+    size_t length;
+} _Py_SourceMapping;
+
+/* Map the source file fd of file_size bytes read-only, for the text which
+   starts at offset.  Return 1 on success, or 0 if the file should be read
+   instead (small, not mappable, or no NUL byte after the end of the file):
+   no exception is raised. */
+extern int _Py_MapSourceFile(int fd, off_t offset, off_t file_size,
+                             _Py_SourceMapping *map);
+extern void _Py_UnmapSourceFile(_Py_SourceMapping *map);
+
 #ifdef __cplusplus
 }
 #endif
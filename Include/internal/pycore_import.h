@@ -12,6 +12,17 @@ PyAPI_FUNC(PyObject *) _PyImport_FindBuiltin(
 
 extern void _PyImport_Cleanup(PyThreadState *tstate);
 
+/* -X importtime: time a section (an import or an initialization phase)
+   and print a line when it ends.  Does nothing unless enabled. */
+typedef struct {
+    int64_t start;
+    int64_t accumulated;
+} _PyImportTimer;
+
+extern void _PyImport_InitTiming(const PyConfig *config);
+extern void _PyImport_TimerStart(_PyImportTimer *timer);
+extern void _PyImport_TimerStop(_PyImportTimer *timer, const char *name);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,40 @@
+#ifndef Py_INTERNAL_LAZYIMPORT_H
+#define Py_INTERNAL_LAZYIMPORT_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef Py_BUILD_CORE
+#  error "this header requires Py_BUILD_CORE define"
+#endif
+
+/* Placeholder bound by "import x" in -X lazy_imports mode: the module is
+   only loaded when the name is first resolved (see Objects/lazyimportobject.c). */
+typedef struct {
+    PyObject_HEAD
+    PyObject *lz_names;     /* list of the dotted names to import */
+    PyObject *lz_globals;   /* globals of the importing module */
+    PyObject *lz_module;    /* top-level module once loaded, else NULL */
+} PyLazyImportObject;
+
+extern PyTypeObject _PyLazyImport_Type;
+
+#define _PyLazyImport_CheckExact(op) Py_IS_TYPE(op, &_PyLazyImport_Type)
+
+extern PyObject *_PyLazyImport_New(PyObject *name, PyObject *globals);
+
+/* Add another "import name" sharing the same top-level name */
+extern int _PyLazyImport_AddName(PyObject *lazy, PyObject *name);
+
+/* Load the module(s) and return the top-level module (new reference) */
+extern PyObject *_PyLazyImport_Resolve(PyObject *lazy);
+
+/* Resolve the lazy object bound to name in dict, and rebind name to the
+   module.  Return a new reference to the module. */
+extern PyObject *_PyLazyImport_ResolveInDict(PyObject *dict, PyObject *name,
+                                             PyObject *lazy);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* !Py_INTERNAL_LAZYIMPORT_H */
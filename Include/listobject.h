@@ -36,6 +36,7 @@ PyAPI_FUNC(int) PyList_Sort(PyObject *);
 PyAPI_FUNC(int) PyList_Reverse(PyObject *);
 PyAPI_FUNC(PyObject *) PyList_AsTuple(PyObject *);
 PyAPI_FUNC(PyObject *) PyList_Extend(PyObject *, PyObject *);
+PyAPI_FUNC(int) _PyList_Reserve(PyObject *, Py_ssize_t, int);
 PyAPI_FUNC(PyObject **) PyList_Items(PyObject *);
   
 #ifdef __cplusplus
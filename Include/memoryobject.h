@@ -0,0 +1,22 @@
+/* Memory view object.  In Python this is available as "memoryview". */
+
+#ifndef Py_MEMORYOBJECT_H
+#define Py_MEMORYOBJECT_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* A memoryview shares the bytes exported by an object such as str or
+   bytearray, without copying them; slicing it gives a memoryview of part
+   of the same bytes. */
+
+PyAPI_DATA(PyTypeObject) PyMemoryView_Type;
+
+PyAPI_FUNC(int) PyMemoryView_Check(PyObject *);
+
+PyAPI_FUNC(PyObject *) PyMemoryView_FromObject(PyObject *base);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* !Py_MEMORYOBJECT_H */
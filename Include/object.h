@@ -672,6 +672,28 @@ typedef struct {
     objobjargproc mp_ass_subscript;
 } PyMappingMethods;
 
+/* A contiguous run of bytes exported by an object such as str or
+   bytearray.  obj holds a reference to the exporter, which must keep buf
+   valid until PyBuffer_Release() is called. */
+typedef struct bufferinfo {
+    void *buf;
+    PyObject *obj;        /* owned reference */
+    Py_ssize_t len;
+    int readonly;
+} Py_buffer;
+
+typedef int (*getbufferproc)(PyObject *, Py_buffer *, int);
+typedef void (*releasebufferproc)(PyObject *, Py_buffer *);
+
+typedef struct {
+     getbufferproc bf_getbuffer;
+     releasebufferproc bf_releasebuffer;
+} PyBufferProcs;
+
+/* Flags for getting buffers */
+#define PyBUF_SIMPLE 0
+#define PyBUF_WRITABLE 0x0001
+
 /* Allow printfunc in the tp_vectorcall_offset slot for
  * backwards-compatibility */
 typedef Py_ssize_t printfunc;
@@ -706,7 +728,7 @@ struct _typeobject {
     setattrofunc tp_setattro;
 
     /* Functions to access object as input/output buffer */
-    void *tp_as_buffer;
+    PyBufferProcs *tp_as_buffer;
 
     /* Flags to define presence of optional/expanded features */
     unsigned long tp_flags;
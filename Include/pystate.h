@@ -109,7 +109,12 @@ struct _ts {
 
     /* Borrowed reference to the current frame (it can be NULL) */
     PyFrameObject *frame;
-  
+
+    /* C-level profile hook, called on frame entry (PyTrace_CALL) and
+       frame exit (PyTrace_RETURN).  See PyEval_SetProfile(). */
+    Py_tracefunc c_profilefunc;
+    PyObject *c_profileobj;
+
     /* The exception currently being raised */
     PyObject *curexc_type;
     PyObject *curexc_value;
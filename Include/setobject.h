@@ -19,6 +19,7 @@ PyAPI_FUNC(int) PySet_Discard(PyObject *set, PyObject *key);
 PyAPI_FUNC(PyObject *) PySet_Pop(PyObject *set);
 PyAPI_FUNC(Py_ssize_t) PySet_Size(PyObject *anyset);
 PyAPI_FUNC(int) PySet_Update(PyObject *set, PyObject *iterable);
+PyAPI_FUNC(int) _PySet_Reserve(PyObject *set, Py_ssize_t n, int exact);
 
 /* Internal function. Used to iterate over set key/hash values */
 PyAPI_FUNC(int) PySet_NextEntry(PyObject *set, Py_ssize_t *pos, PyObject **key, Py_hash_t *hash);
@@ -0,0 +1,11 @@
+'''This module implements specialized container datatypes providing
+alternatives to Python's general purpose built-in containers, dict,
+list, set, and tuple.
+
+* deque        list-like container with fast appends and pops on either end
+
+'''
+
+__all__ = ['deque']
+
+from _collections import deque
@@ -0,0 +1,139 @@
+"""Tests for the array module, checked against lists.
+
+Run directly: ./python Lib/test/test_array.py.  A failed assert makes
+the process exit with a non-zero status.
+"""
+
+import io
+import os
+from array import array
+
+TESTFILE = "/tmp/test_array.bin"
+
+INT_RANGES = {
+    "b": (-2 ** 7, 2 ** 7 - 1), "B": (0, 2 ** 8 - 1),
+    "h": (-2 ** 15, 2 ** 15 - 1), "H": (0, 2 ** 16 - 1),
+    "i": (-2 ** 31, 2 ** 31 - 1), "I": (0, 2 ** 32 - 1),
+    "q": (-2 ** 63, 2 ** 63 - 1), "Q": (0, 2 ** 64 - 1),
+}
+
+
+def expect(exc, f, *args):
+    try:
+        f(*args)
+    except exc:
+        pass
+    else:
+        raise AssertionError("%s not raised" % exc.__name__)
+
+
+def test_item_ranges():
+    for code, (lo, hi) in INT_RANGES.items():
+        a = array(code, [lo, hi, 0])
+        assert a.tolist() == [lo, hi, 0]
+        assert a.itemsize * 8 >= (hi - lo).bit_length()
+        expect(OverflowError, a.append, hi + 1)
+        expect(OverflowError, a.append, lo - 1)
+        assert len(a) == 3
+    for code in "lL":
+        assert array(code, [7]).tolist() == [7]
+    assert array("f", [0.5, -2.0]).tolist() == [0.5, -2.0]
+    assert array("f", [0.1])[0] != 0.1
+    assert array("d", [0.1])[0] == 0.1
+    expect(TypeError, array("i").append, 1.5)
+    expect(TypeError, array("d").append, "x")
+    expect(ValueError, array, "z")
+
+
+def test_sequence():
+    for code in ("b", "i", "q", "d"):
+        model = list(range(-20, 20))
+        a = array(code, model)
+        assert a.typecode == code and len(a) == len(model)
+        for s in (slice(None), slice(3, 30, 4), slice(None, None, -1),
+                  slice(-5, 2, -3), slice(10, 5)):
+            assert a[s].tolist() == model[s]
+        a[2:5] = array(code, [9, 9])
+        model[2:5] = [9, 9]
+        a[::3] = array(code, [1] * len(model[::3]))
+        model[::3] = [1] * len(model[::3])
+        del a[1::4]
+        del model[1::4]
+        a[-1] = 5
+        model[-1] = 5
+        assert a.tolist() == model
+        expect(IndexError, lambda: a[len(model)])
+        expect(ValueError, a.__setitem__, slice(None, None, 2),
+               array(code, [1]))
+        expect(TypeError, a.__setitem__, slice(0, 2), array("H", [1, 2]))
+        a.extend(array(code, [3, 4]))
+        a.extend([5])
+        model += [3, 4, 5]
+        assert a.pop() == model.pop() and a.pop(0) == model.pop(0)
+        assert (a + a).tolist() == model + model
+        assert a == array(code, model) and not (a != array(code, model))
+        assert (a < a + array(code, [0])) and not (a < a)
+        del a[:]
+        assert len(a) == 0 and a.tolist() == []
+        expect(IndexError, a.pop)
+
+
+def test_bytes_and_files():
+    for code in ("h", "Q", "f", "d"):
+        a = array(code, range(1000))
+        s = a.tobytes()
+        assert len(s) == 1000 * a.itemsize
+        b = array(code)
+        b.frombytes(s)
+        assert b == a
+        expect(ValueError, b.frombytes, s[:a.itemsize + 1])
+    a = array("i", range(100000))
+    try:
+        with io.open(TESTFILE, "wb") as f:
+            a.tofile(f)
+        b = array("i")
+        with io.open(TESTFILE, "rb") as f:
+            b.fromfile(f, 60000)
+            b.fromfile(f, 40000)
+            expect(EOFError, b.fromfile, f, 1)
+        assert b == a
+    finally:
+        os.remove(TESTFILE)
+
+
+def test_reductions():
+    # Every length around the unrolled loops, so the tails are covered.
+    for n in range(0, 70):
+        ints = [(i * 7919) % 2001 - 1000 for i in range(n)]
+        for code in ("b", "h", "i", "q", "d"):
+            vals = ints if code != "b" else [x % 100 for x in ints]
+            a = array(code, vals)
+            assert a.sum() == sum(vals)
+            assert a.dot(a) == sum(x * x for x in vals)
+            if n:
+                assert a.min() == min(vals) and a.max() == max(vals)
+            else:
+                expect(ValueError, a.min)
+                expect(ValueError, a.max)
+    big = array("q", [2 ** 62] * 8)
+    assert big.sum() == 2 ** 65
+    assert array("Q", [2 ** 64 - 1] * 3).sum() == 3 * (2 ** 64 - 1)
+    assert array("q", [-2 ** 63] * 3).sum() == -3 * 2 ** 63
+    nan = float("nan")
+    for pos in (0, 5, 16):
+        vals = [1.0] * 20
+        vals[pos] = nan
+        a = array("d", vals)
+        assert a.max() != a.max() and a.min() != a.min()
+    expect(ValueError, array("i", [1]).dot, array("i", [1, 2]))
+
+
+def main():
+    test_item_ranges()
+    test_sequence()
+    test_bytes_and_files()
+    test_reductions()
+    print("test_array: ok")
+
+
+main()
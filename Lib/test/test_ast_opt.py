@@ -0,0 +1,147 @@
+"""Tests for the AST optimizer: dead code, builtin calls and f-strings.
+
+Run directly: ./python Lib/test/test_ast_opt.py.  A failed assert makes
+the process exit with a non-zero status.
+"""
+
+import os
+import sys
+
+TESTDIR = "/tmp/test_ast_opt_dir"
+
+
+def write_module(name, source):
+    with open(TESTDIR + "/" + name + ".py", "w") as f:
+        f.write(source)
+
+
+def import_module(name, source):
+    write_module(name, source)
+    __import__(name)
+    return sys.modules[name]
+
+
+def peak_kib():
+    with open("/proc/self/status") as f:
+        for line in f.read().split("\n"):
+            if line.startswith("VmHWM:"):
+                return int(line.split()[1])
+    return 0
+
+
+def test_builtins_folded_on_import():
+    mod = import_module("astopt_fold", "def f():\n    return len('abc')\n")
+    assert 3 in mod.f.__code__.co_consts
+    assert mod.f() == 3
+
+
+def test_builtins_not_folded_when_bound():
+    mod = import_module("astopt_bound",
+                        "def f():\n    return len('abc')\n"
+                        "def len(x):\n    return 42\n")
+    assert mod.f() == 42
+    mod = import_module("astopt_imported",
+                        "from astopt_fold import f as len\n"
+                        "def g():\n    return len('abc')\n")
+    assert 3 not in mod.g.__code__.co_consts
+    mod = import_module("astopt_globals",
+                        "globals()['len'] = lambda x: 42\n"
+                        "def f():\n    return len('abc')\n")
+    assert mod.f() == 42
+
+
+def test_builtins_not_folded_by_compile_or_exec():
+    ns = {"len": lambda x: 42}
+    exec("r = len('ab')", ns)
+    assert ns["r"] == 42
+    code = compile("r = len('abc')", "<test>", "exec")
+    assert 3 not in code.co_consts
+    ns = {}
+    exec(code, ns)
+    assert ns["r"] == 3
+    try:
+        compile("x = 1", "<test>", "exec", 0x4000)
+    except ValueError:
+        pass
+    else:
+        assert False, "compile() accepted a private flag"
+
+
+def test_fstrings():
+    def f():
+        return f"{5:>3}|{1.5:.2f}|{'a'!r}"
+    assert f() == "  5|1.50|'a'"
+    assert "  5|1.50|'a'" in f.__code__.co_consts
+    # A width above the size limit is left for run time, unformatted
+    before = peak_kib()
+    code = compile('def f():\n    return f"{0:>1000000000}"\n',
+                   "<test>", "exec")
+    assert peak_kib() - before < 64 * 1024
+    code = compile('x = f"{0:.100000}"', "<test>", "exec")
+    assert max([len(c) for c in code.co_consts if isinstance(c, str)]) < 10
+
+
+def test_dead_code():
+    def gen():
+        if 0:
+            yield 1
+        return 2
+    assert type(gen()).__name__ == "generator"
+
+    def after_return():
+        return 1
+        x = 2
+    assert after_return() == 1
+
+    def local_in_dead_branch():
+        if 0:
+            y = 1
+        try:
+            return y
+        except NameError:
+            return "unbound"
+    assert local_in_dead_branch() == "unbound"
+
+    try:
+        compile("if 0:\n    break\n", "<test>", "exec")
+    except SyntaxError:
+        pass
+    else:
+        assert False, "dead 'break' outside a loop was not rejected"
+
+    n = 0
+    while 0:
+        n += 1
+    else:
+        n = 5
+    assert n == 5
+
+
+def main():
+    # The code cache would skip compiling the test modules
+    sys.dont_write_bytecode = True
+    try:
+        os.mkdir(TESTDIR)
+    except OSError:
+        pass
+    sys.path.insert(0, TESTDIR)
+    names = ["astopt_fold", "astopt_bound", "astopt_imported",
+             "astopt_globals"]
+    try:
+        test_builtins_folded_on_import()
+        test_builtins_not_folded_when_bound()
+        test_builtins_not_folded_by_compile_or_exec()
+        test_fstrings()
+        test_dead_code()
+    finally:
+        sys.path.remove(TESTDIR)
+        for name in names:
+            try:
+                os.remove(TESTDIR + "/" + name + ".py")
+            except OSError:
+                pass
+        os.rmdir(TESTDIR)
+    print("test_ast_opt: ok")
+
+
+main()
@@ -0,0 +1,137 @@
+"""Tests for bytearray, memoryview and the buffer protocol.
+
+Run directly: ./python Lib/test/test_bytearray.py.  A failed assert makes
+the process exit with a non-zero status.
+"""
+
+import io
+import os
+
+TESTFILE = "/tmp/test_bytearray.bin"
+
+
+def expect(exc, f, *args):
+    try:
+        f(*args)
+    except exc:
+        pass
+    else:
+        raise AssertionError("%s not raised" % exc.__name__)
+
+
+def test_bytearray_model():
+    # Front deletions only move the start; check against a list of ints.
+    b = bytearray()
+    model = []
+    for i in range(2000):
+        b.append(i % 256)
+        model.append(i % 256)
+        if i % 3 == 0:
+            assert b.pop(0) == model.pop(0)
+        if i % 7 == 0:
+            del b[:2]
+            del model[:2]
+        if i % 11 == 0:
+            b.extend(bytearray([1, 2, 3]))
+            model.extend([1, 2, 3])
+    assert len(b) == len(model)
+    assert list(b) == model
+    assert b.pop() == model.pop()
+    b[5] = 200
+    model[5] = 200
+    assert b[5] == 200 and b[-1] == model[-1]
+    assert list(b[10:20]) == model[10:20]
+    expect(ValueError, b.append, 256)
+    expect(IndexError, lambda: b[len(model)])
+
+
+def test_bytearray_ops():
+    b = bytearray("spam")
+    assert len(b) == 4 and b[0] == ord("s")
+    assert bytearray(3) == bytearray([0, 0, 0])
+    assert b + bytearray("eggs") == bytearray("spameggs")
+    assert b * 3 == bytearray("spamspamspam")
+    assert b * 0 == bytearray() and bytearray() * 5 == bytearray()
+    del b[:1]
+    assert b * 2 == bytearray("pampam")
+    assert b.find("am") == 1 and b.find("x") == -1
+    c = b.copy()
+    c.append(33)
+    assert b == bytearray("pam") and c == bytearray("pam!")
+    c.clear()
+    assert len(c) == 0 and repr(c) == "bytearray('')"
+
+
+def test_exports_block_resize():
+    b = bytearray("abcdef")
+    m = memoryview(b)
+    for resize in (lambda: b.append(1), lambda: b.extend(bytearray(3)),
+                   lambda: b.pop(), lambda: b.clear(),
+                   lambda: b.__delitem__(slice(0, 2))):
+        expect(BufferError, resize)
+    assert b == bytearray("abcdef")
+    b[0] = ord("A")
+    assert m[0] == ord("A")
+    m.release()
+    assert m.released
+    expect(ValueError, lambda: m[0])
+    b.append(ord("g"))
+    assert len(b) == 7
+
+
+def test_memoryview():
+    b = bytearray("0123456789")
+    m = memoryview(b)
+    assert len(m) == 10 and m.nbytes == 10 and not m.readonly
+    assert m.obj is b
+    s = m[2:6]
+    assert len(s) == 4 and s.tobytes() == "2345"
+    assert s.tolist() == [ord(c) for c in "2345"]
+    s[0:2] = "ab"
+    m[9] = ord("Z")
+    assert b == bytearray("01ab45678Z")
+    expect(ValueError, s.__setitem__, slice(0, 2), "abc")
+    expect(NotImplementedError, lambda: m[::2])
+    ro = memoryview("text")
+    assert ro.readonly and ro.tobytes() == "text"
+    expect(TypeError, ro.__setitem__, 0, 65)
+    expect(TypeError, memoryview, 42)
+    m.release()
+    s.release()
+    b.append(0)
+
+
+def test_fileio():
+    try:
+        with io.FileIO(TESTFILE, "w") as f:
+            assert f.write("head") == 4
+            assert f.write(bytearray("-mid-")) == 5
+            assert f.write(memoryview(bytearray("xxtailxx"))[2:6]) == 4
+            expect(TypeError, f.write, 42)
+        with io.FileIO(TESTFILE, "r") as f:
+            buf = bytearray(6)
+            assert f.readinto(buf) == 6
+            assert buf == bytearray("head-m")
+            view = memoryview(buf)[1:4]
+            assert f.readinto(view) == 3
+            assert buf == bytearray("hid--m")
+            assert f.readinto(bytearray(100)) == 4
+            assert f.readinto(bytearray(10)) == 0
+            expect(TypeError, f.readinto, "read-only")
+            view.release()
+        with io.open(TESTFILE, "rb") as f:
+            assert f.read() == "head-mid-tail"
+    finally:
+        os.remove(TESTFILE)
+
+
+def main():
+    test_bytearray_model()
+    test_bytearray_ops()
+    test_exports_block_resize()
+    test_memoryview()
+    test_fileio()
+    print("test_bytearray: ok")
+
+
+main()
@@ -0,0 +1,248 @@
+"""Tests for collections.deque, checked against a list model.
+
+Run directly: ./python Lib/test/test_collections.py.  A failed assert
+makes the process exit with a non-zero status.
+"""
+
+from collections import deque
+
+
+class Random:
+    # Small LCG: the tree has no random module.
+    def __init__(self, seed):
+        self.state = seed
+
+    def randrange(self, n):
+        self.state = (self.state * 6364136223846793005
+                      + 1442695040888963407) % 2 ** 64
+        return (self.state >> 33) % n
+
+
+class Model:
+    """The list a deque should hold, with maxlen trimming."""
+
+    def __init__(self, maxlen):
+        self.items = []
+        self.maxlen = maxlen
+
+    def append(self, x):
+        if self.maxlen == 0:
+            return
+        if self.maxlen is not None and len(self.items) == self.maxlen:
+            del self.items[0]
+        self.items.append(x)
+
+    def appendleft(self, x):
+        if self.maxlen == 0:
+            return
+        if self.maxlen is not None and len(self.items) == self.maxlen:
+            del self.items[-1]
+        self.items.insert(0, x)
+
+    def rotate(self, n):
+        if self.items:
+            n = n % len(self.items)
+            if n:
+                self.items[:] = self.items[-n:] + self.items[:-n]
+
+
+def check(d, m):
+    assert len(d) == len(m.items)
+    assert list(d) == m.items, (list(d), m.items)
+    assert list(reversed(d)) == m.items[::-1]
+    assert d.maxlen == m.maxlen
+
+
+def step(rng, d, m, n):
+    op = rng.randrange(17)
+    x = rng.randrange(50)
+    if op == 0:
+        d.append(n)
+        m.append(n)
+    elif op == 1:
+        d.appendleft(n)
+        m.appendleft(n)
+    elif op == 2:
+        if m.items:
+            assert d.pop() == m.items.pop()
+        else:
+            try:
+                d.pop()
+            except IndexError:
+                pass
+            else:
+                raise AssertionError("pop() from an empty deque")
+    elif op == 3:
+        if m.items:
+            assert d.popleft() == m.items.pop(0)
+        else:
+            try:
+                d.popleft()
+            except IndexError:
+                pass
+            else:
+                raise AssertionError("popleft() from an empty deque")
+    elif op == 4:
+        new = [n + i for i in range(rng.randrange(150))]
+        d.extend(new)
+        for v in new:
+            m.append(v)
+    elif op == 5:
+        new = [n + i for i in range(rng.randrange(150))]
+        d.extendleft(iter(new))
+        for v in new:
+            m.appendleft(v)
+    elif op == 6:
+        k = rng.randrange(300) - 150
+        d.rotate(k)
+        m.rotate(k)
+    elif op == 7:
+        d.reverse()
+        m.items.reverse()
+    elif op == 8:
+        v = m.items[x % len(m.items)] if m.items and x % 3 else -1
+        if v in m.items:
+            d.remove(v)
+            m.items.remove(v)
+        else:
+            try:
+                d.remove(v)
+            except ValueError:
+                pass
+            else:
+                raise AssertionError("remove() of a missing value")
+    elif op == 9:
+        v = m.items[x % len(m.items)] if m.items else 0
+        assert d.count(v) == m.items.count(v)
+        assert (v in d) == (v in m.items)
+        assert (-1 in d) == (-1 in m.items)
+    elif op == 10:
+        if m.items:
+            i = x % len(m.items) - (x & 1) * len(m.items)
+            assert d[i] == m.items[i]
+            d[i] = -n
+            m.items[i] = -n
+        for i in (len(m.items), -len(m.items) - 1):
+            try:
+                d[i]
+            except IndexError:
+                pass
+            else:
+                raise AssertionError("index %d out of range" % i)
+    elif op == 11:
+        if m.items:
+            i = x % len(m.items)
+            del d[i]
+            del m.items[i]
+    elif op == 12:
+        c = d.copy()
+        assert type(c) is deque and c.maxlen == d.maxlen
+        assert c == d and list(c) == m.items
+        c.append(n)
+        assert list(d) == m.items
+    elif op == 13:
+        other = deque(m.items[:-1] + [n])
+        if m.items:
+            assert (d < other) == (m.items < list(other))
+            assert (d >= other) == (m.items >= list(other))
+        assert (d == deque(m.items)) and not (d != deque(m.items))
+        assert repr(d) == repr_of(m)
+    elif op == 14:
+        if rng.randrange(10) == 0:
+            d.clear()
+            m.items.clear()
+    elif op == 15:
+        it = iter(d)
+        for v in m.items[:x]:
+            assert next(it) == v
+    else:
+        check(d, m)
+
+
+def repr_of(m):
+    if m.maxlen is None:
+        return "deque(%r)" % (m.items,)
+    return "deque(%r, maxlen=%d)" % (m.items, m.maxlen)
+
+
+def test_model():
+    for seed, maxlen in ((1, None), (2, None), (3, 0), (4, 1), (5, 7),
+                         (6, 64), (7, 100), (8, 300)):
+        rng = Random(seed)
+        d = deque(maxlen=maxlen)
+        m = Model(maxlen)
+        for n in range(3000):
+            step(rng, d, m, n)
+        check(d, m)
+
+
+def test_init():
+    assert list(deque(range(200))) == list(range(200))
+    assert list(deque(range(200), 10)) == list(range(190, 200))
+    d = deque([1, 2, 3], maxlen=5)
+    d.__init__("ab")
+    assert list(d) == ["a", "b"] and d.maxlen is None
+    for bad in (-1, "x"):
+        try:
+            deque([], bad)
+        except (ValueError, TypeError):
+            pass
+        else:
+            raise AssertionError("bad maxlen %r accepted" % (bad,))
+
+
+def test_mutation_during_iteration():
+    d = deque(range(100))
+    for grow in (d.append, d.appendleft):
+        it = iter(d)
+        next(it)
+        grow(0)
+        try:
+            next(it)
+        except RuntimeError:
+            pass
+        else:
+            raise AssertionError("deque mutated during iteration")
+    it = reversed(d)
+    next(it)
+    d.pop()
+    try:
+        next(it)
+    except RuntimeError:
+        pass
+    else:
+        raise AssertionError("deque mutated during reversed iteration")
+
+    class Evil:
+        def __eq__(self, other):
+            d.clear()
+            return False
+
+    d = deque([1, 2, Evil(), 4])
+    for scan in (lambda: d.count(4), lambda: d.remove(4), lambda: 4 in d):
+        d.extend([1, 2, Evil(), 4])
+        try:
+            scan()
+        except RuntimeError:
+            pass
+        else:
+            raise AssertionError("deque mutated during a scan")
+
+
+def test_length_hint():
+    d = deque(range(10))
+    it = iter(d)
+    next(it)
+    assert it.__length_hint__() == 9
+    assert len(list(it)) == 9
+
+
+def main():
+    test_model()
+    test_init()
+    test_mutation_during_iteration()
+    test_length_hint()
+    print("test_collections: ok")
+
+
+main()
@@ -0,0 +1,143 @@
+"""Tests for heapq, checked against sorted().
+
+Run directly: ./python Lib/test/test_heapq.py.  A failed assert makes
+the process exit with a non-zero status.
+"""
+
+from heapq import (heappush, heappop, heapify, heapreplace, heappushpop,
+                   merge, nsmallest, nlargest)
+
+
+class Random:
+    # Small LCG: the tree has no random module.
+    def __init__(self, seed):
+        self.state = seed
+
+    def randrange(self, n):
+        self.state = (self.state * 6364136223846793005
+                      + 1442695040888963407) % 2 ** 64
+        return (self.state >> 33) % n
+
+
+def is_heap(heap):
+    for k in range(1, len(heap)):
+        if heap[k] < heap[(k - 1) // 2]:
+            return False
+    return True
+
+
+def datasets():
+    rng = Random(1)
+    ints = [rng.randrange(1000) - 500 for i in range(500)]
+    yield ints
+    yield [x * 0.5 for x in ints]
+    yield [str(x) for x in ints]
+    yield [(x % 7, str(x)) for x in ints]
+    yield [x * 10 ** 30 for x in ints]
+    yield [x if x % 2 else x + 0.25 for x in ints]
+    yield []
+    yield [3]
+
+
+def test_push_pop():
+    for data in datasets():
+        heap = []
+        for x in data:
+            heappush(heap, x)
+            assert is_heap(heap)
+        assert [heappop(heap) for x in data] == sorted(data)
+        assert heap == []
+
+
+def test_heapify():
+    for data in datasets():
+        heap = list(data)
+        heapify(heap)
+        assert is_heap(heap)
+        assert sorted(heap) == sorted(data)
+
+
+def test_replace_and_pushpop():
+    heap = [5, 7, 9]
+    assert heapreplace(heap, 1) == 5
+    assert sorted(heap) == [1, 7, 9] and is_heap(heap)
+    assert heappushpop(heap, 0) == 0
+    assert heappushpop(heap, 8) == 1
+    assert sorted(heap) == [7, 8, 9] and is_heap(heap)
+    assert heappushpop([], 4) == 4
+    for f in (heappop, lambda h: heapreplace(h, 1)):
+        try:
+            f([])
+        except IndexError:
+            pass
+        else:
+            raise AssertionError("pop from an empty heap")
+    try:
+        heappush((), 1)
+    except TypeError:
+        pass
+    else:
+        raise AssertionError("heappush() accepted a tuple")
+
+
+def test_nsmallest_nlargest():
+    for data in datasets():
+        for n in (0, 1, 5, 100, len(data), len(data) + 10):
+            assert nsmallest(n, data) == sorted(data)[:n]
+            assert nsmallest(n, iter(data)) == sorted(data)[:n]
+            assert nlargest(n, data) == sorted(data, reverse=True)[:n]
+            assert nlargest(n, iter(data)) == sorted(data, reverse=True)[:n]
+    # Ties keep the input order, as sorted() does
+    data = [(i % 5, i) for i in range(100)]
+    key = lambda t: t[0]
+    for n in (1, 7, 30):
+        assert nsmallest(n, data, key=key) == sorted(data, key=key)[:n]
+        assert (nlargest(n, data, key=key)
+                == sorted(data, key=key, reverse=True)[:n])
+    assert nsmallest(-1, [1, 2]) == [] and nlargest(-1, [1, 2]) == []
+
+
+def test_merge():
+    rng = Random(2)
+    inputs = [sorted(rng.randrange(100) for i in range(rng.randrange(30)))
+              for j in range(6)]
+    everything = sorted(x for inp in inputs for x in inp)
+    assert list(merge(*inputs)) == everything
+    assert list(merge()) == []
+    assert list(merge([], [1], [])) == [1]
+    rev = [sorted(inp, reverse=True) for inp in inputs]
+    assert list(merge(*rev, reverse=True)) == everything[::-1]
+    words = [["a", "bbb"], ["cc", "dddd"]]
+    assert list(merge(*words, key=len)) == ["a", "cc", "bbb", "dddd"]
+
+
+def test_mutating_comparison():
+    heap = []
+
+    class Evil:
+        def __lt__(self, other):
+            heap.clear()
+            return False
+
+    for f in (lambda: heappush(heap, Evil()), lambda: heappop(heap),
+              lambda: heapify(heap), lambda: heapreplace(heap, Evil())):
+        heap[:] = [Evil(), Evil(), Evil()]
+        try:
+            f()
+        except RuntimeError:
+            pass
+        else:
+            raise AssertionError("heap resized by a comparison")
+
+
+def main():
+    test_push_pop()
+    test_heapify()
+    test_replace_and_pushpop()
+    test_nsmallest_nlargest()
+    test_merge()
+    test_mutating_comparison()
+    print("test_heapq: ok")
+
+
+main()
@@ -0,0 +1,92 @@
+"""Regression tests for the import statement.
+
+Run directly: ./python Lib/test/test_import.py.  A crash or a failed
+assert makes the process exit with a non-zero status.
+"""
+
+import os
+import sys
+
+TESTDIR = "/tmp/test_import_dir"
+
+
+def write_module(name, source):
+    path = TESTDIR + "/" + name + ".py"
+    with open(path, "w") as f:
+        f.write(source)
+    return path
+
+
+def test_from_source_module():
+    # A module loaded from a .py file used to be returned as a borrowed
+    # reference and released by "from m import x", leaving a dangling
+    # entry in sys.modules.
+    write_module("import_from_src", "x = [1, 2, 3]\ndef f():\n    return x\n")
+    from import_from_src import x, f
+    assert x == [1, 2, 3]
+    for i in range(100):
+        from import_from_src import f
+        junk = [str(j) for j in range(50)]
+    mod = sys.modules["import_from_src"]
+    assert mod.x is x
+    assert mod.f() == [1, 2, 3]
+    import import_from_src
+    assert import_from_src is mod
+
+
+def test_import_source_module():
+    write_module("import_plain_src", "y = 'spam'\n")
+    for i in range(100):
+        import import_plain_src
+    assert sys.modules["import_plain_src"].y == "spam"
+    assert import_plain_src.y == "spam"
+
+
+def test_nested_imports():
+    # The imports run by a module share the sys.path listings checked for
+    # the outermost import.
+    write_module("import_nest_c", "z = 3\n")
+    write_module("import_nest_b",
+                 "import import_nest_c\nz = import_nest_c.z + 2\n")
+    write_module("import_nest_a",
+                 "import import_nest_b\nz = import_nest_b.z + 1\n")
+    import import_nest_a
+    assert import_nest_a.z == 6
+
+
+def test_module_added_later():
+    try:
+        import import_added_later
+    except ImportError:
+        pass
+    else:
+        raise AssertionError("import_added_later found before it exists")
+    write_module("import_added_later", "w = 'eggs'\n")
+    import import_added_later
+    assert import_added_later.w == "eggs"
+
+
+def main():
+    try:
+        os.mkdir(TESTDIR)
+    except OSError:
+        pass
+    sys.path.insert(0, TESTDIR)
+    try:
+        test_from_source_module()
+        test_import_source_module()
+        test_nested_imports()
+        test_module_added_later()
+    finally:
+        sys.path.remove(TESTDIR)
+        for name in ("import_from_src", "import_plain_src", "import_nest_a",
+                     "import_nest_b", "import_nest_c", "import_added_later"):
+            try:
+                os.remove(TESTDIR + "/" + name + ".py")
+            except OSError:
+                pass
+        os.rmdir(TESTDIR)
+    print("test_import: ok")
+
+
+main()
@@ -0,0 +1,92 @@
+"""Tests for presizing containers from the length of their input.
+
+Run directly: ./python Lib/test/test_presize.py.  A failed assert makes
+the process exit with a non-zero status.
+"""
+
+
+class Countdown:
+    def __init__(self, n):
+        self.n = n
+
+    def __iter__(self):
+        return self
+
+    def __next__(self):
+        if self.n == 0:
+            raise StopIteration
+        self.n -= 1
+        return self.n
+
+
+class RaisingHint(Countdown):
+    def __length_hint__(self):
+        raise RuntimeError("no hint")
+
+
+class NegativeHint(Countdown):
+    def __length_hint__(self):
+        return -5
+
+
+class NonIntHint(Countdown):
+    def __length_hint__(self):
+        return "five"
+
+
+class HugeHint(Countdown):
+    def __length_hint__(self):
+        return 10 ** 12
+
+
+class NoMemoryHint(Countdown):
+    def __length_hint__(self):
+        raise MemoryError
+
+
+def test_bad_hints_ignored():
+    # A hint is only a hint: one which fails or is absurd must not change
+    # the result.
+    for cls in (Countdown, RaisingHint, NegativeHint, NonIntHint, HugeHint):
+        assert [x for x in cls(5)] == [4, 3, 2, 1, 0]
+        assert {x for x in cls(5)} == {0, 1, 2, 3, 4}
+        assert {x: -x for x in cls(3)} == {2: -2, 1: -1, 0: 0}
+        assert dict.fromkeys(cls(3)) == {0: None, 1: None, 2: None}
+        assert set(cls(3)) == {0, 1, 2}
+        s = {9}
+        s.update(cls(3))
+        assert s == {0, 1, 2, 9}
+        assert dict((x, x) for x in cls(2)) == {0: 0, 1: 1}
+        assert dict(zip(cls(2), cls(2))) == {1: 1, 0: 0}
+
+
+def test_memory_error_kept():
+    try:
+        [x for x in NoMemoryHint(3)]
+    except MemoryError:
+        pass
+    else:
+        raise AssertionError("MemoryError from __length_hint__ was lost")
+
+
+def test_exact_sizes():
+    # Exact sizes are reserved in full, past the caps for guesses.
+    n = 300000
+    assert len(set(range(n))) == n
+    assert len({x for x in range(n)}) == n
+    assert len({x: 0 for x in range(n)}) == n
+    assert len(dict.fromkeys(range(n))) == n
+    assert len([x for x in range(2 * 1024 * 1024)]) == 2 * 1024 * 1024
+    d = {}
+    d.update(zip(range(n), range(n)))
+    assert len(d) == n and d[n - 1] == n - 1
+
+
+def main():
+    test_bad_hints_ignored()
+    test_memory_error_kept()
+    test_exact_sizes()
+    print("test_presize: ok")
+
+
+main()
@@ -0,0 +1,141 @@
+"""Tests for list.sort() on the radix sort path, serial and parallel.
+
+Run directly: ./python Lib/test/test_sort.py.  A failed assert makes the
+process exit with a non-zero status.
+"""
+
+
+class Random:
+    # Small LCG: the tree has no random module.
+    def __init__(self, seed):
+        self.state = seed
+
+    def randrange(self, n):
+        self.state = (self.state * 6364136223846793005
+                      + 1442695040888963407) % 2 ** 64
+        return (self.state >> 33) % n
+
+
+def ref_sort(data, key=None, reverse=False):
+    # Tuples of (key, index) never take the radix path, and the index
+    # makes the merge sort result unique, so this is the stable order.
+    if reverse:
+        return ref_sort(data[::-1], key)[::-1]
+    if key is None:
+        key = lambda x: x
+    pairs = sorted([(key(x), i) for i, x in enumerate(data)])
+    return [data[i] for k, i in pairs]
+
+
+def same(a, b):
+    # Compares identities, so that stability is checked for equal items
+    return len(a) == len(b) and all(x is y for x, y in zip(a, b))
+
+
+def int_lists(rng, n):
+    yield [rng.randrange(1000) for i in range(n)]
+    yield [rng.randrange(2 ** 40) - 2 ** 39 for i in range(n)]
+    yield [2 ** 61 - rng.randrange(3) for i in range(n)] + [-2 ** 61]
+    # Too wide for 62 bits: the merge sort takes it
+    yield [rng.randrange(100) for i in range(n)] + [2 ** 70, -2 ** 70]
+    yield [1000 + i // 7 for i in range(n)]
+    yield [True, False] * (n // 2) + [5]
+
+
+def float_lists(rng, n):
+    yield [rng.randrange(10 ** 6) / 7.0 - 50000 for i in range(n)]
+    yield ([0.0, -0.0, 1.5, -1.5, float("inf"), float("-inf")] * (n // 6)
+           + [1e-310, -1e-310, 1e308])
+    yield [float(rng.randrange(5)) for i in range(n)]
+
+
+def str_lists(rng, n):
+    yield [str(rng.randrange(10 ** 9)) for i in range(n)]
+    yield ["common-prefix-%d" % rng.randrange(n) for i in range(n)]
+    yield ["abcdefgh" + str(rng.randrange(50)) for i in range(n)] + [""]
+    yield ["é" * rng.randrange(4) + "ab"[rng.randrange(2)]
+           for i in range(n)]
+
+
+def check(data, key=None):
+    for reverse in (False, True):
+        got = sorted(data, key=key, reverse=reverse)
+        assert same(got, ref_sort(data, key, reverse))
+        lst = list(data)
+        lst.sort(key=key, reverse=reverse)
+        assert same(lst, got)
+
+
+def test_radix():
+    rng = Random(1)
+    for n in (1023, 1024, 5000):
+        for gen in (int_lists, float_lists, str_lists):
+            for data in gen(rng, n):
+                check(data)
+
+
+def test_key():
+    rng = Random(2)
+    data = [(rng.randrange(50), i) for i in range(3000)]
+    check(data, key=lambda t: t[0])
+    check(data, key=lambda t: t[0] * 0.5)
+    check(data, key=lambda t: "k%03d" % t[0])
+    words = ["w%d" % rng.randrange(100) for i in range(3000)]
+    check(words, key=len)
+
+
+def test_runs():
+    for data in (list(range(5000)), list(range(5000, 0, -1)),
+                 [float(i) for i in range(4000)] + [0.5]):
+        check(data)
+
+
+def test_nan():
+    nan = float("nan")
+    data = [float(i % 97) for i in range(3000)]
+    data[1500] = nan
+    got = sorted(data)
+    assert len(got) == len(data) and nan in got
+    assert sorted(x for x in got if x == x) == sorted(data[:1500]
+                                                      + data[1501:])
+
+
+def test_parallel():
+    # Chunks are at least 64K items, so these split into 2 to 4 chunks
+    rng = Random(3)
+    n = 300000
+    ints = [rng.randrange(10 ** 6) for i in range(n)]
+    floats = [x / 3.0 for x in ints]
+    strs = ["s%d" % (x % 1000) for x in ints[:150000]]
+    for data in (ints, floats, strs):
+        expected = sorted(data)
+        for parallel in (1, 2, 4, 16):
+            assert same(sorted(data, parallel=parallel), expected)
+        lst = list(data)
+        lst.sort(reverse=True, parallel=4)
+        assert same(lst, sorted(data, reverse=True))
+    pairs = [(x % 100, i) for i, x in enumerate(ints[:200000])]
+    key = lambda t: t[0]
+    assert same(sorted(pairs, key=key, parallel=3),
+                ref_sort(pairs, key))
+    # Ignored off the radix path
+    assert sorted([(2,), (1,)] * 3, parallel=8) == [(1,)] * 3 + [(2,)] * 3
+    for bad in (0, -1):
+        try:
+            sorted(ints[:10], parallel=bad)
+        except ValueError:
+            pass
+        else:
+            raise AssertionError("parallel=%d accepted" % bad)
+
+
+def main():
+    test_radix()
+    test_key()
+    test_runs()
+    test_nan()
+    test_parallel()
+    print("test_sort: ok")
+
+
+main()
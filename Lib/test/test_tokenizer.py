@@ -0,0 +1,64 @@
+"""Regression tests for the tokenizer.
+
+Run directly: ./python Lib/test/test_tokenizer.py.  A crash or a failed
+assert makes the process exit with a non-zero status.
+"""
+
+import os
+import sys
+
+TESTDIR = "/tmp/test_tokenizer_dir"
+
+
+def test_large_module_non_ascii():
+    # Sources of 64 KiB or more are tokenized in a read-only mapping;
+    # backing up over a non-ASCII character used to write to it.
+    lines = ["a%d = %d" % (i, i) for i in range(8000)]
+    lines.append('x = "é"')
+    lines.append('y = "café ☃"')
+    source = "\n".join(lines) + "\n"
+    assert len(source) >= 64 * 1024
+    with open(TESTDIR + "/tok_big_module.py", "w") as f:
+        f.write(source)
+    sys.path.insert(0, TESTDIR)
+    try:
+        import tok_big_module
+    finally:
+        sys.path.remove(TESTDIR)
+    assert tok_big_module.x == "é"
+    assert tok_big_module.y == "café ☃"
+    assert tok_big_module.a7999 == 7999
+
+
+def test_exec_keeps_source():
+    # exec() and compile() tokenize the str in place: it must not change.
+    source = 'z = "éè"\nw = z + "..."\n'
+    copy = "".join([c for c in source])
+    ns = {}
+    exec(source, ns)
+    assert ns["w"] == "éè..."
+    assert source == copy
+    code = compile(source, "<test>", "exec")
+    assert source == copy
+
+
+def main():
+    # Keep the code cache out of it: the module must be tokenized
+    sys.dont_write_bytecode = True
+    try:
+        os.mkdir(TESTDIR)
+    except OSError:
+        pass
+    try:
+        test_large_module_non_ascii()
+        test_exec_keeps_source()
+    finally:
+        try:
+            os.remove(TESTDIR + "/tok_big_module.py")
+        except OSError:
+            pass
+        os.rmdir(TESTDIR)
+    print("test_tokenizer: ok")
+
+
+main()
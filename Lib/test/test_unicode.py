@@ -0,0 +1,47 @@
+"""Regression tests for str methods.
+
+Run directly: ./python Lib/test/test_unicode.py.  A failed assert makes
+the process exit with a non-zero status.
+"""
+
+
+def test_startswith():
+    # tailmatch() used to report a match whenever the first or the last
+    # character differed.
+    assert not "abc".startswith("xbc")
+    assert not "abc".startswith("abx")
+    assert not "abc".startswith("axc")
+    assert "abc".startswith("abc")
+    assert "abc".startswith("ab")
+    assert "abc".startswith("")
+    assert not "abc".startswith("abcd")
+    assert "xabc".startswith("abc", 1)
+    assert not "xabc".startswith("xbc", 1)
+    assert not "abc".startswith("bc", 0, 2)
+    assert "abc".startswith(("x", "ab"))
+    assert not "abc".startswith(("xb", "ax"))
+    assert not "--save".startswith("-n")
+
+
+def test_endswith():
+    assert not "abc".endswith("abx")
+    assert not "abc".endswith("xbc")
+    assert not "abc".endswith("axc")
+    assert "abc".endswith("abc")
+    assert "abc".endswith("bc")
+    assert "abc".endswith("")
+    assert not "abc".endswith("zabc")
+    assert "abcx".endswith("abc", 0, 3)
+    assert not "abcx".endswith("abx", 0, 3)
+    assert "abc".endswith(("x", "bc"))
+    assert not "abc".endswith(("xc", "bx"))
+    assert not "file.txt".endswith(".py")
+
+
+def main():
+    test_startswith()
+    test_endswith()
+    print("test_unicode: ok")
+
+
+main()
@@ -0,0 +1,1199 @@
+/* Container types: deque
+ *
+ * A deque is a doubly linked list of blocks of BLOCKLEN item pointers, so
+ * that appends and pops at either end are O(1) and never move the other
+ * items, unlike list.insert(0, x) and list.pop(0).  Blocks emptied by pops
+ * are kept on a small per-deque free list for the next appends.
+ *
+ * The items live in leftblock->data[leftindex] ... rightblock->data[rightindex].
+ * An empty deque has one block with leftindex == rightindex + 1, centered
+ * so that it can grow in either direction without a new block.
+ *
+ * Every operation that moves the ends increments the state counter: an
+ * iterator remembers the state it started with and raises RuntimeError
+ * when the deque was mutated under it.
+ */
+
+#define PY_SSIZE_T_CLEAN
+#include "Python.h"
+
+
+#define BLOCKLEN 64
+#define CENTER ((BLOCKLEN - 1) / 2)
+#define MAXFREEBLOCKS 16
+
+typedef struct BLOCK {
+    struct BLOCK *leftlink;
+    PyObject *data[BLOCKLEN];
+    struct BLOCK *rightlink;
+} block;
+
+typedef struct {
+    PyObject_VAR_HEAD           /* ob_size is the number of items */
+    block *leftblock;
+    block *rightblock;
+    Py_ssize_t leftindex;       /* 0 <= leftindex < BLOCKLEN */
+    Py_ssize_t rightindex;      /* -1 <= rightindex < BLOCKLEN */
+    size_t state;               /* incremented whenever the ends move */
+    Py_ssize_t maxlen;          /* -1 when unbounded */
+    Py_ssize_t numfreeblocks;
+    block *freeblocks[MAXFREEBLOCKS];
+} dequeobject;
+
+static PyTypeObject deque_type;
+
+/* Is the deque longer than maxlen?  Always false for maxlen == -1. */
+#define NEEDS_TRIM(deque, maxlen) ((size_t)(maxlen) < (size_t)(Py_SIZE(deque)))
+
+static block *
+newblock(dequeobject *deque)
+{
+    block *b;
+
+    if (deque->numfreeblocks) {
+        deque->numfreeblocks--;
+        return deque->freeblocks[deque->numfreeblocks];
+    }
+    b = PyMem_Malloc(sizeof(block));
+    if (b == NULL) {
+        PyErr_NoMemory();
+        return NULL;
+    }
+    return b;
+}
+
+static void
+freeblock(dequeobject *deque, block *b)
+{
+    if (deque->numfreeblocks < MAXFREEBLOCKS) {
+        deque->freeblocks[deque->numfreeblocks] = b;
+        deque->numfreeblocks++;
+    }
+    else {
+        PyMem_Free(b);
+    }
+}
+
+static PyObject *
+deque_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
+{
+    dequeobject *deque;
+    block *b;
+
+    deque = (dequeobject *)type->tp_alloc(type, 0);
+    if (deque == NULL)
+        return NULL;
+    deque->numfreeblocks = 0;
+    b = newblock(deque);
+    if (b == NULL) {
+        Py_DECREF(deque);
+        return NULL;
+    }
+    b->leftlink = NULL;
+    b->rightlink = NULL;
+
+    Py_SET_SIZE(deque, 0);
+    deque->leftblock = b;
+    deque->rightblock = b;
+    deque->leftindex = CENTER + 1;
+    deque->rightindex = CENTER;
+    deque->state = 0;
+    deque->maxlen = -1;
+    return (PyObject *)deque;
+}
+
+static PyObject *
+deque_pop(dequeobject *deque, PyObject *unused)
+{
+    PyObject *item;
+    block *prevblock;
+
+    if (Py_SIZE(deque) == 0) {
+        PyErr_SetString(PyExc_IndexError, "pop from an empty deque");
+        return NULL;
+    }
+    item = deque->rightblock->data[deque->rightindex];
+    deque->rightindex--;
+    Py_SET_SIZE(deque, Py_SIZE(deque) - 1);
+    deque->state++;
+
+    if (deque->rightindex < 0) {
+        if (Py_SIZE(deque)) {
+            prevblock = deque->rightblock->leftlink;
+            freeblock(deque, deque->rightblock);
+            prevblock->rightlink = NULL;
+            deque->rightblock = prevblock;
+            deque->rightindex = BLOCKLEN - 1;
+        }
+        else {
+            /* Recenter instead of freeing the last block */
+            deque->leftindex = CENTER + 1;
+            deque->rightindex = CENTER;
+        }
+    }
+    return item;
+}
+
+PyDoc_STRVAR(pop_doc, "Remove and return the rightmost element.");
+
+static PyObject *
+deque_popleft(dequeobject *deque, PyObject *unused)
+{
+    PyObject *item;
+    block *nextblock;
+
+    if (Py_SIZE(deque) == 0) {
+        PyErr_SetString(PyExc_IndexError, "pop from an empty deque");
+        return NULL;
+    }
+    item = deque->leftblock->data[deque->leftindex];
+    deque->leftindex++;
+    Py_SET_SIZE(deque, Py_SIZE(deque) - 1);
+    deque->state++;
+
+    if (deque->leftindex == BLOCKLEN) {
+        if (Py_SIZE(deque)) {
+            nextblock = deque->leftblock->rightlink;
+            freeblock(deque, deque->leftblock);
+            nextblock->leftlink = NULL;
+            deque->leftblock = nextblock;
+            deque->leftindex = 0;
+        }
+        else {
+            deque->leftindex = CENTER + 1;
+            deque->rightindex = CENTER;
+        }
+    }
+    return item;
+}
+
+PyDoc_STRVAR(popleft_doc, "Remove and return the leftmost element.");
+
+/* Append item (a new reference, stolen) on the right, dropping the
+ * leftmost item if the deque grows past maxlen */
+static int
+deque_append_internal(dequeobject *deque, PyObject *item, Py_ssize_t maxlen)
+{
+    if (deque->rightindex == BLOCKLEN - 1) {
+        block *b = newblock(deque);
+        if (b == NULL) {
+            Py_DECREF(item);
+            return -1;
+        }
+        b->leftlink = deque->rightblock;
+        b->rightlink = NULL;
+        deque->rightblock->rightlink = b;
+        deque->rightblock = b;
+        deque->rightindex = -1;
+    }
+    Py_SET_SIZE(deque, Py_SIZE(deque) + 1);
+    deque->rightindex++;
+    deque->rightblock->data[deque->rightindex] = item;
+    if (NEEDS_TRIM(deque, maxlen)) {
+        PyObject *olditem = deque_popleft(deque, NULL);
+        Py_DECREF(olditem);
+    }
+    else {
+        deque->state++;
+    }
+    return 0;
+}
+
+static int
+deque_appendleft_internal(dequeobject *deque, PyObject *item,
+                          Py_ssize_t maxlen)
+{
+    if (deque->leftindex == 0) {
+        block *b = newblock(deque);
+        if (b == NULL) {
+            Py_DECREF(item);
+            return -1;
+        }
+        b->rightlink = deque->leftblock;
+        b->leftlink = NULL;
+        deque->leftblock->leftlink = b;
+        deque->leftblock = b;
+        deque->leftindex = BLOCKLEN;
+    }
+    Py_SET_SIZE(deque, Py_SIZE(deque) + 1);
+    deque->leftindex--;
+    deque->leftblock->data[deque->leftindex] = item;
+    if (NEEDS_TRIM(deque, maxlen)) {
+        PyObject *olditem = deque_pop(deque, NULL);
+        Py_DECREF(olditem);
+    }
+    else {
+        deque->state++;
+    }
+    return 0;
+}
+
+static PyObject *
+deque_append(dequeobject *deque, PyObject *item)
+{
+    Py_INCREF(item);
+    if (deque_append_internal(deque, item, deque->maxlen) < 0)
+        return NULL;
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(append_doc, "Add an element to the right side of the deque.");
+
+static PyObject *
+deque_appendleft(dequeobject *deque, PyObject *item)
+{
+    Py_INCREF(item);
+    if (deque_appendleft_internal(deque, item, deque->maxlen) < 0)
+        return NULL;
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(appendleft_doc, "Add an element to the left side of the deque.");
+
+/* Run through the iterator when the deque has maxlen 0 */
+static PyObject *
+consume_iterator(PyObject *it)
+{
+    PyObject *item;
+
+    while ((item = PyIter_Next(it)) != NULL) {
+        Py_DECREF(item);
+    }
+    Py_DECREF(it);
+    if (PyErr_Occurred())
+        return NULL;
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+deque_extend_side(dequeobject *deque, PyObject *iterable,
+                  int (*append)(dequeobject *, PyObject *, Py_ssize_t))
+{
+    PyObject *it, *item;
+
+    /* Extending by itself: work on a copy */
+    if ((PyObject *)deque == iterable) {
+        PyObject *result, *s = PySequence_List(iterable);
+        if (s == NULL)
+            return NULL;
+        result = deque_extend_side(deque, s, append);
+        Py_DECREF(s);
+        return result;
+    }
+
+    it = PyObject_GetIter(iterable);
+    if (it == NULL)
+        return NULL;
+    if (deque->maxlen == 0)
+        return consume_iterator(it);
+
+    while ((item = PyIter_Next(it)) != NULL) {
+        if (append(deque, item, deque->maxlen) < 0) {
+            Py_DECREF(it);
+            return NULL;
+        }
+    }
+    Py_DECREF(it);
+    if (PyErr_Occurred())
+        return NULL;
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+deque_extend(dequeobject *deque, PyObject *iterable)
+{
+    return deque_extend_side(deque, iterable, deque_append_internal);
+}
+
+PyDoc_STRVAR(extend_doc,
+"Extend the right side of the deque with elements from the iterable");
+
+static PyObject *
+deque_extendleft(dequeobject *deque, PyObject *iterable)
+{
+    return deque_extend_side(deque, iterable, deque_appendleft_internal);
+}
+
+PyDoc_STRVAR(extendleft_doc,
+"Extend the left side of the deque with elements from the iterable");
+
+static PyObject *
+deque_copy(PyObject *deque, PyObject *Py_UNUSED(ignored))
+{
+    dequeobject *old = (dequeobject *)deque;
+    PyObject *result;
+
+    if (Py_IS_TYPE(deque, &deque_type)) {
+        dequeobject *new = (dequeobject *)deque_new(&deque_type, NULL, NULL);
+        if (new == NULL)
+            return NULL;
+        new->maxlen = old->maxlen;
+        result = deque_extend(new, deque);
+        if (result == NULL) {
+            Py_DECREF(new);
+            return NULL;
+        }
+        Py_DECREF(result);
+        return (PyObject *)new;
+    }
+    if (old->maxlen < 0)
+        return PyObject_CallOneArg((PyObject *)Py_TYPE(deque), deque);
+    return PyObject_CallFunction((PyObject *)Py_TYPE(deque), "On",
+                                 deque, old->maxlen);
+}
+
+PyDoc_STRVAR(copy_doc, "Return a shallow copy of a deque.");
+
+static int
+deque_clear(dequeobject *deque)
+{
+    while (Py_SIZE(deque)) {
+        PyObject *item = deque_pop(deque, NULL);
+        Py_DECREF(item);
+    }
+    return 0;
+}
+
+static PyObject *
+deque_clearmethod(dequeobject *deque, PyObject *Py_UNUSED(ignored))
+{
+    deque_clear(deque);
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(clear_doc, "Remove all elements from the deque.");
+
+/* Move the n rightmost items to the left end (the n leftmost items to the
+ * right end if n is negative), one block-sized run at a time */
+static int
+_deque_rotate(dequeobject *deque, Py_ssize_t n)
+{
+    block *b = NULL;
+    block *leftblock = deque->leftblock;
+    block *rightblock = deque->rightblock;
+    Py_ssize_t leftindex = deque->leftindex;
+    Py_ssize_t rightindex = deque->rightindex;
+    Py_ssize_t len = Py_SIZE(deque), halflen = len >> 1;
+    int rv = -1;
+
+    if (len <= 1)
+        return 0;
+    if (n > halflen || n < -halflen) {
+        n %= len;
+        if (n > halflen)
+            n -= len;
+        else if (n < -halflen)
+            n += len;
+    }
+    assert(-halflen <= n && n <= halflen);
+
+    deque->state++;
+    while (n > 0) {
+        if (leftindex == 0) {
+            if (b == NULL) {
+                b = newblock(deque);
+                if (b == NULL)
+                    goto done;
+            }
+            b->rightlink = leftblock;
+            leftblock->leftlink = b;
+            leftblock = b;
+            b->leftlink = NULL;
+            leftindex = BLOCKLEN;
+            b = NULL;
+        }
+        {
+            PyObject **src, **dest;
+            Py_ssize_t m = n;
+
+            if (m > rightindex + 1)
+                m = rightindex + 1;
+            if (m > leftindex)
+                m = leftindex;
+            assert(m > 0 && m <= len);
+            rightindex -= m;
+            leftindex -= m;
+            src = &rightblock->data[rightindex + 1];
+            dest = &leftblock->data[leftindex];
+            n -= m;
+            memmove(dest, src, m * sizeof(PyObject *));
+        }
+        if (rightindex < 0) {
+            assert(leftblock != rightblock);
+            assert(b == NULL);
+            b = rightblock;
+            rightblock = rightblock->leftlink;
+            rightblock->rightlink = NULL;
+            rightindex = BLOCKLEN - 1;
+        }
+    }
+    while (n < 0) {
+        if (rightindex == BLOCKLEN - 1) {
+            if (b == NULL) {
+                b = newblock(deque);
+                if (b == NULL)
+                    goto done;
+            }
+            b->leftlink = rightblock;
+            rightblock->rightlink = b;
+            rightblock = b;
+            b->rightlink = NULL;
+            rightindex = -1;
+            b = NULL;
+        }
+        {
+            PyObject **src, **dest;
+            Py_ssize_t m = -n;
+
+            if (m > BLOCKLEN - leftindex)
+                m = BLOCKLEN - leftindex;
+            if (m > BLOCKLEN - 1 - rightindex)
+                m = BLOCKLEN - 1 - rightindex;
+            assert(m > 0 && m <= len);
+            src = &leftblock->data[leftindex];
+            dest = &rightblock->data[rightindex + 1];
+            leftindex += m;
+            rightindex += m;
+            n += m;
+            memmove(dest, src, m * sizeof(PyObject *));
+        }
+        if (leftindex == BLOCKLEN) {
+            assert(leftblock != rightblock);
+            assert(b == NULL);
+            b = leftblock;
+            leftblock = leftblock->rightlink;
+            leftblock->leftlink = NULL;
+            leftindex = 0;
+        }
+    }
+    rv = 0;
+done:
+    if (b != NULL)
+        freeblock(deque, b);
+    deque->leftblock = leftblock;
+    deque->rightblock = rightblock;
+    deque->leftindex = leftindex;
+    deque->rightindex = rightindex;
+    return rv;
+}
+
+static PyObject *
+deque_rotate(dequeobject *deque, PyObject *const *args, Py_ssize_t nargs)
+{
+    Py_ssize_t n = 1;
+
+    if (!_PyArg_CheckPositional("rotate", nargs, 0, 1))
+        return NULL;
+    if (nargs) {
+        n = PyNumber_AsSsize_t(args[0], PyExc_OverflowError);
+        if (n == -1 && PyErr_Occurred())
+            return NULL;
+    }
+    if (_deque_rotate(deque, n) < 0)
+        return NULL;
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(rotate_doc,
+"Rotate the deque n steps to the right (default n=1).  If n is negative, rotates left.");
+
+static PyObject *
+deque_reverse(dequeobject *deque, PyObject *Py_UNUSED(ignored))
+{
+    block *leftblock = deque->leftblock;
+    block *rightblock = deque->rightblock;
+    Py_ssize_t leftindex = deque->leftindex;
+    Py_ssize_t rightindex = deque->rightindex;
+    Py_ssize_t n = Py_SIZE(deque) >> 1;
+    PyObject *tmp;
+
+    while (--n >= 0) {
+        tmp = leftblock->data[leftindex];
+        leftblock->data[leftindex] = rightblock->data[rightindex];
+        rightblock->data[rightindex] = tmp;
+
+        if (++leftindex == BLOCKLEN) {
+            leftblock = leftblock->rightlink;
+            leftindex = 0;
+        }
+        if (--rightindex < 0) {
+            rightblock = rightblock->leftlink;
+            rightindex = BLOCKLEN - 1;
+        }
+    }
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(reverse_doc, "D.reverse() -- reverse *IN PLACE*");
+
+/* Call visit(item, arg) on the items from left to right, until it returns
+ * nonzero.  Return that value, or 0.  Raise RuntimeError if the deque is
+ * mutated by visit(). */
+static int
+deque_visit(dequeobject *deque, int (*visit)(PyObject *, void *), void *arg)
+{
+    block *b = deque->leftblock;
+    Py_ssize_t index = deque->leftindex;
+    Py_ssize_t n = Py_SIZE(deque);
+    size_t start_state = deque->state;
+
+    while (--n >= 0) {
+        PyObject *item = b->data[index];
+        int res;
+
+        Py_INCREF(item);
+        res = visit(item, arg);
+        Py_DECREF(item);
+        if (start_state != deque->state) {
+            PyErr_SetString(PyExc_RuntimeError,
+                            "deque mutated during iteration");
+            return -1;
+        }
+        if (res != 0)
+            return res;
+        if (++index == BLOCKLEN) {
+            b = b->rightlink;
+            index = 0;
+        }
+    }
+    return 0;
+}
+
+typedef struct {
+    PyObject *value;
+    Py_ssize_t count;           /* matches so far, or position of the match */
+} deque_search;
+
+static int
+count_visit(PyObject *item, void *arg)
+{
+    deque_search *search = (deque_search *)arg;
+    int cmp = PyObject_RichCompareBool(item, search->value, Py_EQ);
+    if (cmp < 0)
+        return -1;
+    search->count += cmp;
+    return 0;
+}
+
+static int
+find_visit(PyObject *item, void *arg)
+{
+    deque_search *search = (deque_search *)arg;
+    int cmp = PyObject_RichCompareBool(item, search->value, Py_EQ);
+    if (cmp == 0)
+        search->count++;
+    return cmp;
+}
+
+static PyObject *
+deque_count(dequeobject *deque, PyObject *v)
+{
+    deque_search search = {v, 0};
+
+    if (deque_visit(deque, count_visit, &search) < 0)
+        return NULL;
+    return PyLong_FromSsize_t(search.count);
+}
+
+PyDoc_STRVAR(count_doc, "D.count(value) -> integer -- return number of occurrences of value");
+
+static int
+deque_contains(dequeobject *deque, PyObject *v)
+{
+    deque_search search = {v, 0};
+    return deque_visit(deque, find_visit, &search);
+}
+
+/* Delete the item at index i, 0 <= i < len(deque) */
+static int
+deque_del_item(dequeobject *deque, Py_ssize_t i)
+{
+    PyObject *item;
+    int rv;
+
+    assert(i >= 0 && i < Py_SIZE(deque));
+    if (_deque_rotate(deque, -i) < 0)
+        return -1;
+    item = deque_popleft(deque, NULL);
+    rv = _deque_rotate(deque, i);
+    assert(item != NULL);
+    Py_DECREF(item);
+    return rv;
+}
+
+static PyObject *
+deque_remove(dequeobject *deque, PyObject *value)
+{
+    deque_search search = {value, 0};
+    int res = deque_visit(deque, find_visit, &search);
+
+    if (res < 0)
+        return NULL;
+    if (res == 0) {
+        PyErr_SetString(PyExc_ValueError, "deque.remove(x): x not in deque");
+        return NULL;
+    }
+    if (deque_del_item(deque, search.count) < 0)
+        return NULL;
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(remove_doc,
+"D.remove(value) -- remove first occurrence of value.");
+
+static Py_ssize_t
+deque_len(dequeobject *deque)
+{
+    return Py_SIZE(deque);
+}
+
+/* The block and index of item i, 0 <= i < len(deque), walking from the
+ * nearest end */
+static block *
+deque_locate(dequeobject *deque, Py_ssize_t i, Py_ssize_t *index)
+{
+    block *b;
+    Py_ssize_t n;
+
+    if (i == 0) {
+        *index = deque->leftindex;
+        return deque->leftblock;
+    }
+    if (i == Py_SIZE(deque) - 1) {
+        *index = deque->rightindex;
+        return deque->rightblock;
+    }
+    n = (deque->leftindex + i) / BLOCKLEN;
+    *index = (deque->leftindex + i) % BLOCKLEN;
+    if (i < (Py_SIZE(deque) >> 1)) {
+        b = deque->leftblock;
+        while (--n >= 0)
+            b = b->rightlink;
+    }
+    else {
+        n = (deque->leftindex + Py_SIZE(deque) - 1) / BLOCKLEN - n;
+        b = deque->rightblock;
+        while (--n >= 0)
+            b = b->leftlink;
+    }
+    return b;
+}
+
+static PyObject *
+deque_item(dequeobject *deque, Py_ssize_t i)
+{
+    block *b;
+    Py_ssize_t index;
+    PyObject *item;
+
+    if (i < 0 || i >= Py_SIZE(deque)) {
+        PyErr_SetString(PyExc_IndexError, "deque index out of range");
+        return NULL;
+    }
+    b = deque_locate(deque, i, &index);
+    item = b->data[index];
+    Py_INCREF(item);
+    return item;
+}
+
+static int
+deque_ass_item(dequeobject *deque, Py_ssize_t i, PyObject *v)
+{
+    block *b;
+    Py_ssize_t index;
+
+    if (i < 0 || i >= Py_SIZE(deque)) {
+        PyErr_SetString(PyExc_IndexError, "deque index out of range");
+        return -1;
+    }
+    if (v == NULL)
+        return deque_del_item(deque, i);
+    b = deque_locate(deque, i, &index);
+    Py_INCREF(v);
+    Py_SETREF(b->data[index], v);
+    return 0;
+}
+
+static void
+deque_dealloc(dequeobject *deque)
+{
+    Py_ssize_t i;
+
+    if (deque->leftblock != NULL) {
+        deque_clear(deque);
+        assert(deque->leftblock == deque->rightblock);
+        PyMem_Free(deque->leftblock);
+        deque->leftblock = NULL;
+        deque->rightblock = NULL;
+    }
+    for (i = 0; i < deque->numfreeblocks; i++) {
+        PyMem_Free(deque->freeblocks[i]);
+    }
+    Py_TYPE(deque)->tp_free(deque);
+}
+
+static PyObject *
+deque_repr(PyObject *deque)
+{
+    PyObject *aslist, *result;
+    int i;
+
+    i = Py_ReprEnter(deque);
+    if (i != 0) {
+        if (i < 0)
+            return NULL;
+        return PyString_FromString("[...]");
+    }
+    aslist = PySequence_List(deque);
+    if (aslist == NULL) {
+        Py_ReprLeave(deque);
+        return NULL;
+    }
+    if (((dequeobject *)deque)->maxlen >= 0)
+        result = PyString_FromFormat("%s(%R, maxlen=%zd)",
+                                     _PyType_Name(Py_TYPE(deque)), aslist,
+                                     ((dequeobject *)deque)->maxlen);
+    else
+        result = PyString_FromFormat("%s(%R)",
+                                     _PyType_Name(Py_TYPE(deque)), aslist);
+    Py_ReprLeave(deque);
+    Py_DECREF(aslist);
+    return result;
+}
+
+static PyObject *
+deque_richcompare(PyObject *v, PyObject *w, int op)
+{
+    PyObject *it1 = NULL, *it2 = NULL, *x, *y;
+    Py_ssize_t vs, ws;
+    int b, cmp = -1;
+
+    if (!PyObject_TypeCheck(v, &deque_type) ||
+        !PyObject_TypeCheck(w, &deque_type)) {
+        Py_RETURN_NOTIMPLEMENTED;
+    }
+
+    /* Shortcuts */
+    vs = Py_SIZE(v);
+    ws = Py_SIZE(w);
+    if (op == Py_EQ) {
+        if (v == w)
+            Py_RETURN_TRUE;
+        if (vs != ws)
+            Py_RETURN_FALSE;
+    }
+    if (op == Py_NE) {
+        if (v == w)
+            Py_RETURN_FALSE;
+        if (vs != ws)
+            Py_RETURN_TRUE;
+    }
+
+    /* Search for the first index where items are different */
+    it1 = PyObject_GetIter(v);
+    if (it1 == NULL)
+        goto done;
+    it2 = PyObject_GetIter(w);
+    if (it2 == NULL)
+        goto done;
+    for (;;) {
+        x = PyIter_Next(it1);
+        if (x == NULL && PyErr_Occurred())
+            goto done;
+        y = PyIter_Next(it2);
+        if (x == NULL || y == NULL)
+            break;
+        b = PyObject_RichCompareBool(x, y, Py_EQ);
+        if (b == 0) {
+            cmp = PyObject_RichCompareBool(x, y, op);
+            Py_DECREF(x);
+            Py_DECREF(y);
+            goto done;
+        }
+        Py_DECREF(x);
+        Py_DECREF(y);
+        if (b < 0)
+            goto done;
+    }
+    /* We reached the end of one deque or both */
+    Py_XDECREF(x);
+    Py_XDECREF(y);
+    if (PyErr_Occurred())
+        goto done;
+    switch (op) {
+    case Py_LT: cmp = y != NULL; break;  /* if w was longer */
+    case Py_LE: cmp = x == NULL; break;  /* if v was not longer */
+    case Py_EQ: cmp = x == y;    break;  /* if we reached the end of both */
+    case Py_NE: cmp = x != y;    break;  /* if one deque continues */
+    case Py_GT: cmp = x != NULL; break;  /* if v was longer */
+    case Py_GE: cmp = y == NULL; break;  /* if w was not longer */
+    }
+
+done:
+    Py_XDECREF(it1);
+    Py_XDECREF(it2);
+    if (cmp == 1)
+        Py_RETURN_TRUE;
+    if (cmp == 0)
+        Py_RETURN_FALSE;
+    return NULL;
+}
+
+static int
+deque_init(dequeobject *deque, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"iterable", "maxlen", NULL};
+    PyObject *iterable = NULL;
+    PyObject *maxlenobj = NULL;
+    Py_ssize_t maxlen = -1;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|OO:deque", kwlist,
+                                     &iterable, &maxlenobj))
+        return -1;
+    if (maxlenobj != NULL && maxlenobj != Py_None) {
+        maxlen = PyLong_AsSsize_t(maxlenobj);
+        if (maxlen == -1 && PyErr_Occurred())
+            return -1;
+        if (maxlen < 0) {
+            PyErr_SetString(PyExc_ValueError, "maxlen must be non-negative");
+            return -1;
+        }
+    }
+    deque->maxlen = maxlen;
+    if (Py_SIZE(deque) > 0)
+        deque_clear(deque);
+    if (iterable != NULL) {
+        PyObject *rv = deque_extend(deque, iterable);
+        if (rv == NULL)
+            return -1;
+        Py_DECREF(rv);
+    }
+    return 0;
+}
+
+static PyObject *
+deque_get_maxlen(dequeobject *deque, void *Py_UNUSED(ignored))
+{
+    if (deque->maxlen < 0)
+        Py_RETURN_NONE;
+    return PyLong_FromSsize_t(deque->maxlen);
+}
+
+static PyGetSetDef deque_getset[] = {
+    {"maxlen", (getter)deque_get_maxlen, (setter)NULL,
+     "maximum size of a deque or None if unbounded"},
+    {0}
+};
+
+static PySequenceMethods deque_as_sequence = {
+    (lenfunc)deque_len,                 /* sq_length */
+    0,                                  /* sq_concat */
+    0,                                  /* sq_repeat */
+    (ssizeargfunc)deque_item,           /* sq_item */
+    0,                                  /* sq_slice */
+    (ssizeobjargproc)deque_ass_item,    /* sq_ass_item */
+    0,                                  /* sq_ass_slice */
+    (objobjproc)deque_contains,         /* sq_contains */
+};
+
+static PyObject *deque_iter(dequeobject *deque);
+static PyObject *deque_reviter(dequeobject *deque, PyObject *Py_UNUSED(ignored));
+PyDoc_STRVAR(reversed_doc,
+    "D.__reversed__() -- return a reverse iterator over the deque");
+
+static PyMethodDef deque_methods[] = {
+    {"append",          (PyCFunction)deque_append,
+        METH_O,          append_doc},
+    {"appendleft",      (PyCFunction)deque_appendleft,
+        METH_O,          appendleft_doc},
+    {"clear",           (PyCFunction)deque_clearmethod,
+        METH_NOARGS,     clear_doc},
+    {"__copy__",        deque_copy,
+        METH_NOARGS,     copy_doc},
+    {"copy",            deque_copy,
+        METH_NOARGS,     copy_doc},
+    {"count",           (PyCFunction)deque_count,
+        METH_O,          count_doc},
+    {"extend",          (PyCFunction)deque_extend,
+        METH_O,          extend_doc},
+    {"extendleft",      (PyCFunction)deque_extendleft,
+        METH_O,          extendleft_doc},
+    {"pop",             (PyCFunction)deque_pop,
+        METH_NOARGS,     pop_doc},
+    {"popleft",         (PyCFunction)deque_popleft,
+        METH_NOARGS,     popleft_doc},
+    {"remove",          (PyCFunction)deque_remove,
+        METH_O,          remove_doc},
+    {"__reversed__",    (PyCFunction)deque_reviter,
+        METH_NOARGS,     reversed_doc},
+    {"reverse",         (PyCFunction)deque_reverse,
+        METH_NOARGS,     reverse_doc},
+    {"rotate",          (PyCFunction)(void(*)(void))deque_rotate,
+        METH_FASTCALL,   rotate_doc},
+    {NULL,              NULL}   /* sentinel */
+};
+
+PyDoc_STRVAR(deque_doc,
+"deque([iterable[, maxlen]]) --> deque object\n\
+\n\
+A list-like sequence optimized for data accesses near its endpoints.");
+
+static PyTypeObject deque_type = {
+    PyVarObject_HEAD_INIT(&PyType_Type, 0)
+    "collections.deque",                /* tp_name */
+    sizeof(dequeobject),                /* tp_basicsize */
+    0,                                  /* tp_itemsize */
+    (destructor)deque_dealloc,          /* tp_dealloc */
+    0,                                  /* tp_vectorcall_offset */
+    0,                                  /* tp_getattr */
+    0,                                  /* tp_setattr */
+    0,                                  /* tp_as_async */
+    deque_repr,                         /* tp_repr */
+    0,                                  /* tp_as_number */
+    &deque_as_sequence,                 /* tp_as_sequence */
+    0,                                  /* tp_as_mapping */
+    PyObject_HashNotImplemented,        /* tp_hash */
+    0,                                  /* tp_call */
+    0,                                  /* tp_str */
+    PyObject_GenericGetAttr,            /* tp_getattro */
+    0,                                  /* tp_setattro */
+    0,                                  /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,
+                                        /* tp_flags */
+    deque_doc,                          /* tp_doc */
+    0,                                  /* tp_traverse */
+    0,                                  /* tp_clear */
+    (richcmpfunc)deque_richcompare,     /* tp_richcompare */
+    0,                                  /* tp_weaklistoffset*/
+    (getiterfunc)deque_iter,            /* tp_iter */
+    0,                                  /* tp_iternext */
+    deque_methods,                      /* tp_methods */
+    0,                                  /* tp_members */
+    deque_getset,                       /* tp_getset */
+    0,                                  /* tp_base */
+    0,                                  /* tp_dict */
+    0,                                  /* tp_descr_get */
+    0,                                  /* tp_descr_set */
+    0,                                  /* tp_dictoffset */
+    (initproc)deque_init,               /* tp_init */
+    PyType_GenericAlloc,                /* tp_alloc */
+    deque_new,                          /* tp_new */
+    PyMem_Free,                         /* tp_free */
+};
+
+/*********************** Deque Iterator **************************/
+
+typedef struct {
+    PyObject_HEAD
+    block *b;
+    Py_ssize_t index;
+    dequeobject *deque;
+    size_t state;               /* state when the iterator was created */
+    Py_ssize_t counter;         /* number of items remaining */
+} dequeiterobject;
+
+static PyTypeObject dequeiter_type;
+static PyTypeObject dequereviter_type;
+
+static PyObject *
+dequeiter_new(PyTypeObject *type, dequeobject *deque, int reverse)
+{
+    dequeiterobject *it = PyObject_New(dequeiterobject, type);
+    if (it == NULL)
+        return NULL;
+    it->b = reverse ? deque->rightblock : deque->leftblock;
+    it->index = reverse ? deque->rightindex : deque->leftindex;
+    Py_INCREF(deque);
+    it->deque = deque;
+    it->state = deque->state;
+    it->counter = Py_SIZE(deque);
+    return (PyObject *)it;
+}
+
+static PyObject *
+deque_iter(dequeobject *deque)
+{
+    return dequeiter_new(&dequeiter_type, deque, 0);
+}
+
+static PyObject *
+deque_reviter(dequeobject *deque, PyObject *Py_UNUSED(ignored))
+{
+    return dequeiter_new(&dequereviter_type, deque, 1);
+}
+
+static void
+dequeiter_dealloc(dequeiterobject *dio)
+{
+    Py_XDECREF(dio->deque);
+    PyMem_Free(dio);
+}
+
+static int
+dequeiter_check_state(dequeiterobject *it)
+{
+    if (it->deque->state != it->state) {
+        PyErr_SetString(PyExc_RuntimeError, "deque mutated during iteration");
+        it->counter = 0;
+        return -1;
+    }
+    return 0;
+}
+
+static PyObject *
+dequeiter_next(dequeiterobject *it)
+{
+    PyObject *item;
+
+    if (it->counter == 0 || dequeiter_check_state(it) < 0)
+        return NULL;
+    assert(!(it->b == it->deque->rightblock &&
+             it->index > it->deque->rightindex));
+
+    item = it->b->data[it->index];
+    it->index++;
+    it->counter--;
+    if (it->index == BLOCKLEN && it->counter > 0) {
+        it->b = it->b->rightlink;
+        it->index = 0;
+    }
+    Py_INCREF(item);
+    return item;
+}
+
+static PyObject *
+dequereviter_next(dequeiterobject *it)
+{
+    PyObject *item;
+
+    if (it->counter == 0 || dequeiter_check_state(it) < 0)
+        return NULL;
+    assert(!(it->b == it->deque->leftblock &&
+             it->index < it->deque->leftindex));
+
+    item = it->b->data[it->index];
+    it->index--;
+    it->counter--;
+    if (it->index < 0 && it->counter > 0) {
+        it->b = it->b->leftlink;
+        it->index = BLOCKLEN - 1;
+    }
+    Py_INCREF(item);
+    return item;
+}
+
+static PyObject *
+dequeiter_len(dequeiterobject *it, PyObject *Py_UNUSED(ignored))
+{
+    return PyLong_FromSsize_t(it->counter);
+}
+
+PyDoc_STRVAR(length_hint_doc, "Private method returning an estimate of len(list(it)).");
+
+static PyMethodDef dequeiter_methods[] = {
+    {"__length_hint__", (PyCFunction)dequeiter_len, METH_NOARGS, length_hint_doc},
+    {NULL,              NULL}           /* sentinel */
+};
+
+static PyTypeObject dequeiter_type = {
+    PyVarObject_HEAD_INIT(&PyType_Type, 0)
+    "_collections._deque_iterator",     /* tp_name */
+    sizeof(dequeiterobject),            /* tp_basicsize */
+    0,                                  /* tp_itemsize */
+    (destructor)dequeiter_dealloc,      /* tp_dealloc */
+    0,                                  /* tp_vectorcall_offset */
+    0,                                  /* tp_getattr */
+    0,                                  /* tp_setattr */
+    0,                                  /* tp_as_async */
+    0,                                  /* tp_repr */
+    0,                                  /* tp_as_number */
+    0,                                  /* tp_as_sequence */
+    0,                                  /* tp_as_mapping */
+    0,                                  /* tp_hash */
+    0,                                  /* tp_call */
+    0,                                  /* tp_str */
+    PyObject_GenericGetAttr,            /* tp_getattro */
+    0,                                  /* tp_setattro */
+    0,                                  /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT,                 /* tp_flags */
+    0,                                  /* tp_doc */
+    0,                                  /* tp_traverse */
+    0,                                  /* tp_clear */
+    0,                                  /* tp_richcompare */
+    0,                                  /* tp_weaklistoffset */
+    PyObject_SelfIter,                  /* tp_iter */
+    (iternextfunc)dequeiter_next,       /* tp_iternext */
+    dequeiter_methods,                  /* tp_methods */
+};
+
+static PyTypeObject dequereviter_type = {
+    PyVarObject_HEAD_INIT(&PyType_Type, 0)
+    "_collections._deque_reverse_iterator", /* tp_name */
+    sizeof(dequeiterobject),            /* tp_basicsize */
+    0,                                  /* tp_itemsize */
+    (destructor)dequeiter_dealloc,      /* tp_dealloc */
+    0,                                  /* tp_vectorcall_offset */
+    0,                                  /* tp_getattr */
+    0,                                  /* tp_setattr */
+    0,                                  /* tp_as_async */
+    0,                                  /* tp_repr */
+    0,                                  /* tp_as_number */
+    0,                                  /* tp_as_sequence */
+    0,                                  /* tp_as_mapping */
+    0,                                  /* tp_hash */
+    0,                                  /* tp_call */
+    0,                                  /* tp_str */
+    PyObject_GenericGetAttr,            /* tp_getattro */
+    0,                                  /* tp_setattro */
+    0,                                  /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT,                 /* tp_flags */
+    0,                                  /* tp_doc */
+    0,                                  /* tp_traverse */
+    0,                                  /* tp_clear */
+    0,                                  /* tp_richcompare */
+    0,                                  /* tp_weaklistoffset */
+    PyObject_SelfIter,                  /* tp_iter */
+    (iternextfunc)dequereviter_next,    /* tp_iternext */
+    dequeiter_methods,                  /* tp_methods */
+};
+
+
+PyDoc_STRVAR(module_doc,
+"High performance data structures.\n\
+- deque:        ordered collection accessible from endpoints only");
+
+
+static int
+collections_exec(PyObject *module)
+{
+    if (PyType_Ready(&dequeiter_type) < 0 ||
+        PyType_Ready(&dequereviter_type) < 0) {
+        return -1;
+    }
+    if (PyModule_AddType(module, &deque_type) < 0) {
+        return -1;
+    }
+    return 0;
+}
+
+
+static PyModuleDef_Slot collections_slots[] = {
+    {Py_mod_exec, collections_exec},
+    {0, NULL}
+};
+
+
+static struct PyModuleDef collectionsmodule = {
+    PyModuleDef_HEAD_INIT,
+    .m_name = "_collections",
+    .m_doc = module_doc,
+    .m_size = 0,
+    .m_slots = collections_slots,
+};
+
+
+PyMODINIT_FUNC
+PyInit__collections(void)
+{
+    return PyModuleDef_Init(&collectionsmodule);
+}
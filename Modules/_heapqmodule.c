@@ -0,0 +1,831 @@
+/* Heap queue algorithm and top-k selection
+ *
+ * heappush(), heappop() and friends keep a Python list in heap order
+ * (heap[k] <= heap[2*k+1] and heap[k] <= heap[2*k+2]).  nsmallest() and
+ * nlargest() stream their iterable through a bounded heap of n C entries,
+ * and merge() is an iterator over a heap with one entry per input.
+ *
+ * Comparisons take the shortcuts that list.sort() uses for homogeneous
+ * keys (see unsafe_long_compare and friends in Objects/listobject.c):
+ * exact floats, single-digit ints and strings are compared in C, as are
+ * the first items of tuples holding them.  Anything else goes through
+ * PyObject_RichCompareBool(Py_LT).
+ */
+
+#define PY_SSIZE_T_CLEAN
+#include "Python.h"
+
+
+/* Compare v and w without calling Python code: return -1, 0 or 1 when v
+ * is less than, equal to or greater than w (or a NaN is involved), or 2
+ * when they are not of one of the supported types. */
+static inline int
+fast_compare(PyObject *v, PyObject *w)
+{
+    PyTypeObject *type = Py_TYPE(v);
+
+    if (type != Py_TYPE(w))
+        return 2;
+    if (type == &PyFloat_Type) {
+        double x = PyFloat_AsDouble(v), y = PyFloat_AsDouble(w);
+        return (x < y) ? -1 : (y < x);
+    }
+    if (type == &PyLong_Type) {
+        PyLongObject *vl = (PyLongObject *)v, *wl = (PyLongObject *)w;
+        sdigit x, y;
+        if (Py_ABS(Py_SIZE(vl)) > 1 || Py_ABS(Py_SIZE(wl)) > 1)
+            return 2;
+        x = Py_SIZE(vl) == 0 ? 0 : (sdigit)vl->ob_digit[0];
+        y = Py_SIZE(wl) == 0 ? 0 : (sdigit)wl->ob_digit[0];
+        if (Py_SIZE(vl) < 0)
+            x = -x;
+        if (Py_SIZE(wl) < 0)
+            y = -y;
+        return (x < y) ? -1 : (y < x);
+    }
+    if (type == &PyString_Type) {
+        Py_ssize_t vlen = PyString_Size(v), wlen = PyString_Size(w);
+        int res = memcmp(PyString_AsChar(v), PyString_AsChar(w),
+                         Py_MIN(vlen, wlen));
+        if (res == 0)
+            return (vlen < wlen) ? -1 : (wlen < vlen);
+        return (res < 0) ? -1 : 1;
+    }
+    return 2;
+}
+
+/* v < w: 1 if true, 0 if false, -1 on error */
+static int
+heap_lt(PyObject *v, PyObject *w)
+{
+    int res = fast_compare(v, w);
+
+    if (res != 2) {
+        return res < 0;
+    }
+    if (Py_IS_TYPE(v, &PyTuple_Type) && Py_IS_TYPE(w, &PyTuple_Type) &&
+        PyTuple_Size(v) > 0 && PyTuple_Size(w) > 0)
+    {
+        /* Most (priority, task) pairs differ by their priority */
+        res = fast_compare(PyTuple_Items(v)[0], PyTuple_Items(w)[0]);
+        if (res == -1 || res == 1) {
+            return res < 0;
+        }
+    }
+    Py_INCREF(v);
+    Py_INCREF(w);
+    res = PyObject_RichCompareBool(v, w, Py_LT);
+    Py_DECREF(v);
+    Py_DECREF(w);
+    return res;
+}
+
+
+/* Heaps stored in a list */
+
+static int
+check_heap(PyObject *heap)
+{
+    if (!PyList_Check(heap)) {
+        PyErr_SetString(PyExc_TypeError, "heap argument must be a list");
+        return -1;
+    }
+    return 0;
+}
+
+/* Move the item at pos up towards startpos until its parent is not
+ * greater.  The comparisons may run Python code that resizes the list. */
+static int
+siftdown(PyObject *heap, Py_ssize_t startpos, Py_ssize_t pos)
+{
+    Py_ssize_t size = PyList_Size(heap);
+    PyObject **arr = PyList_Items(heap);
+
+    assert(pos < size);
+    while (pos > startpos) {
+        Py_ssize_t parentpos = (pos - 1) >> 1;
+        PyObject *parent = arr[parentpos];
+        int cmp = heap_lt(arr[pos], parent);
+        if (cmp < 0)
+            return -1;
+        if (size != PyList_Size(heap)) {
+            PyErr_SetString(PyExc_RuntimeError,
+                            "list changed size during iteration");
+            return -1;
+        }
+        if (cmp == 0)
+            break;
+        arr = PyList_Items(heap);
+        parent = arr[parentpos];
+        arr[parentpos] = arr[pos];
+        arr[pos] = parent;
+        pos = parentpos;
+    }
+    return 0;
+}
+
+/* Move the smaller child of pos up until pos is a leaf, then sift the
+ * item that was at pos back up from there. */
+static int
+siftup(PyObject *heap, Py_ssize_t pos)
+{
+    Py_ssize_t startpos = pos;
+    Py_ssize_t endpos = PyList_Size(heap);
+    Py_ssize_t limit = endpos >> 1;     /* smallest pos without a child */
+    PyObject **arr = PyList_Items(heap);
+
+    assert(pos < endpos);
+    while (pos < limit) {
+        Py_ssize_t childpos = 2 * pos + 1;
+        PyObject *tmp;
+        if (childpos + 1 < endpos) {
+            int cmp = heap_lt(arr[childpos], arr[childpos + 1]);
+            if (cmp < 0)
+                return -1;
+            childpos += cmp ^ 1;
+            if (endpos != PyList_Size(heap)) {
+                PyErr_SetString(PyExc_RuntimeError,
+                                "list changed size during iteration");
+                return -1;
+            }
+            arr = PyList_Items(heap);
+        }
+        tmp = arr[childpos];
+        arr[childpos] = arr[pos];
+        arr[pos] = tmp;
+        pos = childpos;
+    }
+    return siftdown(heap, startpos, pos);
+}
+
+PyDoc_STRVAR(heappush_doc,
+"heappush($module, heap, item, /)\n\
+--\n\
+\n\
+Push item onto heap, maintaining the heap invariant.");
+
+static PyObject *
+heapq_heappush(PyObject *module, PyObject *const *args, Py_ssize_t nargs)
+{
+    if (!_PyArg_CheckPositional("heappush", nargs, 2, 2))
+        return NULL;
+    if (check_heap(args[0]) < 0 || PyList_Append(args[0], args[1]) < 0)
+        return NULL;
+    if (siftdown(args[0], 0, PyList_Size(args[0]) - 1) < 0)
+        return NULL;
+    Py_RETURN_NONE;
+}
+
+/* Replace heap[0] by item (a new reference) and return the old heap[0] */
+static PyObject *
+replace_top(PyObject *heap, PyObject *item)
+{
+    PyObject **arr = PyList_Items(heap);
+    PyObject *top = arr[0];
+
+    arr[0] = item;
+    if (siftup(heap, 0) < 0) {
+        Py_DECREF(top);
+        return NULL;
+    }
+    return top;
+}
+
+PyDoc_STRVAR(heappop_doc,
+"heappop($module, heap, /)\n\
+--\n\
+\n\
+Pop the smallest item off the heap, maintaining the heap invariant.");
+
+static PyObject *
+heapq_heappop(PyObject *module, PyObject *heap)
+{
+    Py_ssize_t n;
+    PyObject *last;
+
+    if (check_heap(heap) < 0)
+        return NULL;
+    n = PyList_Size(heap);
+    if (n == 0) {
+        PyErr_SetString(PyExc_IndexError, "index out of range");
+        return NULL;
+    }
+    last = PyList_Items(heap)[n - 1];
+    Py_INCREF(last);
+    if (PyList_SetSlice(heap, n - 1, n, NULL) < 0) {
+        Py_DECREF(last);
+        return NULL;
+    }
+    if (n == 1)
+        return last;
+    return replace_top(heap, last);
+}
+
+PyDoc_STRVAR(heapreplace_doc,
+"heapreplace($module, heap, item, /)\n\
+--\n\
+\n\
+Pop and return the current smallest value, and add the new item.\n\
+\n\
+This is more efficient than heappop() followed by heappush(), and can be\n\
+more appropriate when using a fixed-size heap.  The value returned may be\n\
+larger than item!");
+
+static PyObject *
+heapq_heapreplace(PyObject *module, PyObject *const *args, Py_ssize_t nargs)
+{
+    if (!_PyArg_CheckPositional("heapreplace", nargs, 2, 2))
+        return NULL;
+    if (check_heap(args[0]) < 0)
+        return NULL;
+    if (PyList_Size(args[0]) == 0) {
+        PyErr_SetString(PyExc_IndexError, "index out of range");
+        return NULL;
+    }
+    Py_INCREF(args[1]);
+    return replace_top(args[0], args[1]);
+}
+
+PyDoc_STRVAR(heappushpop_doc,
+"heappushpop($module, heap, item, /)\n\
+--\n\
+\n\
+Push item on the heap, then pop and return the smallest item from the heap.\n\
+\n\
+The combined action runs more efficiently than heappush() followed by\n\
+a separate call to heappop().");
+
+static PyObject *
+heapq_heappushpop(PyObject *module, PyObject *const *args, Py_ssize_t nargs)
+{
+    PyObject *heap, *item;
+    int cmp;
+
+    if (!_PyArg_CheckPositional("heappushpop", nargs, 2, 2))
+        return NULL;
+    heap = args[0];
+    item = args[1];
+    if (check_heap(heap) < 0)
+        return NULL;
+    if (PyList_Size(heap) == 0) {
+        Py_INCREF(item);
+        return item;
+    }
+    cmp = heap_lt(PyList_Items(heap)[0], item);
+    if (cmp < 0)
+        return NULL;
+    if (cmp == 0) {
+        Py_INCREF(item);
+        return item;
+    }
+    if (PyList_Size(heap) == 0) {
+        PyErr_SetString(PyExc_IndexError, "index out of range");
+        return NULL;
+    }
+    Py_INCREF(item);
+    return replace_top(heap, item);
+}
+
+PyDoc_STRVAR(heapify_doc,
+"heapify($module, heap, /)\n\
+--\n\
+\n\
+Transform list into a heap, in-place, in O(len(heap)) time.");
+
+static PyObject *
+heapq_heapify(PyObject *module, PyObject *heap)
+{
+    Py_ssize_t i;
+
+    if (check_heap(heap) < 0)
+        return NULL;
+    /* The leaves are heaps already: sift the parents from the bottom up */
+    for (i = PyList_Size(heap) / 2 - 1; i >= 0; i--) {
+        if (siftup(heap, i) < 0)
+            return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+
+/* Heaps of C entries, for nsmallest(), nlargest() and merge().
+ *
+ * The entry on top is the one with the smallest key, or the largest with
+ * HEAP_MAX.  Equal keys are ordered by their order field: the lowest comes
+ * first, or the highest with HEAP_LATER. */
+
+#define HEAP_MAX 1
+#define HEAP_LATER 2
+
+typedef struct {
+    PyObject *key;
+    PyObject *item;
+    PyObject *iter;             /* input of item, for merge() only */
+    Py_ssize_t order;
+} HeapEntry;
+
+/* Should a sit above b?  1 if true, 0 if false, -1 on error */
+static int
+entry_above(HeapEntry *a, HeapEntry *b, int flags)
+{
+    PyObject *x = a->key, *y = b->key;
+    int cmp;
+
+    if (flags & HEAP_MAX) {
+        x = b->key;
+        y = a->key;
+    }
+    cmp = heap_lt(x, y);
+    if (cmp != 0)
+        return cmp;
+    cmp = heap_lt(y, x);
+    if (cmp != 0)
+        return cmp < 0 ? -1 : 0;
+    return (flags & HEAP_LATER) ? a->order > b->order : a->order < b->order;
+}
+
+/* Restore the heap after the entry at pos was replaced */
+static int
+entries_siftdown(HeapEntry *heap, Py_ssize_t size, Py_ssize_t pos, int flags)
+{
+    HeapEntry entry = heap[pos];
+
+    for (;;) {
+        Py_ssize_t childpos = 2 * pos + 1;
+        int cmp;
+        if (childpos >= size)
+            break;
+        if (childpos + 1 < size) {
+            cmp = entry_above(&heap[childpos + 1], &heap[childpos], flags);
+            if (cmp < 0)
+                goto error;
+            childpos += cmp;
+        }
+        cmp = entry_above(&heap[childpos], &entry, flags);
+        if (cmp < 0)
+            goto error;
+        if (cmp == 0)
+            break;
+        heap[pos] = heap[childpos];
+        pos = childpos;
+    }
+    heap[pos] = entry;
+    return 0;
+
+error:
+    heap[pos] = entry;
+    return -1;
+}
+
+static int
+entries_heapify(HeapEntry *heap, Py_ssize_t size, int flags)
+{
+    for (Py_ssize_t i = size / 2 - 1; i >= 0; i--) {
+        if (entries_siftdown(heap, size, i, flags) < 0)
+            return -1;
+    }
+    return 0;
+}
+
+static void
+entries_clear(HeapEntry *heap, Py_ssize_t size)
+{
+    for (Py_ssize_t i = 0; i < size; i++) {
+        Py_DECREF(heap[i].key);
+        Py_DECREF(heap[i].item);
+        Py_XDECREF(heap[i].iter);
+    }
+    PyMem_Free(heap);
+}
+
+static PyObject *
+call_key(PyObject *keyfunc, PyObject *item)
+{
+    if (keyfunc == NULL) {
+        Py_INCREF(item);
+        return item;
+    }
+    return PyObject_CallOneArg(keyfunc, item);
+}
+
+/* sorted(iterable, key=keyfunc, reverse=largest)[:n] */
+static PyObject *
+sorted_head(Py_ssize_t n, PyObject *iterable, PyObject *keyfunc, int largest)
+{
+    PyObject *list, *sort, *args, *kwargs, *res;
+    _Py_IDENTIFIER(sort);
+
+    list = PySequence_List(iterable);
+    if (list == NULL)
+        return NULL;
+    sort = _PyObject_GetAttrId(list, &PyId_sort);
+    args = PyTuple_New(0);
+    kwargs = Py_BuildValue("{sOsO}", "key", keyfunc ? keyfunc : Py_None,
+                           "reverse", largest ? Py_True : Py_False);
+    res = (sort && args && kwargs) ? PyObject_Call(sort, args, kwargs) : NULL;
+    Py_XDECREF(sort);
+    Py_XDECREF(args);
+    Py_XDECREF(kwargs);
+    if (res == NULL) {
+        Py_DECREF(list);
+        return NULL;
+    }
+    Py_DECREF(res);
+    if (PyList_Size(list) > n &&
+        PyList_SetSlice(list, n, PyList_Size(list), NULL) < 0) {
+        Py_DECREF(list);
+        return NULL;
+    }
+    return list;
+}
+
+/* Keep the n best items seen so far in a heap with the worst on top: an
+ * item only goes in when it beats the top.  Items that are equal rank in
+ * the order they came, like sorted() does. */
+static PyObject *
+select_n(Py_ssize_t n, PyObject *iterable, PyObject *keyfunc, int largest)
+{
+    /* Worst on top: smallest keys and last arrivals for nlargest() */
+    int flags = (largest ? 0 : HEAP_MAX) | HEAP_LATER;
+    HeapEntry *heap = NULL;
+    Py_ssize_t size = 0, allocated = 0, order, size_hint;
+    PyObject *it, *item, *result;
+
+    if (n <= 0)
+        return PyList_New(0);
+    /* A full sort is cheaper when all the items are kept anyway */
+    size_hint = PyObject_Size(iterable);
+    if (size_hint < 0)
+        PyErr_Clear();
+    else if (n >= size_hint)
+        return sorted_head(n, iterable, keyfunc, largest);
+
+    it = PyObject_GetIter(iterable);
+    if (it == NULL)
+        return NULL;
+    for (order = 0; (item = PyIter_Next(it)) != NULL; order++) {
+        PyObject *key = call_key(keyfunc, item);
+        if (key == NULL) {
+            Py_DECREF(item);
+            goto error;
+        }
+        if (size < n) {
+            if (size == allocated) {
+                Py_ssize_t newsize = Py_MIN(n, allocated ? 2 * allocated : 16);
+                HeapEntry *newheap = PyMem_Realloc(heap,
+                                                   newsize * sizeof(HeapEntry));
+                if (newheap == NULL) {
+                    Py_DECREF(key);
+                    Py_DECREF(item);
+                    PyErr_NoMemory();
+                    goto error;
+                }
+                heap = newheap;
+                allocated = newsize;
+            }
+            heap[size].key = key;
+            heap[size].item = item;
+            heap[size].iter = NULL;
+            heap[size].order = order;
+            if (++size == n && entries_heapify(heap, size, flags) < 0)
+                goto error;
+            continue;
+        }
+        /* item comes last: it must have a strictly better key */
+        int cmp = largest ? heap_lt(heap[0].key, key) : heap_lt(key, heap[0].key);
+        if (cmp <= 0) {
+            Py_DECREF(key);
+            Py_DECREF(item);
+            if (cmp < 0)
+                goto error;
+            continue;
+        }
+        Py_SETREF(heap[0].key, key);
+        Py_SETREF(heap[0].item, item);
+        heap[0].order = order;
+        if (entries_siftdown(heap, size, 0, flags) < 0)
+            goto error;
+    }
+    if (PyErr_Occurred())
+        goto error;
+    Py_CLEAR(it);
+    if (size < n && entries_heapify(heap, size, flags) < 0)
+        goto error;
+
+    /* Pop the worst entries to the end */
+    result = PyList_New(size);
+    if (result == NULL)
+        goto error;
+    while (size > 0) {
+        HeapEntry top = heap[0];
+        heap[0] = heap[--size];
+        if (entries_siftdown(heap, size, 0, flags) < 0) {
+            heap[size] = top;
+            Py_DECREF(result);
+            size++;
+            goto error;
+        }
+        Py_DECREF(top.key);
+        PyList_SetItem(result, size, top.item);
+    }
+    PyMem_Free(heap);
+    return result;
+
+error:
+    Py_XDECREF(it);
+    entries_clear(heap, size);
+    return NULL;
+}
+
+static PyObject *
+select_args(PyObject *args, PyObject *kwds, const char *format, int largest)
+{
+    static char *kwlist[] = {"n", "iterable", "key", NULL};
+    Py_ssize_t n;
+    PyObject *iterable, *keyfunc = Py_None;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, format, kwlist,
+                                     &n, &iterable, &keyfunc))
+        return NULL;
+    return select_n(n, iterable, keyfunc == Py_None ? NULL : keyfunc, largest);
+}
+
+PyDoc_STRVAR(nsmallest_doc,
+"nsmallest($module, n, iterable, key=None)\n\
+--\n\
+\n\
+Find the n smallest elements in a dataset.\n\
+\n\
+Equivalent to:  sorted(iterable, key=key)[:n]");
+
+static PyObject *
+heapq_nsmallest(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    return select_args(args, kwds, "nO|O:nsmallest", 0);
+}
+
+PyDoc_STRVAR(nlargest_doc,
+"nlargest($module, n, iterable, key=None)\n\
+--\n\
+\n\
+Find the n largest elements in a dataset.\n\
+\n\
+Equivalent to:  sorted(iterable, key=key, reverse=True)[:n]");
+
+static PyObject *
+heapq_nlargest(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    return select_args(args, kwds, "nO|O:nlargest", 1);
+}
+
+
+/* merge() iterator: one entry per unexhausted input, holding its next
+ * item.  The order field is the position of the input, so that equal
+ * items come out in the order of their inputs. */
+
+typedef struct {
+    PyObject_HEAD
+    HeapEntry *heap;
+    Py_ssize_t size;
+    PyObject *keyfunc;          /* NULL for the identity */
+    int flags;
+    int running;                /* in next(), which may call Python code */
+} mergeobject;
+
+static PyTypeObject MergeType;
+
+/* Load the next item of entry->iter into entry.  Return 1 on success, 0
+ * when the input is exhausted, or -1 on error. */
+static int
+merge_advance(mergeobject *mo, HeapEntry *entry)
+{
+    PyObject *item = PyIter_Next(entry->iter);
+    PyObject *key;
+
+    if (item == NULL)
+        return PyErr_Occurred() ? -1 : 0;
+    key = call_key(mo->keyfunc, item);
+    if (key == NULL) {
+        Py_DECREF(item);
+        return -1;
+    }
+    entry->item = item;
+    entry->key = key;
+    return 1;
+}
+
+static void
+merge_dealloc(mergeobject *mo)
+{
+    entries_clear(mo->heap, mo->size);
+    Py_XDECREF(mo->keyfunc);
+    PyMem_Free(mo);
+}
+
+static PyObject *
+merge_next(mergeobject *mo)
+{
+    HeapEntry *top = &mo->heap[0];
+    PyObject *result;
+    int res;
+
+    if (mo->size == 0)
+        return NULL;
+    if (mo->running) {
+        PyErr_SetString(PyExc_ValueError, "merge() already executing");
+        return NULL;
+    }
+    mo->running = 1;
+    /* Return the item on top, and replace it by the next item of the same
+     * input, or by the last entry when that input is exhausted */
+    result = top->item;
+    Py_DECREF(top->key);
+    res = merge_advance(mo, top);
+    if (res == 0) {
+        Py_DECREF(top->iter);
+        *top = mo->heap[--mo->size];
+    }
+    if (res < 0 || (mo->size > 0 &&
+                    entries_siftdown(mo->heap, mo->size, 0, mo->flags) < 0)) {
+        /* Stop at the first error */
+        if (res < 0) {
+            Py_DECREF(top->iter);
+            *top = mo->heap[--mo->size];
+        }
+        entries_clear(mo->heap, mo->size);
+        mo->heap = NULL;
+        mo->size = 0;
+        Py_CLEAR(result);
+    }
+    mo->running = 0;
+    return result;
+}
+
+PyDoc_STRVAR(merge_doc,
+"merge($module, *iterables, key=None, reverse=False)\n\
+--\n\
+\n\
+Merge multiple sorted inputs into a single sorted output.\n\
+\n\
+Similar to sorted(itertools.chain(*iterables)) but returns an iterator,\n\
+does not pull the data into memory all at once, and assumes that each of\n\
+the input streams is already sorted (smallest to largest).\n\
+\n\
+If key is given, it is applied to each item to get the key to compare.\n\
+If reverse is true, the inputs must be sorted from largest to smallest.");
+
+static PyObject *
+heapq_merge(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"key", "reverse", NULL};
+    PyObject *keyfunc = Py_None;
+    PyObject *empty;
+    mergeobject *mo;
+    Py_ssize_t i, n = PyTuple_Size(args);
+    int reverse = 0;
+
+    empty = PyTuple_New(0);
+    if (empty == NULL)
+        return NULL;
+    if (!PyArg_ParseTupleAndKeywords(empty, kwds, "|$Op:merge", kwlist,
+                                     &keyfunc, &reverse)) {
+        Py_DECREF(empty);
+        return NULL;
+    }
+    Py_DECREF(empty);
+
+    mo = PyObject_New(mergeobject, &MergeType);
+    if (mo == NULL)
+        return NULL;
+    mo->heap = PyMem_New(HeapEntry, n ? n : 1);
+    mo->size = 0;
+    mo->keyfunc = keyfunc == Py_None ? NULL : keyfunc;
+    Py_XINCREF(mo->keyfunc);
+    mo->flags = reverse ? HEAP_MAX : 0;
+    mo->running = 0;
+    if (mo->heap == NULL) {
+        PyErr_NoMemory();
+        goto error;
+    }
+    for (i = 0; i < n; i++) {
+        HeapEntry *entry = &mo->heap[mo->size];
+        int res;
+        entry->iter = PyObject_GetIter(PyTuple_GetItem(args, i));
+        if (entry->iter == NULL)
+            goto error;
+        entry->order = i;
+        res = merge_advance(mo, entry);
+        if (res <= 0) {
+            Py_DECREF(entry->iter);
+            if (res < 0)
+                goto error;
+            continue;
+        }
+        mo->size++;
+    }
+    if (entries_heapify(mo->heap, mo->size, mo->flags) < 0)
+        goto error;
+    return (PyObject *)mo;
+
+error:
+    Py_DECREF(mo);
+    return NULL;
+}
+
+static PyTypeObject MergeType = {
+    PyVarObject_HEAD_INIT(&PyType_Type, 0)
+    "_heapq.merge",                     /* tp_name */
+    sizeof(mergeobject),                /* tp_basicsize */
+    0,                                  /* tp_itemsize */
+    (destructor)merge_dealloc,          /* tp_dealloc */
+    0,                                  /* tp_vectorcall_offset */
+    0,                                  /* tp_getattr */
+    0,                                  /* tp_setattr */
+    0,                                  /* tp_as_async */
+    0,                                  /* tp_repr */
+    0,                                  /* tp_as_number */
+    0,                                  /* tp_as_sequence */
+    0,                                  /* tp_as_mapping */
+    0,                                  /* tp_hash */
+    0,                                  /* tp_call */
+    0,                                  /* tp_str */
+    PyObject_GenericGetAttr,            /* tp_getattro */
+    0,                                  /* tp_setattro */
+    0,                                  /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT,                 /* tp_flags */
+    0,                                  /* tp_doc */
+    0,                                  /* tp_traverse */
+    0,                                  /* tp_clear */
+    0,                                  /* tp_richcompare */
+    0,                                  /* tp_weaklistoffset */
+    PyObject_SelfIter,                  /* tp_iter */
+    (iternextfunc)merge_next,           /* tp_iternext */
+};
+
+
+static PyMethodDef heapq_methods[] = {
+    {"heappush",    (PyCFunction)(void(*)(void))heapq_heappush,
+     METH_FASTCALL, heappush_doc},
+    {"heappushpop", (PyCFunction)(void(*)(void))heapq_heappushpop,
+     METH_FASTCALL, heappushpop_doc},
+    {"heappop",     heapq_heappop,  METH_O, heappop_doc},
+    {"heapreplace", (PyCFunction)(void(*)(void))heapq_heapreplace,
+     METH_FASTCALL, heapreplace_doc},
+    {"heapify",     heapq_heapify,  METH_O, heapify_doc},
+    {"merge",       (PyCFunction)(void(*)(void))heapq_merge,
+     METH_VARARGS | METH_KEYWORDS, merge_doc},
+    {"nsmallest",   (PyCFunction)(void(*)(void))heapq_nsmallest,
+     METH_VARARGS | METH_KEYWORDS, nsmallest_doc},
+    {"nlargest",    (PyCFunction)(void(*)(void))heapq_nlargest,
+     METH_VARARGS | METH_KEYWORDS, nlargest_doc},
+    {NULL,          NULL}           /* sentinel */
+};
+
+
+PyDoc_STRVAR(module_doc,
+"Heap queue algorithm (a.k.a. priority queue).\n\
+\n\
+Heaps are lists for which a[k] <= a[2*k+1] and a[k] <= a[2*k+2] for\n\
+all k, counting elements from 0.  The smallest element is always a[0].\n\
+\n\
+heappush(heap, item) -- push an item onto the heap\n\
+heappop(heap) -- pop the smallest item off the heap\n\
+heappushpop(heap, item) -- push, then pop the smallest item\n\
+heapreplace(heap, item) -- pop the smallest item, then push\n\
+heapify(x) -- transform a list into a heap, in place\n\
+merge(*iterables) -- merge sorted inputs into one sorted iterator\n\
+nsmallest(n, iterable) -- the n smallest items, smallest first\n\
+nlargest(n, iterable) -- the n largest items, largest first");
+
+
+static int
+heapq_exec(PyObject *module)
+{
+    if (PyType_Ready(&MergeType) < 0) {
+        return -1;
+    }
+    return 0;
+}
+
+
+static PyModuleDef_Slot heapq_slots[] = {
+    {Py_mod_exec, heapq_exec},
+    {0, NULL}
+};
+
+
+static struct PyModuleDef heapqmodule = {
+    PyModuleDef_HEAD_INIT,
+    .m_name = "_heapq",
+    .m_doc = module_doc,
+    .m_size = 0,
+    .m_methods = heapq_methods,
+    .m_slots = heapq_slots,
+};
+
+
+PyMODINIT_FUNC
+PyInit__heapq(void)
+{
+    return PyModuleDef_Init(&heapqmodule);
+}
@@ -667,20 +667,86 @@ _io_FileIO_read_impl(fileio *self, Py_ssize_t size)
         size = _PY_READ_MAX;
     }
 
-    ptr = (char *) PyMem_Malloc(size);
-    if (ptr == NULL) {
-      return NULL;
+    /* Read straight into the new string, then trim it */
+    bytes = PyString_New(size);
+    if (bytes == NULL) {
+        return NULL;
     }
+    ptr = (char *)PyString_AsChar(bytes);
     n = _Py_read(self->fd, ptr, size);
     if (n == -1) {
-	PyMem_Free(ptr);
+        Py_DECREF(bytes);
         return NULL;
     }
-    bytes = PyString_FromStringAndSize(ptr, n);
-    PyMem_Free(ptr);
+    if (n != size) {
+        if (PyString_Resize(&bytes, n) < 0) {
+            Py_CLEAR(bytes);
+            return NULL;
+        }
+    }
     return bytes;
 }
 
+/*[clinic input]
+_io.FileIO.readinto
+    buffer: Py_buffer(accept={rwbuffer})
+    /
+
+Read bytes into a pre-allocated, writable bytes-like object b.
+
+Only makes one system call, so less than len(b) bytes may be read.
+Returns the number of bytes read (0 for EOF).
+[clinic start generated code]*/
+
+static PyObject *
+_io_FileIO_readinto_impl(fileio *self, Py_buffer *buffer)
+/*[clinic end generated code: output=b01a5a22c8415cb4 input=6d0dcdb487933eb6]*/
+{
+    Py_ssize_t n;
+
+    if (self->fd < 0)
+        return err_closed();
+    if (!self->readable)
+        return err_mode("reading");
+
+    n = _Py_read(self->fd, buffer->buf, buffer->len);
+    if (n == -1) {
+        return NULL;
+    }
+    return PyLong_FromSsize_t(n);
+}
+
+/*[clinic input]
+_io.FileIO.write
+    b: Py_buffer
+    /
+
+Write buffer b to file, return number of bytes written.
+
+Only makes one system call, so not all of the data may be written.
+The number of bytes actually written is returned.  In non-blocking mode,
+returns None if the write would block.
+[clinic start generated code]*/
+
+static PyObject *
+_io_FileIO_write_impl(fileio *self, Py_buffer *b)
+/*[clinic end generated code: output=b4059db3d363a2f7 input=6e7908b36f0ce74f]*/
+{
+    Py_ssize_t n;
+
+    if (self->fd < 0)
+        return err_closed();
+    if (!self->writable)
+        return err_mode("writing");
+
+    /* str, bytearray or memoryview: written without a copy */
+    n = _Py_write(self->fd, b->buf, b->len);
+    if (n < 0) {
+        return NULL;
+    }
+    return PyLong_FromSsize_t(n);
+}
+
 /* Cribbed from posix_lseek() */
 static PyObject *
 portable_lseek(fileio *self, PyObject *posobj, int whence, bool suppress_pipe_error)
@@ -1159,6 +1225,43 @@ exit:
     return return_value;
 }
 
+PyDoc_STRVAR(_io_FileIO_readinto__doc__,
+"readinto($self, buffer, /)\n"
+"--\n"
+"\n"
+"Read bytes into a pre-allocated, writable bytes-like object b.\n"
+"\n"
+"Only makes one system call, so less than len(b) bytes may be read.\n"
+"Returns the number of bytes read (0 for EOF).");
+
+#define _IO_FILEIO_READINTO_METHODDEF    \
+    {"readinto", (PyCFunction)_io_FileIO_readinto, METH_O, _io_FileIO_readinto__doc__},
+
+static PyObject *
+_io_FileIO_readinto_impl(fileio *self, Py_buffer *buffer);
+
+static PyObject *
+_io_FileIO_readinto(fileio *self, PyObject *arg)
+{
+    PyObject *return_value = NULL;
+    Py_buffer buffer = {NULL, NULL};
+
+    if (PyObject_GetBuffer(arg, &buffer, PyBUF_WRITABLE) < 0) {
+        PyErr_Clear();
+        _PyArg_BadArgument("readinto", "argument", "read-write bytes-like object", arg);
+        goto exit;
+    }
+    return_value = _io_FileIO_readinto_impl(self, &buffer);
+
+exit:
+    /* Cleanup for buffer */
+    if (buffer.obj) {
+       PyBuffer_Release(&buffer);
+    }
+
+    return return_value;
+}
+
 PyDoc_STRVAR(_io_FileIO_write__doc__,
 "write($self, b, /)\n"
 "--\n"
@@ -1172,27 +1275,31 @@ PyDoc_STRVAR(_io_FileIO_write__doc__,
 #define _IO_FILEIO_WRITE_METHODDEF    \
     {"write", (PyCFunction)_io_FileIO_write, METH_O, _io_FileIO_write__doc__},
 
+static PyObject *
+_io_FileIO_write_impl(fileio *self, Py_buffer *b);
+
 static PyObject *
 _io_FileIO_write(fileio *self, PyObject *arg)
 {
-  const char *buf;
-  Py_ssize_t len, n;
+    PyObject *return_value = NULL;
+    Py_buffer b = {NULL, NULL};
 
-  if (!PyString_Check(arg)) {
-    _PyArg_BadArgument("write", "argument", "string", arg);
-    return NULL;
-  }
-  buf = PyString_AsCharAndSize(arg, &len);
-  if (self->fd < 0)
-    return err_closed();
-  if (!self->writable)
-    return err_mode("writing");
-      
-  n = _Py_write(self->fd, buf, len);
-  if (n < 0) {
-    return NULL;
-  }
-  return PyLong_FromSsize_t(n);
+    if (PyObject_GetBuffer(arg, &b, PyBUF_SIMPLE) != 0) {
+        goto exit;
+    }
+    if (!PyBuffer_IsContiguous(&b, 'C')) {
+        _PyArg_BadArgument("write", "argument", "contiguous buffer", arg);
+        goto exit;
+    }
+    return_value = _io_FileIO_write_impl(self, &b);
+
+exit:
+    /* Cleanup for b */
+    if (b.obj) {
+       PyBuffer_Release(&b);
+    }
+
+    return return_value;
 }
 
 PyDoc_STRVAR(_io_FileIO_seek__doc__,
@@ -1320,12 +1427,13 @@ _io_FileIO_isatty(fileio *self, PyObject *Py_UNUSED(ignored))
 #ifndef _IO_FILEIO_TRUNCATE_METHODDEF
     #define _IO_FILEIO_TRUNCATE_METHODDEF
 #endif /* !defined(_IO_FILEIO_TRUNCATE_METHODDEF) */
-/*[clinic end generated code: output=3479912ec0f7e029 input=a9049054013a1b77]*/
+/*[clinic end generated code: output=dc27b1408406622b input=a9049054013a1b77]*/
 
 
 static PyMethodDef fileio_methods[] = {
     _IO_FILEIO_READ_METHODDEF
     _IO_FILEIO_READALL_METHODDEF
+    _IO_FILEIO_READINTO_METHODDEF
     _IO_FILEIO_WRITE_METHODDEF
     _IO_FILEIO_SEEK_METHODDEF
     _IO_FILEIO_TELL_METHODDEF
@@ -0,0 +1,332 @@
+/* Deterministic function-level profiler
+ *
+ * Installs a C profile hook (PyEval_SetProfile) that fires on every frame
+ * entry and exit in the eval loop.  Counters are kept per code object in
+ * its co_extra slot, so the hot path is a co_extra fetch, a clock read and
+ * a push/pop on a small C stack.  No Python objects are created until
+ * snapshot() is called.
+ *
+ * All entries are also chained on a doubly linked list so that snapshot()
+ * can find them.  An entry unlinks itself when its code object is freed.
+ */
+
+#define PY_SSIZE_T_CLEAN
+#include "Python.h"
+#include "frameobject.h"
+
+#include <time.h>
+
+typedef struct _profentry {
+    struct _profentry *prev;
+    struct _profentry *next;
+    PyCodeObject *code;         /* borrowed: the entry dies with the code */
+    uint64_t calls;
+    int64_t inclusive;          /* nanoseconds, outermost activations only */
+    int64_t exclusive;          /* nanoseconds, minus time spent in callees */
+    int active;                 /* activations currently on the stack */
+} ProfEntry;
+
+typedef struct {
+    ProfEntry *entry;
+    PyFrameObject *frame;       /* borrowed: the frame is executing */
+    int64_t start;
+    int64_t children;
+} ProfContext;
+
+static struct {
+    Py_ssize_t extra_index;     /* co_extra slot, -1 until first start() */
+    ProfEntry entries;          /* list head (sentinel) */
+    ProfContext *stack;
+    Py_ssize_t depth;
+    Py_ssize_t allocated;
+    int enabled;
+} profiler = {
+    .extra_index = -1,
+    .entries = {&profiler.entries, &profiler.entries},
+};
+
+
+static inline int64_t
+profile_now(void)
+{
+    struct timespec ts;
+#ifdef CLOCK_MONOTONIC
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#else
+    clock_gettime(CLOCK_REALTIME, &ts);
+#endif
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+
+/* co_extra free function: called when the code object is deallocated */
+static void
+profile_entry_free(void *ptr)
+{
+    ProfEntry *entry = (ProfEntry *)ptr;
+    entry->prev->next = entry->next;
+    entry->next->prev = entry->prev;
+    PyMem_Free(entry);
+}
+
+
+static ProfEntry *
+profile_get_entry(PyCodeObject *code)
+{
+    void *extra;
+    if (_PyCode_GetExtra((PyObject *)code, profiler.extra_index, &extra) < 0) {
+        return NULL;
+    }
+    if (extra != NULL) {
+        return (ProfEntry *)extra;
+    }
+
+    ProfEntry *entry = PyMem_Calloc(1, sizeof(ProfEntry));
+    if (entry == NULL) {
+        PyErr_NoMemory();
+        return NULL;
+    }
+    entry->code = code;
+    if (_PyCode_SetExtra((PyObject *)code, profiler.extra_index, entry) < 0) {
+        PyMem_Free(entry);
+        return NULL;
+    }
+    entry->next = &profiler.entries;
+    entry->prev = profiler.entries.prev;
+    profiler.entries.prev->next = entry;
+    profiler.entries.prev = entry;
+    return entry;
+}
+
+
+static int
+profile_enter(PyFrameObject *frame, int64_t now)
+{
+    ProfEntry *entry = profile_get_entry(frame->f_code);
+    if (entry == NULL) {
+        return -1;
+    }
+
+    if (profiler.depth == profiler.allocated) {
+        Py_ssize_t allocated = profiler.allocated ? profiler.allocated * 2 : 64;
+        ProfContext *stack = PyMem_Realloc(profiler.stack,
+                                           allocated * sizeof(ProfContext));
+        if (stack == NULL) {
+            PyErr_NoMemory();
+            return -1;
+        }
+        profiler.stack = stack;
+        profiler.allocated = allocated;
+    }
+
+    /* A generator resumed after a yield re-enters its frame; only count
+       the first entry as a call. */
+    if (frame->f_lasti < 0) {
+        entry->calls++;
+    }
+    entry->active++;
+
+    ProfContext *ctx = &profiler.stack[profiler.depth++];
+    ctx->entry = entry;
+    ctx->frame = frame;
+    ctx->start = now;
+    ctx->children = 0;
+    return 0;
+}
+
+
+static void
+profile_leave(PyFrameObject *frame, int64_t now)
+{
+    /* Frames entered before start() return without a matching context */
+    if (profiler.depth == 0 || profiler.stack[profiler.depth - 1].frame != frame) {
+        return;
+    }
+
+    ProfContext *ctx = &profiler.stack[--profiler.depth];
+    ProfEntry *entry = ctx->entry;
+    int64_t elapsed = now - ctx->start;
+
+    /* Recursive activations are already covered by the outermost one */
+    if (--entry->active == 0) {
+        entry->inclusive += elapsed;
+    }
+    entry->exclusive += elapsed - ctx->children;
+    if (profiler.depth > 0) {
+        profiler.stack[profiler.depth - 1].children += elapsed;
+    }
+}
+
+
+static int
+profile_callback(PyObject *obj, PyFrameObject *frame, int what, PyObject *arg)
+{
+    int64_t now = profile_now();
+
+    if (what == PyTrace_CALL) {
+        return profile_enter(frame, now);
+    }
+    if (what == PyTrace_RETURN) {
+        profile_leave(frame, now);
+    }
+    return 0;
+}
+
+
+static void
+profile_reset_stack(void)
+{
+    for (Py_ssize_t i = 0; i < profiler.depth; i++) {
+        profiler.stack[i].entry->active = 0;
+    }
+    profiler.depth = 0;
+}
+
+
+PyDoc_STRVAR(profile_start_doc,
+"start()\n\
+\n\
+Start collecting call counts and timings for every Python function.");
+
+static PyObject *
+profile_start(PyObject *module, PyObject *Py_UNUSED(ignored))
+{
+    if (profiler.extra_index < 0) {
+        profiler.extra_index = _PyEval_RequestCodeExtraIndex(profile_entry_free);
+        if (profiler.extra_index < 0) {
+            PyErr_SetString(PyExc_RuntimeError,
+                            "no free co_extra slot for the profiler");
+            return NULL;
+        }
+    }
+    if (!profiler.enabled) {
+        profile_reset_stack();
+        PyEval_SetProfile(profile_callback, NULL);
+        profiler.enabled = 1;
+    }
+    Py_RETURN_NONE;
+}
+
+
+PyDoc_STRVAR(profile_stop_doc,
+"stop()\n\
+\n\
+Stop collecting.  Counters collected so far are kept.");
+
+static PyObject *
+profile_stop(PyObject *module, PyObject *Py_UNUSED(ignored))
+{
+    if (profiler.enabled) {
+        PyEval_SetProfile(NULL, NULL);
+        profile_reset_stack();
+        profiler.enabled = 0;
+    }
+    Py_RETURN_NONE;
+}
+
+
+PyDoc_STRVAR(profile_clear_doc,
+"clear()\n\
+\n\
+Reset all counters to zero.");
+
+static PyObject *
+profile_clear(PyObject *module, PyObject *Py_UNUSED(ignored))
+{
+    ProfEntry *entry;
+    for (entry = profiler.entries.next; entry != &profiler.entries;
+         entry = entry->next) {
+        entry->calls = 0;
+        entry->inclusive = 0;
+        entry->exclusive = 0;
+    }
+    Py_RETURN_NONE;
+}
+
+
+PyDoc_STRVAR(profile_snapshot_doc,
+"snapshot() -> list\n\
+\n\
+Return a list of (code, calls, inclusive, exclusive) tuples, one for\n\
+every function called since the counters were last cleared.  Times are\n\
+in seconds; inclusive time includes callees, exclusive time does not.");
+
+static PyObject *
+profile_snapshot(PyObject *module, PyObject *Py_UNUSED(ignored))
+{
+    ProfEntry *entry;
+    PyObject *list = PyList_New(0);
+    if (list == NULL) {
+        return NULL;
+    }
+
+    for (entry = profiler.entries.next; entry != &profiler.entries;
+         entry = entry->next) {
+        if (entry->calls == 0 && entry->exclusive == 0) {
+            continue;
+        }
+        PyObject *item = Py_BuildValue("(OKdd)", (PyObject *)entry->code,
+                                       (unsigned long long)entry->calls,
+                                       entry->inclusive * 1e-9,
+                                       entry->exclusive * 1e-9);
+        if (item == NULL) {
+            Py_DECREF(list);
+            return NULL;
+        }
+        int res = PyList_Append(list, item);
+        Py_DECREF(item);
+        if (res < 0) {
+            Py_DECREF(list);
+            return NULL;
+        }
+    }
+    return list;
+}
+
+
+PyDoc_STRVAR(profile_is_enabled_doc,
+"is_enabled() -> bool\n\
+\n\
+Return True if the profiler is collecting.");
+
+static PyObject *
+profile_is_enabled(PyObject *module, PyObject *Py_UNUSED(ignored))
+{
+    return PyBool_FromLong(profiler.enabled);
+}
+
+
+static PyMethodDef profile_methods[] = {
+    {"start",      profile_start,      METH_NOARGS, profile_start_doc},
+    {"stop",       profile_stop,       METH_NOARGS, profile_stop_doc},
+    {"clear",      profile_clear,      METH_NOARGS, profile_clear_doc},
+    {"snapshot",   profile_snapshot,   METH_NOARGS, profile_snapshot_doc},
+    {"is_enabled", profile_is_enabled, METH_NOARGS, profile_is_enabled_doc},
+    {NULL,         NULL}           /* sentinel */
+};
+
+
+PyDoc_STRVAR(module_doc,
+"Deterministic function profiler.\n\
+\n\
+start() -- start counting calls and timing every function\n\
+stop() -- stop counting\n\
+clear() -- reset all counters\n\
+snapshot() -- return [(code, calls, inclusive, exclusive), ...]\n\
+is_enabled() -- is the profiler collecting?");
+
+
+static struct PyModuleDef profilemodule = {
+    PyModuleDef_HEAD_INIT,
+    .m_name = "_profile",
+    .m_doc = module_doc,
+    .m_size = 0,
+    .m_methods = profile_methods,
+};
+
+
+PyMODINIT_FUNC
+PyInit__profile(void)
+{
+    return PyModuleDef_Init(&profilemodule);
+}
@@ -0,0 +1,1508 @@
+/* Array object implementation
+ *
+ * An array stores machine numbers of one type contiguously, without a
+ * PyObject per item: array('d') holds a million floats in 8 MB where a
+ * list needs a pointer and a float object per item.  Items are boxed only
+ * when read.
+ *
+ * The reductions sum(), min(), max() and dot() are plain loops over the
+ * raw items, written with independent accumulators so that the compiler
+ * turns them into SIMD code; they run at close to memory bandwidth.
+ */
+
+#define PY_SSIZE_T_CLEAN
+#include "Python.h"
+
+
+struct arraydescr {
+    char typecode;
+    int itemsize;
+    int is_float;
+    PyObject * (*getitem)(const char *);
+    int (*setitem)(char *, PyObject *);
+    PyObject * (*sum)(const char *, Py_ssize_t);
+    PyObject * (*min)(const char *, Py_ssize_t);
+    PyObject * (*max)(const char *, Py_ssize_t);
+    PyObject * (*dot)(const char *, const char *, Py_ssize_t);
+};
+
+typedef struct {
+    PyObject_VAR_HEAD           /* ob_size is the number of items */
+    char *ob_item;
+    Py_ssize_t allocated;       /* in items */
+    const struct arraydescr *ob_descr;
+} arrayobject;
+
+static PyTypeObject array_type;
+
+#define array_Check(op) PyObject_TypeCheck(op, &array_type)
+
+/* Bytes written to or read from a file per call of its write() method */
+#define BLOCKSIZE (64 * 1024)
+
+/* An integer sum is split in sums of the high and low 32 bits of its
+ * terms, which cannot overflow for up to SUM_CHUNK terms */
+#define SUM_CHUNK ((Py_ssize_t)1 << 30)
+
+
+/****************************** Item access *****************************/
+
+static int
+get_integer(PyObject *v, PyObject **result)
+{
+    if (PyFloat_Check(v)) {
+        PyErr_SetString(PyExc_TypeError,
+                        "array item must be integer");
+        return -1;
+    }
+    *result = PyNumber_Index(v);
+    return *result == NULL ? -1 : 0;
+}
+
+static int
+item_out_of_range(const struct arraydescr *descr)
+{
+    PyErr_Format(PyExc_OverflowError,
+                 "array item out of range for typecode '%c'",
+                 descr->typecode);
+    return -1;
+}
+
+#define SIGNED_ITEM(NAME, TYPE, MIN, MAX)                               \
+static PyObject *                                                       \
+NAME##_getitem(const char *p)                                           \
+{                                                                       \
+    return PyLong_FromLongLong(*(const TYPE *)p);                       \
+}                                                                       \
+                                                                        \
+static int                                                              \
+NAME##_setitem(char *p, PyObject *v)                                    \
+{                                                                       \
+    PyObject *index;                                                    \
+    long long x;                                                        \
+    if (get_integer(v, &index) < 0)                                     \
+        return -1;                                                      \
+    x = PyLong_AsLongLong(index);                                       \
+    Py_DECREF(index);                                                   \
+    if (x == -1 && PyErr_Occurred()) {                                  \
+        if (PyErr_ExceptionMatches(PyExc_OverflowError)) {              \
+            PyErr_Clear();                                              \
+            return item_out_of_range(&NAME##_descr);                    \
+        }                                                               \
+        return -1;                                                      \
+    }                                                                   \
+    if (x < (MIN) || x > (MAX))                                         \
+        return item_out_of_range(&NAME##_descr);                        \
+    *(TYPE *)p = (TYPE)x;                                               \
+    return 0;                                                           \
+}
+
+#define UNSIGNED_ITEM(NAME, TYPE, MAX)                                  \
+static PyObject *                                                       \
+NAME##_getitem(const char *p)                                           \
+{                                                                       \
+    return PyLong_FromUnsignedLongLong(*(const TYPE *)p);               \
+}                                                                       \
+                                                                        \
+static int                                                              \
+NAME##_setitem(char *p, PyObject *v)                                    \
+{                                                                       \
+    PyObject *index;                                                    \
+    unsigned long long x;                                               \
+    if (get_integer(v, &index) < 0)                                     \
+        return -1;                                                      \
+    x = PyLong_AsUnsignedLongLong(index);                               \
+    Py_DECREF(index);                                                   \
+    if (x == (unsigned long long)-1 && PyErr_Occurred()) {              \
+        if (PyErr_ExceptionMatches(PyExc_OverflowError)) {              \
+            PyErr_Clear();                                              \
+            return item_out_of_range(&NAME##_descr);                    \
+        }                                                               \
+        return -1;                                                      \
+    }                                                                   \
+    if (x > (MAX))                                                      \
+        return item_out_of_range(&NAME##_descr);                        \
+    *(TYPE *)p = (TYPE)x;                                               \
+    return 0;                                                           \
+}
+
+#define FLOAT_ITEM(NAME, TYPE)                                          \
+static PyObject *                                                       \
+NAME##_getitem(const char *p)                                           \
+{                                                                       \
+    return PyFloat_FromDouble(*(const TYPE *)p);                        \
+}                                                                       \
+                                                                        \
+static int                                                              \
+NAME##_setitem(char *p, PyObject *v)                                    \
+{                                                                       \
+    double x = PyFloat_AsDouble(v);                                     \
+    if (x == -1.0 && PyErr_Occurred())                                  \
+        return -1;                                                      \
+    *(TYPE *)p = (TYPE)x;                                               \
+    return 0;                                                           \
+}
+
+
+/****************************** Reductions ******************************/
+
+/* Add hi * 2**32 + lo to the Python int *total */
+static int
+add_split_sum(PyObject **total, PyObject *hi, unsigned long long lo)
+{
+    PyObject *shift, *part, *sum;
+
+    if (hi == NULL)
+        return -1;
+    shift = PyLong_FromLong(32);
+    if (shift == NULL) {
+        Py_DECREF(hi);
+        return -1;
+    }
+    part = PyNumber_Lshift(hi, shift);
+    Py_DECREF(hi);
+    Py_DECREF(shift);
+    if (part == NULL)
+        return -1;
+    sum = PyNumber_Add(*total, part);
+    Py_DECREF(part);
+    if (sum == NULL)
+        return -1;
+    Py_SETREF(*total, sum);
+    part = PyLong_FromUnsignedLongLong(lo);
+    if (part == NULL)
+        return -1;
+    sum = PyNumber_Add(*total, part);
+    Py_DECREF(part);
+    if (sum == NULL)
+        return -1;
+    Py_SETREF(*total, sum);
+    return 0;
+}
+
+static PyObject *
+empty_reduction(const char *name)
+{
+    PyErr_Format(PyExc_ValueError, "%s() arg is an empty array", name);
+    return NULL;
+}
+
+/* Sum TERM(i) for i in range(n) exactly, where the terms fit in WIDE, a
+ * 64-bit type whose signedness matches the terms */
+#define SPLIT_SUM(WIDE, FROMWIDE, TERM)                                 \
+    PyObject *total = PyLong_FromLong(0);                               \
+    Py_ssize_t start, i;                                                \
+    if (total == NULL)                                                  \
+        return NULL;                                                    \
+    for (start = 0; start < n; start += SUM_CHUNK) {                    \
+        Py_ssize_t end = n - start > SUM_CHUNK ? start + SUM_CHUNK : n; \
+        WIDE hi = 0;                                                    \
+        unsigned long long lo = 0;                                      \
+        for (i = start; i < end; i++) {                                 \
+            WIDE term = (TERM);                                         \
+            hi += term >> 32;                                           \
+            lo += (unsigned long long)term & 0xffffffffU;               \
+        }                                                               \
+        if (add_split_sum(&total, FROMWIDE(hi), lo) < 0) {              \
+            Py_DECREF(total);                                           \
+            return NULL;                                                \
+        }                                                               \
+    }                                                                   \
+    return total;
+
+/* Four independent lanes, so that the comparisons vectorize */
+#define MINMAX_LOOP(TYPE, OP)                                           \
+    TYPE m0 = p[0], m1 = p[0], m2 = p[0], m3 = p[0];                    \
+    Py_ssize_t i;                                                       \
+    for (i = 0; i + 4 <= n; i += 4) {                                   \
+        m0 = p[i] OP m0 ? p[i] : m0;                                    \
+        m1 = p[i + 1] OP m1 ? p[i + 1] : m1;                            \
+        m2 = p[i + 2] OP m2 ? p[i + 2] : m2;                            \
+        m3 = p[i + 3] OP m3 ? p[i + 3] : m3;                            \
+    }                                                                   \
+    for (; i < n; i++)                                                  \
+        m0 = p[i] OP m0 ? p[i] : m0;                                    \
+    m0 = m1 OP m0 ? m1 : m0;                                            \
+    m2 = m3 OP m2 ? m3 : m2;                                            \
+    m0 = m2 OP m0 ? m2 : m0;
+
+#define INT_REDUCTIONS(NAME, TYPE, WIDE, FROMWIDE)                      \
+static PyObject *                                                       \
+NAME##_sum(const char *data, Py_ssize_t n)                              \
+{                                                                       \
+    const TYPE *p = (const TYPE *)data;                                 \
+    SPLIT_SUM(WIDE, FROMWIDE, p[i])                                     \
+}                                                                       \
+                                                                        \
+static PyObject *                                                       \
+NAME##_min(const char *data, Py_ssize_t n)                              \
+{                                                                       \
+    const TYPE *p = (const TYPE *)data;                                 \
+    if (n == 0)                                                         \
+        return empty_reduction("min");                                  \
+    MINMAX_LOOP(TYPE, <)                                                \
+    return NAME##_getitem((const char *)&m0);                           \
+}                                                                       \
+                                                                        \
+static PyObject *                                                       \
+NAME##_max(const char *data, Py_ssize_t n)                              \
+{                                                                       \
+    const TYPE *p = (const TYPE *)data;                                 \
+    if (n == 0)                                                         \
+        return empty_reduction("max");                                  \
+    MINMAX_LOOP(TYPE, >)                                                \
+    return NAME##_getitem((const char *)&m0);                           \
+}
+
+/* The products of items up to 32 bits fit in 64 bits */
+#define NARROW_DOT(NAME, TYPE, WIDE, FROMWIDE)                          \
+static PyObject *                                                       \
+NAME##_dot(const char *data, const char *other, Py_ssize_t n)           \
+{                                                                       \
+    const TYPE *p = (const TYPE *)data, *q = (const TYPE *)other;       \
+    SPLIT_SUM(WIDE, FROMWIDE, (WIDE)p[i] * q[i])                        \
+}
+
+/* Wider products are computed on Python ints */
+#define WIDE_DOT(NAME, TYPE)                                            \
+static PyObject *                                                       \
+NAME##_dot(const char *data, const char *other, Py_ssize_t n)           \
+{                                                                       \
+    const TYPE *p = (const TYPE *)data, *q = (const TYPE *)other;       \
+    return object_dot(NAME##_getitem, (const char *)p,                  \
+                      (const char *)q, sizeof(TYPE), n);                \
+}
+
+/* Eight lanes of double, whatever TYPE is: the result is more accurate
+ * than a left-to-right sum, and does not depend on the target's SIMD
+ * width */
+#define FLOAT_REDUCTIONS(NAME, TYPE)                                    \
+static PyObject *                                                       \
+NAME##_sum(const char *data, Py_ssize_t n)                              \
+{                                                                       \
+    const TYPE *p = (const TYPE *)data;                                 \
+    double s[8] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};             \
+    Py_ssize_t i;                                                       \
+    int k;                                                              \
+    for (i = 0; i + 8 <= n; i += 8) {                                   \
+        for (k = 0; k < 8; k++)                                         \
+            s[k] += p[i + k];                                           \
+    }                                                                   \
+    for (; i < n; i++)                                                  \
+        s[0] += p[i];                                                   \
+    return PyFloat_FromDouble(((s[0] + s[1]) + (s[2] + s[3])) +         \
+                              ((s[4] + s[5]) + (s[6] + s[7])));         \
+}                                                                       \
+                                                                        \
+static PyObject *                                                       \
+NAME##_dot(const char *data, const char *other, Py_ssize_t n)           \
+{                                                                       \
+    const TYPE *p = (const TYPE *)data, *q = (const TYPE *)other;       \
+    double s[8] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};             \
+    Py_ssize_t i;                                                       \
+    int k;                                                              \
+    for (i = 0; i + 8 <= n; i += 8) {                                   \
+        for (k = 0; k < 8; k++)                                         \
+            s[k] += (double)p[i + k] * q[i + k];                        \
+    }                                                                   \
+    for (; i < n; i++)                                                  \
+        s[0] += (double)p[i] * q[i];                                    \
+    return PyFloat_FromDouble(((s[0] + s[1]) + (s[2] + s[3])) +         \
+                              ((s[4] + s[5]) + (s[6] + s[7])));         \
+}                                                                       \
+                                                                        \
+static PyObject *                                                       \
+NAME##_min(const char *data, Py_ssize_t n)                              \
+{                                                                       \
+    const TYPE *p = (const TYPE *)data;                                 \
+    if (n == 0)                                                         \
+        return empty_reduction("min");                                  \
+    if (has_nan_##NAME(p, n))                                           \
+        return PyFloat_FromDouble(Py_NAN);                              \
+    MINMAX_LOOP(TYPE, <)                                                \
+    return PyFloat_FromDouble(m0);                                      \
+}                                                                       \
+                                                                        \
+static PyObject *                                                       \
+NAME##_max(const char *data, Py_ssize_t n)                              \
+{                                                                       \
+    const TYPE *p = (const TYPE *)data;                                 \
+    if (n == 0)                                                         \
+        return empty_reduction("max");                                  \
+    if (has_nan_##NAME(p, n))                                           \
+        return PyFloat_FromDouble(Py_NAN);                              \
+    MINMAX_LOOP(TYPE, >)                                                \
+    return PyFloat_FromDouble(m0);                                      \
+}
+
+/* min() and max() return a NaN if there is one: a comparison with a NaN
+ * is false, so the lanes alone would skip some NaNs and keep others */
+#define HAS_NAN(NAME, TYPE)                                             \
+static int                                                              \
+has_nan_##NAME(const TYPE *p, Py_ssize_t n)                             \
+{                                                                       \
+    int found = 0;                                                      \
+    Py_ssize_t i;                                                       \
+    for (i = 0; i < n; i++)                                             \
+        found |= p[i] != p[i];                                          \
+    return found;                                                       \
+}
+
+static PyObject *
+object_dot(PyObject *(*getitem)(const char *), const char *p,
+           const char *q, int itemsize, Py_ssize_t n)
+{
+    PyObject *total = PyLong_FromLong(0);
+    Py_ssize_t i;
+
+    for (i = 0; i < n && total != NULL; i++) {
+        PyObject *x, *y, *prod;
+        x = getitem(p + i * itemsize);
+        y = getitem(q + i * itemsize);
+        prod = x && y ? PyNumber_Multiply(x, y) : NULL;
+        Py_XDECREF(x);
+        Py_XDECREF(y);
+        if (prod == NULL) {
+            Py_CLEAR(total);
+            break;
+        }
+        Py_SETREF(total, PyNumber_Add(total, prod));
+        Py_DECREF(prod);
+    }
+    return total;
+}
+
+
+/* The setters name their descriptor in range errors */
+#define DECLARE_DESCR(NAME) static const struct arraydescr NAME##_descr;
+
+#define DESCR(NAME, CODE, TYPE, IS_FLOAT)                               \
+static const struct arraydescr NAME##_descr = {                         \
+    CODE, sizeof(TYPE), IS_FLOAT, NAME##_getitem, NAME##_setitem,       \
+    NAME##_sum, NAME##_min, NAME##_max, NAME##_dot                      \
+};
+
+DECLARE_DESCR(b)
+DECLARE_DESCR(B)
+DECLARE_DESCR(h)
+DECLARE_DESCR(H)
+DECLARE_DESCR(i)
+DECLARE_DESCR(I)
+DECLARE_DESCR(l)
+DECLARE_DESCR(L)
+DECLARE_DESCR(q)
+DECLARE_DESCR(Q)
+
+SIGNED_ITEM(b, signed char, SCHAR_MIN, SCHAR_MAX)
+UNSIGNED_ITEM(B, unsigned char, UCHAR_MAX)
+SIGNED_ITEM(h, short, SHRT_MIN, SHRT_MAX)
+UNSIGNED_ITEM(H, unsigned short, USHRT_MAX)
+SIGNED_ITEM(i, int, INT_MIN, INT_MAX)
+UNSIGNED_ITEM(I, unsigned int, UINT_MAX)
+SIGNED_ITEM(l, long, LONG_MIN, LONG_MAX)
+UNSIGNED_ITEM(L, unsigned long, ULONG_MAX)
+SIGNED_ITEM(q, long long, LLONG_MIN, LLONG_MAX)
+UNSIGNED_ITEM(Q, unsigned long long, ULLONG_MAX)
+FLOAT_ITEM(f, float)
+FLOAT_ITEM(d, double)
+
+INT_REDUCTIONS(b, signed char, long long, PyLong_FromLongLong)
+INT_REDUCTIONS(B, unsigned char, unsigned long long, PyLong_FromUnsignedLongLong)
+INT_REDUCTIONS(h, short, long long, PyLong_FromLongLong)
+INT_REDUCTIONS(H, unsigned short, unsigned long long, PyLong_FromUnsignedLongLong)
+INT_REDUCTIONS(i, int, long long, PyLong_FromLongLong)
+INT_REDUCTIONS(I, unsigned int, unsigned long long, PyLong_FromUnsignedLongLong)
+INT_REDUCTIONS(l, long, long long, PyLong_FromLongLong)
+INT_REDUCTIONS(L, unsigned long, unsigned long long, PyLong_FromUnsignedLongLong)
+INT_REDUCTIONS(q, long long, long long, PyLong_FromLongLong)
+INT_REDUCTIONS(Q, unsigned long long, unsigned long long, PyLong_FromUnsignedLongLong)
+
+NARROW_DOT(b, signed char, long long, PyLong_FromLongLong)
+NARROW_DOT(B, unsigned char, unsigned long long, PyLong_FromUnsignedLongLong)
+NARROW_DOT(h, short, long long, PyLong_FromLongLong)
+NARROW_DOT(H, unsigned short, unsigned long long, PyLong_FromUnsignedLongLong)
+NARROW_DOT(i, int, long long, PyLong_FromLongLong)
+NARROW_DOT(I, unsigned int, unsigned long long, PyLong_FromUnsignedLongLong)
+#if SIZEOF_LONG <= 4
+NARROW_DOT(l, long, long long, PyLong_FromLongLong)
+NARROW_DOT(L, unsigned long, unsigned long long, PyLong_FromUnsignedLongLong)
+#else
+WIDE_DOT(l, long)
+WIDE_DOT(L, unsigned long)
+#endif
+WIDE_DOT(q, long long)
+WIDE_DOT(Q, unsigned long long)
+
+HAS_NAN(f, float)
+HAS_NAN(d, double)
+FLOAT_REDUCTIONS(f, float)
+FLOAT_REDUCTIONS(d, double)
+
+DESCR(b, 'b', signed char, 0)
+DESCR(B, 'B', unsigned char, 0)
+DESCR(h, 'h', short, 0)
+DESCR(H, 'H', unsigned short, 0)
+DESCR(i, 'i', int, 0)
+DESCR(I, 'I', unsigned int, 0)
+DESCR(l, 'l', long, 0)
+DESCR(L, 'L', unsigned long, 0)
+DESCR(q, 'q', long long, 0)
+DESCR(Q, 'Q', unsigned long long, 0)
+DESCR(f, 'f', float, 1)
+DESCR(d, 'd', double, 1)
+
+static const struct arraydescr *descriptors[] = {
+    &b_descr, &B_descr, &h_descr, &H_descr, &i_descr, &I_descr,
+    &l_descr, &L_descr, &q_descr, &Q_descr, &f_descr, &d_descr,
+    NULL
+};
+
+#define TYPECODES "bBhHiIlLqQfd"
+
+
+/**************************** Array objects *****************************/
+
+static PyObject *
+newarrayobject(PyTypeObject *type, Py_ssize_t size,
+               const struct arraydescr *descr)
+{
+    arrayobject *op;
+
+    if (size < 0 || size > PY_SSIZE_T_MAX / descr->itemsize) {
+        return PyErr_NoMemory();
+    }
+    op = (arrayobject *)type->tp_alloc(type, 0);
+    if (op == NULL)
+        return NULL;
+    op->ob_descr = descr;
+    op->allocated = size;
+    Py_SET_SIZE(op, size);
+    op->ob_item = NULL;
+    if (size > 0) {
+        op->ob_item = PyMem_Malloc(size * descr->itemsize);
+        if (op->ob_item == NULL) {
+            Py_DECREF(op);
+            return PyErr_NoMemory();
+        }
+    }
+    return (PyObject *)op;
+}
+
+/* Set the size to newsize, over-allocating on growth so that a series
+ * of appends takes amortized linear time, like list_resize() */
+static int
+array_resize(arrayobject *self, Py_ssize_t newsize)
+{
+    Py_ssize_t allocated = self->allocated;
+    Py_ssize_t itemsize = self->ob_descr->itemsize;
+    size_t new_allocated;
+    char *items;
+
+    if (allocated >= newsize && newsize >= (allocated >> 1)) {
+        Py_SET_SIZE(self, newsize);
+        return 0;
+    }
+    if (newsize == 0) {
+        PyMem_Free(self->ob_item);
+        self->ob_item = NULL;
+        Py_SET_SIZE(self, 0);
+        self->allocated = 0;
+        return 0;
+    }
+    new_allocated = (size_t)newsize + (newsize >> 4) +
+                    (newsize < 8 ? 3 : 7);
+    if (new_allocated > (size_t)PY_SSIZE_T_MAX / itemsize) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    items = PyMem_Realloc(self->ob_item, new_allocated * itemsize);
+    if (items == NULL) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    self->ob_item = items;
+    Py_SET_SIZE(self, newsize);
+    self->allocated = new_allocated;
+    return 0;
+}
+
+static void
+array_dealloc(arrayobject *op)
+{
+    PyMem_Free(op->ob_item);
+    Py_TYPE(op)->tp_free(op);
+}
+
+static PyObject *
+getarrayitem(arrayobject *self, Py_ssize_t i)
+{
+    return self->ob_descr->getitem(self->ob_item +
+                                   i * self->ob_descr->itemsize);
+}
+
+static int
+setarrayitem(arrayobject *self, Py_ssize_t i, PyObject *v)
+{
+    return self->ob_descr->setitem(self->ob_item +
+                                   i * self->ob_descr->itemsize, v);
+}
+
+static int
+array_append_item(arrayobject *self, PyObject *v)
+{
+    Py_ssize_t n = Py_SIZE(self);
+
+    if (array_resize(self, n + 1) < 0)
+        return -1;
+    if (setarrayitem(self, n, v) < 0) {
+        Py_SET_SIZE(self, n);
+        return -1;
+    }
+    return 0;
+}
+
+/* Append the raw items of s, a string whose length is a multiple of the
+ * item size */
+static int
+array_append_raw(arrayobject *self, const char *s, Py_ssize_t nbytes)
+{
+    Py_ssize_t itemsize = self->ob_descr->itemsize;
+    Py_ssize_t n = Py_SIZE(self);
+
+    assert(nbytes % itemsize == 0);
+    if (nbytes == 0)
+        return 0;
+    if (n > PY_SSIZE_T_MAX - nbytes / itemsize) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    if (array_resize(self, n + nbytes / itemsize) < 0)
+        return -1;
+    memcpy(self->ob_item + n * itemsize, s, nbytes);
+    return 0;
+}
+
+static int
+array_do_extend(arrayobject *self, PyObject *bb)
+{
+    Py_ssize_t n = Py_SIZE(self);
+
+    if (array_Check(bb)) {
+        arrayobject *b = (arrayobject *)bb;
+        if (b->ob_descr != self->ob_descr) {
+            PyErr_SetString(PyExc_TypeError,
+                            "can only extend with array of same kind");
+            return -1;
+        }
+        /* b may be self, whose items move on resize */
+        Py_ssize_t m = Py_SIZE(b);
+        if (n > PY_SSIZE_T_MAX - m) {
+            PyErr_NoMemory();
+            return -1;
+        }
+        if (array_resize(self, n + m) < 0)
+            return -1;
+        memcpy(self->ob_item + n * self->ob_descr->itemsize, b->ob_item,
+               m * b->ob_descr->itemsize);
+        return 0;
+    }
+    if (PyList_Check(bb) || PyTuple_CheckExact(bb)) {
+        int islist = PyList_Check(bb);
+        Py_ssize_t i, m = Py_SIZE(bb);
+        if (array_resize(self, n + m) < 0)
+            return -1;
+        /* An item's __index__ may shrink the list */
+        for (i = 0; i < m && i < Py_SIZE(bb); i++) {
+            PyObject *v = islist ? PyList_Items(bb)[i] : PyTuple_Items(bb)[i];
+            int res;
+            Py_INCREF(v);
+            res = setarrayitem(self, n + i, v);
+            Py_DECREF(v);
+            if (res < 0) {
+                array_resize(self, n + i);
+                return -1;
+            }
+        }
+        return i < m ? array_resize(self, n + i) : 0;
+    }
+
+    PyObject *it = PyObject_GetIter(bb);
+    PyObject *v;
+    if (it == NULL)
+        return -1;
+    while ((v = PyIter_Next(it)) != NULL) {
+        if (array_append_item(self, v) < 0) {
+            Py_DECREF(v);
+            Py_DECREF(it);
+            return -1;
+        }
+        Py_DECREF(v);
+    }
+    Py_DECREF(it);
+    return PyErr_Occurred() ? -1 : 0;
+}
+
+static PyObject *
+array_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
+{
+    int c;
+    PyObject *initial = NULL;
+    const struct arraydescr * const *descr;
+    arrayobject *a;
+
+    if (type == &array_type && !_PyArg_NoKeywords("array.array", kwds))
+        return NULL;
+    if (!PyArg_ParseTuple(args, "C|O:array", &c, &initial))
+        return NULL;
+
+    for (descr = descriptors; *descr != NULL; descr++) {
+        if ((*descr)->typecode == c)
+            break;
+    }
+    if (*descr == NULL) {
+        PyErr_SetString(PyExc_ValueError,
+                        "bad typecode (must be b, B, h, H, i, I, l, L, q, "
+                        "Q, f or d)");
+        return NULL;
+    }
+
+    a = (arrayobject *)newarrayobject(type, 0, *descr);
+    if (a == NULL)
+        return NULL;
+    if (initial == NULL)
+        return (PyObject *)a;
+
+    if (PyString_Check(initial)) {
+        Py_ssize_t nbytes;
+        const char *s = PyString_AsCharAndSize(initial, &nbytes);
+        if (s == NULL)
+            goto error;
+        if (nbytes % (*descr)->itemsize != 0) {
+            PyErr_SetString(PyExc_ValueError,
+                            "bytes length not a multiple of item size");
+            goto error;
+        }
+        if (array_append_raw(a, s, nbytes) < 0)
+            goto error;
+    }
+    else if (array_Check(initial) &&
+             ((arrayobject *)initial)->ob_descr != *descr) {
+        /* Convert item by item, checking the range */
+        arrayobject *b = (arrayobject *)initial;
+        Py_ssize_t i, m = Py_SIZE(b);
+        if (array_resize(a, m) < 0)
+            goto error;
+        for (i = 0; i < m; i++) {
+            PyObject *v = getarrayitem(b, i);
+            if (v == NULL || setarrayitem(a, i, v) < 0) {
+                Py_XDECREF(v);
+                goto error;
+            }
+            Py_DECREF(v);
+        }
+    }
+    else if (array_do_extend(a, initial) < 0) {
+        goto error;
+    }
+    return (PyObject *)a;
+
+  error:
+    Py_DECREF(a);
+    return NULL;
+}
+
+static PyObject *
+array_slice(arrayobject *a, Py_ssize_t start, Py_ssize_t step,
+            Py_ssize_t slicelength)
+{
+    Py_ssize_t itemsize = a->ob_descr->itemsize;
+    arrayobject *np;
+    Py_ssize_t i;
+
+    np = (arrayobject *)newarrayobject(&array_type, slicelength,
+                                       a->ob_descr);
+    if (np == NULL)
+        return NULL;
+    if (step == 1) {
+        if (slicelength > 0)
+            memcpy(np->ob_item, a->ob_item + start * itemsize,
+                   slicelength * itemsize);
+    }
+    else {
+        for (i = 0; i < slicelength; i++, start += step)
+            memcpy(np->ob_item + i * itemsize,
+                   a->ob_item + start * itemsize, itemsize);
+    }
+    return (PyObject *)np;
+}
+
+
+/*************************** Sequence protocol **************************/
+
+static Py_ssize_t
+array_length(arrayobject *a)
+{
+    return Py_SIZE(a);
+}
+
+static PyObject *
+array_item(arrayobject *a, Py_ssize_t i)
+{
+    if (i < 0 || i >= Py_SIZE(a)) {
+        PyErr_SetString(PyExc_IndexError, "array index out of range");
+        return NULL;
+    }
+    return getarrayitem(a, i);
+}
+
+static int
+array_del_items(arrayobject *a, Py_ssize_t start, Py_ssize_t step,
+                Py_ssize_t slicelength)
+{
+    Py_ssize_t itemsize = a->ob_descr->itemsize;
+    Py_ssize_t n = Py_SIZE(a);
+    Py_ssize_t i, dest;
+
+    if (slicelength <= 0)
+        return 0;
+    if (step < 0) {
+        start += step * (slicelength - 1);
+        step = -step;
+    }
+    /* Close the gaps left by the deleted items, one run at a time */
+    dest = start;
+    for (i = 0; i < slicelength; i++) {
+        Py_ssize_t cur = start + i * step;
+        Py_ssize_t next = i + 1 < slicelength ? cur + step : n;
+        Py_ssize_t run = next - cur - 1;
+        if (run > 0) {
+            memmove(a->ob_item + dest * itemsize,
+                    a->ob_item + (cur + 1) * itemsize, run * itemsize);
+            dest += run;
+        }
+    }
+    return array_resize(a, n - slicelength);
+}
+
+static int
+array_ass_item(arrayobject *a, Py_ssize_t i, PyObject *v)
+{
+    if (i < 0 || i >= Py_SIZE(a)) {
+        PyErr_SetString(PyExc_IndexError,
+                        "array assignment index out of range");
+        return -1;
+    }
+    if (v == NULL)
+        return array_del_items(a, i, 1, 1);
+    return setarrayitem(a, i, v);
+}
+
+static int
+array_contains(arrayobject *self, PyObject *v)
+{
+    Py_ssize_t i;
+    int cmp;
+
+    for (i = 0, cmp = 0; cmp == 0 && i < Py_SIZE(self); i++) {
+        PyObject *item = getarrayitem(self, i);
+        if (item == NULL)
+            return -1;
+        cmp = PyObject_RichCompareBool(item, v, Py_EQ);
+        Py_DECREF(item);
+    }
+    return cmp;
+}
+
+static PyObject *
+array_concat(arrayobject *a, PyObject *bb)
+{
+    arrayobject *b, *np;
+    Py_ssize_t itemsize = a->ob_descr->itemsize;
+
+    if (!array_Check(bb)) {
+        PyErr_Format(PyExc_TypeError,
+             "can only append array (not \"%.200s\") to array",
+                     Py_TYPE(bb)->tp_name);
+        return NULL;
+    }
+    b = (arrayobject *)bb;
+    if (a->ob_descr != b->ob_descr) {
+        PyErr_BadArgument();
+        return NULL;
+    }
+    if (Py_SIZE(a) > PY_SSIZE_T_MAX - Py_SIZE(b)) {
+        return PyErr_NoMemory();
+    }
+    np = (arrayobject *)newarrayobject(&array_type,
+                                       Py_SIZE(a) + Py_SIZE(b),
+                                       a->ob_descr);
+    if (np == NULL)
+        return NULL;
+    if (Py_SIZE(a) > 0)
+        memcpy(np->ob_item, a->ob_item, Py_SIZE(a) * itemsize);
+    if (Py_SIZE(b) > 0)
+        memcpy(np->ob_item + Py_SIZE(a) * itemsize, b->ob_item,
+               Py_SIZE(b) * itemsize);
+    return (PyObject *)np;
+}
+
+static PySequenceMethods array_as_sequence = {
+    (lenfunc)array_length,              /* sq_length */
+    (binaryfunc)array_concat,           /* sq_concat */
+    0,                                  /* sq_repeat */
+    (ssizeargfunc)array_item,           /* sq_item */
+    0,                                  /* was_sq_slice */
+    (ssizeobjargproc)array_ass_item,    /* sq_ass_item */
+    0,                                  /* was_sq_ass_slice */
+    (objobjproc)array_contains,         /* sq_contains */
+};
+
+
+/*************************** Mapping protocol ***************************/
+
+static PyObject *
+array_subscr(arrayobject *self, PyObject *item)
+{
+    if (PyIndex_Check(item)) {
+        Py_ssize_t i = PyNumber_AsSsize_t(item, PyExc_IndexError);
+        if (i == -1 && PyErr_Occurred())
+            return NULL;
+        if (i < 0)
+            i += Py_SIZE(self);
+        return array_item(self, i);
+    }
+    if (PySlice_Check(item)) {
+        Py_ssize_t start, stop, step, slicelength;
+        if (PySlice_Unpack(item, &start, &stop, &step) < 0)
+            return NULL;
+        slicelength = PySlice_AdjustIndices(Py_SIZE(self), &start, &stop,
+                                            step);
+        return array_slice(self, start, step, slicelength);
+    }
+    PyErr_SetString(PyExc_TypeError,
+                    "array indices must be integers");
+    return NULL;
+}
+
+static int
+array_ass_subscr(arrayobject *self, PyObject *item, PyObject *value)
+{
+    Py_ssize_t start, stop, step, slicelength, needed, i, n;
+    Py_ssize_t itemsize = self->ob_descr->itemsize;
+    arrayobject *other;
+    int res;
+
+    if (PyIndex_Check(item)) {
+        i = PyNumber_AsSsize_t(item, PyExc_IndexError);
+        if (i == -1 && PyErr_Occurred())
+            return -1;
+        if (i < 0)
+            i += Py_SIZE(self);
+        return array_ass_item(self, i, value);
+    }
+    if (!PySlice_Check(item)) {
+        PyErr_SetString(PyExc_TypeError,
+                        "array indices must be integers");
+        return -1;
+    }
+    if (PySlice_Unpack(item, &start, &stop, &step) < 0)
+        return -1;
+    slicelength = PySlice_AdjustIndices(Py_SIZE(self), &start, &stop, step);
+
+    if (value == NULL)
+        return array_del_items(self, start, step, slicelength);
+    if (!array_Check(value)) {
+        PyErr_Format(PyExc_TypeError,
+            "can only assign array (not \"%.200s\") to array slice",
+                     Py_TYPE(value)->tp_name);
+        return -1;
+    }
+    other = (arrayobject *)value;
+    if (other->ob_descr != self->ob_descr) {
+        PyErr_BadArgument();
+        return -1;
+    }
+    /* a[i:j] = a copies the items first, as they move with the resize */
+    if (other == self) {
+        other = (arrayobject *)array_slice(self, 0, 1, Py_SIZE(self));
+        if (other == NULL)
+            return -1;
+    }
+    else {
+        Py_INCREF(other);
+    }
+    needed = Py_SIZE(other);
+    n = Py_SIZE(self);
+    res = 0;
+    if (step == 1) {
+        /* Make room for the new items, or close the gap, and copy */
+        if (slicelength < needed) {
+            if (array_resize(self, n + needed - slicelength) < 0) {
+                res = -1;
+                goto done;
+            }
+        }
+        if (slicelength != needed) {
+            memmove(self->ob_item + (start + needed) * itemsize,
+                    self->ob_item + (start + slicelength) * itemsize,
+                    (n - start - slicelength) * itemsize);
+        }
+        if (slicelength > needed)
+            res = array_resize(self, n + needed - slicelength);
+        if (res == 0 && needed > 0)
+            memcpy(self->ob_item + start * itemsize, other->ob_item,
+                   needed * itemsize);
+    }
+    else if (needed != slicelength) {
+        PyErr_Format(PyExc_ValueError,
+            "attempt to assign array of size %zd "
+            "to extended slice of size %zd",
+                     needed, slicelength);
+        res = -1;
+    }
+    else {
+        for (i = 0; i < slicelength; i++, start += step)
+            memcpy(self->ob_item + start * itemsize,
+                   other->ob_item + i * itemsize, itemsize);
+    }
+  done:
+    Py_DECREF(other);
+    return res;
+}
+
+static PyMappingMethods array_as_mapping = {
+    (lenfunc)array_length,              /* mp_length */
+    (binaryfunc)array_subscr,           /* mp_subscript */
+    (objobjargproc)array_ass_subscr,    /* mp_ass_subscript */
+};
+
+
+/****************************** Methods *********************************/
+
+static PyObject *
+array_append(arrayobject *self, PyObject *v)
+{
+    if (array_append_item(self, v) < 0)
+        return NULL;
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(append_doc,
+"Append a new item to the end of the array.");
+
+static PyObject *
+array_extend(arrayobject *self, PyObject *bb)
+{
+    if (array_do_extend(self, bb) < 0)
+        return NULL;
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(extend_doc,
+"Append items to the end of the array from an array or iterable.");
+
+static PyObject *
+array_pop(arrayobject *self, PyObject *const *args, Py_ssize_t nargs)
+{
+    Py_ssize_t i = -1, n = Py_SIZE(self);
+    PyObject *v;
+
+    if (!_PyArg_CheckPositional("pop", nargs, 0, 1))
+        return NULL;
+    if (nargs == 1) {
+        i = PyNumber_AsSsize_t(args[0], PyExc_IndexError);
+        if (i == -1 && PyErr_Occurred())
+            return NULL;
+    }
+    if (n == 0) {
+        PyErr_SetString(PyExc_IndexError, "pop from empty array");
+        return NULL;
+    }
+    if (i < 0)
+        i += n;
+    if (i < 0 || i >= n) {
+        PyErr_SetString(PyExc_IndexError, "pop index out of range");
+        return NULL;
+    }
+    v = getarrayitem(self, i);
+    if (v == NULL)
+        return NULL;
+    if (array_del_items(self, i, 1, 1) < 0) {
+        Py_DECREF(v);
+        return NULL;
+    }
+    return v;
+}
+
+PyDoc_STRVAR(pop_doc,
+"Remove and return item (default last).");
+
+static PyObject *
+array_tolist(arrayobject *self, PyObject *unused)
+{
+    PyObject *list = PyList_New(Py_SIZE(self));
+    Py_ssize_t i;
+
+    if (list == NULL)
+        return NULL;
+    for (i = 0; i < Py_SIZE(self); i++) {
+        PyObject *v = getarrayitem(self, i);
+        if (v == NULL) {
+            Py_DECREF(list);
+            return NULL;
+        }
+        PyList_Items(list)[i] = v;
+    }
+    return list;
+}
+
+PyDoc_STRVAR(tolist_doc,
+"Convert array to an ordinary list with the same items.");
+
+static PyObject *
+array_tobytes(arrayobject *self, PyObject *unused)
+{
+    return PyString_FromStringAndSize(self->ob_item,
+                                      Py_SIZE(self) * self->ob_descr->itemsize);
+}
+
+PyDoc_STRVAR(tobytes_doc,
+"Convert the array to a string of its raw machine values.");
+
+static PyObject *
+array_frombytes(arrayobject *self, PyObject *arg)
+{
+    Py_ssize_t nbytes;
+    const char *s;
+
+    if (!PyString_Check(arg)) {
+        _PyArg_BadArgument("frombytes", "argument", "string", arg);
+        return NULL;
+    }
+    s = PyString_AsCharAndSize(arg, &nbytes);
+    if (s == NULL)
+        return NULL;
+    if (nbytes % self->ob_descr->itemsize != 0) {
+        PyErr_SetString(PyExc_ValueError,
+                        "bytes length not a multiple of item size");
+        return NULL;
+    }
+    if (array_append_raw(self, s, nbytes) < 0)
+        return NULL;
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(frombytes_doc,
+"Append the raw machine values of a string, as written by tobytes().");
+
+static PyObject *
+array_tofile(arrayobject *self, PyObject *f)
+{
+    _Py_IDENTIFIER(write);
+    Py_ssize_t nbytes = Py_SIZE(self) * self->ob_descr->itemsize;
+    Py_ssize_t offset;
+
+    for (offset = 0; offset < nbytes; offset += BLOCKSIZE) {
+        Py_ssize_t size = Py_MIN(nbytes - offset, BLOCKSIZE);
+        PyObject *block, *res;
+
+        block = PyString_FromStringAndSize(self->ob_item + offset, size);
+        if (block == NULL)
+            return NULL;
+        res = _PyObject_CallMethodIdOneArg(f, &PyId_write, block);
+        Py_DECREF(block);
+        if (res == NULL)
+            return NULL;
+        Py_DECREF(res);
+    }
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(tofile_doc,
+"Write all items (as machine values) to the file object f.");
+
+static PyObject *
+array_fromfile(arrayobject *self, PyObject *const *args, Py_ssize_t nargs)
+{
+    _Py_IDENTIFIER(read);
+    Py_ssize_t itemsize = self->ob_descr->itemsize;
+    Py_ssize_t n, nbytes, got;
+    PyObject *size, *data;
+    const char *s;
+    int not_enough;
+
+    if (!_PyArg_CheckPositional("fromfile", nargs, 2, 2))
+        return NULL;
+    n = PyNumber_AsSsize_t(args[1], PyExc_OverflowError);
+    if (n == -1 && PyErr_Occurred())
+        return NULL;
+    if (n < 0) {
+        PyErr_SetString(PyExc_ValueError, "negative count");
+        return NULL;
+    }
+    if (n > PY_SSIZE_T_MAX / itemsize) {
+        return PyErr_NoMemory();
+    }
+    nbytes = n * itemsize;
+
+    size = PyLong_FromSsize_t(nbytes);
+    if (size == NULL)
+        return NULL;
+    data = _PyObject_CallMethodIdOneArg(args[0], &PyId_read, size);
+    Py_DECREF(size);
+    if (data == NULL)
+        return NULL;
+    if (!PyString_Check(data)) {
+        PyErr_SetString(PyExc_TypeError,
+                        "read() didn't return a string");
+        Py_DECREF(data);
+        return NULL;
+    }
+    s = PyString_AsCharAndSize(data, &got);
+    if (s == NULL) {
+        Py_DECREF(data);
+        return NULL;
+    }
+    /* Keep the whole items of a short read, as CPython does */
+    not_enough = got < nbytes;
+    got = Py_MIN(got, nbytes);
+    if (array_append_raw(self, s, got - got % itemsize) < 0) {
+        Py_DECREF(data);
+        return NULL;
+    }
+    Py_DECREF(data);
+    if (not_enough) {
+        PyErr_SetString(PyExc_EOFError,
+                        "read() didn't return enough bytes");
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(fromfile_doc,
+"fromfile(f, n)\n\
+\n\
+Read n items (as machine values) from the file object f and append them\n\
+to the end of the array.");
+
+static PyObject *
+array_sum(arrayobject *self, PyObject *unused)
+{
+    return self->ob_descr->sum(self->ob_item, Py_SIZE(self));
+}
+
+PyDoc_STRVAR(sum_doc,
+"Return the sum of the items.\n\
+\n\
+Integer sums are exact; floating point items are summed in double\n\
+precision in several partial sums.");
+
+static PyObject *
+array_min(arrayobject *self, PyObject *unused)
+{
+    return self->ob_descr->min(self->ob_item, Py_SIZE(self));
+}
+
+PyDoc_STRVAR(min_doc,
+"Return the smallest item, or NaN if there is a NaN among them.");
+
+static PyObject *
+array_max(arrayobject *self, PyObject *unused)
+{
+    return self->ob_descr->max(self->ob_item, Py_SIZE(self));
+}
+
+PyDoc_STRVAR(max_doc,
+"Return the largest item, or NaN if there is a NaN among them.");
+
+static PyObject *
+array_dot(arrayobject *self, PyObject *arg)
+{
+    arrayobject *other = (arrayobject *)arg;
+
+    if (!array_Check(arg)) {
+        _PyArg_BadArgument("dot", "argument", "array", arg);
+        return NULL;
+    }
+    if (other->ob_descr != self->ob_descr) {
+        PyErr_SetString(PyExc_TypeError,
+                        "dot() needs arrays of the same typecode");
+        return NULL;
+    }
+    if (Py_SIZE(other) != Py_SIZE(self)) {
+        PyErr_SetString(PyExc_ValueError,
+                        "dot() needs arrays of the same length");
+        return NULL;
+    }
+    return self->ob_descr->dot(self->ob_item, other->ob_item, Py_SIZE(self));
+}
+
+PyDoc_STRVAR(dot_doc,
+"dot(other)\n\
+\n\
+Return the sum of the products of the items of two arrays of the same\n\
+typecode and length.");
+
+
+static PyObject *
+array_get_typecode(arrayobject *a, void *closure)
+{
+    char typecode = a->ob_descr->typecode;
+    return PyString_FromStringAndSize(&typecode, 1);
+}
+
+static PyObject *
+array_get_itemsize(arrayobject *a, void *closure)
+{
+    return PyLong_FromLong((long)a->ob_descr->itemsize);
+}
+
+static PyGetSetDef array_getsets [] = {
+    {"typecode", (getter) array_get_typecode, NULL,
+     "the typecode character used to create the array"},
+    {"itemsize", (getter) array_get_itemsize, NULL,
+     "the size, in bytes, of one array item"},
+    {NULL}
+};
+
+static PyMethodDef array_methods[] = {
+    {"append",          (PyCFunction)array_append,
+        METH_O,          append_doc},
+    {"dot",             (PyCFunction)array_dot,
+        METH_O,          dot_doc},
+    {"extend",          (PyCFunction)array_extend,
+        METH_O,          extend_doc},
+    {"frombytes",       (PyCFunction)array_frombytes,
+        METH_O,          frombytes_doc},
+    {"fromfile",        (PyCFunction)(void(*)(void))array_fromfile,
+        METH_FASTCALL,   fromfile_doc},
+    {"max",             (PyCFunction)array_max,
+        METH_NOARGS,     max_doc},
+    {"min",             (PyCFunction)array_min,
+        METH_NOARGS,     min_doc},
+    {"pop",             (PyCFunction)(void(*)(void))array_pop,
+        METH_FASTCALL,   pop_doc},
+    {"sum",             (PyCFunction)array_sum,
+        METH_NOARGS,     sum_doc},
+    {"tobytes",         (PyCFunction)array_tobytes,
+        METH_NOARGS,     tobytes_doc},
+    {"tofile",          (PyCFunction)array_tofile,
+        METH_O,          tofile_doc},
+    {"tolist",          (PyCFunction)array_tolist,
+        METH_NOARGS,     tolist_doc},
+    {NULL,              NULL}   /* sentinel */
+};
+
+static PyObject *
+array_repr(arrayobject *a)
+{
+    char typecode = a->ob_descr->typecode;
+    PyObject *list, *s;
+
+    if (Py_SIZE(a) == 0)
+        return PyString_FromFormat("%s('%c')",
+                                   _PyType_Name(Py_TYPE(a)), typecode);
+    list = array_tolist(a, NULL);
+    if (list == NULL)
+        return NULL;
+    s = PyString_FromFormat("%s('%c', %R)",
+                            _PyType_Name(Py_TYPE(a)), typecode, list);
+    Py_DECREF(list);
+    return s;
+}
+
+static PyObject *
+array_richcompare(PyObject *v, PyObject *w, int op)
+{
+    arrayobject *va, *wa;
+    PyObject *vi = NULL, *wi = NULL;
+    Py_ssize_t i, k;
+    PyObject *res;
+
+    if (!array_Check(v) || !array_Check(w))
+        Py_RETURN_NOTIMPLEMENTED;
+
+    va = (arrayobject *)v;
+    wa = (arrayobject *)w;
+
+    if (Py_SIZE(va) != Py_SIZE(wa) && (op == Py_EQ || op == Py_NE)) {
+        /* Shortcut: if the lengths differ, the arrays differ */
+        return PyBool_FromLong(op == Py_NE);
+    }
+    if (va->ob_descr == wa->ob_descr && !va->ob_descr->is_float &&
+        (op == Py_EQ || op == Py_NE)) {
+        /* Equal integers have equal bytes */
+        int eq = Py_SIZE(va) == 0 ||
+                 memcmp(va->ob_item, wa->ob_item,
+                        Py_SIZE(va) * va->ob_descr->itemsize) == 0;
+        return PyBool_FromLong(eq == (op == Py_EQ));
+    }
+
+    /* Search for the first index where items are different */
+    k = 1;
+    for (i = 0; i < Py_SIZE(va) && i < Py_SIZE(wa); i++) {
+        vi = getarrayitem(va, i);
+        wi = getarrayitem(wa, i);
+        if (vi == NULL || wi == NULL) {
+            Py_XDECREF(vi);
+            Py_XDECREF(wi);
+            return NULL;
+        }
+        k = PyObject_RichCompareBool(vi, wi, Py_EQ);
+        if (k == 0)
+            break; /* Keeping vi and wi alive! */
+        Py_DECREF(vi);
+        Py_DECREF(wi);
+        if (k < 0)
+            return NULL;
+    }
+
+    if (k) {
+        /* No more items to compare -- compare sizes */
+        Py_ssize_t vs = Py_SIZE(va);
+        Py_ssize_t ws = Py_SIZE(wa);
+        int cmp;
+        switch (op) {
+        case Py_LT: cmp = vs <  ws; break;
+        case Py_LE: cmp = vs <= ws; break;
+        case Py_EQ: cmp = vs == ws; break;
+        case Py_NE: cmp = vs != ws; break;
+        case Py_GT: cmp = vs >  ws; break;
+        case Py_GE: cmp = vs >= ws; break;
+        default: return NULL; /* cannot happen */
+        }
+        return PyBool_FromLong(cmp);
+    }
+
+    /* We have an item that differs.  First, shortcuts for EQ/NE */
+    if (op == Py_EQ) {
+        Py_INCREF(Py_False);
+        res = Py_False;
+    }
+    else if (op == Py_NE) {
+        Py_INCREF(Py_True);
+        res = Py_True;
+    }
+    else {
+        /* Compare the final item again using the proper operator */
+        res = PyObject_RichCompare(vi, wi, op);
+    }
+    Py_DECREF(vi);
+    Py_DECREF(wi);
+    return res;
+}
+
+
+PyDoc_STRVAR(array_doc,
+"array(typecode [, initializer]) --> array\n\
+\n\
+Return a new array whose items are restricted by typecode, and\n\
+initialized from the optional initializer value, which must be a list,\n\
+a string of raw machine values, an array or an iterable.\n\
+\n\
+Arrays represent basic values and behave very much like lists, except\n\
+the type of objects stored in them is constrained.  The typecode is a\n\
+single character:\n\
+\n\
+    Type code   C Type             Minimum size in bytes\n\
+    'b'         signed integer     1\n\
+    'B'         unsigned integer   1\n\
+    'h'         signed integer     2\n\
+    'H'         unsigned integer   2\n\
+    'i'         signed integer     2\n\
+    'I'         unsigned integer   2\n\
+    'l'         signed integer     4\n\
+    'L'         unsigned integer   4\n\
+    'q'         signed integer     8\n\
+    'Q'         unsigned integer   8\n\
+    'f'         floating point     4\n\
+    'd'         floating point     8");
+
+static PyTypeObject array_type = {
+    PyVarObject_HEAD_INIT(&PyType_Type, 0)
+    "array.array",                      /* tp_name */
+    sizeof(arrayobject),                /* tp_basicsize */
+    0,                                  /* tp_itemsize */
+    (destructor)array_dealloc,          /* tp_dealloc */
+    0,                                  /* tp_vectorcall_offset */
+    0,                                  /* tp_getattr */
+    0,                                  /* tp_setattr */
+    0,                                  /* tp_as_async */
+    (reprfunc)array_repr,               /* tp_repr */
+    0,                                  /* tp_as_number */
+    &array_as_sequence,                 /* tp_as_sequence */
+    &array_as_mapping,                  /* tp_as_mapping */
+    PyObject_HashNotImplemented,        /* tp_hash */
+    0,                                  /* tp_call */
+    0,                                  /* tp_str */
+    PyObject_GenericGetAttr,            /* tp_getattro */
+    0,                                  /* tp_setattro */
+    0,                                  /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,
+                                        /* tp_flags */
+    array_doc,                          /* tp_doc */
+    0,                                  /* tp_traverse */
+    0,                                  /* tp_clear */
+    array_richcompare,                  /* tp_richcompare */
+    0,                                  /* tp_weaklistoffset */
+    0,                                  /* tp_iter */
+    0,                                  /* tp_iternext */
+    array_methods,                      /* tp_methods */
+    0,                                  /* tp_members */
+    array_getsets,                      /* tp_getset */
+    0,                                  /* tp_base */
+    0,                                  /* tp_dict */
+    0,                                  /* tp_descr_get */
+    0,                                  /* tp_descr_set */
+    0,                                  /* tp_dictoffset */
+    0,                                  /* tp_init */
+    PyType_GenericAlloc,                /* tp_alloc */
+    array_new,                          /* tp_new */
+    PyMem_Free,                         /* tp_free */
+};
+
+
+PyDoc_STRVAR(module_doc,
+"This module defines an object type which can efficiently represent\n\
+an array of basic values: integers of 8 to 64 bits and floating point\n\
+numbers.  Arrays are sequence types and behave very much like lists,\n\
+except that the type of objects stored in them is constrained.");
+
+
+static int
+array_exec(PyObject *module)
+{
+    PyObject *typecodes;
+
+    if (PyModule_AddType(module, &array_type) < 0) {
+        return -1;
+    }
+    typecodes = PyString_FromString(TYPECODES);
+    if (PyModule_AddObject(module, "typecodes", typecodes) < 0) {
+        Py_XDECREF(typecodes);
+        return -1;
+    }
+    return 0;
+}
+
+
+static PyModuleDef_Slot array_slots[] = {
+    {Py_mod_exec, array_exec},
+    {0, NULL}
+};
+
+
+static struct PyModuleDef arraymodule = {
+    PyModuleDef_HEAD_INIT,
+    .m_name = "array",
+    .m_doc = module_doc,
+    .m_size = 0,
+    .m_slots = array_slots,
+};
+
+
+PyMODINIT_FUNC
+PyInit_array(void)
+{
+    return PyModuleDef_Init(&arraymodule);
+}
@@ -1191,6 +1191,278 @@ calculate_path(PyCalculatePath *calculate, _PyPathConfig *pathconfig)
 }
 
 
+/* --- Path configuration cache --------------------------------------------
+
+   With -X pathconfig_cache, the outputs of calculate_path() are written to
+   "<executable>.pathconfig" and read back by later runs, which then skip
+   the symbolic link resolution and the landmark searches: a hit costs one
+   stat() of the executable and the read of the cache file.
+
+   The file is a few text lines: a header which must match exactly (the
+   executable, its identity and mtime, and the other inputs of
+   calculate_path()), followed by whether the landmarks were found and by
+   the prefix, exec_prefix and module search path.  Rebuilding or replacing
+   the executable, or changing PYTHONHOME, PYTHONPATH or the platlibdir,
+   invalidates it.  Failing to read or write the cache is not an error: the
+   path is computed as usual. */
+
+#define PATHCONFIG_CACHE_SUFFIX ".pathconfig"
+#define PATHCONFIG_CACHE_MAX_SIZE (64 * 1024)
+
+static char *
+pathconfig_cache_filename(_PyPathConfig *pathconfig)
+{
+    size_t len = strlen(pathconfig->program_full_path);
+    char *filename = PyMem_Malloc(len + sizeof(PATHCONFIG_CACHE_SUFFIX));
+    if (filename == NULL) {
+        return NULL;
+    }
+    memcpy(filename, pathconfig->program_full_path, len);
+    memcpy(filename + len, PATHCONFIG_CACHE_SUFFIX,
+           sizeof(PATHCONFIG_CACHE_SUFFIX));
+    return filename;
+}
+
+
+/* Format the header lines of the cache file. Return NULL on memory error. */
+static char *
+pathconfig_cache_header(PyCalculatePath *calculate,
+                        _PyPathConfig *pathconfig, const struct stat *st)
+{
+#ifdef HAVE_STAT_TV_NSEC
+    long mtime_nsec = (long)st->st_mtim.tv_nsec;
+#else
+    long mtime_nsec = 0;
+#endif
+    const char *home = pathconfig->home;
+    const char *pythonpath = calculate->pythonpath_env;
+    const char *platlibdir = calculate->platlibdir;
+    const char *fmt = "python-pathconfig " VERSION "\n"
+                      "executable=%s\n"
+                      "stat=%llu %llu %lld %lld.%09ld\n"
+                      "home%s%s\n"
+                      "pythonpath%s%s\n"
+                      "platlibdir%s%s\n";
+    /* A missing variable ("home") differs from an empty one ("home=") */
+#define FMT_OPT(VALUE) ((VALUE) != NULL ? "=" : ""), ((VALUE) != NULL ? (VALUE) : "")
+
+    int len = snprintf(NULL, 0, fmt, pathconfig->program_full_path,
+                       (unsigned long long)st->st_dev,
+                       (unsigned long long)st->st_ino,
+                       (long long)st->st_size, (long long)st->st_mtime,
+                       mtime_nsec,
+                       FMT_OPT(home), FMT_OPT(pythonpath),
+                       FMT_OPT(platlibdir));
+    if (len < 0) {
+        return NULL;
+    }
+    char *header = PyMem_Malloc((size_t)len + 1);
+    if (header == NULL) {
+        return NULL;
+    }
+    snprintf(header, (size_t)len + 1, fmt, pathconfig->program_full_path,
+             (unsigned long long)st->st_dev,
+             (unsigned long long)st->st_ino,
+             (long long)st->st_size, (long long)st->st_mtime,
+             mtime_nsec,
+             FMT_OPT(home), FMT_OPT(pythonpath), FMT_OPT(platlibdir));
+#undef FMT_OPT
+    return header;
+}
+
+
+/* Read the "name=value\n" line at *p and advance *p to the next line.
+   Return a copy of value, or NULL if the line does not match. */
+static char *
+pathconfig_cache_value(char **p, const char *name)
+{
+    size_t name_len = strlen(name);
+    if (strncmp(*p, name, name_len) != 0 || (*p)[name_len] != '=') {
+        return NULL;
+    }
+    char *value = *p + name_len + 1;
+    char *end = strchr(value, '\n');
+    if (end == NULL) {
+        return NULL;
+    }
+    *p = end + 1;
+    return substring(value, end - value);
+}
+
+
+/* Fill the prefix, exec_prefix and module_search_path of pathconfig from
+   the cache file, if it matches header.  Return 1 on a cache hit, 0 on a
+   miss. */
+static int
+pathconfig_cache_read(PyCalculatePath *calculate, _PyPathConfig *pathconfig,
+                      const char *filename, const char *header)
+{
+    FILE *fp = fopen(filename, "rb");
+    if (fp == NULL) {
+        return 0;
+    }
+    char *data = PyMem_Malloc(PATHCONFIG_CACHE_MAX_SIZE + 1);
+    if (data == NULL) {
+        fclose(fp);
+        return 0;
+    }
+    size_t size = fread(data, 1, PATHCONFIG_CACHE_MAX_SIZE, fp);
+    int complete = feof(fp) && !ferror(fp);
+    fclose(fp);
+    data[size] = '\0';
+
+    size_t header_len = strlen(header);
+    char *prefix = NULL, *exec_prefix = NULL, *module_search_path = NULL;
+    if (!complete || size <= header_len
+        || memcmp(data, header, header_len) != 0)
+    {
+        goto miss;
+    }
+
+    char *p = data + header_len;
+    int prefix_found, exec_prefix_found, consumed = 0;
+    if (sscanf(p, "found=%d %d\n%n", &prefix_found, &exec_prefix_found,
+               &consumed) != 2 || consumed == 0)
+    {
+        goto miss;
+    }
+    p += consumed;
+    prefix = pathconfig_cache_value(&p, "prefix");
+    if (prefix == NULL) {
+        goto miss;
+    }
+    exec_prefix = pathconfig_cache_value(&p, "exec_prefix");
+    if (exec_prefix == NULL) {
+        goto miss;
+    }
+    module_search_path = pathconfig_cache_value(&p, "module_search_path");
+    if (module_search_path == NULL || *p != '\0') {
+        goto miss;
+    }
+    PyMem_Free(data);
+
+    calculate->prefix_found = prefix_found;
+    calculate->exec_prefix_found = exec_prefix_found;
+    pathconfig->prefix = prefix;
+    pathconfig->exec_prefix = exec_prefix;
+    pathconfig->module_search_path = module_search_path;
+    return 1;
+
+miss:
+    PyMem_Free(prefix);
+    PyMem_Free(exec_prefix);
+    PyMem_Free(module_search_path);
+    PyMem_Free(data);
+    return 0;
+}
+
+
+/* Write the cache file: write a temporary file and rename it, so that a
+   concurrent run never reads a partial cache. */
+static void
+pathconfig_cache_write(PyCalculatePath *calculate, _PyPathConfig *pathconfig,
+                       const char *filename, const char *header)
+{
+    const char *values[] = {pathconfig->prefix, pathconfig->exec_prefix,
+                            pathconfig->module_search_path};
+    for (size_t i = 0; i < Py_ARRAY_LENGTH(values); i++) {
+        if (strchr(values[i], '\n') != NULL) {
+            return;
+        }
+    }
+
+    size_t len = strlen(filename) + 32;
+    char *tmpname = PyMem_Malloc(len);
+    if (tmpname == NULL) {
+        return;
+    }
+    snprintf(tmpname, len, "%s.%ld.tmp", filename, (long)getpid());
+
+    FILE *fp = fopen(tmpname, "wb");
+    if (fp == NULL) {
+        PyMem_Free(tmpname);
+        return;
+    }
+    fprintf(fp, "%sfound=%d %d\n"
+            "prefix=%s\nexec_prefix=%s\nmodule_search_path=%s\n",
+            header, calculate->prefix_found, calculate->exec_prefix_found,
+            pathconfig->prefix, pathconfig->exec_prefix,
+            pathconfig->module_search_path);
+    int failed = ferror(fp);
+    if (fclose(fp) != 0) {
+        failed = 1;
+    }
+    if (failed || rename(tmpname, filename) < 0) {
+        (void)unlink(tmpname);
+    }
+    PyMem_Free(tmpname);
+}
+
+
+static PyStatus
+calculate_path_cached(PyCalculatePath *calculate, _PyPathConfig *pathconfig)
+{
+    PyStatus status;
+
+    if (pathconfig->program_full_path == NULL) {
+        status = calculate_program(calculate, pathconfig);
+        if (_PyStatus_EXCEPTION(status)) {
+            return status;
+        }
+    }
+
+    struct stat st;
+    if (pathconfig->prefix != NULL
+        || pathconfig->exec_prefix != NULL
+        || pathconfig->module_search_path != NULL
+        || pathconfig->program_full_path[0] == '\0'
+        || _Py_cstat(pathconfig->program_full_path, &st) != 0
+        || strchr(pathconfig->program_full_path, '\n') != NULL)
+    {
+        /* Nothing to cache, or no executable to validate the cache with */
+        return calculate_path(calculate, pathconfig);
+    }
+
+    char *filename = pathconfig_cache_filename(pathconfig);
+    char *header = pathconfig_cache_header(calculate, pathconfig, &st);
+    if (filename == NULL || header == NULL) {
+        status = _PyStatus_NO_MEMORY();
+        goto done;
+    }
+
+    if (pathconfig_cache_read(calculate, pathconfig, filename, header)) {
+        /* Same warnings as calculate_path() */
+        if (calculate->warnings) {
+            if (!calculate->prefix_found) {
+                fprintf(stderr,
+                    "Could not find platform independent libraries <prefix>\n");
+            }
+            if (!calculate->exec_prefix_found) {
+                fprintf(stderr,
+                    "Could not find platform dependent libraries <exec_prefix>\n");
+            }
+            if (!calculate->prefix_found || !calculate->exec_prefix_found) {
+                fprintf(stderr,
+                    "Consider setting $PYTHONHOME to <prefix>[:<exec_prefix>]\n");
+            }
+        }
+        status = _PyStatus_OK();
+        goto done;
+    }
+
+    status = calculate_path(calculate, pathconfig);
+    if (_PyStatus_EXCEPTION(status)) {
+        goto done;
+    }
+    pathconfig_cache_write(calculate, pathconfig, filename, header);
+
+done:
+    PyMem_Free(filename);
+    PyMem_Free(header);
+    return status;
+}
+
+
 /* Calculate the Python path configuration.
 
    Inputs:
@@ -1204,6 +1476,7 @@ calculate_path(PyCalculatePath *calculate, _PyPathConfig *pathconfig)
    - PyConfig fields ('config' function argument):
 
      - pathconfig_warnings
+     - pathconfig_cache: see calculate_path_cached()
      - pythonpath_env (PYTHONPATH environment variable)
 
    - _PyPathConfig fields ('pathconfig' function argument):
@@ -1233,7 +1506,12 @@ _PyPathConfig_Calculate(_PyPathConfig *pathconfig, const PyConfig *config)
         goto done;
     }
 
-    status = calculate_path(&calculate, pathconfig);
+    if (config->pathconfig_cache) {
+        status = calculate_path_cached(&calculate, pathconfig);
+    }
+    else {
+        status = calculate_path(&calculate, pathconfig);
+    }
     if (_PyStatus_EXCEPTION(status)) {
         goto done;
     }
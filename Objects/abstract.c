@@ -86,12 +86,13 @@ _PyObject_HasLen(PyObject *o) {
    this function returns -1.
 */
 
-Py_ssize_t
-PyObject_LengthHint(PyObject *o, Py_ssize_t defaultvalue)
+static Py_ssize_t
+length_hint(PyObject *o, Py_ssize_t defaultvalue, int *exact)
 {
     PyObject *hint, *result;
     Py_ssize_t res;
     _Py_IDENTIFIER(__length_hint__);
+    *exact = 0;
     if (_PyObject_HasLen(o)) {
         res = PyObject_Length(o);
         if (res < 0) {
@@ -102,17 +103,35 @@ PyObject_LengthHint(PyObject *o, Py_ssize_t defaultvalue)
             PyErr_Clear();
         }
         else {
+            *exact = 1;
             return res;
         }
     }
-    hint = _PyObject_LookupSpecial(o, &PyId___length_hint__);
+    hint = _PyType_LookupId(Py_TYPE(o), &PyId___length_hint__);
     if (hint == NULL) {
         if (PyErr_Occurred()) {
             return -1;
         }
         return defaultvalue;
     }
-    result = _PyObject_CallNoArg(hint);
+    /* The iterators of the builtin types report what really remains */
+    *exact = !PyType_HasFeature(Py_TYPE(o), Py_TPFLAGS_HEAPTYPE);
+    Py_INCREF(hint);
+    if (PyType_HasFeature(Py_TYPE(hint), Py_TPFLAGS_METHOD_DESCRIPTOR)) {
+        /* Avoid a temporary bound method: comprehensions ask every
+           iterator for its hint, however short it is */
+        result = _PyObject_CallOneArg(hint, o);
+    }
+    else {
+        descrgetfunc f = Py_TYPE(hint)->tp_descr_get;
+        if (f != NULL) {
+            Py_SETREF(hint, f(hint, o, (PyObject *)Py_TYPE(o)));
+            if (hint == NULL) {
+                return -1;
+            }
+        }
+        result = _PyObject_CallNoArg(hint);
+    }
     Py_DECREF(hint);
     if (result == NULL) {
         if (PyErr_ExceptionMatches(PyExc_TypeError)) {
@@ -143,6 +162,31 @@ PyObject_LengthHint(PyObject *o, Py_ssize_t defaultvalue)
     return res;
 }
 
+Py_ssize_t
+PyObject_LengthHint(PyObject *o, Py_ssize_t defaultvalue)
+{
+    int exact;
+    return length_hint(o, defaultvalue, &exact);
+}
+
+Py_ssize_t
+_PyObject_PresizeHint(PyObject *o, int *exact)
+{
+    Py_ssize_t n = length_hint(o, 0, exact);
+    if (n < 0) {
+        /* A broken hint is no hint, but don't hide a lack of memory or
+           an interrupt */
+        if (PyErr_ExceptionMatches(PyExc_MemoryError) ||
+                !PyErr_ExceptionMatches(PyExc_Exception)) {
+            return -1;
+        }
+        PyErr_Clear();
+        *exact = 0;
+        return 0;
+    }
+    return n;
+}
+
 PyObject *
 PyObject_GetItem(PyObject *o, PyObject *key)
 {
@@ -260,6 +304,73 @@ PyObject_DelItemString(PyObject *o, const char *key)
     return ret;
 }
 
+/* Buffer C-API */
+
+int
+PyObject_CheckBuffer(PyObject *obj)
+{
+    PyBufferProcs *tp_as_buffer = Py_TYPE(obj)->tp_as_buffer;
+    return (tp_as_buffer != NULL && tp_as_buffer->bf_getbuffer != NULL);
+}
+
+int
+PyObject_GetBuffer(PyObject *obj, Py_buffer *view, int flags)
+{
+    PyBufferProcs *pb = Py_TYPE(obj)->tp_as_buffer;
+
+    if (pb == NULL || pb->bf_getbuffer == NULL) {
+        PyErr_Format(PyExc_TypeError,
+                     "a bytes-like object is required, not '%.100s'",
+                     Py_TYPE(obj)->tp_name);
+        return -1;
+    }
+    return (*pb->bf_getbuffer)(obj, view, flags);
+}
+
+int
+PyBuffer_FillInfo(Py_buffer *view, PyObject *obj, void *buf, Py_ssize_t len,
+                  int readonly, int flags)
+{
+    if (view == NULL) {
+        PyErr_SetString(PyExc_BufferError,
+                        "PyBuffer_FillInfo: view==NULL argument is obsolete");
+        return -1;
+    }
+    if ((flags & PyBUF_WRITABLE) == PyBUF_WRITABLE && readonly == 1) {
+        PyErr_SetString(PyExc_BufferError,
+                        "Object is not writable.");
+        return -1;
+    }
+
+    view->obj = obj;
+    if (obj)
+        Py_INCREF(obj);
+    view->buf = buf;
+    view->len = len;
+    view->readonly = readonly;
+    return 0;
+}
+
+void
+PyBuffer_Release(Py_buffer *view)
+{
+    PyObject *obj = view->obj;
+    PyBufferProcs *pb;
+    if (!obj)
+        return;
+    pb = Py_TYPE(obj)->tp_as_buffer;
+    if (pb && pb->bf_releasebuffer)
+        pb->bf_releasebuffer(obj, view);
+    view->obj = NULL;
+    Py_DECREF(obj);
+}
+
+int
+PyBuffer_IsContiguous(const Py_buffer *view, char fort)
+{
+    return 1;
+}
+
 PyObject *
 PyObject_Format(PyObject *obj, PyObject *format_spec)
 {
@@ -0,0 +1,1120 @@
+/* PyByteArray (bytearray) implementation
+
+   The bytes live in ob_bytes[ob_start - ob_bytes : ob_start - ob_bytes +
+   ob_size], followed by a NUL byte.  Deleting bytes from the front only
+   advances ob_start, so that a parser consuming records from the head of
+   a bytearray does not move the rest each time.
+
+   While a buffer is exported (ob_exports > 0), e.g. to a memoryview or to
+   FileIO.readinto(), the bytes must stay where they are: any resize raises
+   BufferError. */
+
+#include "Python.h"
+
+typedef struct {
+    PyObject_VAR_HEAD           /* ob_size is the number of bytes */
+    Py_ssize_t ob_alloc;        /* How many bytes allocated in ob_bytes */
+    char *ob_bytes;             /* Physical backing buffer */
+    char *ob_start;             /* Logical start inside ob_bytes */
+    Py_ssize_t ob_exports;      /* How many buffer exports */
+} PyByteArrayObject;
+
+/* The bytes of a bytearray, "" if it never allocated any */
+static char empty_string[] = "";
+#define AS_STRING(self) \
+    (((PyByteArrayObject *)(self))->ob_alloc ? \
+     ((PyByteArrayObject *)(self))->ob_start : empty_string)
+
+int PyByteArray_Check(PyObject *op) {
+  return PyObject_TypeCheck(op, &PyByteArray_Type);
+}
+
+int PyByteArray_CheckExact(PyObject *op) {
+  return Py_IS_TYPE(op, &PyByteArray_Type);
+}
+
+/* Convert an item to a byte value, in range(0, 256) */
+static int
+_getbytevalue(PyObject *arg, int *value)
+{
+    Py_ssize_t face_value;
+
+    if (!PyIndex_Check(arg)) {
+        PyErr_Format(PyExc_TypeError,
+                     "'%.200s' object cannot be interpreted as an integer",
+                     Py_TYPE(arg)->tp_name);
+        return 0;
+    }
+    face_value = PyNumber_AsSsize_t(arg, NULL);
+    if (face_value == -1 && PyErr_Occurred()) {
+        return 0;
+    }
+    if (face_value < 0 || face_value >= 256) {
+        PyErr_SetString(PyExc_ValueError, "byte must be in range(0, 256)");
+        return 0;
+    }
+    *value = (int)face_value;
+    return 1;
+}
+
+static int
+bytearray_getbuffer(PyByteArrayObject *obj, Py_buffer *view, int flags)
+{
+    if (view == NULL) {
+        PyErr_SetString(PyExc_BufferError,
+            "bytearray_getbuffer: view==NULL argument is obsolete");
+        return -1;
+    }
+    /* cannot fail if view != NULL and readonly == 0 */
+    (void)PyBuffer_FillInfo(view, (PyObject*)obj, AS_STRING(obj),
+                            Py_SIZE(obj), 0, flags);
+    obj->ob_exports++;
+    return 0;
+}
+
+static void
+bytearray_releasebuffer(PyByteArrayObject *obj, Py_buffer *view)
+{
+    obj->ob_exports--;
+}
+
+static int
+_canresize(PyByteArrayObject *self)
+{
+    if (self->ob_exports > 0) {
+        PyErr_SetString(PyExc_BufferError,
+                "Existing exports of data: object cannot be re-sized");
+        return 0;
+    }
+    return 1;
+}
+
+/* Direct API functions */
+
+PyObject *
+PyByteArray_FromObject(PyObject *input)
+{
+    return PyObject_CallOneArg((PyObject *)&PyByteArray_Type, input);
+}
+
+PyObject *
+PyByteArray_FromStringAndSize(const char *bytes, Py_ssize_t size)
+{
+    PyByteArrayObject *new;
+    Py_ssize_t alloc;
+
+    if (size < 0) {
+        PyErr_SetString(PyExc_SystemError,
+            "Negative size passed to PyByteArray_FromStringAndSize");
+        return NULL;
+    }
+
+    /* Prevent buffer overflow when setting alloc to size+1. */
+    if (size == PY_SSIZE_T_MAX) {
+        return PyErr_NoMemory();
+    }
+
+    new = (PyByteArrayObject *)PyType_GenericAlloc(&PyByteArray_Type, 0);
+    if (new == NULL)
+        return NULL;
+
+    alloc = size + 1;
+    new->ob_bytes = PyMem_Malloc(alloc);
+    if (new->ob_bytes == NULL) {
+        Py_DECREF(new);
+        return PyErr_NoMemory();
+    }
+    if (bytes != NULL && size > 0)
+        memcpy(new->ob_bytes, bytes, size);
+    new->ob_bytes[size] = '\0';  /* Trailing null byte */
+    Py_SET_SIZE(new, size);
+    new->ob_alloc = alloc;
+    new->ob_start = new->ob_bytes;
+    new->ob_exports = 0;
+
+    return (PyObject *)new;
+}
+
+Py_ssize_t
+PyByteArray_Size(PyObject *self)
+{
+    assert(self != NULL);
+    assert(PyByteArray_Check(self));
+
+    return Py_SIZE(self);
+}
+
+char  *
+PyByteArray_AsString(PyObject *self)
+{
+    assert(self != NULL);
+    assert(PyByteArray_Check(self));
+
+    return AS_STRING(self);
+}
+
+int
+PyByteArray_Resize(PyObject *self, Py_ssize_t requested_size)
+{
+    void *sval;
+    PyByteArrayObject *obj = ((PyByteArrayObject *)self);
+    /* All computations are done unsigned to avoid integer overflows */
+    size_t alloc = (size_t) obj->ob_alloc;
+    size_t logical_offset = (size_t) (obj->ob_start - obj->ob_bytes);
+    size_t size = (size_t) requested_size;
+
+    assert(self != NULL);
+    assert(PyByteArray_Check(self));
+    assert(logical_offset <= alloc);
+    assert(requested_size >= 0);
+
+    if (requested_size == Py_SIZE(self)) {
+        return 0;
+    }
+    if (!_canresize(obj)) {
+        return -1;
+    }
+
+    if (size + logical_offset + 1 <= alloc) {
+        /* Current buffer is large enough to host the requested size,
+           decide on a strategy. */
+        if (size < alloc / 2) {
+            /* Major downsize; resize down to exact size */
+            alloc = size + 1;
+        }
+        else {
+            /* Minor downsize; quick exit */
+            Py_SET_SIZE(self, size);
+            AS_STRING(self)[size] = '\0'; /* Trailing null */
+            return 0;
+        }
+    }
+    else {
+        /* Need growing, decide on a strategy */
+        if (size <= alloc * 1.125) {
+            /* Moderate upsize; overallocate similar to list_resize() */
+            alloc = size + (size >> 3) + (size < 9 ? 3 : 6);
+        }
+        else {
+            /* Major upsize; resize up to exact size */
+            alloc = size + 1;
+        }
+    }
+    if (alloc > PY_SSIZE_T_MAX) {
+        PyErr_NoMemory();
+        return -1;
+    }
+
+    if (logical_offset > 0) {
+        sval = PyMem_Malloc(alloc);
+        if (sval == NULL) {
+            PyErr_NoMemory();
+            return -1;
+        }
+        memcpy(sval, AS_STRING(self),
+               Py_MIN((size_t)requested_size, (size_t)Py_SIZE(self)));
+        PyMem_Free(obj->ob_bytes);
+    }
+    else {
+        sval = PyMem_Realloc(obj->ob_bytes, alloc);
+        if (sval == NULL) {
+            PyErr_NoMemory();
+            return -1;
+        }
+    }
+
+    obj->ob_bytes = obj->ob_start = sval;
+    Py_SET_SIZE(self, size);
+    obj->ob_alloc = alloc;
+    obj->ob_bytes[size] = '\0'; /* Trailing null byte */
+
+    return 0;
+}
+
+/* Functions stuffed into the type object */
+
+static Py_ssize_t
+bytearray_length(PyByteArrayObject *self)
+{
+    return Py_SIZE(self);
+}
+
+static PyObject *
+bytearray_concat(PyByteArrayObject *self, PyObject *other)
+{
+    Py_buffer vo;
+    PyObject *result;
+
+    if (PyObject_GetBuffer(other, &vo, PyBUF_SIMPLE) != 0) {
+        PyErr_Format(PyExc_TypeError, "can't concat %.100s to %.100s",
+                     Py_TYPE(other)->tp_name, Py_TYPE(self)->tp_name);
+        return NULL;
+    }
+    if (Py_SIZE(self) > PY_SSIZE_T_MAX - vo.len) {
+        PyBuffer_Release(&vo);
+        return PyErr_NoMemory();
+    }
+    result = PyByteArray_FromStringAndSize(NULL, Py_SIZE(self) + vo.len);
+    if (result != NULL) {
+        memcpy(AS_STRING(result), AS_STRING(self), Py_SIZE(self));
+        memcpy(AS_STRING(result) + Py_SIZE(self), vo.buf, vo.len);
+    }
+    PyBuffer_Release(&vo);
+    return result;
+}
+
+static PyObject *
+bytearray_repeat(PyByteArrayObject *self, Py_ssize_t count)
+{
+    PyObject *result;
+    Py_ssize_t mysize, size, i;
+
+    if (count < 0)
+        count = 0;
+    mysize = Py_SIZE(self);
+    if (count > 0 && mysize > PY_SSIZE_T_MAX / count)
+        return PyErr_NoMemory();
+    size = mysize * count;
+    result = PyByteArray_FromStringAndSize(NULL, size);
+    if (result != NULL && size != 0) {
+        char *buf = AS_STRING(result);
+        if (mysize == 1)
+            memset(buf, self->ob_start[0], size);
+        else {
+            for (i = 0; i < count; i++)
+                memcpy(buf + i * mysize, self->ob_start, mysize);
+        }
+    }
+    return result;
+}
+
+static PyObject *
+bytearray_getitem(PyByteArrayObject *self, Py_ssize_t i)
+{
+    if (i < 0 || i >= Py_SIZE(self)) {
+        PyErr_SetString(PyExc_IndexError, "bytearray index out of range");
+        return NULL;
+    }
+    return PyLong_FromLong((unsigned char)(self->ob_start[i]));
+}
+
+static PyObject *
+bytearray_subscript(PyByteArrayObject *self, PyObject *index)
+{
+    if (PyIndex_Check(index)) {
+        Py_ssize_t i = PyNumber_AsSsize_t(index, PyExc_IndexError);
+
+        if (i == -1 && PyErr_Occurred())
+            return NULL;
+
+        if (i < 0)
+            i += Py_SIZE(self);
+        return bytearray_getitem(self, i);
+    }
+    else if (PySlice_Check(index)) {
+        Py_ssize_t start, stop, step, slicelength, i;
+        if (PySlice_Unpack(index, &start, &stop, &step) < 0) {
+            return NULL;
+        }
+        slicelength = PySlice_AdjustIndices(Py_SIZE(self),
+                                            &start, &stop, step);
+
+        if (step == 1) {
+            return PyByteArray_FromStringAndSize(AS_STRING(self) + start,
+                                                 slicelength);
+        }
+        else {
+            const char *source = AS_STRING(self);
+            PyObject *result;
+            char *result_buf;
+
+            result = PyByteArray_FromStringAndSize(NULL, slicelength);
+            if (result == NULL)
+                return NULL;
+            result_buf = AS_STRING(result);
+            for (i = 0; i < slicelength; start += step, i++)
+                 result_buf[i] = source[start];
+            return result;
+        }
+    }
+    else {
+        PyErr_Format(PyExc_TypeError,
+                     "bytearray indices must be integers or slices, not %.200s",
+                     Py_TYPE(index)->tp_name);
+        return NULL;
+    }
+}
+
+/* Replace self[lo:hi] by bytes_len bytes, moving the tail as needed */
+static int
+bytearray_setslice_linear(PyByteArrayObject *self,
+                          Py_ssize_t lo, Py_ssize_t hi,
+                          char *bytes, Py_ssize_t bytes_len)
+{
+    Py_ssize_t avail = hi - lo;
+    char *buf = self->ob_start;
+    Py_ssize_t growth = bytes_len - avail;
+    int res = 0;
+    assert(avail >= 0);
+
+    if (growth < 0) {
+        if (!_canresize(self))
+            return -1;
+
+        if (lo == 0) {
+            /* Shrink the buffer by advancing its logical start */
+            self->ob_start -= growth;
+        }
+        else {
+            memmove(buf + lo + bytes_len, buf + hi,
+                    Py_SIZE(self) - hi);
+        }
+        if (PyByteArray_Resize((PyObject *)self,
+                               Py_SIZE(self) + growth) < 0) {
+            /* With lo == 0 the bytearray is restored; otherwise the
+               memmove() completed the operation, but the memory block
+               is not shrunk and MemoryError is still raised. */
+            if (lo == 0) {
+                self->ob_start += growth;
+                return -1;
+            }
+            Py_SET_SIZE(self, Py_SIZE(self) + growth);
+            res = -1;
+        }
+        buf = self->ob_start;
+    }
+    else if (growth > 0) {
+        if (Py_SIZE(self) > (Py_ssize_t)PY_SSIZE_T_MAX - growth) {
+            PyErr_NoMemory();
+            return -1;
+        }
+
+        if (PyByteArray_Resize((PyObject *)self,
+                               Py_SIZE(self) + growth) < 0) {
+            return -1;
+        }
+        buf = self->ob_start;
+        /* Make the place for the additional bytes */
+        memmove(buf + lo + bytes_len, buf + hi,
+                Py_SIZE(self) - lo - bytes_len);
+    }
+
+    if (bytes_len > 0)
+        memcpy(buf + lo, bytes, bytes_len);
+    return res;
+}
+
+static int
+bytearray_setslice(PyByteArrayObject *self, Py_ssize_t lo, Py_ssize_t hi,
+               PyObject *values)
+{
+    Py_ssize_t needed;
+    void *bytes;
+    Py_buffer vbytes;
+    int res = 0;
+
+    vbytes.len = -1;
+    if (values == (PyObject *)self) {
+        /* Make a copy and call this function recursively */
+        int err;
+        values = PyByteArray_FromStringAndSize(AS_STRING(values),
+                                               Py_SIZE(values));
+        if (values == NULL)
+            return -1;
+        err = bytearray_setslice(self, lo, hi, values);
+        Py_DECREF(values);
+        return err;
+    }
+    if (values == NULL) {
+        /* del b[lo:hi] */
+        bytes = NULL;
+        needed = 0;
+    }
+    else {
+        if (PyObject_GetBuffer(values, &vbytes, PyBUF_SIMPLE) != 0) {
+            PyErr_Format(PyExc_TypeError,
+                         "can't set bytearray slice from %.100s",
+                         Py_TYPE(values)->tp_name);
+            return -1;
+        }
+        needed = vbytes.len;
+        bytes = vbytes.buf;
+    }
+
+    if (lo < 0)
+        lo = 0;
+    if (hi < lo)
+        hi = lo;
+    if (hi > Py_SIZE(self))
+        hi = Py_SIZE(self);
+
+    res = bytearray_setslice_linear(self, lo, hi, bytes, needed);
+    if (vbytes.len != -1)
+        PyBuffer_Release(&vbytes);
+    return res;
+}
+
+static int
+bytearray_setitem(PyByteArrayObject *self, Py_ssize_t i, PyObject *value)
+{
+    int ival;
+
+    if (i < 0)
+        i += Py_SIZE(self);
+
+    if (i < 0 || i >= Py_SIZE(self)) {
+        PyErr_SetString(PyExc_IndexError, "bytearray index out of range");
+        return -1;
+    }
+
+    if (value == NULL)
+        return bytearray_setslice(self, i, i+1, NULL);
+
+    if (!_getbytevalue(value, &ival))
+        return -1;
+
+    self->ob_start[i] = ival;
+    return 0;
+}
+
+static int
+bytearray_ass_subscript(PyByteArrayObject *self, PyObject *index,
+                        PyObject *values)
+{
+    Py_ssize_t start, stop, step, slicelen, needed;
+    char *buf, *bytes;
+    buf = self->ob_start;
+
+    if (PyIndex_Check(index)) {
+        Py_ssize_t i = PyNumber_AsSsize_t(index, PyExc_IndexError);
+
+        if (i == -1 && PyErr_Occurred())
+            return -1;
+
+        if (i < 0)
+            i += Py_SIZE(self);
+
+        if (i < 0 || i >= Py_SIZE(self)) {
+            PyErr_SetString(PyExc_IndexError,
+                            "bytearray index out of range");
+            return -1;
+        }
+
+        if (values == NULL) {
+            /* Fall through to slice assignment */
+            start = i;
+            stop = i + 1;
+            step = 1;
+            slicelen = 1;
+        }
+        else {
+            int ival;
+            if (!_getbytevalue(values, &ival))
+                return -1;
+            buf[i] = (char)ival;
+            return 0;
+        }
+    }
+    else if (PySlice_Check(index)) {
+        if (PySlice_Unpack(index, &start, &stop, &step) < 0) {
+            return -1;
+        }
+        slicelen = PySlice_AdjustIndices(Py_SIZE(self), &start,
+                                         &stop, step);
+    }
+    else {
+        PyErr_Format(PyExc_TypeError,
+                     "bytearray indices must be integers or slices, not %.200s",
+                      Py_TYPE(index)->tp_name);
+        return -1;
+    }
+
+    if (values == NULL) {
+        bytes = NULL;
+        needed = 0;
+    }
+    else if (values == (PyObject *)self || !PyByteArray_Check(values)) {
+        int err;
+        if (PyIndex_Check(values)) {
+            PyErr_SetString(PyExc_TypeError,
+                            "can assign only bytes, buffers, or iterables "
+                            "of ints in range(0, 256)");
+            return -1;
+        }
+        /* Make a copy and call this function recursively */
+        values = PyByteArray_FromObject(values);
+        if (values == NULL)
+            return -1;
+        err = bytearray_ass_subscript(self, index, values);
+        Py_DECREF(values);
+        return err;
+    }
+    else {
+        assert(PyByteArray_Check(values));
+        bytes = AS_STRING(values);
+        needed = Py_SIZE(values);
+    }
+    /* Make sure b[5:2] = ... inserts before 5, not before 2. */
+    if ((step < 0 && start < stop) ||
+        (step > 0 && start > stop))
+        stop = start;
+    if (step == 1) {
+        return bytearray_setslice_linear(self, start, stop, bytes, needed);
+    }
+    else {
+        if (needed == 0) {
+            /* Delete slice */
+            size_t cur;
+            Py_ssize_t i;
+
+            if (!_canresize(self))
+                return -1;
+
+            if (slicelen == 0)
+                /* Nothing to do here. */
+                return 0;
+
+            if (step < 0) {
+                stop = start + 1;
+                start = stop + step * (slicelen - 1) - 1;
+                step = -step;
+            }
+            for (cur = start, i = 0;
+                 i < slicelen; cur += step, i++) {
+                Py_ssize_t lim = step - 1;
+
+                if (cur + step >= (size_t)Py_SIZE(self))
+                    lim = Py_SIZE(self) - cur - 1;
+
+                memmove(buf + cur - i,
+                        buf + cur + 1, lim);
+            }
+            /* Move the tail of the bytes, in one chunk */
+            cur = start + (size_t)slicelen*step;
+            if (cur < (size_t)Py_SIZE(self)) {
+                memmove(buf + cur - slicelen,
+                        buf + cur,
+                        Py_SIZE(self) - cur);
+            }
+            if (PyByteArray_Resize((PyObject *)self,
+                               Py_SIZE(self) - slicelen) < 0)
+                return -1;
+
+            return 0;
+        }
+        else {
+            /* Assign slice */
+            Py_ssize_t i;
+            size_t cur;
+
+            if (needed != slicelen) {
+                PyErr_Format(PyExc_ValueError,
+                             "attempt to assign bytes of size %zd "
+                             "to extended slice of size %zd",
+                             needed, slicelen);
+                return -1;
+            }
+            for (cur = start, i = 0; i < slicelen; cur += step, i++)
+                buf[cur] = bytes[i];
+            return 0;
+        }
+    }
+}
+
+static int
+bytearray_init(PyByteArrayObject *self, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"source", 0};
+    PyObject *arg = NULL;
+    PyObject *it;
+    PyObject *(*iternext)(PyObject *);
+
+    if (Py_SIZE(self) != 0) {
+        /* Empty previous contents (yes, do this first of all!) */
+        if (PyByteArray_Resize((PyObject *)self, 0) < 0)
+            return -1;
+    }
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|O:bytearray", kwlist,
+                                     &arg))
+        return -1;
+
+    if (arg == NULL)
+        return 0;
+
+    /* Is it an int? */
+    if (PyIndex_Check(arg)) {
+        Py_ssize_t count = PyNumber_AsSsize_t(arg, PyExc_OverflowError);
+        if (count == -1 && PyErr_Occurred()) {
+            return -1;
+        }
+        if (count < 0) {
+            PyErr_SetString(PyExc_ValueError, "negative count");
+            return -1;
+        }
+        if (count > 0) {
+            if (PyByteArray_Resize((PyObject *)self, count))
+                return -1;
+            memset(self->ob_bytes, 0, count);
+        }
+        return 0;
+    }
+
+    /* Use the buffer API */
+    if (PyObject_CheckBuffer(arg)) {
+        Py_ssize_t size;
+        Py_buffer view;
+        if (PyObject_GetBuffer(arg, &view, PyBUF_SIMPLE) < 0)
+            return -1;
+        size = view.len;
+        if (PyByteArray_Resize((PyObject *)self, size) < 0) goto fail;
+        if (size > 0)
+            memcpy(self->ob_start, view.buf, size);
+        PyBuffer_Release(&view);
+        return 0;
+    fail:
+        PyBuffer_Release(&view);
+        return -1;
+    }
+
+    /* Get the iterator */
+    it = PyObject_GetIter(arg);
+    if (it == NULL) {
+        if (PyErr_ExceptionMatches(PyExc_TypeError)) {
+            PyErr_Format(PyExc_TypeError,
+                         "cannot convert '%.200s' object to bytearray",
+                         Py_TYPE(arg)->tp_name);
+        }
+        return -1;
+    }
+    iternext = *Py_TYPE(it)->tp_iternext;
+
+    /* Run the iterator to exhaustion */
+    for (;;) {
+        PyObject *item;
+        int rc, value;
+
+        /* Get the next item */
+        item = iternext(it);
+        if (item == NULL) {
+            if (PyErr_Occurred()) {
+                if (!PyErr_ExceptionMatches(PyExc_StopIteration))
+                    goto error;
+                PyErr_Clear();
+            }
+            break;
+        }
+
+        /* Interpret it as an int (__index__) */
+        rc = _getbytevalue(item, &value);
+        Py_DECREF(item);
+        if (!rc)
+            goto error;
+
+        /* Append the byte */
+        if (Py_SIZE(self) + 1 < self->ob_alloc) {
+            Py_SET_SIZE(self, Py_SIZE(self) + 1);
+            self->ob_start[Py_SIZE(self)] = '\0';
+        }
+        else if (PyByteArray_Resize((PyObject *)self, Py_SIZE(self)+1) < 0)
+            goto error;
+        self->ob_start[Py_SIZE(self)-1] = value;
+    }
+
+    /* Clean up and return success */
+    Py_DECREF(it);
+    return 0;
+
+ error:
+    /* Error handling when it != NULL */
+    Py_DECREF(it);
+    return -1;
+}
+
+static PyObject *
+bytearray_repr(PyByteArrayObject *self)
+{
+    PyObject *s, *res;
+    const char *className = _PyType_Name(Py_TYPE(self));
+
+    s = PyString_FromStringAndSize(AS_STRING(self), Py_SIZE(self));
+    if (s == NULL)
+        return NULL;
+    res = PyString_FromFormat("%s(%R)", className, s);
+    Py_DECREF(s);
+    return res;
+}
+
+static PyObject *
+bytearray_richcompare(PyObject *self, PyObject *other, int op)
+{
+    Py_ssize_t self_size, other_size;
+    Py_buffer self_bytes, other_bytes;
+    int cmp;
+
+    if (!PyObject_CheckBuffer(self) || !PyObject_CheckBuffer(other)) {
+        Py_RETURN_NOTIMPLEMENTED;
+    }
+
+    /* Bytearrays can be compared to anything that supports the buffer API. */
+    if (PyObject_GetBuffer(self, &self_bytes, PyBUF_SIMPLE) != 0) {
+        PyErr_Clear();
+        Py_RETURN_NOTIMPLEMENTED;
+    }
+    self_size = self_bytes.len;
+
+    if (PyObject_GetBuffer(other, &other_bytes, PyBUF_SIMPLE) != 0) {
+        PyErr_Clear();
+        PyBuffer_Release(&self_bytes);
+        Py_RETURN_NOTIMPLEMENTED;
+    }
+    other_size = other_bytes.len;
+
+    if (self_size != other_size && (op == Py_EQ || op == Py_NE)) {
+        /* Shortcut: if the lengths differ, the objects differ */
+        PyBuffer_Release(&self_bytes);
+        PyBuffer_Release(&other_bytes);
+        return PyBool_FromLong((op == Py_NE));
+    }
+    else {
+        cmp = memcmp(self_bytes.buf, other_bytes.buf,
+                     Py_MIN(self_size, other_size));
+        /* In ISO C, memcmp() guarantees to use unsigned bytes! */
+
+        PyBuffer_Release(&self_bytes);
+        PyBuffer_Release(&other_bytes);
+
+        if (cmp != 0) {
+            Py_RETURN_RICHCOMPARE(cmp, 0, op);
+        }
+
+        Py_RETURN_RICHCOMPARE(self_size, other_size, op);
+    }
+
+}
+
+static void
+bytearray_dealloc(PyByteArrayObject *self)
+{
+    if (self->ob_exports > 0) {
+        PyErr_SetString(PyExc_SystemError,
+                        "deallocated bytearray object has exported buffers");
+        PyErr_Print();
+    }
+    if (self->ob_bytes != 0) {
+        PyMem_Free(self->ob_bytes);
+    }
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+
+/* Return the first index of the bytes of sub in self[start:end], or -1 */
+static Py_ssize_t
+bytearray_find_internal(PyByteArrayObject *self, const char *sub,
+                        Py_ssize_t sub_len, Py_ssize_t start, Py_ssize_t end)
+{
+    const char *s = AS_STRING(self);
+    Py_ssize_t i;
+
+    if (start < 0) {
+        start += Py_SIZE(self);
+        if (start < 0)
+            start = 0;
+    }
+    if (end > Py_SIZE(self))
+        end = Py_SIZE(self);
+    else if (end < 0) {
+        end += Py_SIZE(self);
+        if (end < 0)
+            end = 0;
+    }
+    if (end - start < sub_len)
+        return -1;
+    if (sub_len == 0)
+        return start;
+
+    for (i = start; i <= end - sub_len; i++) {
+        const char *p = memchr(s + i, sub[0], end - sub_len + 1 - i);
+        if (p == NULL)
+            return -1;
+        i = p - s;
+        if (memcmp(p, sub, sub_len) == 0)
+            return i;
+    }
+    return -1;
+}
+
+/* Find the byte value or the bytes-like object sub */
+static Py_ssize_t
+bytearray_find_object(PyByteArrayObject *self, PyObject *sub,
+                      Py_ssize_t start, Py_ssize_t end)
+{
+    Py_buffer subbuf;
+    Py_ssize_t res;
+
+    if (PyIndex_Check(sub)) {
+        int ival;
+        char byte;
+        if (!_getbytevalue(sub, &ival))
+            return -2;
+        byte = (char)ival;
+        return bytearray_find_internal(self, &byte, 1, start, end);
+    }
+    if (PyObject_GetBuffer(sub, &subbuf, PyBUF_SIMPLE) != 0)
+        return -2;
+    res = bytearray_find_internal(self, subbuf.buf, subbuf.len, start, end);
+    PyBuffer_Release(&subbuf);
+    return res;
+}
+
+static int
+bytearray_contains(PyObject *self, PyObject *arg)
+{
+    Py_ssize_t pos = bytearray_find_object((PyByteArrayObject *)self, arg,
+                                           0, PY_SSIZE_T_MAX);
+    if (pos == -2)
+        return -1;
+    return pos >= 0;
+}
+
+PyDoc_STRVAR(find__doc__,
+"B.find(sub[, start[, end]]) -> int\n\
+\n\
+Return the lowest index in B where subsection sub is found, such that sub\n\
+is contained within B[start:end].  sub is a byte value or a bytes-like\n\
+object.  Return -1 on failure.");
+
+static PyObject *
+bytearray_find(PyByteArrayObject *self, PyObject *const *args,
+               Py_ssize_t nargs)
+{
+    Py_ssize_t start = 0, end = PY_SSIZE_T_MAX, res;
+
+    if (!_PyArg_CheckPositional("find", nargs, 1, 3))
+        return NULL;
+    if (nargs > 1 && !_PyEval_SliceIndex(args[1], &start))
+        return NULL;
+    if (nargs > 2 && !_PyEval_SliceIndex(args[2], &end))
+        return NULL;
+    res = bytearray_find_object(self, args[0], start, end);
+    if (res == -2)
+        return NULL;
+    return PyLong_FromSsize_t(res);
+}
+
+PyDoc_STRVAR(clear__doc__,
+"B.clear() -> None\n\
+\n\
+Remove all items from the bytearray.");
+
+static PyObject *
+bytearray_clear(PyByteArrayObject *self, PyObject *Py_UNUSED(ignored))
+{
+    if (PyByteArray_Resize((PyObject *)self, 0) < 0)
+        return NULL;
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(copy__doc__,
+"B.copy() -> bytearray\n\
+\n\
+Return a copy of B.");
+
+static PyObject *
+bytearray_copy(PyByteArrayObject *self, PyObject *Py_UNUSED(ignored))
+{
+    return PyByteArray_FromStringAndSize(AS_STRING(self), Py_SIZE(self));
+}
+
+PyDoc_STRVAR(append__doc__,
+"B.append(item) -> None\n\
+\n\
+Append a single item, an int in range(0, 256), to the end of B.");
+
+static PyObject *
+bytearray_append(PyByteArrayObject *self, PyObject *arg)
+{
+    Py_ssize_t n = Py_SIZE(self);
+    int item;
+
+    if (!_getbytevalue(arg, &item))
+        return NULL;
+    if (n == PY_SSIZE_T_MAX) {
+        PyErr_SetString(PyExc_OverflowError,
+                        "cannot add more objects to bytearray");
+        return NULL;
+    }
+    if (PyByteArray_Resize((PyObject *)self, n + 1) < 0)
+        return NULL;
+
+    self->ob_start[n] = item;
+
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(extend__doc__,
+"B.extend(iterable_of_ints) -> None\n\
+\n\
+Append all the items from the iterator or sequence to the end of B.");
+
+static PyObject *
+bytearray_extend(PyByteArrayObject *self, PyObject *iterable_of_ints)
+{
+    PyObject *bytearray_obj;
+
+    /* bytearray_setslice code only accepts something supporting PEP 3118. */
+    if (PyObject_CheckBuffer(iterable_of_ints)) {
+        if (bytearray_setslice(self, Py_SIZE(self), Py_SIZE(self),
+                               iterable_of_ints) == -1)
+            return NULL;
+
+        Py_RETURN_NONE;
+    }
+
+    bytearray_obj = PyByteArray_FromObject(iterable_of_ints);
+    if (bytearray_obj == NULL)
+        return NULL;
+    if (bytearray_setslice(self, Py_SIZE(self), Py_SIZE(self),
+                           bytearray_obj) == -1) {
+        Py_DECREF(bytearray_obj);
+        return NULL;
+    }
+    Py_DECREF(bytearray_obj);
+
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(pop__doc__,
+"B.pop([index]) -> int\n\
+\n\
+Remove and return a single item from B.  If no index argument is given,\n\
+will pop the last item.");
+
+static PyObject *
+bytearray_pop(PyByteArrayObject *self, PyObject *const *args,
+              Py_ssize_t nargs)
+{
+    Py_ssize_t index = -1, n = Py_SIZE(self);
+    int value;
+    char *buf;
+
+    if (!_PyArg_CheckPositional("pop", nargs, 0, 1))
+        return NULL;
+    if (nargs == 1) {
+        index = PyNumber_AsSsize_t(args[0], PyExc_OverflowError);
+        if (index == -1 && PyErr_Occurred())
+            return NULL;
+    }
+
+    if (n == 0) {
+        /* special-case to avoid the error message */
+        PyErr_SetString(PyExc_IndexError,
+                        "pop from empty bytearray");
+        return NULL;
+    }
+    if (index < 0)
+        index += Py_SIZE(self);
+    if (index < 0 || index >= Py_SIZE(self)) {
+        PyErr_SetString(PyExc_IndexError, "pop index out of range");
+        return NULL;
+    }
+    if (!_canresize(self))
+        return NULL;
+
+    buf = self->ob_start;
+    value = (unsigned char)buf[index];
+    memmove(buf + index, buf + index + 1, n - index);
+    if (PyByteArray_Resize((PyObject *)self, n - 1) < 0)
+        return NULL;
+
+    return PyLong_FromLong(value);
+}
+
+static PySequenceMethods bytearray_as_sequence = {
+    (lenfunc)bytearray_length,              /* sq_length */
+    (binaryfunc)bytearray_concat,           /* sq_concat */
+    (ssizeargfunc)bytearray_repeat,         /* sq_repeat */
+    (ssizeargfunc)bytearray_getitem,        /* sq_item */
+    0,                                      /* was_sq_slice */
+    (ssizeobjargproc)bytearray_setitem,     /* sq_ass_item */
+    0,                                      /* was_sq_ass_slice */
+    (objobjproc)bytearray_contains,         /* sq_contains */
+};
+
+static PyMappingMethods bytearray_as_mapping = {
+    (lenfunc)bytearray_length,
+    (binaryfunc)bytearray_subscript,
+    (objobjargproc)bytearray_ass_subscript,
+};
+
+static PyBufferProcs bytearray_as_buffer = {
+    (getbufferproc)bytearray_getbuffer,
+    (releasebufferproc)bytearray_releasebuffer,
+};
+
+static PyMethodDef
+bytearray_methods[] = {
+    {"append", (PyCFunction)bytearray_append, METH_O, append__doc__},
+    {"clear", (PyCFunction)bytearray_clear, METH_NOARGS, clear__doc__},
+    {"copy", (PyCFunction)bytearray_copy, METH_NOARGS, copy__doc__},
+    {"extend", (PyCFunction)bytearray_extend, METH_O, extend__doc__},
+    {"find", (PyCFunction)(void(*)(void))bytearray_find, METH_FASTCALL,
+     find__doc__},
+    {"pop", (PyCFunction)(void(*)(void))bytearray_pop, METH_FASTCALL,
+     pop__doc__},
+    {NULL}
+};
+
+PyDoc_STRVAR(bytearray_doc,
+"bytearray(iterable_of_ints) -> bytearray\n\
+bytearray(string) -> bytearray\n\
+bytearray(bytes_or_buffer) -> mutable copy of bytes_or_buffer\n\
+bytearray(int) -> bytes array of size given by the parameter initialized with null bytes\n\
+bytearray() -> empty bytes array\n\
+\n\
+Construct a mutable bytearray object from:\n\
+  - an iterable yielding integers in range(256)\n\
+  - a str or any object implementing the buffer API.\n\
+  - an integer");
+
+PyTypeObject PyByteArray_Type = {
+    PyVarObject_HEAD_INIT(&PyType_Type, 0)
+    "bytearray",
+    sizeof(PyByteArrayObject),
+    0,
+    (destructor)bytearray_dealloc,       /* tp_dealloc */
+    0,                                  /* tp_vectorcall_offset */
+    0,                                  /* tp_getattr */
+    0,                                  /* tp_setattr */
+    0,                                  /* tp_as_async */
+    (reprfunc)bytearray_repr,           /* tp_repr */
+    0,                                  /* tp_as_number */
+    &bytearray_as_sequence,             /* tp_as_sequence */
+    &bytearray_as_mapping,              /* tp_as_mapping */
+    PyObject_HashNotImplemented,        /* tp_hash */
+    0,                                  /* tp_call */
+    0,                                  /* tp_str */
+    PyObject_GenericGetAttr,            /* tp_getattro */
+    0,                                  /* tp_setattro */
+    &bytearray_as_buffer,               /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE, /* tp_flags */
+    bytearray_doc,                      /* tp_doc */
+    0,                                  /* tp_traverse */
+    0,                                  /* tp_clear */
+    (richcmpfunc)bytearray_richcompare, /* tp_richcompare */
+    0,                                  /* tp_weaklistoffset */
+    0,                                  /* tp_iter */
+    0,                                  /* tp_iternext */
+    bytearray_methods,                  /* tp_methods */
+    0,                                  /* tp_members */
+    0,                                  /* tp_getset */
+    0,                                  /* tp_base */
+    0,                                  /* tp_dict */
+    0,                                  /* tp_descr_get */
+    0,                                  /* tp_descr_set */
+    0,                                  /* tp_dictoffset */
+    (initproc)bytearray_init,           /* tp_init */
+    PyType_GenericAlloc,                /* tp_alloc */
+    PyType_GenericNew,                  /* tp_new */
+    PyMem_Free,                         /* tp_free */
+};
@@ -30,14 +30,10 @@ struct _dictkeysobject {
        - lookdict(): general-purpose, and may return DKIX_ERROR if (and
          only if) a comparison raises an exception.
 
-       - lookdict_unicode(): specialized to Unicode string keys, comparison of
-         which can never raise an exception; that function can never return
-         DKIX_ERROR.
-
-       - lookdict_unicode_nodummy(): similar to lookdict_unicode() but further
-         specialized for Unicode string keys that cannot be the <dummy> value.
-
-       - lookdict_split(): Version of lookdict() for split tables. */
+       - lookdict_unicode(): specialized to tables whose keys are all exact
+         strings, comparison of which can never raise an exception; that
+         function can never return DKIX_ERROR.  New tables start with it and
+         switch to lookdict() when another kind of key is inserted. */
     dict_lookup_func dk_lookup;
 
     /* Number of usable entries in dk_entries. */
@@ -36,7 +36,8 @@ Size of indices is dk_size.  Type of each index in indices is vary on dk_size:
 
 * int8  for          dk_size <= 128
 * int16 for 256   <= dk_size <= 2**15
-* int32 for 2**16 <= dk_size <= 2**31
+* int24 for 2**16 <= dk_size <= 2**23  (3 bytes, in grouped tables)
+* int32 for 2**24 <= dk_size <= 2**31
 * int64 for 2**32 <= dk_size
 
 dk_entries is array of PyDictKeyEntry.  Its size is USABLE_FRACTION(dk_size).
@@ -45,6 +46,12 @@ DK_ENTRIES(dk) can be used to get pointer to entries.
 NOTE: Since negative value is used for DKIX_EMPTY and DKIX_DUMMY, type of
 dk_indices entry is signed integer and int16 is used for table which
 dk_size == 256.
+
+Tables with int24, int32 or int64 indices are probed by groups of slots (see
+"Grouped probing" below): the start of their dk_indices is aligned on a cache
+line, and it is an array of groups, each made of DK_GROUP_SIZE control bytes
+followed by the DK_GROUP_SIZE indices of the group's slots.
+dictkeys_get_index() and dictkeys_set_index() hide the difference.
 */
 
 
@@ -110,6 +117,13 @@ converting the dict to the combined table.
  */
 #define PyDict_MINSIZE 8
 
+/* PyDict_MAXPRESIZE is the largest table allocated up front from a guess
+ * of the number of items (_PyDict_NewPresized(), _PyDict_Reserve() for an
+ * inexact size).  A guess can be wrong, so beyond it the dict grows as
+ * items really arrive.
+ */
+#define PyDict_MAXPRESIZE (128 * 1024)
+
 #include "Python.h"
 #include "pycore_object.h"   // _PyObject_GC_TRACK()
 #include "pycore_pyerrors.h" // _PyErr_Fetch()
@@ -276,6 +290,8 @@ equally good collision statistics, needed less code & used less memory.
 /* forward declarations */
 static Py_ssize_t lookdict(PyDictObject *mp, PyObject *key,
                            Py_hash_t hash, PyObject **value_addr);
+static Py_ssize_t lookdict_unicode(PyDictObject *mp, PyObject *key,
+                                   Py_hash_t hash, PyObject **value_addr);
 
 static int dictresize(PyDictObject *mp, Py_ssize_t minused);
 
@@ -485,16 +501,40 @@ _PyDict_Fini(void)
 #define DK_IXSIZE(dk)                          \
     (DK_SIZE(dk) <= 0xff ?                     \
         1 : DK_SIZE(dk) <= 0xffff ?            \
-            2 : DK_SIZE(dk) <= 0xffffffff ?    \
-                4 : sizeof(int64_t))
+            2 : DK_SIZE(dk) <= 0xffffff ?      \
+                3 : DK_SIZE(dk) <= 0xffffffff ?    \
+                    4 : sizeof(int64_t))
 #else
 #define DK_IXSIZE(dk)                          \
     (DK_SIZE(dk) <= 0xff ?                     \
         1 : DK_SIZE(dk) <= 0xffff ?            \
-            2 : sizeof(int32_t))
+            2 : DK_SIZE(dk) <= 0xffffff ?      \
+                3 : sizeof(int32_t))
 #endif
+
+/* Tables of at least DK_GROUPED_MINSIZE slots, which are those with int24,
+   int32 or int64 indices, are grouped: a group is DK_GROUP_SIZE control bytes
+   followed by DK_GROUP_SIZE indices, so that with int24 indices it fills
+   exactly one cache line. */
+#define DK_GROUP_SIZE 16
+#define DK_GROUPED_MINSIZE 0x10000
+#define DK_GROUP_ALIGN 64
+#define DK_IS_GROUPED(dk) (DK_SIZE(dk) >= DK_GROUPED_MINSIZE)
+/* Bytes added to the indices of a table of the given size by the grouping:
+   the control bytes, and room to align the first group */
+#define DK_GROUPED_EXTRA(size) \
+    ((size) >= DK_GROUPED_MINSIZE ? (size) + DK_GROUP_ALIGN : 0)
+#define DK_GROUPS(dk) \
+    ((uint8_t *)_Py_ALIGN_UP((dk)->dk_indices, DK_GROUP_ALIGN))
+/* Group g of a grouped table with es-byte indices */
+#define DK_GROUP(dk, g, es) \
+    (DK_GROUPS(dk) + (size_t)(g) * DK_GROUP_SIZE * (1 + (es)))
+#define DK_GROUP_INDICES(group) ((group) + DK_GROUP_SIZE)
+
 #define DK_ENTRIES(dk) \
-    ((PyDictKeyEntry*)(&((int8_t*)((dk)->dk_indices))[DK_SIZE(dk) * DK_IXSIZE(dk)]))
+    ((PyDictKeyEntry*)(DK_IS_GROUPED(dk) ? \
+        DK_GROUPS(dk) + DK_SIZE(dk) * (1 + DK_IXSIZE(dk)) : \
+        (uint8_t*)((dk)->dk_indices) + DK_SIZE(dk) * DK_IXSIZE(dk)))
 
 #define DK_MASK(dk) (((dk)->dk_size)-1)
 #define IS_POWER_OF_2(x) (((x) & (x-1)) == 0)
@@ -531,15 +571,26 @@ dictkeys_get_index(const PyDictKeysObject *keys, Py_ssize_t i)
         const int16_t *indices = (const int16_t*)(keys->dk_indices);
         ix = indices[i];
     }
+    else if (s <= 0xffffff) {
+        const uint8_t *group = DK_GROUP(keys, i / DK_GROUP_SIZE, 3);
+        const uint8_t *p = DK_GROUP_INDICES(group) + 3 * (i % DK_GROUP_SIZE);
+        ix = p[0] | (p[1] << 8) | (p[2] << 16);
+        if (ix >= 0x800000) {
+            /* DKIX_EMPTY or DKIX_DUMMY */
+            ix -= 0x1000000;
+        }
+    }
 #if SIZEOF_VOID_P > 4
     else if (s > 0xffffffff) {
-        const int64_t *indices = (const int64_t*)(keys->dk_indices);
-        ix = indices[i];
+        const uint8_t *group = DK_GROUP(keys, i / DK_GROUP_SIZE, 8);
+        const int64_t *indices = (const int64_t*)DK_GROUP_INDICES(group);
+        ix = indices[i % DK_GROUP_SIZE];
     }
 #endif
     else {
-        const int32_t *indices = (const int32_t*)(keys->dk_indices);
-        ix = indices[i];
+        const uint8_t *group = DK_GROUP(keys, i / DK_GROUP_SIZE, 4);
+        const int32_t *indices = (const int32_t*)DK_GROUP_INDICES(group);
+        ix = indices[i % DK_GROUP_SIZE];
     }
     assert(ix >= DKIX_DUMMY);
     return ix;
@@ -563,16 +614,26 @@ dictkeys_set_index(PyDictKeysObject *keys, Py_ssize_t i, Py_ssize_t ix)
         assert(ix <= 0x7fff);
         indices[i] = (int16_t)ix;
     }
+    else if (s <= 0xffffff) {
+        uint8_t *group = DK_GROUP(keys, i / DK_GROUP_SIZE, 3);
+        uint8_t *p = DK_GROUP_INDICES(group) + 3 * (i % DK_GROUP_SIZE);
+        assert(ix <= 0x7fffff);
+        p[0] = (uint8_t)ix;
+        p[1] = (uint8_t)(ix >> 8);
+        p[2] = (uint8_t)(ix >> 16);
+    }
 #if SIZEOF_VOID_P > 4
     else if (s > 0xffffffff) {
-        int64_t *indices = (int64_t*)(keys->dk_indices);
-        indices[i] = ix;
+        uint8_t *group = DK_GROUP(keys, i / DK_GROUP_SIZE, 8);
+        int64_t *indices = (int64_t*)DK_GROUP_INDICES(group);
+        indices[i % DK_GROUP_SIZE] = ix;
     }
 #endif
     else {
-        int32_t *indices = (int32_t*)(keys->dk_indices);
+        uint8_t *group = DK_GROUP(keys, i / DK_GROUP_SIZE, 4);
+        int32_t *indices = (int32_t*)DK_GROUP_INDICES(group);
         assert(ix <= 0x7fffffff);
-        indices[i] = (int32_t)ix;
+        indices[i % DK_GROUP_SIZE] = (int32_t)ix;
     }
 }
 
@@ -614,13 +675,164 @@ dictkeys_set_index(PyDictKeysObject *keys, Py_ssize_t i, Py_ssize_t ix)
  */
 #define GROWTH_RATE(d) ((d)->ma_used*3)
 
+/* Grouped probing
+ *
+ * With millions of keys, each probe of the per-slot sequence is a cache miss
+ * in dk_indices, followed by another one in dk_entries to compare the hash.
+ * Grouped tables (see DK_GROUPED_MINSIZE) also keep a control byte per slot:
+ * DK_CTRL_EMPTY, DK_CTRL_DUMMY, or 7 bits of the hash of the key in the slot.
+ * Their slots are probed DK_GROUP_SIZE consecutive slots at a time: the
+ * control bytes of a group are compared with the hash at once (with SSE2, in
+ * a single instruction), and only the slots whose bits match are looked up in
+ * dk_entries.  The control bytes are stored next to the indices of their
+ * group, so a hit costs the same two cache misses as a per-slot probe, and a
+ * missing key usually costs a single one.  The key is missing once a group
+ * has an empty slot.
+ *
+ * dk_entries is unchanged, so the insertion order and all the code which does
+ * not probe are the same for both kinds of tables.  Smaller tables stay in
+ * the cache anyway and keep the per-slot probing.
+ */
+#define DK_CTRL_EMPTY ((uint8_t)0x80)
+#define DK_CTRL_DUMMY ((uint8_t)0xfe)
+
+/* Control byte of slot i of a grouped table */
+#define DK_CTRL(dk, i) \
+    (DK_GROUP(dk, (i) / DK_GROUP_SIZE, DK_IXSIZE(dk))[(i) % DK_GROUP_SIZE])
+
+/* The first group probed is the one of slot hash & mask, and the next ones
+   follow the recurrence of the per-slot probing (see the comments at the
+   top of this file), so that consecutive ints still fill consecutive slots.
+   The control byte folds all the bytes of the hash: the low ones tell apart
+   the keys of a group, the high ones the keys which start in the same
+   group. */
+static inline uint8_t
+dk_ctrl_hash(Py_hash_t hash)
+{
+    size_t h = (size_t)hash;
+#if SIZEOF_SIZE_T == 8
+    h ^= h >> 32;
+#endif
+    h ^= h >> 16;
+    h ^= h >> 8;
+    return (uint8_t)(h & 0x7f);
+}
+
+#if defined(__SSE2__)
+#  include <emmintrin.h>
+
+/* Bit i of the result is set if ctrl[i] == c */
+static inline unsigned int
+dk_group_match(const uint8_t *ctrl, uint8_t c)
+{
+    __m128i group = _mm_loadu_si128((const __m128i *)ctrl);
+    return (unsigned int)_mm_movemask_epi8(
+        _mm_cmpeq_epi8(group, _mm_set1_epi8((char)c)));
+}
+
+/* Bit i of the result is set if ctrl[i] is DK_CTRL_EMPTY or DK_CTRL_DUMMY */
+static inline unsigned int
+dk_group_match_free(const uint8_t *ctrl)
+{
+    __m128i group = _mm_loadu_si128((const __m128i *)ctrl);
+    return (unsigned int)_mm_movemask_epi8(group);
+}
+#else
+static inline unsigned int
+dk_group_match(const uint8_t *ctrl, uint8_t c)
+{
+    unsigned int mask = 0;
+    for (int i = 0; i < DK_GROUP_SIZE; i++) {
+        mask |= (unsigned int)(ctrl[i] == c) << i;
+    }
+    return mask;
+}
+
+static inline unsigned int
+dk_group_match_free(const uint8_t *ctrl)
+{
+    unsigned int mask = 0;
+    for (int i = 0; i < DK_GROUP_SIZE; i++) {
+        mask |= (unsigned int)(ctrl[i] >> 7) << i;
+    }
+    return mask;
+}
+#endif
+
+/* With int32 or int64 indices, a group spans more than one cache line: load
+   the end of its indices while its control bytes are compared */
+#if defined(__GNUC__) || defined(__clang__)
+#  define DK_PREFETCH_GROUP(group, es) \
+    do { \
+        if ((es) > 3) { \
+            __builtin_prefetch((group) + DK_GROUP_SIZE * (1 + (es)) - 1); \
+        } \
+    } while (0)
+#else
+#  define DK_PREFETCH_GROUP(group, es)
+#endif
+
+/* Index stored in slot j of a group, whose control byte tells that it is
+   used (so that it is >= 0) */
+static inline Py_ssize_t
+dk_group_get_index(const uint8_t *group, Py_ssize_t es, int j)
+{
+    if (es == 3) {
+        const uint8_t *p = DK_GROUP_INDICES(group) + 3 * j;
+        return p[0] | (p[1] << 8) | (p[2] << 16);
+    }
+    if (es == 4) {
+        return ((const int32_t *)DK_GROUP_INDICES(group))[j];
+    }
+    return (Py_ssize_t)((const int64_t *)DK_GROUP_INDICES(group))[j];
+}
+
+/* Index of the lowest set bit of a group mask (mask != 0) */
+static inline int
+dk_group_first(unsigned int mask)
+{
+    assert(mask != 0);
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctz(mask);
+#else
+    int i = 0;
+    while (!(mask & 1)) {
+        mask >>= 1;
+        i++;
+    }
+    return i;
+#endif
+}
+
+/* Store the index ix >= 0 of the entry of the given hash in slot i */
+static inline void
+dictkeys_set_entry_index(PyDictKeysObject *keys, Py_ssize_t i,
+                         Py_ssize_t ix, Py_hash_t hash)
+{
+    assert(ix >= 0);
+    dictkeys_set_index(keys, i, ix);
+    if (DK_IS_GROUPED(keys)) {
+        DK_CTRL(keys, i) = dk_ctrl_hash(hash);
+    }
+}
+
+/* Turn slot i into a dummy once its entry is deleted */
+static inline void
+dictkeys_set_dummy(PyDictKeysObject *keys, Py_ssize_t i)
+{
+    dictkeys_set_index(keys, i, DKIX_DUMMY);
+    if (DK_IS_GROUPED(keys)) {
+        DK_CTRL(keys, i) = DK_CTRL_DUMMY;
+    }
+}
+
 /* This immutable, empty PyDictKeysObject is used for PyDict_Clear()
  * (which cannot fail and thus can do no allocation).
  */
 static PyDictKeysObject empty_keys_struct = {
         1, /* dk_refcnt */
         1, /* dk_size */
-        lookdict, /* dk_lookup */
+        lookdict_unicode, /* dk_lookup */
         0, /* dk_usable (immutable) */
         0, /* dk_nentries */
         {DKIX_EMPTY, DKIX_EMPTY, DKIX_EMPTY, DKIX_EMPTY,
@@ -667,6 +879,12 @@ _PyDict_CheckConsistency(PyObject *op, int check_content)
         for (i=0; i < keys->dk_size; i++) {
             Py_ssize_t ix = dictkeys_get_index(keys, i);
             CHECK(DKIX_DUMMY <= ix && ix <= usable);
+            if (DK_IS_GROUPED(keys)) {
+                uint8_t ctrl = DK_CTRL(keys, i);
+                CHECK(ix >= 0 ? ctrl < 0x80 :
+                      ctrl == (ix == DKIX_EMPTY ? DK_CTRL_EMPTY
+                                                : DK_CTRL_DUMMY));
+            }
         }
 
         for (i=0; i < usable; i++) {
@@ -701,6 +919,9 @@ static PyDictKeysObject *new_keys_object(Py_ssize_t size)
     else if (size <= 0xffff) {
         es = 2;
     }
+    else if (size <= 0xffffff) {
+        es = 3;
+    }
 #if SIZEOF_VOID_P > 4
     else if (size <= 0xffffffff) {
         es = 4;
@@ -712,7 +933,8 @@ static PyDictKeysObject *new_keys_object(Py_ssize_t size)
     {
         dk = PyMem_Malloc(sizeof(PyDictKeysObject)
                              + es * size
-                             + sizeof(PyDictKeyEntry) * usable);
+                             + sizeof(PyDictKeyEntry) * usable
+                             + DK_GROUPED_EXTRA(size));
         if (dk == NULL) {
             PyErr_NoMemory();
             return NULL;
@@ -721,9 +943,18 @@ static PyDictKeysObject *new_keys_object(Py_ssize_t size)
     dk->dk_refcnt = 1;
     dk->dk_size = size;
     dk->dk_usable = usable;
-    dk->dk_lookup = lookdict;  
+    dk->dk_lookup = lookdict_unicode;
     dk->dk_nentries = 0;
-    memset(&dk->dk_indices[0], 0xff, es * size);
+    if (DK_IS_GROUPED(dk)) {
+        for (Py_ssize_t g = 0; g < size / DK_GROUP_SIZE; g++) {
+            uint8_t *group = DK_GROUP(dk, g, es);
+            memset(group, DK_CTRL_EMPTY, DK_GROUP_SIZE);
+            memset(DK_GROUP_INDICES(group), 0xff, es * DK_GROUP_SIZE);
+        }
+    }
+    else {
+        memset(&dk->dk_indices[0], 0xff, es * size);
+    }
     memset(DK_ENTRIES(dk), 0, sizeof(PyDictKeyEntry) * usable);
     return dk;
 }
@@ -773,7 +1004,17 @@ clone_combined_dict(PyDictObject *orig)
         return NULL;
     }
 
-    memcpy(keys, orig->ma_keys, keys_size);
+    if (DK_IS_GROUPED(orig->ma_keys)) {
+        /* The groups are aligned from the address of each copy */
+        PyDictKeysObject *ok = orig->ma_keys;
+        memcpy(keys, ok, sizeof(PyDictKeysObject));
+        memcpy(DK_GROUPS(keys), DK_GROUPS(ok),
+               (char *)&DK_ENTRIES(ok)[USABLE_FRACTION(DK_SIZE(ok))]
+               - (char *)DK_GROUPS(ok));
+    }
+    else {
+        memcpy(keys, orig->ma_keys, keys_size);
+    }
 
     /* After copying key/value pairs, we need to incref all
        keys and values and they are about to be co-owned by a
@@ -811,10 +1052,41 @@ PyDict_New(void)
     return new_dict(Py_EMPTY_KEYS);
 }
 
+/* lookdict_index() for grouped tables */
+static Py_ssize_t
+lookdict_index_grouped(PyDictKeysObject *k, Py_hash_t hash, Py_ssize_t index)
+{
+    Py_ssize_t es = DK_IXSIZE(k);
+    uint8_t c = dk_ctrl_hash(hash);
+    size_t gmask = DK_MASK(k) / DK_GROUP_SIZE;
+    size_t perturb = (size_t)hash;
+    size_t g = ((size_t)hash / DK_GROUP_SIZE) & gmask;
+
+    for (;;) {
+        const uint8_t *group = DK_GROUP(k, g, es);
+        unsigned int match = dk_group_match(group, c);
+        for (; match; match &= match - 1) {
+            int j = dk_group_first(match);
+            if (dk_group_get_index(group, es, j) == index) {
+                return g * DK_GROUP_SIZE + j;
+            }
+        }
+        if (dk_group_match(group, DK_CTRL_EMPTY)) {
+            return DKIX_EMPTY;
+        }
+        perturb >>= PERTURB_SHIFT;
+        g = (g*5 + perturb + 1) & gmask;
+    }
+    Py_UNREACHABLE();
+}
+
 /* Search index of hash table from offset of entry table */
 static Py_ssize_t
 lookdict_index(PyDictKeysObject *k, Py_hash_t hash, Py_ssize_t index)
 {
+    if (DK_IS_GROUPED(k)) {
+        return lookdict_index_grouped(k, hash, index);
+    }
     size_t mask = DK_MASK(k);
     size_t perturb = (size_t)hash;
     size_t i = (size_t)hash & mask;
@@ -853,10 +1125,13 @@ comparison raises an exception.
 lookdict_unicode() below is specialized to string keys, comparison of which can
 never raise an exception; that function can never return DKIX_ERROR when key
 is string.  Otherwise, it falls back to lookdict().
-lookdict_unicode_nodummy is further specialized for string keys that cannot be
-the <dummy> value.
 For both, when the key isn't found a DKIX_EMPTY is returned.
+Both hand grouped tables over to lookdict_grouped().
 */
+static Py_ssize_t lookdict_grouped(PyDictObject *mp, PyObject *key,
+                                   Py_hash_t hash, PyObject **value_addr,
+                                   int unicode);
+
 static Py_ssize_t _Py_HOT_FUNCTION
 lookdict(PyDictObject *mp, PyObject *key,
          Py_hash_t hash, PyObject **value_addr)
@@ -867,6 +1142,9 @@ lookdict(PyDictObject *mp, PyObject *key,
 
 top:
     dk = mp->ma_keys;
+    if (DK_IS_GROUPED(dk)) {
+        return lookdict_grouped(mp, key, hash, value_addr, 0);
+    }
     ep0 = DK_ENTRIES(dk);
     mask = DK_MASK(dk);
     perturb = hash;
@@ -912,6 +1190,115 @@ top:
     Py_UNREACHABLE();
 }
 
+/* Specialized version for tables whose keys are all exact strings: equal
+   strings have equal hashes, so a key is found by identity or by comparing
+   the hash and then the characters, without calling __eq__. */
+static Py_ssize_t _Py_HOT_FUNCTION
+lookdict_unicode(PyDictObject *mp, PyObject *key,
+                 Py_hash_t hash, PyObject **value_addr)
+{
+    /* A string subclass may override __eq__ */
+    if (!PyString_CheckExact(key)) {
+        return lookdict(mp, key, hash, value_addr);
+    }
+
+    PyDictKeysObject *dk = mp->ma_keys;
+    if (DK_IS_GROUPED(dk)) {
+        return lookdict_grouped(mp, key, hash, value_addr, 1);
+    }
+    PyDictKeyEntry *ep0 = DK_ENTRIES(dk);
+    size_t mask = DK_MASK(dk);
+    size_t perturb = hash;
+    size_t i = (size_t)hash & mask;
+
+    for (;;) {
+        Py_ssize_t ix = dictkeys_get_index(dk, i);
+        if (ix >= 0) {
+            PyDictKeyEntry *ep = &ep0[ix];
+            assert(ep->me_key != NULL);
+            assert(PyString_CheckExact(ep->me_key));
+            if (ep->me_key == key ||
+                    (ep->me_hash == hash && unicode_eq(ep->me_key, key))) {
+                *value_addr = ep->me_value;
+                return ix;
+            }
+        }
+        else if (ix == DKIX_EMPTY) {
+            *value_addr = NULL;
+            return DKIX_EMPTY;
+        }
+        perturb >>= PERTURB_SHIFT;
+        i = (i*5 + perturb + 1) & mask;
+    }
+    Py_UNREACHABLE();
+}
+
+/* Lookup in a grouped table.  If unicode is true, key is an exact string
+   and so are all the keys of the table: they are compared as in
+   lookdict_unicode(). */
+static Py_ssize_t
+lookdict_grouped(PyDictObject *mp, PyObject *key,
+                 Py_hash_t hash, PyObject **value_addr, int unicode)
+{
+    PyDictKeysObject *dk = mp->ma_keys;
+    PyDictKeyEntry *ep0 = DK_ENTRIES(dk);
+    Py_ssize_t es = DK_IXSIZE(dk);
+    uint8_t c = dk_ctrl_hash(hash);
+    size_t gmask = DK_MASK(dk) / DK_GROUP_SIZE;
+    size_t perturb = (size_t)hash;
+    size_t g = ((size_t)hash / DK_GROUP_SIZE) & gmask;
+
+    assert(DK_IS_GROUPED(dk));
+    for (;;) {
+        const uint8_t *group = DK_GROUP(dk, g, es);
+        DK_PREFETCH_GROUP(group, es);
+        unsigned int match = dk_group_match(group, c);
+        for (; match; match &= match - 1) {
+            Py_ssize_t ix = dk_group_get_index(group, es, dk_group_first(match));
+            assert(ix >= 0);
+            PyDictKeyEntry *ep = &ep0[ix];
+            assert(ep->me_key != NULL);
+            if (ep->me_key == key) {
+                *value_addr = ep->me_value;
+                return ix;
+            }
+            if (ep->me_hash != hash) {
+                continue;
+            }
+            if (unicode) {
+                if (unicode_eq(ep->me_key, key)) {
+                    *value_addr = ep->me_value;
+                    return ix;
+                }
+                continue;
+            }
+            PyObject *startkey = ep->me_key;
+            Py_INCREF(startkey);
+            int cmp = PyObject_RichCompareBool(startkey, key, Py_EQ);
+            Py_DECREF(startkey);
+            if (cmp < 0) {
+                *value_addr = NULL;
+                return DKIX_ERROR;
+            }
+            if (dk != mp->ma_keys || ep->me_key != startkey) {
+                /* The dict was mutated, restart */
+                return lookdict(mp, key, hash, value_addr);
+            }
+            if (cmp > 0) {
+                *value_addr = ep->me_value;
+                return ix;
+            }
+        }
+        if (dk_group_match(group, DK_CTRL_EMPTY)) {
+            *value_addr = NULL;
+            return DKIX_EMPTY;
+        }
+        perturb >>= PERTURB_SHIFT;
+        g = (g*5 + perturb + 1) & gmask;
+    }
+    Py_UNREACHABLE();
+}
+
 /* Internal function to find slot for an item from its hash
    when it is known that the key is not present in the dict.
 
@@ -921,6 +1308,21 @@ find_empty_slot(PyDictKeysObject *keys, Py_hash_t hash)
 {
     assert(keys != NULL);
 
+    if (DK_IS_GROUPED(keys)) {
+        Py_ssize_t es = DK_IXSIZE(keys);
+        size_t gmask = DK_MASK(keys) / DK_GROUP_SIZE;
+        size_t perturb = (size_t)hash;
+        size_t g = ((size_t)hash / DK_GROUP_SIZE) & gmask;
+        for (;;) {
+            unsigned int avail = dk_group_match_free(DK_GROUP(keys, g, es));
+            if (avail) {
+                return g * DK_GROUP_SIZE + dk_group_first(avail);
+            }
+            perturb >>= PERTURB_SHIFT;
+            g = (g*5 + perturb + 1) & gmask;
+        }
+    }
+
     const size_t mask = DK_MASK(keys);
     size_t i = hash & mask;
     Py_ssize_t ix = dictkeys_get_index(keys, i);
@@ -963,9 +1365,13 @@ insertdict(PyDictObject *mp, PyObject *key, Py_hash_t hash, PyObject *value)
             if (insertion_resize(mp) < 0)
                 goto Fail;
         }
+        if (!PyString_CheckExact(key) && mp->ma_keys->dk_lookup != lookdict) {
+            mp->ma_keys->dk_lookup = lookdict;
+        }
         Py_ssize_t hashpos = find_empty_slot(mp->ma_keys, hash);
         ep = &DK_ENTRIES(mp->ma_keys)[mp->ma_keys->dk_nentries];
-        dictkeys_set_index(mp->ma_keys, hashpos, mp->ma_keys->dk_nentries);
+        dictkeys_set_entry_index(mp->ma_keys, hashpos,
+                                 mp->ma_keys->dk_nentries, hash);
         ep->me_key = key;
         ep->me_hash = hash;
 	ep->me_value = value;
@@ -1003,7 +1409,9 @@ insert_to_emptydict(PyDictObject *mp, PyObject *key, Py_hash_t hash,
     if (newkeys == NULL) {
         return -1;
     }
-    newkeys->dk_lookup = lookdict;
+    if (!PyString_CheckExact(key)) {
+        newkeys->dk_lookup = lookdict;
+    }
     dictkeys_decref(Py_EMPTY_KEYS);
     mp->ma_keys = newkeys;
     Py_INCREF(key);
@@ -1011,7 +1419,7 @@ insert_to_emptydict(PyDictObject *mp, PyObject *key, Py_hash_t hash,
 
     size_t hashpos = (size_t)hash & (PyDict_MINSIZE-1);
     PyDictKeyEntry *ep = DK_ENTRIES(mp->ma_keys);
-    dictkeys_set_index(mp->ma_keys, hashpos, 0);
+    dictkeys_set_entry_index(mp->ma_keys, hashpos, 0, hash);
     ep->me_key = key;
     ep->me_hash = hash;
     ep->me_value = value;
@@ -1027,6 +1435,13 @@ Internal routine used by dictresize() to build a hashtable of entries.
 static void
 build_indices(PyDictKeysObject *keys, PyDictKeyEntry *ep, Py_ssize_t n)
 {
+    if (DK_IS_GROUPED(keys)) {
+        for (Py_ssize_t ix = 0; ix != n; ix++, ep++) {
+            Py_ssize_t i = find_empty_slot(keys, ep->me_hash);
+            dictkeys_set_entry_index(keys, i, ix, ep->me_hash);
+        }
+        return;
+    }
     size_t mask = (size_t)DK_SIZE(keys) - 1;
     for (Py_ssize_t ix = 0; ix != n; ix++, ep++) {
         Py_hash_t hash = ep->me_hash;
@@ -1116,7 +1531,6 @@ dictresize(PyDictObject *mp, Py_ssize_t minsize)
 PyObject *
 _PyDict_NewPresized(Py_ssize_t minused)
 {
-    const Py_ssize_t max_presize = 128 * 1024;
     Py_ssize_t newsize;
     PyDictKeysObject *new_keys;
 
@@ -1127,8 +1541,8 @@ _PyDict_NewPresized(Py_ssize_t minused)
      * items without resize.  So we create medium size dict instead of very
      * large dict or MemoryError.
      */
-    if (minused > USABLE_FRACTION(max_presize)) {
-        newsize = max_presize;
+    if (minused > USABLE_FRACTION(PyDict_MAXPRESIZE)) {
+        newsize = PyDict_MAXPRESIZE;
     }
     else {
         Py_ssize_t minsize = ESTIMATE_SIZE(minused);
@@ -1145,6 +1559,28 @@ _PyDict_NewPresized(Py_ssize_t minused)
     return new_dict(new_keys);
 }
 
+/* Make room for n more items, so that inserting them does not resize the
+   table.  Unless n is exact (see _PyObject_PresizeHint()) it may be a
+   wrong guess: no more than PyDict_MAXPRESIZE is reserved for it, and the
+   table grows past that as items come. */
+int
+_PyDict_Reserve(PyObject *op, Py_ssize_t n, int exact)
+{
+    PyDictObject *mp = (PyDictObject *)op;
+
+    assert(PyDict_Check(op));
+    if (!exact && n > USABLE_FRACTION(PyDict_MAXPRESIZE)) {
+        n = USABLE_FRACTION(PyDict_MAXPRESIZE);
+    }
+    /* A small dict gets a table of PyDict_MINSIZE on its first insertion */
+    if (n <= mp->ma_keys->dk_usable
+        || mp->ma_used + n <= USABLE_FRACTION(PyDict_MINSIZE)
+        || n > (PY_SSIZE_T_MAX - mp->ma_used) / 3) {
+        return 0;
+    }
+    return dictresize(mp, ESTIMATE_SIZE(mp->ma_used + n));
+}
+
 /* Note that, for historical reasons, PyDict_GetItem() suppresses all errors
  * that may occur (originally dicts supported only string keys, and exceptions
  * weren't possible).  So, while the original intent was that a NULL return
@@ -1305,7 +1741,7 @@ delitem_common(PyDictObject *mp, Py_hash_t hash, Py_ssize_t ix,
 
     mp->ma_used--;
     ep = &DK_ENTRIES(mp->ma_keys)[ix];
-    dictkeys_set_index(mp->ma_keys, hashpos, DKIX_DUMMY);
+    dictkeys_set_dummy(mp->ma_keys, hashpos);
     old_key = ep->me_key;
     ep->me_key = NULL;
     ep->me_value = NULL;
@@ -1471,7 +1907,7 @@ _PyDict_Pop_KnownHash(PyObject *dict, PyObject *key, Py_hash_t hash, PyObject *d
     assert(hashpos >= 0);
     assert(old_value != NULL);
     mp->ma_used--;
-    dictkeys_set_index(mp->ma_keys, hashpos, DKIX_DUMMY);
+    dictkeys_set_dummy(mp->ma_keys, hashpos);
     ep = &DK_ENTRIES(mp->ma_keys)[ix];
     old_key = ep->me_key;
     ep->me_key = NULL;
@@ -1563,6 +1999,11 @@ PyDict_FromKeys(PyObject *cls, PyObject *iterable, PyObject *value)
     }
 
     if (PyDict_CheckExact(d)) {
+        int exact;
+        Py_ssize_t n = _PyObject_PresizeHint(iterable, &exact);
+        if (n < 0 || _PyDict_Reserve(d, n, exact) < 0) {
+            goto Fail;
+        }
         while ((key = PyIter_Next(it)) != NULL) {
             status = PyDict_SetItem(d, key, value);
             Py_DECREF(key);
@@ -1959,6 +2400,7 @@ PyDict_MergeFromSeq2(PyObject *d, PyObject *seq2, int override)
     Py_ssize_t i;       /* index into seq2 of current element */
     PyObject *item;     /* seq2[i] */
     PyObject *fast;     /* item as a 2-tuple or 2-list */
+    int exact;
 
     assert(d != NULL);
     assert(PyDict_Check(d));
@@ -1968,6 +2410,13 @@ PyDict_MergeFromSeq2(PyObject *d, PyObject *seq2, int override)
     if (it == NULL)
         return -1;
 
+    /* Presize for the pairs; duplicate keys only waste a few slots */
+    i = _PyObject_PresizeHint(seq2, &exact);
+    if (i < 0 || _PyDict_Reserve(d, i, exact) < 0) {
+        Py_DECREF(it);
+        return -1;
+    }
+
     for (i = 0; ; ++i) {
         PyObject *key, *value;
         Py_ssize_t n;
@@ -2123,7 +2572,7 @@ dict_merge(PyObject *a, PyObject *b, int override)
         PyObject *keys = PyMapping_Keys(b);
         PyObject *iter;
         PyObject *key, *value;
-        int status;
+        int status, exact;
 
         if (keys == NULL)
             /* Docstring says this is equivalent to E.keys() so
@@ -2133,6 +2582,13 @@ dict_merge(PyObject *a, PyObject *b, int override)
              */
             return -1;
 
+        /* As above, expect few overlapping keys */
+        n = _PyObject_PresizeHint(keys, &exact);
+        if (n < 0 || _PyDict_Reserve(a, n, exact) < 0) {
+            Py_DECREF(keys);
+            return -1;
+        }
+
         iter = PyObject_GetIter(keys);
         Py_DECREF(keys);
         if (iter == NULL)
@@ -2449,10 +2905,14 @@ PyDict_SetDefault(PyObject *d, PyObject *key, PyObject *defaultobj)
                 return NULL;
             }
         }
+        if (!PyString_CheckExact(key)) {
+            mp->ma_keys->dk_lookup = lookdict;
+        }
         Py_ssize_t hashpos = find_empty_slot(mp->ma_keys, hash);
         ep0 = DK_ENTRIES(mp->ma_keys);
         ep = &ep0[mp->ma_keys->dk_nentries];
-        dictkeys_set_index(mp->ma_keys, hashpos, mp->ma_keys->dk_nentries);
+        dictkeys_set_entry_index(mp->ma_keys, hashpos,
+                                 mp->ma_keys->dk_nentries, hash);
         Py_INCREF(key);
         Py_INCREF(value);
         ep->me_key = key;
@@ -2564,7 +3024,7 @@ dict_popitem_impl(PyDictObject *self)
     j = lookdict_index(self->ma_keys, ep->me_hash, i);
     assert(j >= 0);
     assert(dictkeys_get_index(self->ma_keys, j) == i);
-    dictkeys_set_index(self->ma_keys, j, DKIX_DUMMY);
+    dictkeys_set_dummy(self->ma_keys, j);
 
     PyTuple_InitItem(res, 0, ep->me_key);
     PyTuple_InitItem(res, 1, ep->me_value);
@@ -2601,7 +3061,8 @@ _PyDict_SizeOf(PyObject *op)
     if (mp->ma_keys->dk_refcnt == 1)
         res += (sizeof(PyDictKeysObject)
                 + DK_IXSIZE(mp->ma_keys) * size
-                + sizeof(PyDictKeyEntry) * usable);
+                + sizeof(PyDictKeyEntry) * usable
+                + DK_GROUPED_EXTRA(size));
     return res;
 }
 
@@ -2611,7 +3072,8 @@ _PyDict_KeysSize(PyObject *op)
   PyDictKeysObject *keys = (PyDictKeysObject *) op;
   return (sizeof(PyDictKeysObject)
 	  + DK_IXSIZE(keys) * DK_SIZE(keys)
-	  + USABLE_FRACTION(DK_SIZE(keys)) * sizeof(PyDictKeyEntry));
+	  + USABLE_FRACTION(DK_SIZE(keys)) * sizeof(PyDictKeyEntry)
+	  + DK_GROUPED_EXTRA(DK_SIZE(keys)));
 }
 
 static PyObject *
@@ -2712,6 +3174,21 @@ PyDict_Contains(PyObject *op, PyObject *key)
     return (ix != DKIX_EMPTY && value != NULL);
 }
 
+/* Internal version of PyDict_Contains used when the hash value is already
+   known, e.g. stored in the entry of a set */
+int
+_PyDict_Contains_KnownHash(PyObject *op, PyObject *key, Py_hash_t hash)
+{
+    Py_ssize_t ix;
+    PyDictObject *mp = (PyDictObject *)op;
+    PyObject *value;
+
+    ix = (mp->ma_keys->dk_lookup)(mp, key, hash, &value);
+    if (ix == DKIX_ERROR)
+        return -1;
+    return (ix != DKIX_EMPTY && value != NULL);
+}
+
 /* Hack to implement "key in dict" */
 static PySequenceMethods dict_as_sequence = {
     0,                          /* sq_length */
@@ -3577,6 +4054,24 @@ dictkeys_iter(_PyDictViewObject *dv)
     return dictiter_new(dv->dv_dict, &PyDictIterKey_Type);
 }
 
+/* Return the dict of a keys view (borrowed) if it is an exact dict, so
+   that set operations can reuse the hashes stored in its entries, else
+   NULL.  No exception is set. */
+PyObject *
+_PyDictKeys_GetDict(PyObject *op)
+{
+    PyObject *dict;
+
+    if (!PyDictKeys_Check(op)) {
+        return NULL;
+    }
+    dict = (PyObject *)((_PyDictViewObject *)op)->dv_dict;
+    if (dict == NULL || !PyDict_CheckExact(dict)) {
+        return NULL;
+    }
+    return dict;
+}
+
 static int
 dictkeys_contains(_PyDictViewObject *dv, PyObject *obj)
 {
@@ -3656,9 +4151,12 @@ _PyDictView_Intersect(PyObject* self, PyObject *other)
 
     len_self = dictview_len((_PyDictViewObject *)self);
 
-    /* if other is a set and self is smaller than other,
-       reuse set intersection logic */
-    if (Py_IS_TYPE(other, &PySet_Type) && len_self <= PyObject_Size(other)) {
+    /* if other is a set and self is smaller than other, or the keys of
+       an exact dict whose hashes it can reuse, reuse set intersection
+       logic */
+    if (Py_IS_TYPE(other, &PySet_Type)
+        && (len_self <= PyObject_Size(other)
+            || _PyDictKeys_GetDict(self) != NULL)) {
         _Py_IDENTIFIER(intersection);
         return _PyObject_CallMethodIdObjArgs(other, &PyId_intersection, self, NULL);
     }
@@ -3681,6 +4179,29 @@ _PyDictView_Intersect(PyObject* self, PyObject *other)
     if (result == NULL)
         return NULL;
 
+    /* keys of two exact dicts: look up the keys of the smaller one with
+       the hashes stored in its entries */
+    PyObject *self_dict = _PyDictKeys_GetDict(self);
+    PyObject *other_dict = _PyDictKeys_GetDict(other);
+    if (self_dict != NULL && other_dict != NULL) {
+        Py_ssize_t pos = 0;
+        Py_hash_t hash;
+        PyObject *value;
+        while (_PyDict_Next(other_dict, &pos, &key, &value, &hash)) {
+            Py_INCREF(key);
+            rv = _PyDict_Contains_KnownHash(self_dict, key, hash);
+            if (rv > 0) {
+                rv = PySet_Add(result, key);
+            }
+            Py_DECREF(key);
+            if (rv < 0) {
+                Py_DECREF(result);
+                return NULL;
+            }
+        }
+        return result;
+    }
+
     it = PyObject_GetIter(other);
     if (it == NULL) {
         Py_DECREF(result);
@@ -1456,6 +1456,12 @@ SimpleExtendsException(PyExc_Exception, ReferenceError,
                        "Weak ref proxy used after referent went away.");
 
 
+/*
+ *    BufferError extends Exception
+ */
+SimpleExtendsException(PyExc_Exception, BufferError, "Buffer error.");
+
+
 /*
  *    MemoryError extends Exception
  */
@@ -1596,6 +1602,7 @@ _PyExc_Init(void)
     PRE_INIT(SystemError);
     PRE_INIT(ReferenceError);
     PRE_INIT(MemoryError);
+    PRE_INIT(BufferError);
     
     /* OSError subclasses */
     PRE_INIT(ConnectionError);
@@ -1713,6 +1720,7 @@ _PyBuiltins_AddExceptions(PyObject *bltinmod)
     POST_INIT(SystemError);
     POST_INIT(ReferenceError);
     POST_INIT(MemoryError);
+    POST_INIT(BufferError);
     /* OSError subclasses */
     POST_INIT(ConnectionError);
     POST_INIT(BlockingIOError);
@@ -3,6 +3,7 @@
 /* Function object implementation */
 
 #include "Python.h"
+#include "pycore_ceval.h"         // _PyPerfTrampoline_RegisterCode()
 #include "pycore_object.h"
 #include "code.h"
 #include "structmember.h"         // PyMemberDef
@@ -66,6 +67,9 @@ PyFunction_NewWithQualName(PyObject *code, PyObject *globals, PyObject *qualname
     else
         op->func_qualname = op->func_name;
     Py_INCREF(op->func_qualname);
+
+    /* Name the perf trampoline after the qualname while it is known */
+    _PyPerfTrampoline_RegisterCode((PyCodeObject *)code, op->func_qualname);
     return (PyObject *)op;
 }
 
@@ -0,0 +1,157 @@
+/* Lazy import object implementation
+
+   With -X lazy_imports, a module-level "import x" or "import x.y" outside
+   of any try or with block binds one of these instead of running the
+   module body.  The module is imported when the name is first loaded by
+   LOAD_GLOBAL or LOAD_NAME (which then rebind the name to the module), or
+   when an attribute of the placeholder itself is used.
+
+   "import a.b" followed by "import a.c" bind the same name "a": the second
+   import is added to the placeholder already bound, so that resolving "a"
+   imports both a.b and a.c. */
+
+#include "Python.h"
+#include "pycore_lazyimport.h"
+
+
+PyObject *
+_PyLazyImport_New(PyObject *name, PyObject *globals)
+{
+    PyLazyImportObject *lz;
+    lz = PyObject_New(PyLazyImportObject, &_PyLazyImport_Type);
+    if (lz == NULL) {
+        return NULL;
+    }
+    lz->lz_names = PyList_New(0);
+    lz->lz_module = NULL;
+    Py_INCREF(globals);
+    lz->lz_globals = globals;
+    if (lz->lz_names == NULL || PyList_Append(lz->lz_names, name) < 0) {
+        Py_DECREF(lz);
+        return NULL;
+    }
+    return (PyObject *)lz;
+}
+
+int
+_PyLazyImport_AddName(PyObject *lazy, PyObject *name)
+{
+    PyLazyImportObject *lz = (PyLazyImportObject *)lazy;
+    int contains = PySequence_Contains(lz->lz_names, name);
+    if (contains != 0) {
+        return contains < 0 ? -1 : 0;
+    }
+    return PyList_Append(lz->lz_names, name);
+}
+
+PyObject *
+_PyLazyImport_Resolve(PyObject *lazy)
+{
+    PyLazyImportObject *lz = (PyLazyImportObject *)lazy;
+    if (lz->lz_module == NULL) {
+        PyObject *module = NULL;
+        Py_ssize_t n = PyList_Size(lz->lz_names);
+        for (Py_ssize_t i = 0; i < n; i++) {
+            PyObject *name = PyList_GetItem(lz->lz_names, i);
+            /* With no fromlist, the top-level package is returned */
+            Py_XSETREF(module, PyImport_ImportModuleLevelObject(
+                                   name, lz->lz_globals, NULL, NULL, 0));
+            if (module == NULL) {
+                /* Keep the placeholder: the next use tries again */
+                return NULL;
+            }
+        }
+        lz->lz_module = module;
+    }
+    Py_INCREF(lz->lz_module);
+    return lz->lz_module;
+}
+
+PyObject *
+_PyLazyImport_ResolveInDict(PyObject *dict, PyObject *name, PyObject *lazy)
+{
+    PyObject *module = _PyLazyImport_Resolve(lazy);
+    if (module == NULL) {
+        return NULL;
+    }
+    /* The module body may have rebound the name already */
+    PyObject *current = PyDict_GetItemWithError(dict, name);
+    if (current == lazy) {
+        if (PyDict_SetItem(dict, name, module) < 0) {
+            Py_DECREF(module);
+            return NULL;
+        }
+    }
+    else if (current == NULL && PyErr_Occurred()) {
+        Py_DECREF(module);
+        return NULL;
+    }
+    return module;
+}
+
+static void
+lazyimport_dealloc(PyLazyImportObject *lz)
+{
+    Py_XDECREF(lz->lz_names);
+    Py_XDECREF(lz->lz_globals);
+    Py_XDECREF(lz->lz_module);
+    PyMem_Free(lz);
+}
+
+static PyObject *
+lazyimport_repr(PyLazyImportObject *lz)
+{
+    if (lz->lz_module != NULL) {
+        return PyObject_Repr(lz->lz_module);
+    }
+    return PyString_FromFormat("<lazy import %R>",
+                               PyList_GetItem(lz->lz_names, 0));
+}
+
+static PyObject *
+lazyimport_getattro(PyObject *lazy, PyObject *name)
+{
+    PyObject *module = _PyLazyImport_Resolve(lazy);
+    if (module == NULL) {
+        return NULL;
+    }
+    PyObject *res = PyObject_GetAttr(module, name);
+    Py_DECREF(module);
+    return res;
+}
+
+static int
+lazyimport_setattro(PyObject *lazy, PyObject *name, PyObject *value)
+{
+    PyObject *module = _PyLazyImport_Resolve(lazy);
+    if (module == NULL) {
+        return -1;
+    }
+    int res = PyObject_SetAttr(module, name, value);
+    Py_DECREF(module);
+    return res;
+}
+
+PyTypeObject _PyLazyImport_Type = {
+    PyVarObject_HEAD_INIT(&PyType_Type, 0)
+    "lazy_import",
+    sizeof(PyLazyImportObject),
+    0,
+    (destructor)lazyimport_dealloc,             /* tp_dealloc */
+    0,                                          /* tp_vectorcall_offset */
+    0,                                          /* tp_getattr */
+    0,                                          /* tp_setattr */
+    0,                                          /* tp_as_async */
+    (reprfunc)lazyimport_repr,                  /* tp_repr */
+    0,                                          /* tp_as_number */
+    0,                                          /* tp_as_sequence */
+    0,                                          /* tp_as_mapping */
+    0,                                          /* tp_hash */
+    0,                                          /* tp_call */
+    0,                                          /* tp_str */
+    lazyimport_getattro,                        /* tp_getattro */
+    lazyimport_setattro,                        /* tp_setattro */
+    0,                                          /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT,                         /* tp_flags */
+    0,                                          /* tp_doc */
+};
@@ -11,6 +11,10 @@
 #include <sys/types.h>          /* For size_t */
 #endif
 
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>            /* For list.sort(parallel=n) */
+#endif
+
   
 typedef struct {
     PyObject_VAR_HEAD
@@ -190,7 +194,7 @@ exit:
 }
 
 PyDoc_STRVAR(list_sort__doc__,
-"sort($self, /, *, key=None, reverse=False)\n"
+"sort($self, /, *, key=None, reverse=False, parallel=1)\n"
 "--\n"
 "\n"
 "Sort the list in ascending order and return None.\n"
@@ -201,24 +205,29 @@ PyDoc_STRVAR(list_sort__doc__,
 "If a key function is given, apply it once to each list item and sort them,\n"
 "ascending or descending, according to their function values.\n"
 "\n"
-"The reverse flag can be set to sort in descending order.");
+"The reverse flag can be set to sort in descending order.\n"
+"\n"
+"If parallel is greater than 1, a large list whose keys are all ints, all\n"
+"floats or all strings is sorted by up to that many threads.");
 
 #define LIST_SORT_METHODDEF    \
     {"sort", (PyCFunction)(void(*)(void))list_sort, METH_FASTCALL|METH_KEYWORDS, list_sort__doc__},
 
 static PyObject *
-list_sort_impl(PyListObject *self, PyObject *keyfunc, int reverse);
+list_sort_impl(PyListObject *self, PyObject *keyfunc, int reverse,
+               int parallel);
 
 static PyObject *
 list_sort(PyListObject *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames)
 {
     PyObject *return_value = NULL;
-    static const char * const _keywords[] = {"key", "reverse", NULL};
+    static const char * const _keywords[] = {"key", "reverse", "parallel", NULL};
     static _PyArg_Parser _parser = {NULL, _keywords, "sort", 0};
-    PyObject *argsbuf[2];
+    PyObject *argsbuf[3];
     Py_ssize_t noptargs = nargs + (kwnames ? PyTuple_Size(kwnames) : 0) - 0;
     PyObject *keyfunc = Py_None;
     int reverse = 0;
+    int parallel = 1;
 
     args = _PyArg_UnpackKeywords(args, nargs, NULL, kwnames, &_parser, 0, 0, 0, argsbuf);
     if (!args) {
@@ -233,12 +242,21 @@ list_sort(PyListObject *self, PyObject *const *args, Py_ssize_t nargs, PyObject
             goto skip_optional_kwonly;
         }
     }
-    reverse = _PyLong_AsInt(args[1]);
-    if (reverse == -1 && PyErr_Occurred()) {
+    if (args[1]) {
+        reverse = _PyLong_AsInt(args[1]);
+        if (reverse == -1 && PyErr_Occurred()) {
+            goto exit;
+        }
+        if (!--noptargs) {
+            goto skip_optional_kwonly;
+        }
+    }
+    parallel = _PyLong_AsInt(args[2]);
+    if (parallel == -1 && PyErr_Occurred()) {
         goto exit;
     }
 skip_optional_kwonly:
-    return_value = list_sort_impl(self, keyfunc, reverse);
+    return_value = list_sort_impl(self, keyfunc, reverse, parallel);
 
 exit:
     return return_value;
@@ -654,6 +672,14 @@ app1(PyListObject *self, PyObject *v)
 
     assert (v != NULL);
     assert((size_t)n + 1 < PY_SSIZE_T_MAX);
+    if (n < self->allocated) {
+        /* Room reserved by _PyList_Reserve(): list_resize() would
+           shrink the list if it is still less than half full */
+        Py_INCREF(v);
+        PyList_SET_ITEM(self, n, v);
+        Py_SET_SIZE(self, n + 1);
+        return 0;
+    }
     if (list_resize(self, n+1) < 0)
         return -1;
 
@@ -1267,6 +1293,36 @@ PyList_Extend(PyObject *self, PyObject *iterable)
   return list_extend((PyListObject *)self, iterable);
 }
 
+/* Most items _PyList_Reserve() makes room for from an inexact size; a
+   length hint can be wrong, so past this the list grows as items are
+   really appended. */
+#define LIST_MAXPRESIZE (1024 * 1024)
+
+/* Make room for n more items, so that appending them does not reallocate
+   the item array.  Unless n is exact (see _PyObject_PresizeHint()) it may
+   be a wrong guess: it is then capped at LIST_MAXPRESIZE, and the list
+   grows past that as items come. */
+int
+_PyList_Reserve(PyObject *op, Py_ssize_t n, int exact)
+{
+    PyListObject *self = (PyListObject *)op;
+    Py_ssize_t m = Py_SIZE(self);
+
+    assert(PyList_Check(op));
+    if (!exact && n > LIST_MAXPRESIZE) {
+        n = LIST_MAXPRESIZE;
+    }
+    if (n <= 0 || m + n <= self->allocated
+        || n > (Py_ssize_t)(PY_SSIZE_T_MAX / sizeof(PyObject *)) - m) {
+        return 0;
+    }
+    if (list_resize(self, m + n) < 0) {
+        return -1;
+    }
+    Py_SET_SIZE(self, m);
+    return 0;
+}
+
 /*[clinic input]
 list.pop
 
@@ -2445,6 +2501,291 @@ unsafe_tuple_compare(PyObject *v, PyObject *w, MergeState *ms)
         return PyObject_RichCompareBool(vi[i], wi[i], Py_LT);
 }
 
+/* Radix sort for large lists whose keys are all ints, or all use
+ * unsafe_float_compare or unsafe_latin_compare.  Each key is mapped to an
+ * unsigned 64-bit integer ordered like the key itself, and the (key, index)
+ * pairs are sorted with a stable LSD radix sort, one byte per pass; a pass
+ * is skipped when all keys share the same byte.  The permutation is then
+ * applied to the keys (and values).
+ *
+ * Ints are sorted this way when they all fit in 62 bits, even if they are
+ * too large for unsafe_long_compare: they are stored as their distance to
+ * the minimum, so that a small range takes few passes.  Floats have the sign bit flipped, or all
+ * their bits flipped when negative; a list with a NaN is left to the merge
+ * sort, whose answer for NaNs depends on the order of the comparisons.
+ * Strings use the 8 bytes following the prefix common to all of them: two
+ * strings with the same key may still differ after those bytes, and the
+ * merge sort then runs on the result to order them (it is stable, and the
+ * radix sort kept equal strings in their original order).
+ *
+ * Return 1 if the slice is sorted, or 0 if the merge sort has to run,
+ * either because the radix sort did not apply or to finish it.
+ */
+#define RADIX_SORT_MIN 1024
+
+typedef struct {
+    uint64_t key;
+    Py_ssize_t index;
+} radix_item;
+
+static radix_item *
+radix_sort_items(radix_item *a, radix_item *b, Py_ssize_t n)
+{
+    Py_ssize_t counts[8][256];
+    Py_ssize_t i;
+    int pass, d;
+
+    memset(counts, 0, sizeof(counts));
+    for (i = 0; i < n; i++) {
+        uint64_t key = a[i].key;
+        for (pass = 0; pass < 8; pass++) {
+            counts[pass][(key >> (8 * pass)) & 0xff]++;
+        }
+    }
+    for (pass = 0; pass < 8; pass++) {
+        Py_ssize_t *count = counts[pass];
+        int shift = 8 * pass;
+        radix_item *tmp;
+        Py_ssize_t total = 0;
+
+        if (count[(a[0].key >> shift) & 0xff] == n)
+            continue;
+        for (d = 0; d < 256; d++) {
+            Py_ssize_t c = count[d];
+            count[d] = total;
+            total += c;
+        }
+        for (i = 0; i < n; i++) {
+            b[count[(a[i].key >> shift) & 0xff]++] = a[i];
+        }
+        tmp = a;
+        a = b;
+        b = tmp;
+    }
+    return a;
+}
+
+/* With list.sort(parallel=n), the radix_items are split in up to n chunks
+ * of at least RADIX_PARALLEL_MIN items, sorted by one thread each, and the
+ * sorted chunks are then merged pairwise, one thread per pair.  The threads
+ * only see radix_items: the keys were extracted beforehand, and the
+ * permutation is applied afterwards, on the calling thread.  A chunk whose
+ * thread cannot be started is handled by the calling thread.
+ */
+#define RADIX_PARALLEL_MIN 65536
+#define RADIX_MAX_THREADS 64
+
+typedef struct {
+    radix_item *src;
+    radix_item *dst;
+    Py_ssize_t n1;              /* length of the (first) run at src */
+    Py_ssize_t n2;              /* length of the second run, for merges */
+} radix_job;
+
+/* Sort src[:n1] in place, using dst[:n1] as scratch */
+static void *
+radix_sort_job(void *arg)
+{
+    radix_job *job = (radix_job *)arg;
+    radix_item *sorted = radix_sort_items(job->src, job->dst, job->n1);
+    if (sorted != job->src)
+        memcpy(job->src, sorted, job->n1 * sizeof(radix_item));
+    return NULL;
+}
+
+/* Merge the sorted runs src[:n1] and src[n1:n1+n2] into dst: on equal
+ * keys the first run wins, so that the merge is stable. */
+static void *
+radix_merge_job(void *arg)
+{
+    radix_job *job = (radix_job *)arg;
+    radix_item *a = job->src, *aend = a + job->n1;
+    radix_item *b = aend, *bend = b + job->n2;
+    radix_item *dst = job->dst;
+
+    while (a < aend && b < bend)
+        *dst++ = (b->key < a->key) ? *b++ : *a++;
+    memcpy(dst, a, (aend - a) * sizeof(radix_item));
+    dst += aend - a;
+    memcpy(dst, b, (bend - b) * sizeof(radix_item));
+    return NULL;
+}
+
+static void
+radix_run_jobs(void *(*func)(void *), radix_job *jobs, int njobs)
+{
+#ifdef HAVE_PTHREAD_H
+    pthread_t threads[RADIX_MAX_THREADS];
+    int started[RADIX_MAX_THREADS];
+    int i;
+
+    for (i = 1; i < njobs; i++) {
+        started[i] = pthread_create(&threads[i], NULL, func, &jobs[i]) == 0;
+    }
+    func(&jobs[0]);
+    for (i = 1; i < njobs; i++) {
+        if (started[i])
+            pthread_join(threads[i], NULL);
+        else
+            func(&jobs[i]);
+    }
+#else
+    for (int i = 0; i < njobs; i++) {
+        func(&jobs[i]);
+    }
+#endif
+}
+
+/* Sort items[:n] with up to nthreads threads, using items[n:2*n] as
+ * scratch.  Return where the sorted items ended up. */
+static radix_item *
+radix_sort_parallel(radix_item *items, Py_ssize_t n, int nthreads)
+{
+    radix_job jobs[RADIX_MAX_THREADS];
+    Py_ssize_t starts[RADIX_MAX_THREADS + 1];
+    radix_item *src = items, *dst = items + n, *tmp;
+    int i, nchunks;
+
+    nchunks = (int)Py_MIN(nthreads, n / RADIX_PARALLEL_MIN);
+    nchunks = Py_MIN(nchunks, RADIX_MAX_THREADS);
+    if (nchunks <= 1)
+        return radix_sort_items(items, items + n, n);
+
+    for (i = 0; i <= nchunks; i++) {
+        starts[i] = n / nchunks * i + Py_MIN(i, n % nchunks);
+    }
+    for (i = 0; i < nchunks; i++) {
+        jobs[i].src = src + starts[i];
+        jobs[i].dst = dst + starts[i];
+        jobs[i].n1 = starts[i+1] - starts[i];
+        jobs[i].n2 = 0;
+    }
+    radix_run_jobs(radix_sort_job, jobs, nchunks);
+
+    while (nchunks > 1) {
+        int njobs = 0;
+        for (i = 0; i < nchunks; i += 2) {
+            Py_ssize_t end = starts[Py_MIN(i + 2, nchunks)];
+            jobs[njobs].src = src + starts[i];
+            jobs[njobs].dst = dst + starts[i];
+            jobs[njobs].n1 = starts[i+1] - starts[i];
+            jobs[njobs].n2 = end - starts[i+1];
+            starts[njobs++] = starts[i];
+        }
+        starts[njobs] = n;
+        radix_run_jobs(radix_merge_job, jobs, njobs);
+        nchunks = njobs;
+        tmp = src;
+        src = dst;
+        dst = tmp;
+    }
+    return src;
+}
+
+static int
+radix_sort(MergeState *ms, sortslice *lo, Py_ssize_t n, int long_keys,
+           int nthreads)
+{
+    radix_item *items, *sorted;
+    PyObject **perm;
+    Py_ssize_t i, prefix = 0;
+    int descending, resolved = 1;
+
+    /* Leave runs to the merge sort, which finds them in linear time */
+    if (count_run(ms, lo->keys, lo->keys + n, &descending) == n)
+        return 0;
+
+    items = PyMem_New(radix_item, 2 * n);
+    if (items == NULL)
+        return 0;
+
+    if (long_keys) {
+        int64_t min = 0;
+        for (i = 0; i < n; i++) {
+            PyLongObject *v = (PyLongObject *)lo->keys[i];
+            Py_ssize_t j = Py_ABS(Py_SIZE(v));
+            int64_t x = 0;
+            while (--j >= 0)
+                x = (x << PyLong_SHIFT) | v->ob_digit[j];
+            if (Py_SIZE(v) < 0)
+                x = -x;
+            if (i == 0 || x < min)
+                min = x;
+            items[i].key = (uint64_t)x;
+            items[i].index = i;
+        }
+        for (i = 0; i < n; i++) {
+            items[i].key -= (uint64_t)min;
+        }
+    }
+    else if (ms->key_compare == unsafe_float_compare) {
+        for (i = 0; i < n; i++) {
+            double x = PyFloat_AsDouble(lo->keys[i]);
+            uint64_t bits;
+            if (Py_IS_NAN(x)) {
+                PyMem_Free(items);
+                return 0;
+            }
+            if (x == 0.0)
+                x = 0.0;                /* -0.0 == 0.0 */
+            memcpy(&bits, &x, sizeof(bits));
+            items[i].key = (bits >> 63) ? ~bits : bits | ((uint64_t)1 << 63);
+            items[i].index = i;
+        }
+    }
+    else {
+        assert(ms->key_compare == unsafe_latin_compare);
+        const char *first = PyString_AsChar(lo->keys[0]);
+        prefix = PyString_Size(lo->keys[0]);
+        for (i = 1; i < n && prefix > 0; i++) {
+            const char *s = PyString_AsChar(lo->keys[i]);
+            Py_ssize_t j, len = Py_MIN(prefix, PyString_Size(lo->keys[i]));
+            for (j = 0; j < len && s[j] == first[j]; j++)
+                ;
+            prefix = j;
+        }
+        for (i = 0; i < n; i++) {
+            const unsigned char *s =
+                (const unsigned char *)PyString_AsChar(lo->keys[i]);
+            Py_ssize_t j, len = PyString_Size(lo->keys[i]) - prefix;
+            uint64_t key = 0;
+            for (j = 0; j < 8; j++) {
+                key = (key << 8) | (j < len ? s[prefix + j] : 0);
+            }
+            items[i].key = key;
+            items[i].index = i;
+        }
+    }
+
+    sorted = radix_sort_parallel(items, n, nthreads);
+
+    if (ms->key_compare == unsafe_latin_compare) {
+        /* Equal keys only mean equal strings if both end within them */
+        for (i = 1; i < n && resolved; i++) {
+            if (sorted[i].key == sorted[i-1].key) {
+                Py_ssize_t len1 = PyString_Size(lo->keys[sorted[i-1].index]);
+                Py_ssize_t len2 = PyString_Size(lo->keys[sorted[i].index]);
+                resolved = len1 == len2 && len1 <= prefix + 8;
+            }
+        }
+    }
+
+    /* The other half of items is free: use it to permute */
+    perm = (PyObject **)(sorted == items ? items + n : items);
+    for (i = 0; i < n; i++) {
+        perm[i] = lo->keys[sorted[i].index];
+    }
+    if (lo->values != NULL) {
+        for (i = 0; i < n; i++) {
+            perm[n + i] = lo->values[sorted[i].index];
+        }
+        memcpy(lo->values, perm + n, n * sizeof(PyObject *));
+    }
+    memcpy(lo->keys, perm, n * sizeof(PyObject *));
+    PyMem_Free(items);
+    return resolved;
+}
+
 /* An adaptive, stable, natural mergesort.  See listsort.txt.
  * Returns Py_None on success, NULL on error.  Even in case of error, the
  * list will be some permutation of its input state (nothing is lost or
@@ -2456,6 +2797,7 @@ list.sort
     *
     key as keyfunc: object = None
     reverse: bool(accept={int}) = False
+    parallel: int = 1
 
 Sort the list in ascending order and return None.
 
@@ -2466,11 +2808,15 @@ If a key function is given, apply it once to each list item and sort them,
 ascending or descending, according to their function values.
 
 The reverse flag can be set to sort in descending order.
+
+If parallel is greater than 1, a large list whose keys are all ints, all
+floats or all strings is sorted by up to that many threads.
 [clinic start generated code]*/
 
 static PyObject *
-list_sort_impl(PyListObject *self, PyObject *keyfunc, int reverse)
-/*[clinic end generated code: output=57b9f9c5e23fbe42 input=cb56cd179a713060]*/
+list_sort_impl(PyListObject *self, PyObject *keyfunc, int reverse,
+               int parallel)
+/*[clinic end generated code: output=9d46a93c53c0d19d input=fbad1971828761df]*/
 {
     MergeState ms;
     Py_ssize_t nremaining;
@@ -2482,11 +2828,16 @@ list_sort_impl(PyListObject *self, PyObject *keyfunc, int reverse)
     PyObject *result = NULL;            /* guilty until proved innocent */
     Py_ssize_t i;
     PyObject **keys;
+    int radix_longs = 0;
 
     assert(self != NULL);
     assert(PyList_Check(self));
     if (keyfunc == Py_None)
         keyfunc = NULL;
+    if (parallel < 1) {
+        PyErr_SetString(PyExc_ValueError, "parallel must be at least 1");
+        return NULL;
+    }
 
     /* The list is temporarily made empty, so that mutations performed
      * by comparison functions can't affect the slice of memory we're
@@ -2549,6 +2900,7 @@ list_sort_impl(PyListObject *self, PyObject *keyfunc, int reverse)
         int keys_are_all_same_type = 1;
         int strings_are_latin = 1;
         int ints_are_bounded = 1;
+        int ints_fit_radix = 1;
 
         /* Prove that assumption by checking every key. */
         for (i=0; i < saved_ob_size; i++) {
@@ -2578,10 +2930,12 @@ list_sort_impl(PyListObject *self, PyObject *keyfunc, int reverse)
 
             if (keys_are_all_same_type) {
                 if (key_type == &PyLong_Type &&
-                    ints_are_bounded &&
+                    ints_fit_radix &&
                     Py_ABS(Py_SIZE(key)) > 1) {
 
                     ints_are_bounded = 0;
+                    if (Py_ABS(Py_SIZE(key)) * PyLong_SHIFT > 62)
+                        ints_fit_radix = 0;
                 }
 	    }
 	    
@@ -2589,6 +2943,8 @@ list_sort_impl(PyListObject *self, PyObject *keyfunc, int reverse)
 
         /* Choose the best compare, given what we now know about the keys. */
         if (keys_are_all_same_type) {
+            radix_longs = (key_type == &PyLong_Type && ints_fit_radix &&
+                           !keys_are_in_tuples);
 
             if (key_type == &PyString_Type && strings_are_latin) {
                 ms.key_compare = unsafe_latin_compare;
@@ -2639,6 +2995,13 @@ list_sort_impl(PyListObject *self, PyObject *keyfunc, int reverse)
         reverse_slice(&saved_ob_item[0], &saved_ob_item[saved_ob_size]);
     }
 
+    if (saved_ob_size >= RADIX_SORT_MIN &&
+        (radix_longs ||
+         ms.key_compare == unsafe_float_compare ||
+         ms.key_compare == unsafe_latin_compare) &&
+        radix_sort(&ms, &lo, saved_ob_size, radix_longs, parallel))
+        goto succeed;
+
     /* March over the array once, left to right, finding natural runs,
      * and extending short natural runs to minrun elements.
      */
@@ -2732,7 +3095,7 @@ PyList_Sort(PyObject *v)
         PyErr_BadInternalCall();
         return -1;
     }
-    v = list_sort_impl((PyListObject *)v, NULL, 0);
+    v = list_sort_impl((PyListObject *)v, NULL, 0, 1);
     if (v == NULL)
         return -1;
     Py_DECREF(v);
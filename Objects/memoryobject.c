@@ -0,0 +1,505 @@
+/* Memoryview object implementation
+
+   A memoryview holds a buffer exported by its base object and covers
+   view.len bytes at view.buf.  Slicing it exports another buffer from the
+   same base and narrows it to the slice, so no bytes are copied; the base
+   keeps the bytes in place until every memoryview on them is released.
+
+   Only contiguous views of unsigned bytes are supported: a memoryview
+   behaves like a sequence of ints in range(0, 256), and slices must have
+   a step of 1. */
+
+#include "Python.h"
+
+typedef struct {
+    PyObject_HEAD
+    Py_buffer view;             /* view.obj is NULL once released */
+    Py_ssize_t exports;         /* number of buffers exported from here */
+} PyMemoryViewObject;
+
+#define IS_RELEASED(mv) (((PyMemoryViewObject *)(mv))->view.obj == NULL)
+
+#define CHECK_RELEASED(mv) \
+    if (IS_RELEASED(mv)) {                                                \
+        PyErr_SetString(PyExc_ValueError,                                 \
+            "operation forbidden on released memoryview object");         \
+        return NULL;                                                      \
+    }
+
+#define CHECK_RELEASED_INT(mv) \
+    if (IS_RELEASED(mv)) {                                                \
+        PyErr_SetString(PyExc_ValueError,                                 \
+            "operation forbidden on released memoryview object");         \
+        return -1;                                                        \
+    }
+
+int PyMemoryView_Check(PyObject *op) {
+  return Py_IS_TYPE(op, &PyMemoryView_Type);
+}
+
+PyObject *
+PyMemoryView_FromObject(PyObject *base)
+{
+    PyMemoryViewObject *mv;
+
+    if (!PyObject_CheckBuffer(base)) {
+        PyErr_Format(PyExc_TypeError,
+            "memoryview: a bytes-like object is required, not '%.200s'",
+            Py_TYPE(base)->tp_name);
+        return NULL;
+    }
+    mv = PyObject_New(PyMemoryViewObject, &PyMemoryView_Type);
+    if (mv == NULL)
+        return NULL;
+    mv->view.obj = NULL;
+    mv->exports = 0;
+    if (PyObject_GetBuffer(base, &mv->view, PyBUF_SIMPLE) < 0) {
+        Py_DECREF(mv);
+        return NULL;
+    }
+    return (PyObject *)mv;
+}
+
+/* Return a memoryview of self[start:start+len], sharing the bytes */
+static PyObject *
+memory_slice(PyMemoryViewObject *self, Py_ssize_t start, Py_ssize_t len)
+{
+    PyMemoryViewObject *mv;
+
+    mv = PyObject_New(PyMemoryViewObject, &PyMemoryView_Type);
+    if (mv == NULL)
+        return NULL;
+    mv->view.obj = NULL;
+    mv->exports = 0;
+    /* A second export of the base pins the same bytes */
+    if (PyObject_GetBuffer(self->view.obj, &mv->view, PyBUF_SIMPLE) < 0) {
+        Py_DECREF(mv);
+        return NULL;
+    }
+    mv->view.buf = (char *)self->view.buf + start;
+    mv->view.len = len;
+    mv->view.readonly = self->view.readonly;
+    return (PyObject *)mv;
+}
+
+static PyObject *
+memory_new(PyTypeObject *subtype, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"object", NULL};
+    PyObject *obj;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O:memoryview", kwlist,
+                                     &obj))
+        return NULL;
+    return PyMemoryView_FromObject(obj);
+}
+
+static void
+memory_dealloc(PyMemoryViewObject *self)
+{
+    assert(self->exports == 0);
+    PyBuffer_Release(&self->view);
+    PyMem_Free(self);
+}
+
+static int
+memory_getbuf(PyMemoryViewObject *self, Py_buffer *view, int flags)
+{
+    CHECK_RELEASED_INT(self);
+
+    if ((flags & PyBUF_WRITABLE) && self->view.readonly) {
+        PyErr_SetString(PyExc_BufferError,
+            "memoryview: underlying buffer is not writable");
+        return -1;
+    }
+    if (PyBuffer_FillInfo(view, (PyObject *)self, self->view.buf,
+                          self->view.len, self->view.readonly, flags) < 0)
+        return -1;
+    self->exports++;
+    return 0;
+}
+
+static void
+memory_releasebuf(PyMemoryViewObject *self, Py_buffer *view)
+{
+    self->exports--;
+}
+
+static PyBufferProcs memory_as_buffer = {
+    (getbufferproc)memory_getbuf,         /* bf_getbuffer */
+    (releasebufferproc)memory_releasebuf, /* bf_releasebuffer */
+};
+
+
+/**************************************************************************/
+/*                          Methods                                       */
+/**************************************************************************/
+
+PyDoc_STRVAR(memory_release_doc,
+"release($self, /)\n--\n\
+\n\
+Release the underlying buffer exposed by the memoryview object.");
+
+static PyObject *
+memory_release(PyMemoryViewObject *self, PyObject *noargs)
+{
+    if (IS_RELEASED(self))
+        Py_RETURN_NONE;
+    if (self->exports > 0) {
+        PyErr_Format(PyExc_BufferError,
+            "memoryview has %zd exported buffer%s", self->exports,
+            self->exports == 1 ? "" : "s");
+        return NULL;
+    }
+    PyBuffer_Release(&self->view);
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+memory_enter(PyObject *self, PyObject *args)
+{
+    CHECK_RELEASED(self);
+    Py_INCREF(self);
+    return self;
+}
+
+static PyObject *
+memory_exit(PyObject *self, PyObject *args)
+{
+    return memory_release((PyMemoryViewObject *)self, NULL);
+}
+
+PyDoc_STRVAR(memory_tobytes_doc,
+"tobytes($self, /)\n--\n\
+\n\
+Return the data in the buffer as a string.");
+
+static PyObject *
+memory_tobytes(PyMemoryViewObject *self, PyObject *noargs)
+{
+    CHECK_RELEASED(self);
+    return PyString_FromStringAndSize(self->view.buf, self->view.len);
+}
+
+PyDoc_STRVAR(memory_tolist_doc,
+"tolist($self, /)\n--\n\
+\n\
+Return the data in the buffer as a list of ints.");
+
+static PyObject *
+memory_tolist(PyMemoryViewObject *self, PyObject *noargs)
+{
+    const unsigned char *buf;
+    PyObject *list;
+    Py_ssize_t i;
+
+    CHECK_RELEASED(self);
+    buf = self->view.buf;
+    list = PyList_New(self->view.len);
+    if (list == NULL)
+        return NULL;
+    for (i = 0; i < self->view.len; i++) {
+        PyObject *item = PyLong_FromLong(buf[i]);
+        if (item == NULL) {
+            Py_DECREF(list);
+            return NULL;
+        }
+        PyList_Items(list)[i] = item;
+    }
+    return list;
+}
+
+static PyObject *
+memory_repr(PyMemoryViewObject *self)
+{
+    if (IS_RELEASED(self))
+        return PyString_FromFormat("<released memory at %p>", self);
+    else
+        return PyString_FromFormat("<memory at %p>", self);
+}
+
+
+/**************************************************************************/
+/*                          Indexing and slicing                          */
+/**************************************************************************/
+
+static Py_ssize_t
+memory_length(PyMemoryViewObject *self)
+{
+    CHECK_RELEASED_INT(self);
+    return self->view.len;
+}
+
+static PyObject *
+memory_item(PyMemoryViewObject *self, Py_ssize_t index)
+{
+    CHECK_RELEASED(self);
+    if (index < 0 || index >= self->view.len) {
+        PyErr_SetString(PyExc_IndexError, "index out of bounds");
+        return NULL;
+    }
+    return PyLong_FromLong(((unsigned char *)self->view.buf)[index]);
+}
+
+/* Parse a slice with a step of 1; return -1 on error */
+static int
+memory_unpack_slice(PyMemoryViewObject *self, PyObject *key,
+                    Py_ssize_t *start, Py_ssize_t *len)
+{
+    Py_ssize_t stop, step;
+
+    if (PySlice_Unpack(key, start, &stop, &step) < 0)
+        return -1;
+    if (step != 1) {
+        PyErr_SetString(PyExc_NotImplementedError,
+            "memoryview: slices with a step other than 1 are not supported");
+        return -1;
+    }
+    *len = PySlice_AdjustIndices(self->view.len, start, &stop, step);
+    return 0;
+}
+
+static PyObject *
+memory_subscript(PyMemoryViewObject *self, PyObject *key)
+{
+    CHECK_RELEASED(self);
+
+    if (PyIndex_Check(key)) {
+        Py_ssize_t index = PyNumber_AsSsize_t(key, PyExc_IndexError);
+        if (index == -1 && PyErr_Occurred())
+            return NULL;
+        if (index < 0)
+            index += self->view.len;
+        return memory_item(self, index);
+    }
+    else if (PySlice_Check(key)) {
+        Py_ssize_t start, len;
+        if (memory_unpack_slice(self, key, &start, &len) < 0)
+            return NULL;
+        return memory_slice(self, start, len);
+    }
+
+    PyErr_SetString(PyExc_TypeError, "memoryview: invalid slice key");
+    return NULL;
+}
+
+static int
+memory_ass_sub(PyMemoryViewObject *self, PyObject *key, PyObject *value)
+{
+    char *buf = self->view.buf;
+    Py_buffer src;
+    Py_ssize_t start, len;
+
+    CHECK_RELEASED_INT(self);
+    if (self->view.readonly) {
+        PyErr_SetString(PyExc_TypeError, "cannot modify read-only memory");
+        return -1;
+    }
+    if (value == NULL) {
+        PyErr_SetString(PyExc_TypeError, "cannot delete memory");
+        return -1;
+    }
+
+    if (PyIndex_Check(key)) {
+        Py_ssize_t index = PyNumber_AsSsize_t(key, PyExc_IndexError);
+        Py_ssize_t byte;
+        if (index == -1 && PyErr_Occurred())
+            return -1;
+        if (index < 0)
+            index += self->view.len;
+        if (index < 0 || index >= self->view.len) {
+            PyErr_SetString(PyExc_IndexError, "index out of bounds");
+            return -1;
+        }
+        byte = PyNumber_AsSsize_t(value, NULL);
+        if (byte == -1 && PyErr_Occurred())
+            return -1;
+        if (byte < 0 || byte > 255) {
+            PyErr_SetString(PyExc_ValueError,
+                            "memoryview: invalid value for format 'B'");
+            return -1;
+        }
+        buf[index] = (char)byte;
+        return 0;
+    }
+    if (!PySlice_Check(key)) {
+        PyErr_SetString(PyExc_TypeError, "memoryview: invalid slice key");
+        return -1;
+    }
+    if (memory_unpack_slice(self, key, &start, &len) < 0)
+        return -1;
+    if (PyObject_GetBuffer(value, &src, PyBUF_SIMPLE) < 0)
+        return -1;
+    if (src.len != len) {
+        PyErr_SetString(PyExc_ValueError,
+            "memoryview assignment: lvalue and rvalue have different "
+            "structures");
+        PyBuffer_Release(&src);
+        return -1;
+    }
+    /* The source may overlap, e.g. m[1:] = m[:-1] */
+    memmove(buf + start, src.buf, len);
+    PyBuffer_Release(&src);
+    return 0;
+}
+
+static PyMappingMethods memory_as_mapping = {
+    (lenfunc)memory_length,               /* mp_length */
+    (binaryfunc)memory_subscript,         /* mp_subscript */
+    (objobjargproc)memory_ass_sub,        /* mp_ass_subscript */
+};
+
+static PySequenceMethods memory_as_sequence = {
+        (lenfunc)memory_length,           /* sq_length */
+        0,                                /* sq_concat */
+        0,                                /* sq_repeat */
+        (ssizeargfunc)memory_item,        /* sq_item */
+};
+
+
+/**************************************************************************/
+/*                             Comparisons                                */
+/**************************************************************************/
+
+static PyObject *
+memory_richcompare(PyObject *v, PyObject *w, int op)
+{
+    Py_buffer vv, ww;
+    int equal;
+
+    if (op != Py_EQ && op != Py_NE)
+        Py_RETURN_NOTIMPLEMENTED;
+    if (v == w) {
+        equal = 1;
+        goto result;
+    }
+    /* A released view only equals itself */
+    if (IS_RELEASED(v) ||
+        (PyMemoryView_Check(w) && IS_RELEASED(w))) {
+        equal = 0;
+        goto result;
+    }
+    if (!PyObject_CheckBuffer(w))
+        Py_RETURN_NOTIMPLEMENTED;
+    if (PyObject_GetBuffer(v, &vv, PyBUF_SIMPLE) < 0)
+        return NULL;
+    if (PyObject_GetBuffer(w, &ww, PyBUF_SIMPLE) < 0) {
+        PyBuffer_Release(&vv);
+        return NULL;
+    }
+    equal = vv.len == ww.len &&
+            (vv.len == 0 || memcmp(vv.buf, ww.buf, vv.len) == 0);
+    PyBuffer_Release(&vv);
+    PyBuffer_Release(&ww);
+
+  result:
+    if ((equal && op == Py_EQ) || (!equal && op == Py_NE))
+        Py_RETURN_TRUE;
+    else
+        Py_RETURN_FALSE;
+}
+
+
+/**************************************************************************/
+/*                                Getters                                 */
+/**************************************************************************/
+
+static PyObject *
+memory_obj_get(PyMemoryViewObject *self, void *Py_UNUSED(ignored))
+{
+    PyObject *obj = self->view.obj;
+
+    CHECK_RELEASED(self);
+    Py_INCREF(obj);
+    return obj;
+}
+
+static PyObject *
+memory_nbytes_get(PyMemoryViewObject *self, void *Py_UNUSED(ignored))
+{
+    CHECK_RELEASED(self);
+    return PyLong_FromSsize_t(self->view.len);
+}
+
+static PyObject *
+memory_readonly_get(PyMemoryViewObject *self, void *Py_UNUSED(ignored))
+{
+    CHECK_RELEASED(self);
+    return PyBool_FromLong(self->view.readonly);
+}
+
+static PyObject *
+memory_released_get(PyMemoryViewObject *self, void *Py_UNUSED(ignored))
+{
+    return PyBool_FromLong(IS_RELEASED(self));
+}
+
+PyDoc_STRVAR(memory_obj_doc, "The underlying object of the memoryview.");
+PyDoc_STRVAR(memory_nbytes_doc, "The number of bytes in the memoryview.");
+PyDoc_STRVAR(memory_readonly_doc,
+             "A bool indicating whether the memory is read only.");
+PyDoc_STRVAR(memory_released_doc,
+             "A bool indicating whether the memoryview was released.");
+
+static PyGetSetDef memory_getsetlist[] = {
+    {"obj",             (getter)memory_obj_get,        NULL, memory_obj_doc},
+    {"nbytes",          (getter)memory_nbytes_get,     NULL, memory_nbytes_doc},
+    {"readonly",        (getter)memory_readonly_get,   NULL, memory_readonly_doc},
+    {"released",        (getter)memory_released_get,   NULL, memory_released_doc},
+    {NULL, NULL, NULL, NULL},
+};
+
+static PyMethodDef memory_methods[] = {
+    {"release",     (PyCFunction)memory_release, METH_NOARGS, memory_release_doc},
+    {"tobytes",     (PyCFunction)memory_tobytes, METH_NOARGS, memory_tobytes_doc},
+    {"tolist",      (PyCFunction)memory_tolist, METH_NOARGS, memory_tolist_doc},
+    {"__enter__",   memory_enter, METH_NOARGS, NULL},
+    {"__exit__",    memory_exit, METH_VARARGS, NULL},
+    {NULL,          NULL}
+};
+
+PyDoc_STRVAR(memory_doc,
+"memoryview(object)\n--\n\
+\n\
+Create a new memoryview object which references the given object.");
+
+PyTypeObject PyMemoryView_Type = {
+    PyVarObject_HEAD_INIT(&PyType_Type, 0)
+    "memoryview",                             /* tp_name */
+    sizeof(PyMemoryViewObject),               /* tp_basicsize */
+    0,                                        /* tp_itemsize */
+    (destructor)memory_dealloc,               /* tp_dealloc */
+    0,                                        /* tp_vectorcall_offset */
+    0,                                        /* tp_getattr */
+    0,                                        /* tp_setattr */
+    0,                                        /* tp_as_async */
+    (reprfunc)memory_repr,                    /* tp_repr */
+    0,                                        /* tp_as_number */
+    &memory_as_sequence,                      /* tp_as_sequence */
+    &memory_as_mapping,                       /* tp_as_mapping */
+    PyObject_HashNotImplemented,              /* tp_hash */
+    0,                                        /* tp_call */
+    0,                                        /* tp_str */
+    PyObject_GenericGetAttr,                  /* tp_getattro */
+    0,                                        /* tp_setattro */
+    &memory_as_buffer,                        /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT,                       /* tp_flags */
+    memory_doc,                               /* tp_doc */
+    0,                                        /* tp_traverse */
+    0,                                        /* tp_clear */
+    memory_richcompare,                       /* tp_richcompare */
+    0,                                        /* tp_weaklistoffset */
+    0,                                        /* tp_iter */
+    0,                                        /* tp_iternext */
+    memory_methods,                           /* tp_methods */
+    0,                                        /* tp_members */
+    memory_getsetlist,                        /* tp_getset */
+    0,                                        /* tp_base */
+    0,                                        /* tp_dict */
+    0,                                        /* tp_descr_get */
+    0,                                        /* tp_descr_set */
+    0,                                        /* tp_dictoffset */
+    0,                                        /* tp_init */
+    0,                                        /* tp_alloc */
+    memory_new,                               /* tp_new */
+};
@@ -4,6 +4,7 @@
 #include "Python.h"
 #include "pycore_ceval.h"         // _Py_EnterRecursiveCall()
 #include "pycore_initconfig.h"
+#include "pycore_lazyimport.h"    // _PyLazyImport_Type
 #include "pycore_object.h"
 #include "pycore_pyerrors.h"
 #include "pycore_pylifecycle.h"
@@ -1457,6 +1458,8 @@ _PyTypes_Init(void)
     INIT_TYPE(&PyDictRevIterItem_Type, "reversed dict items");
     INIT_TYPE(&PySet_Type, "set");
     INIT_TYPE(&PyString_Type, "str");
+    INIT_TYPE(&PyByteArray_Type, "bytearray");
+    INIT_TYPE(&PyMemoryView_Type, "memoryview");
     INIT_TYPE(&PySlice_Type, "slice");
     INIT_TYPE(&PyStaticMethod_Type, "static method");
     INIT_TYPE(&PyFloat_Type, "float");
@@ -1487,6 +1490,7 @@ _PyTypes_Init(void)
     INIT_TYPE(&PyMethodDescr_Type, "method descr");
     INIT_TYPE(&PyCallIter_Type, "call iter");
     INIT_TYPE(&PySeqIter_Type, "sequence iterator");
+    INIT_TYPE(&_PyLazyImport_Type, "lazy import");
     return _PyStatus_OK();
 
 #undef INIT_TYPE
@@ -51,6 +51,11 @@ either entry->key==dummy or by entry->hash==-1.
 
 #define PySet_MINSIZE 8
 
+/* Most keys _PySet_Reserve() makes room for from an inexact size; a
+   length hint can be wrong, so past this the table grows as keys are
+   really added. */
+#define PySet_MAXPRESIZE (64 * 1024)
+
 typedef struct {
     PyObject *key;
     Py_hash_t hash;             /* Cached hash code of the key */
@@ -289,6 +294,31 @@ set_insert_clean(setentry *table, size_t mask, PyObject *key, Py_hash_t hash)
     entry->hash = hash;
 }
 
+/* Bulk operations between sets and dicts reuse the hashes stored in the
+   dict entries.  When they add or look up the keys of a dict in a set, the
+   bucket of the key SET_PREFETCH_DISTANCE entries ahead is loaded while
+   the current one is probed for, so that large tables do not wait for one
+   cache miss after the other. */
+#define SET_PREFETCH_DISTANCE 8
+
+#if defined(__GNUC__) || defined(__clang__)
+#  define SET_PREFETCH(so, hash) \
+    __builtin_prefetch(&(so)->table[(size_t)(hash) & (size_t)(so)->mask])
+#else
+#  define SET_PREFETCH(so, hash)
+#endif
+
+/* Prefetch the bucket of the next key of dict from position *ahead */
+static inline void
+set_prefetch_dict_key(PySetObject *so, PyObject *dict, Py_ssize_t *ahead)
+{
+    Py_hash_t hash;
+
+    if (_PyDict_Next(dict, ahead, NULL, NULL, &hash)) {
+        SET_PREFETCH(so, hash);
+    }
+}
+
 /* ======== End logic for probing the hash table ========================== */
 /* ======================================================================== */
 
@@ -620,6 +650,28 @@ set_len(PyObject *so)
     return ((PySetObject *)so)->used;
 }
 
+/* Make room for n more keys, so that adding them does not resize the
+   table.  Unless n is exact (see _PyObject_PresizeHint()) it may be a
+   wrong guess: it is then capped at PySet_MAXPRESIZE, and the table grows
+   past that as keys come. */
+int
+_PySet_Reserve(PyObject *op, Py_ssize_t n, int exact)
+{
+    PySetObject *so = (PySetObject *)op;
+
+    assert(PyAnySet_Check(op));
+    if (!exact && n > PySet_MAXPRESIZE) {
+        n = PySet_MAXPRESIZE;
+    }
+    if (n <= 0 || n > PY_SSIZE_T_MAX / 5 - so->fill) {
+        return 0;
+    }
+    if ((so->fill + n)*5 >= so->mask*3) {
+        return set_table_resize(so, (so->used + n)*2);
+    }
+    return 0;
+}
+
 static int
 set_merge(PySetObject *so, PyObject *otherset)
 {
@@ -692,6 +744,29 @@ set_merge(PySetObject *so, PyObject *otherset)
     return 0;
 }
 
+/* Add the keys of an exact dict with the hashes stored in its entries */
+static int
+set_merge_dict(PySetObject *so, PyObject *dict)
+{
+    PyObject *key, *value;
+    Py_hash_t hash;
+    Py_ssize_t pos = 0, ahead = 0, i;
+    Py_ssize_t dictsize = PyDict_Size(dict);
+
+    if ((so->fill + dictsize)*5 >= so->mask*3) {
+        if (set_table_resize(so, (so->used + dictsize)*2) != 0)
+            return -1;
+    }
+    for (i = 0; i < SET_PREFETCH_DISTANCE; i++)
+        set_prefetch_dict_key(so, dict, &ahead);
+    while (_PyDict_Next(dict, &pos, &key, &value, &hash)) {
+        set_prefetch_dict_key(so, dict, &ahead);
+        if (set_add_entry(so, key, hash))
+            return -1;
+    }
+    return 0;
+}
+
 static PyObject *
 set_pop(PySetObject *so, PyObject *Py_UNUSED(ignored))
 {
@@ -927,15 +1002,27 @@ set_iter(PySetObject *so)
 static int
 set_update_internal(PySetObject *so, PyObject *other)
 {
-    PyObject *key, *it;
+    PyObject *key, *it, *dict;
 
     if (PyAnySet_Check(other))
         return set_merge(so, other);
+    if (PyDict_CheckExact(other))
+        return set_merge_dict(so, other);
+    if ((dict = _PyDictKeys_GetDict(other)) != NULL)
+        return set_merge_dict(so, dict);
     
     it = PyObject_GetIter(other);
     if (it == NULL)
         return -1;
 
+    /* Do one big resize at the start, as set_merge() does */
+    int exact;
+    Py_ssize_t n = _PyObject_PresizeHint(other, &exact);
+    if (n < 0 || _PySet_Reserve((PyObject *)so, n, exact) < 0) {
+        Py_DECREF(it);
+        return -1;
+    }
+
     while ((key = PyIter_Next(it)) != NULL) {
         if (set_add_key(so, key)) {
             Py_DECREF(it);
@@ -1204,11 +1291,52 @@ set_or(PySetObject *so, PyObject *other)
     return (PyObject *)result;
 }
 
+/* Add to result the keys of so which are also in an exact dict, iterating
+   over the smaller of the two with the hashes stored in it */
+static int
+set_intersection_dict(PySetObject *result, PySetObject *so, PyObject *dict)
+{
+    PyObject *key, *value;
+    Py_hash_t hash;
+    Py_ssize_t pos = 0, ahead = 0, i;
+    setentry *entry;
+    int rv;
+
+    if (PyDict_Size(dict) < so->used) {
+        for (i = 0; i < SET_PREFETCH_DISTANCE; i++)
+            set_prefetch_dict_key(so, dict, &ahead);
+        while (_PyDict_Next(dict, &pos, &key, &value, &hash)) {
+            set_prefetch_dict_key(so, dict, &ahead);
+            Py_INCREF(key);
+            rv = set_contains_entry(so, key, hash);
+            if (rv > 0)
+                rv = set_add_entry(result, key, hash) ? -1 : 0;
+            Py_DECREF(key);
+            if (rv < 0)
+                return -1;
+        }
+        return 0;
+    }
+
+    while (set_next(so, &pos, &entry)) {
+        key = entry->key;
+        hash = entry->hash;
+        Py_INCREF(key);
+        rv = _PyDict_Contains_KnownHash(dict, key, hash);
+        if (rv > 0)
+            rv = set_add_entry(result, key, hash) ? -1 : 0;
+        Py_DECREF(key);
+        if (rv < 0)
+            return -1;
+    }
+    return 0;
+}
+
 static PyObject *
 set_intersection(PySetObject *so, PyObject *other)
 {
     PySetObject *result;
-    PyObject *key, *it, *tmp;
+    PyObject *key, *it, *tmp, *dict;
     Py_hash_t hash;
     int rv;
 
@@ -1247,6 +1375,15 @@ set_intersection(PySetObject *so, PyObject *other)
         return (PyObject *)result;
     }
 
+    dict = PyDict_CheckExact(other) ? other : _PyDictKeys_GetDict(other);
+    if (dict != NULL) {
+        if (set_intersection_dict(result, so, dict)) {
+            Py_DECREF(result);
+            return NULL;
+        }
+        return (PyObject *)result;
+    }
+
     it = PyObject_GetIter(other);
     if (it == NULL) {
         Py_DECREF(result);
@@ -1395,9 +1532,53 @@ set_isdisjoint(PySetObject *so, PyObject *other)
 PyDoc_STRVAR(isdisjoint_doc,
 "Return True if two sets have a null intersection.");
 
+/* Discard from so the keys of an exact dict, with the hashes stored in
+   either of them */
+static int
+set_difference_update_dict(PySetObject *so, PyObject *dict)
+{
+    PyObject *key, *value;
+    Py_hash_t hash;
+    Py_ssize_t pos = 0, ahead = 0, i;
+    setentry *entry;
+    int rv;
+
+    /* As with sets, only look up the keys of so when the dict is more
+       than 8 times larger.  Discarding does not resize the table, so
+       set_next() can go on. */
+    if ((PyDict_Size(dict) >> 3) > so->used) {
+        while (set_next(so, &pos, &entry)) {
+            key = entry->key;
+            hash = entry->hash;
+            Py_INCREF(key);
+            rv = _PyDict_Contains_KnownHash(dict, key, hash);
+            if (rv > 0)
+                rv = set_discard_entry(so, key, hash);
+            Py_DECREF(key);
+            if (rv < 0)
+                return -1;
+        }
+        return 0;
+    }
+
+    for (i = 0; i < SET_PREFETCH_DISTANCE; i++)
+        set_prefetch_dict_key(so, dict, &ahead);
+    while (_PyDict_Next(dict, &pos, &key, &value, &hash)) {
+        set_prefetch_dict_key(so, dict, &ahead);
+        Py_INCREF(key);
+        rv = set_discard_entry(so, key, hash);
+        Py_DECREF(key);
+        if (rv < 0)
+            return -1;
+    }
+    return 0;
+}
+
 static int
 set_difference_update_internal(PySetObject *so, PyObject *other)
 {
+    PyObject *dict;
+
     if ((PyObject *)so == other)
         return set_clear_internal(so);
 
@@ -1424,6 +1605,10 @@ set_difference_update_internal(PySetObject *so, PyObject *other)
             }
 
         Py_DECREF(other);
+    } else if ((dict = PyDict_CheckExact(other) ? other
+                       : _PyDictKeys_GetDict(other)) != NULL) {
+        if (set_difference_update_dict(so, dict) < 0)
+            return -1;
     } else {
         PyObject *key, *it;
         it = PyObject_GetIter(other);
@@ -1483,6 +1668,7 @@ set_difference(PySetObject *so, PyObject *other)
 {
     PyObject *result;
     PyObject *key;
+    PyObject *dict = NULL;
     Py_hash_t hash;
     setentry *entry;
     Py_ssize_t pos = 0, other_size;
@@ -1491,6 +1677,10 @@ set_difference(PySetObject *so, PyObject *other)
     if (PyAnySet_Check(other)) {
         other_size = PySet_GET_SIZE(other);
     }
+    else if ((dict = PyDict_CheckExact(other) ? other
+                     : _PyDictKeys_GetDict(other)) != NULL) {
+        other_size = PyDict_Size(dict);
+    }
     else {
         return set_copy_and_difference(so, other);
     }
@@ -1508,7 +1698,14 @@ set_difference(PySetObject *so, PyObject *other)
     while (set_next(so, &pos, &entry)) {
         key = entry->key;
         hash = entry->hash;
-        rv = set_contains_entry((PySetObject *)other, key, hash);
+        if (dict != NULL) {
+            Py_INCREF(key);
+            rv = _PyDict_Contains_KnownHash(dict, key, hash);
+            Py_DECREF(key);
+        }
+        else {
+            rv = set_contains_entry((PySetObject *)other, key, hash);
+        }
         if (rv < 0) {
             Py_DECREF(result);
             return NULL;
@@ -3715,7 +3715,6 @@ tailmatch(PyObject *self,
     const void *data_self;
     const void *data_sub;
     Py_ssize_t offset;
-    Py_ssize_t i;
     Py_ssize_t end_sub;
 
 
@@ -3736,28 +3735,14 @@ tailmatch(PyObject *self,
     else
         offset = start;
 
-    if (PyUnicode_READ(data_self, offset) ==
-        PyUnicode_READ(data_sub, 0) &&
-        PyUnicode_READ(data_self, offset + end_sub) ==
+    /* Check the first and last characters before the whole substring */
+    if (PyUnicode_READ(data_self, offset) != PyUnicode_READ(data_sub, 0) ||
+        PyUnicode_READ(data_self, offset + end_sub) !=
         PyUnicode_READ(data_sub, end_sub)) {
-      return ! memcmp((char *)data_self +
-		      (offset),
-		      data_sub,
-		      PyUnicode_GET_LENGTH(substring));
-    } 
-        /* otherwise we have to compare each character by first accessing it */
-        else {
-            /* We do not need to compare 0 and len(substring)-1 because
-               the if statement above ensured already that they are equal
-               when we end up here. */
-            for (i = 1; i < end_sub; ++i) {
-                if (PyUnicode_READ(data_self, offset + i) !=
-                    PyUnicode_READ(data_sub, i))
-                    return 0;
-            }
-            return 1;
-        }
-    return 0;
+        return 0;
+    }
+    return !memcmp((const char *)data_self + offset, data_sub,
+                   PyUnicode_GET_LENGTH(substring));
 }
 
 Py_ssize_t
@@ -6811,6 +6796,19 @@ static PyMappingMethods unicode_as_mapping = {
     (objobjargproc)0,           /* mp_ass_subscript */
 };
 
+/* A string shares its characters read-only, e.g. with memoryview */
+static int
+unicode_getbuffer(PyObject *self, Py_buffer *view, int flags)
+{
+    return PyBuffer_FillInfo(view, self, ((PyUnicodeObject *)self)->data,
+                             PyUnicode_GET_SIZE(self), 1, flags);
+}
+
+static PyBufferProcs unicode_as_buffer = {
+    unicode_getbuffer,
+    NULL,
+};
+
 
 /* Helpers for PyUnicode_Format() */
 
@@ -7848,7 +7846,7 @@ PyTypeObject PyString_Type = {
     (reprfunc) unicode_str,       /* tp_str */
     PyObject_GenericGetAttr,      /* tp_getattro */
     0,                            /* tp_setattro */
-    0,                            /* tp_as_buffer */
+    &unicode_as_buffer,           /* tp_as_buffer */
     Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE |
     Py_TPFLAGS_UNICODE_SUBCLASS,   /* tp_flags */
     unicode_doc,                  /* tp_doc */
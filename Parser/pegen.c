@@ -3,6 +3,7 @@
 #include "tokenizer.h"
 
 #include "pegen.h"
+#include "pycore_compile.h"       // _PyCompile_StageStart()
 #include "string_parser.h"
 
 PyObject *
@@ -316,37 +317,115 @@ error:
     return NULL;
 }
 
-// Here, mark is the start of the node, while p->mark is the end.
-// If node==NULL, they should be the same.
-int
-_PyPegen_insert_memo(Parser *p, int mark, int type, void *node)
+// Memo arrays.  A token has few memos (3 on average on big files), and
+// they are looked up by a linear scan of its array: contiguous and
+// cache-friendly, unlike a list of nodes allocated one by one.
+
+#define MEMO_CHUNK_SLOTS 8192
+
+// Return an array of 2 << size_class slots
+static Memo *
+memo_pool_alloc(MemoPool *pool, int size_class)
 {
-    // Insert in front
-  Memo *m = (Memo *) malloc(sizeof(Memo));
-  if (m == NULL) {
-    return -1;
-  }
-  m->type = type;
-  m->node = node;
-  m->mark = p->mark;
-  m->next = p->tokens[mark]->memo;
-  p->tokens[mark]->memo = m;
-  return 0;
+    Memo *array = pool->free_arrays[size_class];
+    if (array != NULL) {
+        pool->free_arrays[size_class] = (Memo *)array->node;
+        return array;
+    }
+    Py_ssize_t len = (Py_ssize_t)2 << size_class;
+    if (pool->free_len < len) {
+        MemoChunk *chunk = PyMem_Malloc(sizeof(MemoChunk)
+                                        + (MEMO_CHUNK_SLOTS - 1) * sizeof(Memo));
+        if (chunk == NULL) {
+            return NULL;
+        }
+        chunk->next = pool->chunks;
+        pool->chunks = chunk;
+        pool->free_slot = chunk->slots;
+        pool->free_len = MEMO_CHUNK_SLOTS;
+    }
+    array = pool->free_slot;
+    pool->free_slot += len;
+    pool->free_len -= len;
+    return array;
 }
 
-// Like _PyPegen_insert_memo(), but updates an existing node if found.
+// Give back an array to be reused for another token
+static void
+memo_pool_release(MemoPool *pool, Memo *array, int size_class)
+{
+    array->node = pool->free_arrays[size_class];
+    pool->free_arrays[size_class] = array;
+}
+
+static void
+memo_pool_clear(MemoPool *pool)
+{
+    MemoChunk *chunk = pool->chunks;
+    while (chunk != NULL) {
+        MemoChunk *next = chunk->next;
+        PyMem_Free(chunk);
+        chunk = next;
+    }
+    memset(pool, 0, sizeof(*pool));
+}
+
+static int
+memo_grow(Parser *p, Token *t)
+{
+    int size_class = 0;
+    while ((2 << size_class) < t->memo_cap + 1) {
+        size_class++;
+    }
+    if (size_class >= MEMO_POOL_CLASSES) {
+        // More memos than rule types: cannot happen
+        PyErr_SetString(PyExc_SystemError, "too many memos for a token");
+        return -1;
+    }
+    Memo *array = memo_pool_alloc(&p->memo_pool, size_class);
+    if (array == NULL) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    if (t->memo_len > 0) {
+        memcpy(array, t->memo, t->memo_len * sizeof(Memo));
+        memo_pool_release(&p->memo_pool, t->memo, size_class - 1);
+    }
+    t->memo = array;
+    t->memo_cap = 2 << size_class;
+    return 0;
+}
+
+// Here, mark is the start of the node, while p->mark is the end.
+// If node==NULL, they should be the same.
 int
-_PyPegen_update_memo(Parser *p, int mark, int type, void *node)
+_PyPegen_insert_memo(Parser *p, int mark, int type, void *node)
 {
-    for (Memo *m = p->tokens[mark]->memo; m != NULL; m = m->next) {
+    Token *t = p->tokens[mark];
+    for (int i = 0; i < t->memo_len; i++) {
+        Memo *m = &t->memo[i];
         if (m->type == type) {
-            // Update existing node.
             m->node = node;
             m->mark = p->mark;
             return 0;
         }
     }
-    // Insert new node.
+    if (t->memo_len == t->memo_cap && memo_grow(p, t) < 0) {
+        p->error_indicator = 1;
+        return -1;
+    }
+    Memo *m = &t->memo[t->memo_len++];
+    m->type = type;
+    m->node = node;
+    m->mark = p->mark;
+    return 0;
+}
+
+// Like _PyPegen_insert_memo(), but updates an existing node if found.
+// _PyPegen_insert_memo() already does.
+int
+_PyPegen_update_memo(Parser *p, int mark, int type, void *node)
+{
     return _PyPegen_insert_memo(p, mark, type, node);
 }
 
@@ -466,6 +545,8 @@ _PyPegen_fill_token(Parser *p)
 
 #define NSTATISTICS 2000
 static long memo_statistics[NSTATISTICS];
+static long memo_lookups;
+static long memo_hits;
 
 void
 _PyPegen_clear_memo_statistics()
@@ -473,6 +554,15 @@ _PyPegen_clear_memo_statistics()
     for (int i = 0; i < NSTATISTICS; i++) {
         memo_statistics[i] = 0;
     }
+    memo_lookups = 0;
+    memo_hits = 0;
+}
+
+void
+_PyPegen_get_memo_hits(long *lookups, long *hits)
+{
+    *lookups = memo_lookups;
+    *hits = memo_hits;
 }
 
 PyObject *
@@ -509,8 +599,11 @@ _PyPegen_is_memoized(Parser *p, int type, void *pres)
 
     Token *t = p->tokens[p->mark];
 
-    for (Memo *m = t->memo; m != NULL; m = m->next) {
+    memo_lookups++;
+    for (int i = 0; i < t->memo_len; i++) {
+        Memo *m = &t->memo[i];
         if (m->type == type) {
+            memo_hits++;
             if (0 <= type && type < NSTATISTICS) {
                 long count = m->mark - p->mark;
                 // A memoized negative result counts for one.
@@ -782,6 +875,7 @@ void
 _PyPegen_Parser_Free(Parser *p)
 {
     Py_XDECREF(p->normalize);
+    memo_pool_clear(&p->memo_pool);
     for (int i = 0; i < p->size; i++) {
         PyMem_Free(p->tokens[i]);
     }
@@ -850,6 +944,7 @@ _PyPegen_Parser_New(struct tok_state *tok, int start_rule, int flags,
     p->feature_version = feature_version;
     p->known_err_token = NULL;
     p->level = 0;
+    memset(&p->memo_pool, 0, sizeof(p->memo_pool));
 
     return p;
 }
@@ -911,6 +1006,7 @@ _PyPegen_run_parser_from_file_pointer(FILE *fp, int start_rule, PyObject *filena
     mod_ty result = NULL;
 
     int parser_flags = compute_parser_flags(flags);
+    int64_t start = _PyCompile_StageStart();
     Parser *p = _PyPegen_Parser_New(tok, start_rule, parser_flags, PY_MINOR_VERSION,
                                     errcode);
     if (p == NULL) {
@@ -919,6 +1015,7 @@ _PyPegen_run_parser_from_file_pointer(FILE *fp, int start_rule, PyObject *filena
 
     result = _PyPegen_run_parser(p);
     _PyPegen_Parser_Free(p);
+    _PyCompile_StageEnd(_PyCompile_PARSE, start);
 
 error:
     PyTokenizer_Free(tok);
@@ -942,12 +1039,36 @@ _PyPegen_run_parser_from_file(const char *filename, int start_rule,
     return result;
 }
 
+/* Tokenize str on its own, for the compilation statistics */
+static void
+time_tokenize(const char *str, int exec_input)
+{
+    int64_t start = _PyCompile_StageStart();
+    struct tok_state *tok = PyTokenizer_FromString(str, exec_input);
+    if (tok == NULL) {
+        PyErr_Clear();
+        return;
+    }
+    const char *token_start, *token_end;
+    int type;
+    do {
+        type = PyTokenizer_Get(tok, &token_start, &token_end);
+    } while (type != ENDMARKER && type != ERRORTOKEN);
+    PyTokenizer_Free(tok);
+    PyErr_Clear();
+    _PyCompile_StageEnd(_PyCompile_TOKENIZE, start);
+}
+
 mod_ty
 _PyPegen_run_parser_from_string(const char *str, int start_rule, PyObject *filename_ob,
                        PyCompilerFlags *flags)
 {
     int exec_input = start_rule == Py_file_input;
 
+    if (_PyCompile_stats_enabled) {
+        time_tokenize(str, exec_input);
+    }
+
     struct tok_state *tok;
     tok = PyTokenizer_FromString(str, exec_input);
     if (tok == NULL) {
@@ -965,6 +1086,7 @@ _PyPegen_run_parser_from_string(const char *str, int start_rule, PyObject *filen
 
     int parser_flags = compute_parser_flags(flags);
     int feature_version = flags ? flags->cf_feature_version : PY_MINOR_VERSION;
+    int64_t start = _PyCompile_StageStart();
     Parser *p = _PyPegen_Parser_New(tok, start_rule, parser_flags, feature_version,
                                     NULL);
     if (p == NULL) {
@@ -973,6 +1095,7 @@ _PyPegen_run_parser_from_string(const char *str, int start_rule, PyObject *filen
 
     result = _PyPegen_run_parser(p);
     _PyPegen_Parser_Free(p);
+    _PyCompile_StageEnd(_PyCompile_PARSE, start);
 
 error:
     PyTokenizer_Free(tok);
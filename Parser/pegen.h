@@ -5,6 +5,7 @@
 #include <Python.h>
 #include <token.h>
 #include <Python-ast.h>
+#include "pegen_interface.h"
 
 #if 0
 #define PyPARSE_YIELD_IS_KEYWORD        0x0001
@@ -23,20 +24,42 @@
 #define PyPARSE_TYPE_COMMENTS 0x0040
 #define PyPARSE_ASYNC_HACKS   0x0080
 
-typedef struct _memo {
+/* Memoized result of the rule 'type' tried at a token: 'node', with the
+   parser advanced to the token 'mark'. */
+typedef struct {
     int type;
-    void *node;
     int mark;
-    struct _memo *next;
+    void *node;
 } Memo;
 
 typedef struct {
     int type;
     PyObject *bytes;
     int lineno, col_offset, end_lineno, end_col_offset;
+    /* Memos of the rules tried at this token: an array of memo_cap slots
+       allocated from the MemoPool of the Parser */
     Memo *memo;
+    int memo_len, memo_cap;
 } Token;
 
+/* Per-parse allocator of the Token memo arrays: arrays are carved out of
+   large chunks, which keeps the memos of neighbouring tokens close in
+   memory, and arrays outgrown by a token are recycled by size.  All the
+   memos are released with the Parser. */
+#define MEMO_POOL_CLASSES 8     /* arrays of 2, 4, ..., 256 slots */
+
+typedef struct _memo_chunk {
+    struct _memo_chunk *next;
+    Memo slots[1];
+} MemoChunk;
+
+typedef struct {
+    MemoChunk *chunks;
+    Memo *free_slot;            /* next free slot of chunks */
+    Py_ssize_t free_len;        /* number of free slots in chunks */
+    Memo *free_arrays[MEMO_POOL_CLASSES];
+} MemoPool;
+
 typedef struct {
     char *str;
     int type;
@@ -71,6 +94,7 @@ typedef struct {
     growable_comment_array type_ignore_comments;
     Token *known_err_token;
     int level;
+    MemoPool memo_pool;
 } Parser;
 
 typedef struct {
@@ -108,9 +132,6 @@ typedef struct {
     int is_keyword;
 } KeywordOrStarred;
 
-void _PyPegen_clear_memo_statistics(void);
-PyObject *_PyPegen_get_memo_statistics(void);
-
 int _PyPegen_insert_memo(Parser *p, int mark, int type, void *node);
 int _PyPegen_update_memo(Parser *p, int mark, int type, void *node);
 int _PyPegen_is_memoized(Parser *p, int type, void *pres);
@@ -29,6 +29,101 @@
 	      || c == '_')
 
 
+/* Bulk scanning of the current line
+
+   The helpers below return the first character of [p, end) which does not
+   belong to a class: they let tok_get() skip runs of indentation, comment
+   text, identifier characters and string contents inside the line already
+   buffered in [tok->cur, tok->inp), instead of calling tok_nextc() once per
+   character.  tok_nextc() is still used to cross into the next line, so
+   line numbers and buffer refills are unchanged.  With SSE2, 16 characters
+   are tested at a time. */
+
+#if defined(__SSE2__)
+#  include <emmintrin.h>
+#  define TOK_SCAN_SSE2
+#  define TOK_SCAN_WIDTH 16
+
+/* Index of the first zero bit of a 16-bit movemask (mask != 0xffff) */
+#  define FIRST_CLEAR(mask) __builtin_ctz(~(unsigned int)(mask))
+#endif
+
+static const char *
+scan_spaces(const char *p, const char *end)
+{
+#ifdef TOK_SCAN_SSE2
+    const __m128i space = _mm_set1_epi8(' ');
+    while (end - p >= TOK_SCAN_WIDTH) {
+        __m128i v = _mm_loadu_si128((const __m128i *)p);
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(v, space));
+        if (mask != 0xffff) {
+            return p + FIRST_CLEAR(mask);
+        }
+        p += TOK_SCAN_WIDTH;
+    }
+#endif
+    while (p < end && *p == ' ') {
+        p++;
+    }
+    return p;
+}
+
+static const char *
+scan_identifier(const char *p, const char *end)
+{
+#ifdef TOK_SCAN_SSE2
+    /* Unsigned range checks: x - lo <= hi - lo, as min(x - lo, hi - lo) */
+    const __m128i a = _mm_set1_epi8('a'), alpha_max = _mm_set1_epi8(25);
+    const __m128i zero = _mm_set1_epi8('0'), digit_max = _mm_set1_epi8(9);
+    const __m128i case_bit = _mm_set1_epi8(0x20);
+    const __m128i underscore = _mm_set1_epi8('_');
+    while (end - p >= TOK_SCAN_WIDTH) {
+        __m128i v = _mm_loadu_si128((const __m128i *)p);
+        __m128i x = _mm_sub_epi8(_mm_or_si128(v, case_bit), a);
+        __m128i ok = _mm_cmpeq_epi8(_mm_min_epu8(x, alpha_max), x);
+        x = _mm_sub_epi8(v, zero);
+        ok = _mm_or_si128(ok, _mm_cmpeq_epi8(_mm_min_epu8(x, digit_max), x));
+        ok = _mm_or_si128(ok, _mm_cmpeq_epi8(v, underscore));
+        int mask = _mm_movemask_epi8(ok);
+        if (mask != 0xffff) {
+            return p + FIRST_CLEAR(mask);
+        }
+        p += TOK_SCAN_WIDTH;
+    }
+#endif
+    while (p < end && is_potential_identifier_char(Py_CHARMASK(*p))) {
+        p++;
+    }
+    return p;
+}
+
+/* Stop at the quote, at a backslash or at the end of the line */
+static const char *
+scan_string_body(const char *p, const char *end, int quote)
+{
+#ifdef TOK_SCAN_SSE2
+    const __m128i q = _mm_set1_epi8((char)quote);
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i newline = _mm_set1_epi8('\n');
+    while (end - p >= TOK_SCAN_WIDTH) {
+        __m128i v = _mm_loadu_si128((const __m128i *)p);
+        __m128i stop = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(v, q), _mm_cmpeq_epi8(v, backslash)),
+            _mm_cmpeq_epi8(v, newline));
+        int mask = _mm_movemask_epi8(stop);
+        if (mask != 0) {
+            return p + __builtin_ctz((unsigned int)mask);
+        }
+        p += TOK_SCAN_WIDTH;
+    }
+#endif
+    while (p < end && *p != quote && *p != '\\' && *p != '\n') {
+        p++;
+    }
+    return p;
+}
+
+
 /* Don't ever change this -- it would break the portability of Python code */
 #define TABSIZE 8
 
@@ -158,6 +253,22 @@ decode_str(const char *input, int single, struct tok_state *tok)
     return str;
 }
 
+/* Return non-zero if STR is already in the form decode_str() would give,
+   so that the tokenizer can scan it in place: no "\r" to translate, and
+   exec input ending with a newline.  A source file memory-mapped by
+   _Py_MapSourceFile() is then tokenized without being copied. */
+
+static int
+scan_in_place(const char *str, int exec_input)
+{
+    size_t len = strlen(str);
+    if (memchr(str, '\r', len) != NULL)
+        return 0;
+    if (exec_input && (len == 0 || str[len - 1] != '\n'))
+        return 0;
+    return 1;
+}
+
 /* Set up tokenizer for string */
 
 struct tok_state *
@@ -168,10 +279,17 @@ PyTokenizer_FromString(const char *str, int exec_input)
 
     if (tok == NULL)
         return NULL;
-    decoded = decode_str(str, exec_input, tok);
-    if (decoded == NULL) {
-        PyTokenizer_Free(tok);
-        return NULL;
+    if (scan_in_place(str, exec_input)) {
+        /* The buffer is only read (tok_backup() never writes) and
+           tok->input stays NULL, so it is not freed */
+        decoded = (char *)str;
+    }
+    else {
+        decoded = decode_str(str, exec_input, tok);
+        if (decoded == NULL) {
+            PyTokenizer_Free(tok);
+            return NULL;
+        }
     }
 
     tok->buf = tok->cur = tok->inp = decoded;
@@ -398,9 +516,9 @@ tok_backup(struct tok_state *tok, int c)
         if (--tok->cur < tok->buf) {
             Py_FatalError("tokenizer beginning of buffer");
         }
-        if (*tok->cur != c) {
-            *tok->cur = c;
-        }
+        /* Only step back: the buffer may be a read-only mapping or the
+           caller's str, and c is always the character just read */
+        assert(Py_CHARMASK(*tok->cur) == c);
     }
 }
 
@@ -499,7 +617,11 @@ tok_get(struct tok_state *tok, const char **p_start, const char **p_end)
         for (;;) {
             c = tok_nextc(tok);
             if (c == ' ') {
-                col++, altcol++;
+                /* Take the rest of a run of spaces at once */
+                const char *p = scan_spaces(tok->cur, tok->inp);
+                int n = (int)(p - tok->cur) + 1;
+                tok->cur = (char *)p;
+                col += n, altcol += n;
             }
             else if (c == '\t') {
                 col = (col / tok->tabsize + 1) * tok->tabsize;
@@ -605,6 +727,9 @@ tok_get(struct tok_state *tok, const char **p_start, const char **p_end)
 
     /* Skip comment */
     if (c == '#') {
+        /* The comment text runs up to the newline ending the line */
+        const char *nl = memchr(tok->cur, '\n', tok->inp - tok->cur);
+        tok->cur = nl != NULL ? (char *)nl : tok->inp;
         while (c != EOF && c != '\n') {
             c = tok_nextc(tok);
         }
@@ -648,6 +773,7 @@ tok_get(struct tok_state *tok, const char **p_start, const char **p_end)
             if (c >= 128) {
                 nonascii = 1;
             }
+            tok->cur = (char *)scan_identifier(tok->cur, tok->inp);
             c = tok_nextc(tok);
         }
         tok_backup(tok, c);
@@ -897,6 +1023,9 @@ tok_get(struct tok_state *tok, const char **p_start, const char **p_end)
 
         /* Get rest of string */
         while (end_quote_size != quote_size) {
+            if (end_quote_size == 0) {
+                tok->cur = (char *)scan_string_body(tok->cur, tok->inp, quote);
+            }
             c = tok_nextc(tok);
             if (c == EOF) {
                 if (quote_size == 3) {
@@ -0,0 +1,190 @@
+/* This is built as a stand-alone executable by the Makefile, and helps turn
+   Lib/<name>.py modules into frozen modules (see Python/frozen.c).
+
+   Usage: _freeze_module <modname> <input.py> <output.h>
+
+   The module is compiled with a minimal interpreter (no import system, no
+   sys.path) and its code object is serialized with the code cache format
+   (Python/codecache.c) into a C array which is linked into the
+   interpreter.  Importing a frozen module then only has to load the array:
+   the module source is never read, tokenized, parsed or compiled.
+*/
+
+#include <Python.h>
+#include "pycore_codecache.h"     // _PyCodeCache_Dumps()
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Python/frozen.o is not linked into this program: the modules are being
+   frozen, so there is nothing to import from them yet. */
+static const struct _frozen no_modules[] = {
+    {0, 0, 0} /* sentinel */
+};
+const struct _frozen *PyImport_FrozenModules = no_modules;
+
+
+static const char header[] =
+    "/* Auto-generated by Programs/_freeze_module.c */";
+
+
+static void
+runtime_init(void)
+{
+    PyConfig config;
+    PyConfig_InitIsolatedConfig(&config);
+
+    /* No import system and no path configuration: only the compiler is
+       needed, and nothing must be read from Lib/. */
+    config._install_importlib = 0;
+    config._init_main = 0;
+
+    PyStatus status = Py_InitializeFromConfig(&config);
+    if (PyStatus_Exception(status)) {
+        Py_ExitStatusException(status);
+    }
+}
+
+
+static char *
+read_text(const char *inpath, Py_ssize_t *size)
+{
+    FILE *infile = fopen(inpath, "rb");
+    if (infile == NULL) {
+        fprintf(stderr, "cannot open '%s' for reading\n", inpath);
+        return NULL;
+    }
+    if (fseek(infile, 0, SEEK_END) < 0 || (*size = ftell(infile)) < 0
+        || fseek(infile, 0, SEEK_SET) < 0)
+    {
+        fprintf(stderr, "cannot get the size of '%s'\n", inpath);
+        fclose(infile);
+        return NULL;
+    }
+    char *text = malloc(*size + 1);
+    if (text == NULL) {
+        fprintf(stderr, "out of memory reading '%s'\n", inpath);
+        fclose(infile);
+        return NULL;
+    }
+    size_t n = fread(text, 1, *size, infile);
+    fclose(infile);
+    if ((Py_ssize_t)n != *size) {
+        fprintf(stderr, "read too short: got %zu instead of %zd bytes\n",
+                n, *size);
+        free(text);
+        return NULL;
+    }
+    text[n] = '\0';
+    return text;
+}
+
+
+static PyObject *
+compile_and_dump(const char *name, const char *text)
+{
+    char filename[200];
+    PyCompilerFlags cf = _PyCompilerFlags_INIT;
+    PyOS_snprintf(filename, sizeof(filename), "<frozen %s>", name);
+
+    /* Compiled as import would, see _PyCF_FOLD_BUILTINS */
+    cf.cf_flags = _PyCF_FOLD_BUILTINS;
+    PyObject *code = Py_CompileStringExFlags(text, filename, Py_file_input,
+                                             &cf, 0);
+    if (code == NULL) {
+        return NULL;
+    }
+    PyObject *data = _PyCodeCache_Dumps(code);
+    Py_DECREF(code);
+    return data;
+}
+
+
+static int
+write_frozen(const char *outpath, const char *inpath, const char *name,
+             PyObject *data)
+{
+    /* Module names may contain dots: mangle them as Tools/freeze does */
+    char mangled[200];
+    size_t i;
+    for (i = 0; name[i] != '\0' && i < sizeof(mangled) - 1; i++) {
+        mangled[i] = (name[i] == '.') ? '_' : name[i];
+    }
+    mangled[i] = '\0';
+
+    FILE *outfile = fopen(outpath, "w");
+    if (outfile == NULL) {
+        fprintf(stderr, "cannot open '%s' for writing\n", outpath);
+        return -1;
+    }
+
+    Py_ssize_t size;
+    const unsigned char *p =
+        (const unsigned char *)PyString_AsCharAndSize(data, &size);
+    fprintf(outfile, "%s\n", header);
+    fprintf(outfile, "/* Frozen from %s */\n", inpath);
+    fprintf(outfile, "static const unsigned char _Py_M__%s[] = {\n",
+            mangled);
+    for (Py_ssize_t n = 0; n < size; n += 16) {
+        fprintf(outfile, "   ");
+        for (Py_ssize_t j = n; j < size && j < n + 16; j++) {
+            fprintf(outfile, " %u,", p[j]);
+        }
+        fprintf(outfile, "\n");
+    }
+    fprintf(outfile, "};\n");
+
+    if (ferror(outfile)) {
+        fprintf(stderr, "error when writing to '%s'\n", outpath);
+        fclose(outfile);
+        return -1;
+    }
+    fclose(outfile);
+    return 0;
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    const char *name, *inpath, *outpath;
+    char *text;
+    Py_ssize_t size;
+    PyObject *data;
+
+    if (argc != 4) {
+        fprintf(stderr, "need to specify the name, input and output paths\n");
+        return 2;
+    }
+    name = argv[1];
+    inpath = argv[2];
+    outpath = argv[3];
+
+    runtime_init();
+
+    text = read_text(inpath, &size);
+    if (text == NULL) {
+        goto error;
+    }
+
+    data = compile_and_dump(name, text);
+    free(text);
+    if (data == NULL) {
+        goto error;
+    }
+
+    if (write_frozen(outpath, inpath, name, data) < 0) {
+        Py_DECREF(data);
+        goto error;
+    }
+    Py_DECREF(data);
+
+    Py_Finalize();
+    return 0;
+
+error:
+    PyErr_Print();
+    Py_Finalize();
+    return 1;
+}
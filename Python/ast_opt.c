@@ -2,6 +2,8 @@
 #include "Python.h"
 #include "Python-ast.h"
 #include "ast.h"
+#include "pycore_interp.h"        // PyInterpreterState.builtins_copy
+#include "pycore_pystate.h"       // _PyInterpreterState_GET()
 
 
 static int
@@ -380,8 +382,667 @@ fold_compare(expr_ty node, _PyASTOptimizeState *state)
     return 1;
 }
 
+/* Builtins called with constant arguments are folded in a module body
+   compiled by import (_PyCF_FOLD_BUILTINS), unless the module binds their
+   name somewhere (see scan_bind()) or reaches its namespace through
+   globals(), vars(), exec() or eval(): state->shadowed_builtins has bit i
+   set for foldable_builtins[i].  The names all have 3 letters.  Code run
+   by compile() and exec() may get any globals, so nothing is folded in
+   it. */
+static const char * const foldable_builtins[] = {
+    "abs", "chr", "len", "max", "min", "ord", NULL
+};
+
+#define ALL_BUILTINS_SHADOWED (~0)
+
+static int
+builtin_bit(PyObject *name)
+{
+    Py_ssize_t size;
+    const char *s = PyString_AsCharAndSize(name, &size);
+    if (s == NULL || size != 3) {
+        PyErr_Clear();
+        return 0;
+    }
+    for (int i = 0; foldable_builtins[i] != NULL; i++) {
+        if (memcmp(s, foldable_builtins[i], 3) == 0) {
+            return 1 << i;
+        }
+    }
+    return 0;
+}
+
+static int
+fold_call(expr_ty node, _PyASTOptimizeState *state)
+{
+    expr_ty func = node->v.Call.func;
+    asdl_seq *args = node->v.Call.args;
+    Py_ssize_t n = asdl_seq_LEN(args);
+
+    if (func->kind != Name_kind || n == 0 ||
+            asdl_seq_LEN(node->v.Call.keywords) != 0) {
+        return 1;
+    }
+    int bit = builtin_bit(func->v.Name.id);
+    if (bit == 0 || (state->shadowed_builtins & bit)) {
+        return 1;
+    }
+    for (Py_ssize_t i = 0; i < n; i++) {
+        expr_ty arg = (expr_ty)asdl_seq_GET(args, i);
+        if (arg->kind != Constant_kind) {
+            return 1;
+        }
+    }
+
+    /* The builtins as they were at startup, and only if nothing has
+       replaced them since */
+    PyInterpreterState *interp = _PyInterpreterState_GET();
+    if (interp->builtins_copy == NULL) {
+        return 1;
+    }
+    PyObject *callable = PyDict_GetItemWithError(interp->builtins_copy,
+                                                 func->v.Name.id);
+    if (callable == NULL) {
+        return make_const(node, NULL);
+    }
+    if (PyDict_GetItemWithError(interp->builtins,
+                                func->v.Name.id) != callable) {
+        return make_const(node, NULL);
+    }
+    PyObject *argtuple = make_const_tuple(args);
+    if (argtuple == NULL) {
+        return make_const(node, NULL);
+    }
+    PyObject *newval = PyObject_Call(callable, argtuple, NULL);
+    Py_DECREF(argtuple);
+    return make_const(node, newval);
+}
+
+/* Return non-zero if a format spec has a number (a width or a precision)
+   above MAX_STR_SIZE, so that formatting with it could build a huge
+   string: this is checked before formatting, not after. */
+static int
+format_spec_too_wide(PyObject *spec)
+{
+    Py_ssize_t size, n = 0;
+    const char *s;
+
+    if (!PyString_Check(spec)) {
+        return 1;
+    }
+    s = PyString_AsCharAndSize(spec, &size);
+    if (s == NULL) {
+        PyErr_Clear();
+        return 1;
+    }
+    for (Py_ssize_t i = 0; i < size; i++) {
+        if (Py_ISDIGIT(s[i])) {
+            n = n * 10 + (s[i] - '0');
+            if (n > MAX_STR_SIZE) {
+                return 1;
+            }
+        }
+        else {
+            n = 0;
+        }
+    }
+    return 0;
+}
+
+/* Format a constant replacement field, as FORMAT_VALUE would */
+static int
+fold_formatted_value(expr_ty node, _PyASTOptimizeState *state)
+{
+    expr_ty value = node->v.FormattedValue.value;
+    expr_ty spec = node->v.FormattedValue.format_spec;
+
+    if (value->kind != Constant_kind ||
+            (spec != NULL && (spec->kind != Constant_kind ||
+                              format_spec_too_wide(spec->v.Constant.value)))) {
+        return 1;
+    }
+    PyObject *obj = value->v.Constant.value;
+    switch (node->v.FormattedValue.conversion) {
+    case 's':
+        obj = PyObject_Str(obj);
+        break;
+    case 'r':
+        obj = PyObject_Repr(obj);
+        break;
+    case 'a':
+        obj = PyObject_ASCII(obj);
+        break;
+    default:
+        Py_INCREF(obj);
+        break;
+    }
+    if (obj == NULL) {
+        return make_const(node, NULL);
+    }
+    PyObject *newval = PyObject_Format(obj,
+                                       spec ? spec->v.Constant.value : NULL);
+    Py_DECREF(obj);
+    if (newval != NULL && PyString_Size(newval) > MAX_STR_SIZE) {
+        Py_DECREF(newval);
+        return 1;
+    }
+    return make_const(node, newval);
+}
+
+/* Collapse an f-string whose parts are all constant into a str */
+static int
+fold_joinedstr(expr_ty node, _PyASTOptimizeState *state)
+{
+    asdl_seq *values = node->v.JoinedStr.values;
+    Py_ssize_t n = asdl_seq_LEN(values);
+    PyObject *items[MAX_COLLECTION_SIZE];
+
+    if (n > MAX_COLLECTION_SIZE) {
+        return 1;
+    }
+    for (Py_ssize_t i = 0; i < n; i++) {
+        expr_ty value = (expr_ty)asdl_seq_GET(values, i);
+        if (value->kind != Constant_kind ||
+                !PyString_CheckExact(value->v.Constant.value)) {
+            return 1;
+        }
+        items[i] = value->v.Constant.value;
+    }
+    PyObject *empty = PyString_FromString("");
+    if (empty == NULL) {
+        return make_const(node, NULL);
+    }
+    PyObject *newval = PyString_JoinArray(empty, items, n);
+    Py_DECREF(empty);
+    return make_const(node, newval);
+}
+
+/* Dead code elimination
+
+   A branch which can never run ("if 0:", "while False:", statements after
+   return, raise, break or continue) is only dropped from the AST when the
+   symtable would not miss it: it must not bind or declare any name of the
+   enclosing scope, make it a generator, refer to __class__, or contain a
+   return, break or continue that the compiler would reject.  Other dead
+   branches are left to the compiler, which checks them but emits no code
+   for them.  The same walk finds which builtins a module binds. */
+
+typedef struct {
+    int shadowed;       /* builtin_bit()s of the names bound */
+    int unremovable;    /* the code changes the scopes (see above) */
+    int in_function;
+    int in_loop;
+    int nested;         /* inside a lambda or a comprehension */
+} code_scan;
+
+static void scan_stmts(asdl_seq *stmts, Py_ssize_t start, code_scan *sc);
+static void scan_expr(expr_ty node, code_scan *sc);
+
+static void
+scan_bind(PyObject *name, code_scan *sc)
+{
+    sc->shadowed |= builtin_bit(name);
+    if (!sc->nested) {
+        sc->unremovable = 1;
+    }
+}
+
+static void
+scan_exprs(asdl_seq *exprs, code_scan *sc)
+{
+    for (Py_ssize_t i = 0; i < asdl_seq_LEN(exprs); i++) {
+        expr_ty elt = (expr_ty)asdl_seq_GET(exprs, i);
+        if (elt != NULL) {
+            scan_expr(elt, sc);
+        }
+    }
+}
+
+static void
+scan_arguments(arguments_ty args, code_scan *sc)
+{
+    asdl_seq *lists[] = {args->posonlyargs, args->args, args->kwonlyargs};
+    for (int j = 0; j < 3; j++) {
+        for (Py_ssize_t i = 0; i < asdl_seq_LEN(lists[j]); i++) {
+            scan_bind(((arg_ty)asdl_seq_GET(lists[j], i))->arg, sc);
+        }
+    }
+    if (args->vararg != NULL) {
+        scan_bind(args->vararg->arg, sc);
+    }
+    if (args->kwarg != NULL) {
+        scan_bind(args->kwarg->arg, sc);
+    }
+}
+
+static void
+scan_comprehension(expr_ty elt, expr_ty value, asdl_seq *generators,
+                   code_scan *sc)
+{
+    /* The first iterable is evaluated in the enclosing scope */
+    comprehension_ty first = (comprehension_ty)asdl_seq_GET(generators, 0);
+    scan_expr(first->iter, sc);
+    sc->nested++;
+    for (Py_ssize_t i = 0; i < asdl_seq_LEN(generators); i++) {
+        comprehension_ty gen = (comprehension_ty)asdl_seq_GET(generators, i);
+        scan_expr(gen->target, sc);
+        if (i > 0) {
+            scan_expr(gen->iter, sc);
+        }
+        scan_exprs(gen->ifs, sc);
+    }
+    scan_expr(elt, sc);
+    if (value != NULL) {
+        scan_expr(value, sc);
+    }
+    sc->nested--;
+}
+
+static void
+scan_expr(expr_ty node, code_scan *sc)
+{
+    switch (node->kind) {
+    case BoolOp_kind:
+        scan_exprs(node->v.BoolOp.values, sc);
+        break;
+    case NamedExpr_kind:
+        /* Binds in the enclosing scope, even from a comprehension */
+        sc->unremovable = 1;
+        scan_expr(node->v.NamedExpr.target, sc);
+        scan_expr(node->v.NamedExpr.value, sc);
+        break;
+    case BinOp_kind:
+        scan_expr(node->v.BinOp.left, sc);
+        scan_expr(node->v.BinOp.right, sc);
+        break;
+    case UnaryOp_kind:
+        scan_expr(node->v.UnaryOp.operand, sc);
+        break;
+    case Lambda_kind:
+        scan_exprs(node->v.Lambda.args->kw_defaults, sc);
+        scan_exprs(node->v.Lambda.args->defaults, sc);
+        sc->nested++;
+        scan_arguments(node->v.Lambda.args, sc);
+        scan_expr(node->v.Lambda.body, sc);
+        sc->nested--;
+        break;
+    case IfExp_kind:
+        scan_expr(node->v.IfExp.test, sc);
+        scan_expr(node->v.IfExp.body, sc);
+        scan_expr(node->v.IfExp.orelse, sc);
+        break;
+    case Dict_kind:
+        scan_exprs(node->v.Dict.keys, sc);
+        scan_exprs(node->v.Dict.values, sc);
+        break;
+    case Set_kind:
+        scan_exprs(node->v.Set.elts, sc);
+        break;
+    case ListComp_kind:
+        scan_comprehension(node->v.ListComp.elt, NULL,
+                           node->v.ListComp.generators, sc);
+        break;
+    case SetComp_kind:
+        scan_comprehension(node->v.SetComp.elt, NULL,
+                           node->v.SetComp.generators, sc);
+        break;
+    case DictComp_kind:
+        scan_comprehension(node->v.DictComp.key, node->v.DictComp.value,
+                           node->v.DictComp.generators, sc);
+        break;
+    case GeneratorExp_kind:
+        scan_comprehension(node->v.GeneratorExp.elt, NULL,
+                           node->v.GeneratorExp.generators, sc);
+        break;
+    case Yield_kind:
+        sc->unremovable = 1;
+        if (node->v.Yield.value != NULL) {
+            scan_expr(node->v.Yield.value, sc);
+        }
+        break;
+    case YieldFrom_kind:
+        sc->unremovable = 1;
+        scan_expr(node->v.YieldFrom.value, sc);
+        break;
+    case Compare_kind:
+        scan_expr(node->v.Compare.left, sc);
+        scan_exprs(node->v.Compare.comparators, sc);
+        break;
+    case Call_kind:
+        scan_expr(node->v.Call.func, sc);
+        scan_exprs(node->v.Call.args, sc);
+        for (Py_ssize_t i = 0; i < asdl_seq_LEN(node->v.Call.keywords); i++) {
+            keyword_ty kw = (keyword_ty)asdl_seq_GET(node->v.Call.keywords, i);
+            scan_expr(kw->value, sc);
+        }
+        break;
+    case FormattedValue_kind:
+        scan_expr(node->v.FormattedValue.value, sc);
+        if (node->v.FormattedValue.format_spec != NULL) {
+            scan_expr(node->v.FormattedValue.format_spec, sc);
+        }
+        break;
+    case JoinedStr_kind:
+        scan_exprs(node->v.JoinedStr.values, sc);
+        break;
+    case Attribute_kind:
+        scan_expr(node->v.Attribute.value, sc);
+        break;
+    case Subscript_kind:
+        scan_expr(node->v.Subscript.value, sc);
+        scan_expr(node->v.Subscript.slice, sc);
+        break;
+    case Starred_kind:
+        scan_expr(node->v.Starred.value, sc);
+        break;
+    case Name_kind:
+        if (node->v.Name.ctx != Load) {
+            scan_bind(node->v.Name.id, sc);
+        }
+        else if (_PyString_EqualToASCIIString(node->v.Name.id, "super") ||
+                 _PyString_EqualToASCIIString(node->v.Name.id, "__class__")) {
+            /* Creates the __class__ cell of a method */
+            sc->unremovable = 1;
+        }
+        else if (_PyString_EqualToASCIIString(node->v.Name.id, "globals") ||
+                 _PyString_EqualToASCIIString(node->v.Name.id, "vars") ||
+                 _PyString_EqualToASCIIString(node->v.Name.id, "exec") ||
+                 _PyString_EqualToASCIIString(node->v.Name.id, "eval") ||
+                 _PyString_EqualToASCIIString(node->v.Name.id,
+                                              "__builtins__")) {
+            /* May rebind any global behind the compiler's back */
+            sc->shadowed = ALL_BUILTINS_SHADOWED;
+        }
+        break;
+    case List_kind:
+        scan_exprs(node->v.List.elts, sc);
+        break;
+    case Tuple_kind:
+        scan_exprs(node->v.Tuple.elts, sc);
+        break;
+    case Slice_kind:
+        if (node->v.Slice.lower != NULL) {
+            scan_expr(node->v.Slice.lower, sc);
+        }
+        if (node->v.Slice.upper != NULL) {
+            scan_expr(node->v.Slice.upper, sc);
+        }
+        if (node->v.Slice.step != NULL) {
+            scan_expr(node->v.Slice.step, sc);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+static void
+scan_aliases(asdl_seq *names, code_scan *sc)
+{
+    for (Py_ssize_t i = 0; i < asdl_seq_LEN(names); i++) {
+        alias_ty alias = (alias_ty)asdl_seq_GET(names, i);
+        if (alias->asname != NULL) {
+            scan_bind(alias->asname, sc);
+        }
+        else if (_PyString_EqualToASCIIString(alias->name, "*")) {
+            sc->shadowed = ALL_BUILTINS_SHADOWED;
+            sc->unremovable = 1;
+        }
+        else {
+            /* "import a.b" binds "a", and no builtin name has a dot */
+            scan_bind(alias->name, sc);
+        }
+    }
+}
+
+static void
+scan_loop_body(asdl_seq *body, code_scan *sc)
+{
+    int in_loop = sc->in_loop;
+    sc->in_loop = 1;
+    scan_stmts(body, 0, sc);
+    sc->in_loop = in_loop;
+}
+
+static void
+scan_scope(asdl_seq *body, int in_function, code_scan *sc)
+{
+    int outer_function = sc->in_function, outer_loop = sc->in_loop;
+    sc->in_function = in_function;
+    sc->in_loop = 0;
+    sc->nested++;
+    scan_stmts(body, 0, sc);
+    sc->nested--;
+    sc->in_function = outer_function;
+    sc->in_loop = outer_loop;
+}
+
+static void
+scan_stmt(stmt_ty node, code_scan *sc)
+{
+    switch (node->kind) {
+    case FunctionDef_kind:
+        scan_bind(node->v.FunctionDef.name, sc);
+        scan_exprs(node->v.FunctionDef.decorator_list, sc);
+        scan_exprs(node->v.FunctionDef.args->kw_defaults, sc);
+        scan_exprs(node->v.FunctionDef.args->defaults, sc);
+        sc->nested++;
+        scan_arguments(node->v.FunctionDef.args, sc);
+        sc->nested--;
+        scan_scope(node->v.FunctionDef.body, 1, sc);
+        break;
+    case ClassDef_kind:
+        scan_bind(node->v.ClassDef.name, sc);
+        scan_exprs(node->v.ClassDef.decorator_list, sc);
+        scan_exprs(node->v.ClassDef.bases, sc);
+        for (Py_ssize_t i = 0; i < asdl_seq_LEN(node->v.ClassDef.keywords); i++) {
+            keyword_ty kw = (keyword_ty)asdl_seq_GET(node->v.ClassDef.keywords, i);
+            scan_expr(kw->value, sc);
+        }
+        scan_scope(node->v.ClassDef.body, 0, sc);
+        break;
+    case Return_kind:
+        if (!sc->in_function) {
+            sc->unremovable = 1;
+        }
+        if (node->v.Return.value != NULL) {
+            scan_expr(node->v.Return.value, sc);
+        }
+        break;
+    case Delete_kind:
+        scan_exprs(node->v.Delete.targets, sc);
+        break;
+    case Assign_kind:
+        scan_exprs(node->v.Assign.targets, sc);
+        scan_expr(node->v.Assign.value, sc);
+        break;
+    case AugAssign_kind:
+        scan_expr(node->v.AugAssign.target, sc);
+        scan_expr(node->v.AugAssign.value, sc);
+        break;
+    case For_kind:
+        scan_expr(node->v.For.target, sc);
+        scan_expr(node->v.For.iter, sc);
+        scan_loop_body(node->v.For.body, sc);
+        scan_stmts(node->v.For.orelse, 0, sc);
+        break;
+    case While_kind:
+        scan_expr(node->v.While.test, sc);
+        scan_loop_body(node->v.While.body, sc);
+        scan_stmts(node->v.While.orelse, 0, sc);
+        break;
+    case If_kind:
+        scan_expr(node->v.If.test, sc);
+        scan_stmts(node->v.If.body, 0, sc);
+        scan_stmts(node->v.If.orelse, 0, sc);
+        break;
+    case With_kind:
+        for (Py_ssize_t i = 0; i < asdl_seq_LEN(node->v.With.items); i++) {
+            withitem_ty item = (withitem_ty)asdl_seq_GET(node->v.With.items, i);
+            scan_expr(item->context_expr, sc);
+            if (item->optional_vars != NULL) {
+                scan_expr(item->optional_vars, sc);
+            }
+        }
+        scan_stmts(node->v.With.body, 0, sc);
+        break;
+    case Raise_kind:
+        if (node->v.Raise.exc != NULL) {
+            scan_expr(node->v.Raise.exc, sc);
+        }
+        if (node->v.Raise.cause != NULL) {
+            scan_expr(node->v.Raise.cause, sc);
+        }
+        break;
+    case Try_kind:
+        scan_stmts(node->v.Try.body, 0, sc);
+        for (Py_ssize_t i = 0; i < asdl_seq_LEN(node->v.Try.handlers); i++) {
+            excepthandler_ty handler =
+                (excepthandler_ty)asdl_seq_GET(node->v.Try.handlers, i);
+            if (handler->v.ExceptHandler.type != NULL) {
+                scan_expr(handler->v.ExceptHandler.type, sc);
+            }
+            if (handler->v.ExceptHandler.name != NULL) {
+                scan_bind(handler->v.ExceptHandler.name, sc);
+            }
+            scan_stmts(handler->v.ExceptHandler.body, 0, sc);
+        }
+        scan_stmts(node->v.Try.orelse, 0, sc);
+        scan_stmts(node->v.Try.finalbody, 0, sc);
+        break;
+    case Assert_kind:
+        scan_expr(node->v.Assert.test, sc);
+        if (node->v.Assert.msg != NULL) {
+            scan_expr(node->v.Assert.msg, sc);
+        }
+        break;
+    case Import_kind:
+        scan_aliases(node->v.Import.names, sc);
+        break;
+    case ImportFrom_kind:
+        scan_aliases(node->v.ImportFrom.names, sc);
+        break;
+    case Global_kind:
+    case Nonlocal_kind:
+        sc->unremovable = 1;
+        break;
+    case Expr_kind:
+        scan_expr(node->v.Expr.value, sc);
+        break;
+    case Break_kind:
+    case Continue_kind:
+        if (!sc->in_loop) {
+            sc->unremovable = 1;
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+static void
+scan_stmts(asdl_seq *stmts, Py_ssize_t start, code_scan *sc)
+{
+    for (Py_ssize_t i = start; i < asdl_seq_LEN(stmts); i++) {
+        scan_stmt((stmt_ty)asdl_seq_GET(stmts, i), sc);
+    }
+}
+
+/* Can the statements stmts[start:] be removed?  in_loop tells whether a
+   break or continue would be legal there. */
+static int
+removable(asdl_seq *stmts, Py_ssize_t start, int in_loop,
+          _PyASTOptimizeState *state)
+{
+    code_scan sc = {0, 0, state->in_function, in_loop, 0};
+    scan_stmts(stmts, start, &sc);
+    return !sc.unremovable;
+}
+
+/* Replace the statement node by the live branch of a constant if/while */
+static int
+replace_by_branch(stmt_ty node, asdl_seq *live)
+{
+    Py_ssize_t n = asdl_seq_LEN(live);
+    if (n == 0) {
+        node->kind = Pass_kind;
+    }
+    else if (n == 1) {
+        memcpy(node, asdl_seq_GET(live, 0), sizeof(struct _stmt));
+    }
+    else {
+        /* "if True:" compiles to its body alone */
+        PyObject *true_value = PyBool_FromLong(1);
+        expr_ty test = node->v.If.test;
+        if (!make_const(test, true_value)) {
+            return 0;
+        }
+        node->kind = If_kind;
+        node->v.If.test = test;
+        node->v.If.body = live;
+        node->v.If.orelse = NULL;
+    }
+    return 1;
+}
+
+static int
+fold_if(stmt_ty node, _PyASTOptimizeState *state)
+{
+    expr_ty test = node->v.If.test;
+    if (test->kind != Constant_kind) {
+        return 1;
+    }
+    int constant = PyObject_IsTrue(test->v.Constant.value);
+    if (constant < 0) {
+        return 0;
+    }
+    asdl_seq *dead = constant ? node->v.If.orelse : node->v.If.body;
+    asdl_seq *live = constant ? node->v.If.body : node->v.If.orelse;
+    if (!removable(dead, 0, state->in_loop, state)) {
+        return 1;
+    }
+    return replace_by_branch(node, live);
+}
+
+static int
+fold_while(stmt_ty node, _PyASTOptimizeState *state)
+{
+    expr_ty test = node->v.While.test;
+    if (test->kind != Constant_kind) {
+        return 1;
+    }
+    int constant = PyObject_IsTrue(test->v.Constant.value);
+    if (constant < 0) {
+        return 0;
+    }
+    /* The else clause of "while 0:" runs once, as an "if 1:" would */
+    if (constant || !removable(node->v.While.body, 0, 1, state)) {
+        return 1;
+    }
+    return replace_by_branch(node, node->v.While.orelse);
+}
+
+/* Drop the statements following a return, raise, break or continue */
+static int
+fold_unreachable(asdl_seq *stmts, _PyASTOptimizeState *state)
+{
+    Py_ssize_t n = asdl_seq_LEN(stmts);
+    for (Py_ssize_t i = 0; i < n - 1; i++) {
+        stmt_ty st = (stmt_ty)asdl_seq_GET(stmts, i);
+        if (st->kind == Return_kind || st->kind == Raise_kind ||
+                st->kind == Break_kind || st->kind == Continue_kind) {
+            if (removable(stmts, i + 1, state->in_loop, state)) {
+                stmts->size = i + 1;
+            }
+            break;
+        }
+    }
+    return 1;
+}
+
 static int astfold_mod(mod_ty node_,  _PyASTOptimizeState *state);
 static int astfold_stmt(stmt_ty node_, _PyASTOptimizeState *state);
+static int astfold_stmts(asdl_seq *stmts, _PyASTOptimizeState *state);
 static int astfold_expr(expr_ty node_,  _PyASTOptimizeState *state);
 static int astfold_arguments(arguments_ty node_, _PyASTOptimizeState *state);
 static int astfold_comprehension(comprehension_ty node_, _PyASTOptimizeState *state);
@@ -421,7 +1082,7 @@ static int
 astfold_body(asdl_seq *stmts, _PyASTOptimizeState *state)
 {
     int docstring = _PyAST_GetDocString(stmts) != NULL;
-    CALL_SEQ(astfold_stmt, stmt_ty, stmts);
+    CALL(astfold_stmts, asdl_seq, stmts);
     if (!docstring && _PyAST_GetDocString(stmts) != NULL) {
         stmt_ty st = (stmt_ty)asdl_seq_GET(stmts, 0);
         asdl_seq *values = _Py_asdl_seq_new(1);
@@ -447,7 +1108,7 @@ astfold_mod(mod_ty node_, _PyASTOptimizeState *state)
         CALL(astfold_body, asdl_seq, node_->v.Module.body);
         break;
     case Interactive_kind:
-        CALL_SEQ(astfold_stmt, stmt_ty, node_->v.Interactive.body);
+        CALL(astfold_stmts, asdl_seq, node_->v.Interactive.body);
         break;
     case Expression_kind:
         CALL(astfold_expr, expr_ty, node_->v.Expression.body);
@@ -522,13 +1183,16 @@ astfold_expr(expr_ty node_, _PyASTOptimizeState *state)
         CALL(astfold_expr, expr_ty, node_->v.Call.func);
         CALL_SEQ(astfold_expr, expr_ty, node_->v.Call.args);
         CALL_SEQ(astfold_keyword, keyword_ty, node_->v.Call.keywords);
+        CALL(fold_call, expr_ty, node_);
         break;
     case FormattedValue_kind:
         CALL(astfold_expr, expr_ty, node_->v.FormattedValue.value);
         CALL_OPT(astfold_expr, expr_ty, node_->v.FormattedValue.format_spec);
+        CALL(fold_formatted_value, expr_ty, node_);
         break;
     case JoinedStr_kind:
         CALL_SEQ(astfold_expr, expr_ty, node_->v.JoinedStr.values);
+        CALL(fold_joinedstr, expr_ty, node_);
         break;
     case Attribute_kind:
         CALL(astfold_expr, expr_ty, node_->v.Attribute.value);
@@ -602,19 +1266,56 @@ astfold_arg(arg_ty node_, _PyASTOptimizeState *state)
     return 1;
 }
 
+static int
+astfold_stmts(asdl_seq *stmts, _PyASTOptimizeState *state)
+{
+    CALL_SEQ(astfold_stmt, stmt_ty, stmts);
+    CALL(fold_unreachable, asdl_seq, stmts);
+    return 1;
+}
+
+/* Fold a function or class body, which starts a new block for return,
+   break and continue */
+static int
+astfold_scope_body(asdl_seq *stmts, int in_function,
+                   _PyASTOptimizeState *state)
+{
+    int outer_function = state->in_function, outer_loop = state->in_loop;
+    state->in_function = in_function;
+    state->in_loop = 0;
+    CALL(astfold_body, asdl_seq, stmts);
+    state->in_function = outer_function;
+    state->in_loop = outer_loop;
+    return 1;
+}
+
+static int
+astfold_loop_body(asdl_seq *stmts, _PyASTOptimizeState *state)
+{
+    int outer_loop = state->in_loop;
+    state->in_loop = 1;
+    CALL(astfold_stmts, asdl_seq, stmts);
+    state->in_loop = outer_loop;
+    return 1;
+}
+
 static int
 astfold_stmt(stmt_ty node_, _PyASTOptimizeState *state)
 {
     switch (node_->kind) {
     case FunctionDef_kind:
         CALL(astfold_arguments, arguments_ty, node_->v.FunctionDef.args);
-        CALL(astfold_body, asdl_seq, node_->v.FunctionDef.body);
+        if (!astfold_scope_body(node_->v.FunctionDef.body, 1, state)) {
+            return 0;
+        }
         CALL_SEQ(astfold_expr, expr_ty, node_->v.FunctionDef.decorator_list);
         break;
     case ClassDef_kind:
         CALL_SEQ(astfold_expr, expr_ty, node_->v.ClassDef.bases);
         CALL_SEQ(astfold_keyword, keyword_ty, node_->v.ClassDef.keywords);
-        CALL(astfold_body, asdl_seq, node_->v.ClassDef.body);
+        if (!astfold_scope_body(node_->v.ClassDef.body, 0, state)) {
+            return 0;
+        }
         CALL_SEQ(astfold_expr, expr_ty, node_->v.ClassDef.decorator_list);
         break;
     case Return_kind:
@@ -634,34 +1335,36 @@ astfold_stmt(stmt_ty node_, _PyASTOptimizeState *state)
     case For_kind:
         CALL(astfold_expr, expr_ty, node_->v.For.target);
         CALL(astfold_expr, expr_ty, node_->v.For.iter);
-        CALL_SEQ(astfold_stmt, stmt_ty, node_->v.For.body);
-        CALL_SEQ(astfold_stmt, stmt_ty, node_->v.For.orelse);
+        CALL(astfold_loop_body, asdl_seq, node_->v.For.body);
+        CALL(astfold_stmts, asdl_seq, node_->v.For.orelse);
 
         CALL(fold_iter, expr_ty, node_->v.For.iter);
         break;
     case While_kind:
         CALL(astfold_expr, expr_ty, node_->v.While.test);
-        CALL_SEQ(astfold_stmt, stmt_ty, node_->v.While.body);
-        CALL_SEQ(astfold_stmt, stmt_ty, node_->v.While.orelse);
+        CALL(astfold_loop_body, asdl_seq, node_->v.While.body);
+        CALL(astfold_stmts, asdl_seq, node_->v.While.orelse);
+        CALL(fold_while, stmt_ty, node_);
         break;
     case If_kind:
         CALL(astfold_expr, expr_ty, node_->v.If.test);
-        CALL_SEQ(astfold_stmt, stmt_ty, node_->v.If.body);
-        CALL_SEQ(astfold_stmt, stmt_ty, node_->v.If.orelse);
+        CALL(astfold_stmts, asdl_seq, node_->v.If.body);
+        CALL(astfold_stmts, asdl_seq, node_->v.If.orelse);
+        CALL(fold_if, stmt_ty, node_);
         break;
     case With_kind:
         CALL_SEQ(astfold_withitem, withitem_ty, node_->v.With.items);
-        CALL_SEQ(astfold_stmt, stmt_ty, node_->v.With.body);
+        CALL(astfold_stmts, asdl_seq, node_->v.With.body);
         break;
     case Raise_kind:
         CALL_OPT(astfold_expr, expr_ty, node_->v.Raise.exc);
         CALL_OPT(astfold_expr, expr_ty, node_->v.Raise.cause);
         break;
     case Try_kind:
-        CALL_SEQ(astfold_stmt, stmt_ty, node_->v.Try.body);
+        CALL(astfold_stmts, asdl_seq, node_->v.Try.body);
         CALL_SEQ(astfold_excepthandler, excepthandler_ty, node_->v.Try.handlers);
-        CALL_SEQ(astfold_stmt, stmt_ty, node_->v.Try.orelse);
-        CALL_SEQ(astfold_stmt, stmt_ty, node_->v.Try.finalbody);
+        CALL(astfold_stmts, asdl_seq, node_->v.Try.orelse);
+        CALL(astfold_stmts, asdl_seq, node_->v.Try.finalbody);
         break;
     case Assert_kind:
         CALL(astfold_expr, expr_ty, node_->v.Assert.test);
@@ -682,7 +1385,7 @@ astfold_excepthandler(excepthandler_ty node_, _PyASTOptimizeState *state)
     switch (node_->kind) {
     case ExceptHandler_kind:
         CALL_OPT(astfold_expr, expr_ty, node_->v.ExceptHandler.type);
-        CALL_SEQ(astfold_stmt, stmt_ty, node_->v.ExceptHandler.body);
+        CALL(astfold_stmts, asdl_seq, node_->v.ExceptHandler.body);
         break;
     default:
         break;
@@ -706,6 +1409,16 @@ astfold_withitem(withitem_ty node_, _PyASTOptimizeState *state)
 int
 _PyAST_Optimize(mod_ty mod, _PyASTOptimizeState *state)
 {
+    state->in_function = 0;
+    state->in_loop = 0;
+    /* Other code may run with any globals: the REPL, eval(), exec() */
+    state->shadowed_builtins = ALL_BUILTINS_SHADOWED;
+    if (mod->kind == Module_kind
+            && (state->ff_features & _PyCF_FOLD_BUILTINS)) {
+        code_scan sc = {0, 0, 0, 0, 0};
+        scan_stmts(mod->v.Module.body, 0, &sc);
+        state->shadowed_builtins = sc.shadowed;
+    }
     int ret = astfold_mod(mod, state);
     assert(ret || PyErr_Occurred());
     return ret;
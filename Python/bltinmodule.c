@@ -2917,21 +2917,24 @@ sorted as builtin_sorted
     iterable as seq: object
     key as keyfunc: object = None
     reverse: object = False
+    parallel: object = 1
 
 Return a new list containing all items from the iterable in ascending order.
 
 A custom key function can be supplied to customize the sort order, and the
-reverse flag can be set to request the result in descending order.
+reverse flag can be set to request the result in descending order.  See
+list.sort() for parallel.
 [end disabled clinic input]*/
 
 PyDoc_STRVAR(builtin_sorted__doc__,
-"sorted($module, iterable, /, *, key=None, reverse=False)\n"
+"sorted($module, iterable, /, *, key=None, reverse=False, parallel=1)\n"
 "--\n"
 "\n"
 "Return a new list containing all items from the iterable in ascending order.\n"
 "\n"
 "A custom key function can be supplied to customize the sort order, and the\n"
-"reverse flag can be set to request the result in descending order.");
+"reverse flag can be set to request the result in descending order.  See\n"
+"list.sort() for parallel.");
 
 #define BUILTIN_SORTED_METHODDEF    \
     {"sorted", (PyCFunction)(void(*)(void))builtin_sorted, METH_FASTCALL | METH_KEYWORDS, builtin_sorted__doc__},
@@ -3500,6 +3503,7 @@ _PyBuiltin_Init(PyThreadState *tstate)
     SETBUILTIN("False",                 Py_False);
     SETBUILTIN("True",                  Py_True);
     SETBUILTIN("bool",                  &PyBool_Type);
+    SETBUILTIN("bytearray",             &PyByteArray_Type);
     SETBUILTIN("classmethod",           &PyClassMethod_Type);
     SETBUILTIN("dict",                  &PyDict_Type);
     SETBUILTIN("enumerate",             &PyEnum_Type);
@@ -3510,6 +3514,7 @@ _PyBuiltin_Init(PyThreadState *tstate)
     SETBUILTIN("int",                   &PyLong_Type);
     SETBUILTIN("list",                  &PyList_Type);
     SETBUILTIN("map",                   &PyMap_Type);
+    SETBUILTIN("memoryview",            &PyMemoryView_Type);
     SETBUILTIN("object",                &PyBaseObject_Type);
     SETBUILTIN("range",                 &PyRange_Type);
     SETBUILTIN("reversed",              &PyReversed_Type);
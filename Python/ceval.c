@@ -14,6 +14,7 @@
 #include "pycore_ceval.h"
 #include "pycore_code.h"
 #include "pycore_initconfig.h"
+#include "pycore_lazyimport.h"    // _PyLazyImport_CheckExact()
 #include "pycore_object.h"
 #include "pycore_pyerrors.h"
 #include "pycore_pylifecycle.h"
@@ -94,10 +95,93 @@ PyEval_ThreadsInitialized(void)
 
 static int do_raise(PyThreadState *tstate, PyObject *exc, PyObject *cause);
 static int unpack_iterable(PyThreadState *, PyObject *, int, int, PyObject **);
+static int call_profile_protected(PyThreadState *, PyFrameObject *,
+                                  int, PyObject *);
 
 #define _Py_TracingPossible(ceval) ((ceval)->tracing_possible)
 
 
+#ifdef Py_OPCODE_STATS
+/* Per-opcode execution counts, see Misc/SpecialBuilds.txt.
+
+   The timestamp delta between two dispatches is charged to the first
+   opcode.  An opcode's cycles therefore cover its own work and the C code
+   it calls (PyObject_GetItem(), a builtin function, ...), but not the
+   bytecode of the Python functions it calls. */
+
+#if defined(__x86_64__) || defined(__i386__)
+#  include <x86intrin.h>          // __rdtsc()
+#  define READ_TIMESTAMP() __rdtsc()
+#elif defined(__aarch64__)
+static inline uint64_t
+read_timestamp(void)
+{
+    uint64_t t;
+    __asm__ __volatile__ ("mrs %0, cntvct_el0" : "=r" (t));
+    return t;
+}
+#  define READ_TIMESTAMP() read_timestamp()
+#else
+#  include <time.h>               // clock_gettime()
+static inline uint64_t
+read_timestamp(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+#  define READ_TIMESTAMP() read_timestamp()
+#endif
+
+static struct {
+    int enabled;
+    int cycles;                 /* also read the timestamp counter? */
+    int last_opcode;            /* opcode to charge, -1 if none */
+    uint64_t last_timestamp;
+    uint64_t count[256];
+    uint64_t total_cycles[256];
+} opcode_stats = {
+    .last_opcode = -1,
+};
+
+static void
+opcode_stats_record(int opcode)
+{
+    opcode_stats.count[opcode]++;
+    if (opcode_stats.cycles) {
+        uint64_t now = READ_TIMESTAMP();
+        if (opcode_stats.last_opcode >= 0) {
+            opcode_stats.total_cycles[opcode_stats.last_opcode] +=
+                now - opcode_stats.last_timestamp;
+        }
+        opcode_stats.last_opcode = opcode;
+        opcode_stats.last_timestamp = now;
+    }
+}
+
+/* The outermost frame returns to C: charge its last opcode now rather than
+   at the next dispatch, which may be much later. */
+static void
+opcode_stats_flush(void)
+{
+    if (opcode_stats.last_opcode >= 0) {
+        opcode_stats.total_cycles[opcode_stats.last_opcode] +=
+            READ_TIMESTAMP() - opcode_stats.last_timestamp;
+        opcode_stats.last_opcode = -1;
+    }
+}
+
+#define RECORD_OPCODE(op) \
+    do { \
+        if (opcode_stats.enabled) { \
+            opcode_stats_record(op); \
+        } \
+    } while (0)
+#else
+#define RECORD_OPCODE(op) ((void)0)
+#endif
+
+
 PyObject *
 PyEval_EvalCode(PyObject *co, PyObject *globals, PyObject *locals)
 {
@@ -255,6 +339,13 @@ _PyEval_EvalFrameDefault(PyThreadState *tstate, PyFrameObject *f, int throwflag)
     f->f_stacktop = NULL;       /* remains NULL unless yield suspends frame */
     f->f_executing = 1;
 
+    if (tstate->c_profilefunc != NULL) {
+        if (call_profile_protected(tstate, f, PyTrace_CALL, Py_None)) {
+            /* Profile function raised an error */
+            goto exit_eval_frame;
+        }
+    }
+
     if (throwflag) /* support for generator.throw() */
         goto error;
 
@@ -266,6 +357,7 @@ main_loop:
 
         NEXTOPARG();
     dispatch_opcode:
+        RECORD_OPCODE(opcode);
 
         switch (opcode) {
 
@@ -906,10 +998,22 @@ main_loop:
                         goto error;
                     _PyErr_Clear(tstate);
                 }
+                else if (_PyLazyImport_CheckExact(v) && PyDict_Check(locals)) {
+                    Py_SETREF(v, _PyLazyImport_ResolveInDict(locals, name, v));
+                    if (v == NULL) {
+                        goto error;
+                    }
+                }
             }
             if (v == NULL) {
                 v = PyDict_GetItemWithError(f->f_globals, name);
-                if (v != NULL) {
+                if (v != NULL && _PyLazyImport_CheckExact(v)) {
+                    v = _PyLazyImport_ResolveInDict(f->f_globals, name, v);
+                    if (v == NULL) {
+                        goto error;
+                    }
+                }
+                else if (v != NULL) {
                     Py_INCREF(v);
                 }
                 else if (_PyErr_Occurred(tstate)) {
@@ -942,7 +1046,14 @@ main_loop:
                 /* namespace 1: globals */
                 name = GETITEM(names, oparg);
                 v = PyObject_GetItem(f->f_globals, name);
-                if (v == NULL) {
+                if (v != NULL && _PyLazyImport_CheckExact(v)) {
+                    Py_SETREF(v, _PyLazyImport_ResolveInDict(f->f_globals,
+                                                             name, v));
+                    if (v == NULL) {
+                        goto error;
+                    }
+                }
+                else if (v == NULL) {
                     if (!_PyErr_ExceptionMatches(tstate, PyExc_KeyError)) {
                         goto error;
                     }
@@ -1090,6 +1201,32 @@ main_loop:
             continue;
         }
 
+        case RESERVE_FROM_HINT: {
+            /* Presize the comprehension result under the iterator.  A
+               hint which fails is ignored, and the _Py*_Reserve()
+               functions cap one which may be a guess. */
+            PyObject *iter = TOP();
+            PyObject *container = SECOND();
+            int exact, err;
+            Py_ssize_t n = _PyObject_PresizeHint(iter, &exact);
+            if (n < 0) {
+                goto error;
+            }
+            if (Py_IS_TYPE(container, &PyList_Type)) {
+                err = _PyList_Reserve(container, n, exact);
+            }
+            else if (PyDict_CheckExact(container)) {
+                err = _PyDict_Reserve(container, n, exact);
+            }
+            else {
+                err = _PySet_Reserve(container, n, exact);
+            }
+            if (err < 0) {
+                goto error;
+            }
+            continue;
+        }
+
         case LIST_TO_TUPLE: {
             PyObject *list = POP();
             PyObject *tuple = PyList_AsTuple(list);
@@ -1988,7 +2125,18 @@ exception_unwind:
     }
 
 exiting:
+    if (tstate->c_profilefunc != NULL) {
+        if (call_profile_protected(tstate, f, PyTrace_RETURN, retval)) {
+            Py_CLEAR(retval);
+        }
+    }
 
+exit_eval_frame:
+#ifdef Py_OPCODE_STATS
+    if (f->f_back == NULL) {
+        opcode_stats_flush();
+    }
+#endif
     /* pop frame */
     f->f_executing = 0;
     tstate->frame = f->f_back;
@@ -2746,6 +2894,92 @@ Error:
     return 0;
 }
 
+/* Call the C profile hook, preserving any pending exception unless the
+   hook itself fails. */
+static int
+call_profile_protected(PyThreadState *tstate, PyFrameObject *frame,
+                       int what, PyObject *arg)
+{
+    PyObject *type, *value, *traceback;
+    int err;
+    _PyErr_Fetch(tstate, &type, &value, &traceback);
+    err = tstate->c_profilefunc(tstate->c_profileobj, frame, what, arg);
+    if (err == 0) {
+        _PyErr_Restore(tstate, type, value, traceback);
+        return 0;
+    }
+    Py_XDECREF(type);
+    Py_XDECREF(value);
+    Py_XDECREF(traceback);
+    return -1;
+}
+
+void
+PyEval_SetProfile(Py_tracefunc func, PyObject *arg)
+{
+    PyThreadState *tstate = PyThreadState_Get();
+    PyObject *profileobj = tstate->c_profileobj;
+
+    tstate->c_profilefunc = NULL;
+    tstate->c_profileobj = NULL;
+    Py_XDECREF(profileobj);
+
+    Py_XINCREF(arg);
+    tstate->c_profileobj = arg;
+    tstate->c_profilefunc = func;
+}
+
+#ifdef Py_OPCODE_STATS
+void
+_PyEval_SetOpcodeStats(int enabled, int cycles)
+{
+    if (opcode_stats.cycles && !cycles) {
+        opcode_stats_flush();
+    }
+    opcode_stats.enabled = enabled;
+    opcode_stats.cycles = enabled && cycles;
+    opcode_stats.last_opcode = -1;
+}
+
+void
+_PyEval_ClearOpcodeStats(void)
+{
+    memset(opcode_stats.count, 0, sizeof(opcode_stats.count));
+    memset(opcode_stats.total_cycles, 0, sizeof(opcode_stats.total_cycles));
+    opcode_stats.last_opcode = -1;
+}
+
+/* Return {opcode: (count, cycles)} for every opcode executed so far */
+PyObject *
+_PyEval_GetOpcodeStats(void)
+{
+    PyObject *dict = PyDict_New();
+    if (dict == NULL) {
+        return NULL;
+    }
+    for (int i = 0; i < 256; i++) {
+        if (opcode_stats.count[i] == 0) {
+            continue;
+        }
+        PyObject *key = PyLong_FromLong(i);
+        PyObject *value = Py_BuildValue(
+            "(KK)", (unsigned long long)opcode_stats.count[i],
+            (unsigned long long)opcode_stats.total_cycles[i]);
+        if (key == NULL || value == NULL
+            || PyDict_SetItem(dict, key, value) < 0)
+        {
+            Py_XDECREF(key);
+            Py_XDECREF(value);
+            Py_DECREF(dict);
+            return NULL;
+        }
+        Py_DECREF(key);
+        Py_DECREF(value);
+    }
+    return dict;
+}
+#endif
+
 PyFrameObject *
 PyEval_GetFrame(void)
 {
@@ -2942,11 +3176,73 @@ _PyEval_SliceIndexNotNone(PyObject *v, Py_ssize_t *pi)
     return 1;
 }
 
+/* -X lazy_imports: return a lazy import object for "import name", or NULL
+   without an exception if the module must be imported now.  Only plain
+   absolute imports at module level, outside of try and with blocks, are
+   deferred; a module can opt out by setting __lazy_imports__ = False
+   before its imports. */
+static PyObject *
+import_name_lazy(PyThreadState *tstate, PyFrameObject *f,
+                 PyObject *name, PyObject *fromlist, PyObject *level)
+{
+    if (fromlist != Py_None || !PyLong_Check(level) || _PyLong_Sign(level) != 0
+        || f->f_iblock != 0 || f->f_locals != f->f_globals
+        || !PyDict_CheckExact(f->f_globals)) {
+        return NULL;
+    }
+    PyObject *optin = PyDict_GetItemString(f->f_globals, "__lazy_imports__");
+    if (optin != NULL) {
+        /* -1 leaves the exception set for import_name() to raise */
+        int lazy = PyObject_IsTrue(optin);
+        if (lazy <= 0) {
+            return NULL;
+        }
+    }
+
+    /* Nothing to save if the module is already loaded */
+    PyObject *mod = PyImport_GetModule(name);
+    if (mod != NULL) {
+        Py_DECREF(mod);
+        return NULL;
+    }
+    _PyErr_Clear(tstate);
+
+    /* "import a.b" binds "a": extend a lazy "a" already bound */
+    Py_ssize_t len = PyString_Size(name);
+    Py_ssize_t dot = PyString_FindChar(name, '.', 0, len, 1);
+    if (dot >= 0) {
+        PyObject *top = PyString_Substring(name, 0, dot);
+        if (top == NULL) {
+            return NULL;
+        }
+        PyObject *bound = PyDict_GetItemWithError(f->f_globals, top);
+        Py_DECREF(top);
+        if (bound != NULL && _PyLazyImport_CheckExact(bound)
+            && ((PyLazyImportObject *)bound)->lz_module == NULL) {
+            if (_PyLazyImport_AddName(bound, name) < 0) {
+                return NULL;
+            }
+            Py_INCREF(bound);
+            return bound;
+        }
+        if (bound != NULL || _PyErr_Occurred(tstate)) {
+            return NULL;
+        }
+    }
+    return _PyLazyImport_New(name, f->f_globals);
+}
+
 static PyObject *
 import_name(PyThreadState *tstate, PyFrameObject *f,
             PyObject *name, PyObject *fromlist, PyObject *level)
 {
     PyObject *res;
+    if (_PyInterpreterState_GetConfig(tstate->interp)->lazy_imports) {
+        res = import_name_lazy(tstate, f, name, fromlist, level);
+        if (res != NULL || _PyErr_Occurred(tstate)) {
+            return res;
+        }
+    }
     {
         int ilevel = _PyLong_AsInt(level);
         if (ilevel == -1 && _PyErr_Occurred(tstate)) {
@@ -0,0 +1,848 @@
+/* On-disk cache of compiled modules
+
+   import_find_and_load() used to read, parse and compile every .py file on
+   every start.  The code object of each imported module is now serialized
+   into a cache directory and loaded back on the next import of the same
+   unchanged source.
+
+   A cache file is named after a hash of the absolute source path and
+   starts with a header which must match for the file to be used:
+
+       "PYCC"                   4 bytes
+       CODECACHE_MAGIC          uint32
+       source mtime             uint64 seconds, uint32 nanoseconds
+       source size              uint64
+       source path              varint length + bytes
+
+   followed by the serialized code object.  Integers are little-endian.
+
+   Objects are written as a one-byte type code followed by their contents;
+   lengths and small integers are LEB128 varints.  Every string is written
+   once and referred to by index afterwards, which removes the many copies
+   of the same names found in nested code objects.
+
+   The directory is sys.pycache_prefix (-X pycache_prefix=PATH,
+   PYTHONPYCACHEPREFIX) or else $XDG_CACHE_HOME/python-codecache, or
+   ~/.cache/python-codecache.  Nothing is written when sys.dont_write_bytecode
+   is true (-B, PYTHONDONTWRITEBYTECODE).  A cache which can't be read or
+   written is simply ignored. */
+
+#include "Python.h"
+#include "pycore_codecache.h"
+#include "osdefs.h"               // MAXPATHLEN
+
+#include <fcntl.h>                // O_RDONLY
+#include <unistd.h>               // getpid()
+#include <sys/stat.h>             // mkdir()
+
+/* Bump when the bytecode or the format below changes */
+#define CODECACHE_MAGIC 3441
+
+/* Nesting limit of tuples and code objects */
+#define MAX_DEPTH 200
+
+#define TYPE_NONE       'N'
+#define TYPE_ELLIPSIS   '.'
+#define TYPE_FALSE      'F'
+#define TYPE_TRUE       'T'
+#define TYPE_INT        'i'     /* zigzag varint */
+#define TYPE_LONG       'l'     /* varint n + n bytes, two's complement */
+#define TYPE_FLOAT      'g'     /* IEEE 754 double */
+#define TYPE_STRING     's'     /* varint n + n bytes */
+#define TYPE_REF        'r'     /* varint index of a string already read */
+#define TYPE_TUPLE      '('
+#define TYPE_FROZENSET  '<'
+#define TYPE_CODE       'c'
+
+
+/* --- Writer ------------------------------------------------------------ */
+
+typedef struct {
+    char *buf;
+    Py_ssize_t len;
+    Py_ssize_t allocated;
+    PyObject *strings;          /* str -> index */
+    int depth;
+} CacheWriter;
+
+static int
+w_reserve(CacheWriter *w, Py_ssize_t n)
+{
+    if (w->allocated - w->len >= n) {
+        return 0;
+    }
+    Py_ssize_t allocated = w->allocated ? w->allocated : 1024;
+    while (allocated - w->len < n) {
+        if (allocated > PY_SSIZE_T_MAX / 2) {
+            PyErr_NoMemory();
+            return -1;
+        }
+        allocated *= 2;
+    }
+    char *buf = PyMem_Realloc(w->buf, allocated);
+    if (buf == NULL) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    w->buf = buf;
+    w->allocated = allocated;
+    return 0;
+}
+
+static int
+w_bytes(CacheWriter *w, const void *data, Py_ssize_t n)
+{
+    if (w_reserve(w, n) < 0) {
+        return -1;
+    }
+    memcpy(w->buf + w->len, data, n);
+    w->len += n;
+    return 0;
+}
+
+static int
+w_byte(CacheWriter *w, int c)
+{
+    unsigned char byte = (unsigned char)c;
+    return w_bytes(w, &byte, 1);
+}
+
+static int
+w_uint(CacheWriter *w, uint64_t x, int size)
+{
+    unsigned char data[8];
+    for (int i = 0; i < size; i++) {
+        data[i] = (unsigned char)(x >> (8 * i));
+    }
+    return w_bytes(w, data, size);
+}
+
+static int
+w_varint(CacheWriter *w, uint64_t x)
+{
+    unsigned char data[10];
+    int n = 0;
+    do {
+        unsigned char byte = x & 0x7f;
+        x >>= 7;
+        data[n++] = byte | (x ? 0x80 : 0);
+    } while (x);
+    return w_bytes(w, data, n);
+}
+
+static int w_object(CacheWriter *w, PyObject *v);
+
+static int
+w_string(CacheWriter *w, PyObject *v)
+{
+    PyObject *index = PyDict_GetItemWithError(w->strings, v);
+    if (index != NULL) {
+        if (w_byte(w, TYPE_REF) < 0) {
+            return -1;
+        }
+        return w_varint(w, PyLong_AsSize_t(index));
+    }
+    if (PyErr_Occurred()) {
+        return -1;
+    }
+
+    index = PyLong_FromSsize_t(PyDict_Size(w->strings));
+    if (index == NULL) {
+        return -1;
+    }
+    int res = PyDict_SetItem(w->strings, v, index);
+    Py_DECREF(index);
+    if (res < 0) {
+        return -1;
+    }
+
+    Py_ssize_t size;
+    const char *data = PyString_AsCharAndSize(v, &size);
+    if (data == NULL) {
+        return -1;
+    }
+    if (w_byte(w, TYPE_STRING) < 0 || w_varint(w, size) < 0) {
+        return -1;
+    }
+    return w_bytes(w, data, size);
+}
+
+static int
+w_long(CacheWriter *w, PyObject *v)
+{
+    int overflow;
+    long long x = PyLong_AsLongLongAndOverflow(v, &overflow);
+    if (!overflow) {
+        if (x == -1 && PyErr_Occurred()) {
+            return -1;
+        }
+        uint64_t zigzag = ((uint64_t)x << 1) ^ (uint64_t)(x >> 63);
+        if (w_byte(w, TYPE_INT) < 0) {
+            return -1;
+        }
+        return w_varint(w, zigzag);
+    }
+
+    size_t nbytes = _PyLong_NumBits(v) / 8 + 1;
+    if (nbytes == (size_t)-1 / 8 + 1 && PyErr_Occurred()) {
+        return -1;
+    }
+    if (w_byte(w, TYPE_LONG) < 0 || w_varint(w, nbytes) < 0
+        || w_reserve(w, nbytes) < 0)
+    {
+        return -1;
+    }
+    if (_PyLong_AsByteArray((PyLongObject *)v,
+                            (unsigned char *)w->buf + w->len, nbytes,
+                            1, 1) < 0) {
+        return -1;
+    }
+    w->len += nbytes;
+    return 0;
+}
+
+static int
+w_code(CacheWriter *w, PyCodeObject *co)
+{
+    if (w_byte(w, TYPE_CODE) < 0
+        || w_varint(w, co->co_argcount) < 0
+        || w_varint(w, co->co_posonlyargcount) < 0
+        || w_varint(w, co->co_kwonlyargcount) < 0
+        || w_varint(w, co->co_nlocals) < 0
+        || w_varint(w, co->co_stacksize) < 0
+        || w_varint(w, co->co_flags) < 0
+        || w_varint(w, co->co_firstlineno) < 0
+        || w_object(w, co->co_code) < 0
+        || w_object(w, co->co_consts) < 0
+        || w_object(w, co->co_names) < 0
+        || w_object(w, co->co_varnames) < 0
+        || w_object(w, co->co_freevars) < 0
+        || w_object(w, co->co_cellvars) < 0
+        || w_object(w, co->co_filename) < 0
+        || w_object(w, co->co_name) < 0
+        || w_object(w, co->co_lnotab) < 0)
+    {
+        return -1;
+    }
+    return 0;
+}
+
+static int
+w_object(CacheWriter *w, PyObject *v)
+{
+    int res;
+
+    if (++w->depth > MAX_DEPTH) {
+        PyErr_SetString(PyExc_ValueError, "object too deeply nested to cache");
+        return -1;
+    }
+
+    if (v == Py_None) {
+        res = w_byte(w, TYPE_NONE);
+    }
+    else if (v == Py_Ellipsis) {
+        res = w_byte(w, TYPE_ELLIPSIS);
+    }
+    else if (v == Py_False) {
+        res = w_byte(w, TYPE_FALSE);
+    }
+    else if (v == Py_True) {
+        res = w_byte(w, TYPE_TRUE);
+    }
+    else if (PyLong_CheckExact(v)) {
+        res = w_long(w, v);
+    }
+    else if (PyFloat_CheckExact(v)) {
+        double d = PyFloat_AsDouble(v);
+        uint64_t bits;
+        memcpy(&bits, &d, sizeof(bits));
+        res = w_byte(w, TYPE_FLOAT);
+        if (res == 0) {
+            res = w_uint(w, bits, 8);
+        }
+    }
+    else if (PyString_CheckExact(v)) {
+        res = w_string(w, v);
+    }
+    else if (PyTuple_CheckExact(v)) {
+        Py_ssize_t n = PyTuple_Size(v);
+        res = w_byte(w, TYPE_TUPLE);
+        if (res == 0) {
+            res = w_varint(w, n);
+        }
+        for (Py_ssize_t i = 0; res == 0 && i < n; i++) {
+            res = w_object(w, PyTuple_GetItem(v, i));
+        }
+    }
+    else if (PyFrozenSet_CheckExact(v)) {
+        Py_ssize_t pos = 0;
+        PyObject *item;
+        Py_hash_t hash;
+        res = w_byte(w, TYPE_FROZENSET);
+        if (res == 0) {
+            res = w_varint(w, PySet_Size(v));
+        }
+        while (res == 0 && PySet_NextEntry(v, &pos, &item, &hash)) {
+            res = w_object(w, item);
+        }
+    }
+    else if (PyCode_Check(v)) {
+        res = w_code(w, (PyCodeObject *)v);
+    }
+    else {
+        PyErr_Format(PyExc_ValueError, "can't cache a %.200s object",
+                     Py_TYPE(v)->tp_name);
+        res = -1;
+    }
+
+    w->depth--;
+    return res;
+}
+
+static void
+writer_clear(CacheWriter *w)
+{
+    PyMem_Free(w->buf);
+    Py_XDECREF(w->strings);
+}
+
+
+/* --- Reader ------------------------------------------------------------ */
+
+typedef struct {
+    const unsigned char *ptr;
+    const unsigned char *end;
+    PyObject *strings;          /* list: index -> str */
+    int depth;
+} CacheReader;
+
+static int
+bad_data(void)
+{
+    PyErr_SetString(PyExc_ValueError, "bad code cache data");
+    return -1;
+}
+
+static const unsigned char *
+r_bytes(CacheReader *r, Py_ssize_t n)
+{
+    if (n < 0 || r->end - r->ptr < n) {
+        bad_data();
+        return NULL;
+    }
+    const unsigned char *data = r->ptr;
+    r->ptr += n;
+    return data;
+}
+
+static int
+r_uint(CacheReader *r, int size, uint64_t *x)
+{
+    const unsigned char *data = r_bytes(r, size);
+    if (data == NULL) {
+        return -1;
+    }
+    *x = 0;
+    for (int i = 0; i < size; i++) {
+        *x |= (uint64_t)data[i] << (8 * i);
+    }
+    return 0;
+}
+
+static int
+r_varint(CacheReader *r, uint64_t *x)
+{
+    *x = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (r->ptr >= r->end) {
+            return bad_data();
+        }
+        unsigned char byte = *r->ptr++;
+        *x |= (uint64_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            return 0;
+        }
+    }
+    return bad_data();
+}
+
+static int
+r_size(CacheReader *r, Py_ssize_t *n)
+{
+    uint64_t x;
+    if (r_varint(r, &x) < 0) {
+        return -1;
+    }
+    /* Every item takes at least one byte */
+    if (x > (uint64_t)(r->end - r->ptr)) {
+        return bad_data();
+    }
+    *n = (Py_ssize_t)x;
+    return 0;
+}
+
+static int
+r_int(CacheReader *r, int *value)
+{
+    uint64_t x;
+    if (r_varint(r, &x) < 0) {
+        return -1;
+    }
+    if (x > INT_MAX) {
+        return bad_data();
+    }
+    *value = (int)x;
+    return 0;
+}
+
+static PyObject *r_object(CacheReader *r);
+
+static PyObject *
+r_code(CacheReader *r)
+{
+    int argcount, posonlyargcount, kwonlyargcount, nlocals, stacksize;
+    int flags, firstlineno;
+    PyObject *code = NULL, *consts = NULL, *names = NULL, *varnames = NULL;
+    PyObject *freevars = NULL, *cellvars = NULL, *filename = NULL;
+    PyObject *name = NULL, *lnotab = NULL;
+    PyObject *v = NULL;
+
+    if (r_int(r, &argcount) < 0
+        || r_int(r, &posonlyargcount) < 0
+        || r_int(r, &kwonlyargcount) < 0
+        || r_int(r, &nlocals) < 0
+        || r_int(r, &stacksize) < 0
+        || r_int(r, &flags) < 0
+        || r_int(r, &firstlineno) < 0
+        || (code = r_object(r)) == NULL
+        || (consts = r_object(r)) == NULL
+        || (names = r_object(r)) == NULL
+        || (varnames = r_object(r)) == NULL
+        || (freevars = r_object(r)) == NULL
+        || (cellvars = r_object(r)) == NULL
+        || (filename = r_object(r)) == NULL
+        || (name = r_object(r)) == NULL
+        || (lnotab = r_object(r)) == NULL)
+    {
+        goto done;
+    }
+    if (!PyString_CheckExact(code) || !PyTuple_CheckExact(consts)
+        || !PyTuple_CheckExact(names) || !PyTuple_CheckExact(varnames)
+        || !PyTuple_CheckExact(freevars) || !PyTuple_CheckExact(cellvars)
+        || !PyString_CheckExact(filename) || !PyString_CheckExact(name)
+        || !PyString_CheckExact(lnotab))
+    {
+        bad_data();
+        goto done;
+    }
+
+    v = (PyObject *)PyCode_NewWithPosOnlyArgs(
+            argcount, posonlyargcount, kwonlyargcount, nlocals, stacksize,
+            flags, code, consts, names, varnames, freevars, cellvars,
+            filename, name, firstlineno, lnotab);
+
+done:
+    Py_XDECREF(code);
+    Py_XDECREF(consts);
+    Py_XDECREF(names);
+    Py_XDECREF(varnames);
+    Py_XDECREF(freevars);
+    Py_XDECREF(cellvars);
+    Py_XDECREF(filename);
+    Py_XDECREF(name);
+    Py_XDECREF(lnotab);
+    return v;
+}
+
+static PyObject *
+r_object(CacheReader *r)
+{
+    PyObject *v = NULL;
+    const unsigned char *data;
+    uint64_t x;
+    Py_ssize_t n;
+
+    if (++r->depth > MAX_DEPTH) {
+        bad_data();
+        return NULL;
+    }
+    if ((data = r_bytes(r, 1)) == NULL) {
+        goto done;
+    }
+
+    switch (*data) {
+    case TYPE_NONE:
+        v = Py_None;
+        Py_INCREF(v);
+        break;
+
+    case TYPE_ELLIPSIS:
+        v = Py_Ellipsis;
+        Py_INCREF(v);
+        break;
+
+    case TYPE_FALSE:
+        v = Py_False;
+        Py_INCREF(v);
+        break;
+
+    case TYPE_TRUE:
+        v = Py_True;
+        Py_INCREF(v);
+        break;
+
+    case TYPE_INT:
+        if (r_varint(r, &x) == 0) {
+            long long value = (long long)(x >> 1) ^ -(long long)(x & 1);
+            v = PyLong_FromLongLong(value);
+        }
+        break;
+
+    case TYPE_LONG:
+        if (r_size(r, &n) == 0 && (data = r_bytes(r, n)) != NULL) {
+            v = _PyLong_FromByteArray(data, n, 1, 1);
+        }
+        break;
+
+    case TYPE_FLOAT:
+        if (r_uint(r, 8, &x) == 0) {
+            double d;
+            memcpy(&d, &x, sizeof(d));
+            v = PyFloat_FromDouble(d);
+        }
+        break;
+
+    case TYPE_STRING:
+        if (r_size(r, &n) == 0 && (data = r_bytes(r, n)) != NULL) {
+            v = PyString_FromStringAndSize((const char *)data, n);
+            if (v != NULL && PyList_Append(r->strings, v) < 0) {
+                Py_CLEAR(v);
+            }
+        }
+        break;
+
+    case TYPE_REF:
+        if (r_varint(r, &x) == 0) {
+            if (x >= (uint64_t)PyList_Size(r->strings)) {
+                bad_data();
+                break;
+            }
+            v = PyList_GetItem(r->strings, (Py_ssize_t)x);
+            Py_INCREF(v);
+        }
+        break;
+
+    case TYPE_TUPLE:
+        if (r_size(r, &n) < 0 || (v = PyTuple_New(n)) == NULL) {
+            break;
+        }
+        for (Py_ssize_t i = 0; i < n; i++) {
+            PyObject *item = r_object(r);
+            if (item == NULL) {
+                Py_CLEAR(v);
+                break;
+            }
+            PyTuple_InitItem(v, i, item);
+        }
+        break;
+
+    case TYPE_FROZENSET:
+        if (r_size(r, &n) < 0 || (v = PyFrozenSet_New(NULL)) == NULL) {
+            break;
+        }
+        for (Py_ssize_t i = 0; i < n; i++) {
+            PyObject *item = r_object(r);
+            if (item == NULL || PySet_Add(v, item) < 0) {
+                Py_XDECREF(item);
+                Py_CLEAR(v);
+                break;
+            }
+            Py_DECREF(item);
+        }
+        break;
+
+    case TYPE_CODE:
+        v = r_code(r);
+        break;
+
+    default:
+        bad_data();
+        break;
+    }
+
+done:
+    r->depth--;
+    return v;
+}
+
+
+/* --- Serialization ----------------------------------------------------- */
+
+static int
+dump_object(CacheWriter *w, PyObject *v)
+{
+    w->strings = PyDict_New();
+    if (w->strings == NULL) {
+        return -1;
+    }
+    return w_object(w, v);
+}
+
+PyObject *
+_PyCodeCache_Dumps(PyObject *v)
+{
+    CacheWriter w = {0};
+    PyObject *res = NULL;
+    if (dump_object(&w, v) == 0) {
+        res = PyString_FromStringAndSize(w.buf, w.len);
+    }
+    writer_clear(&w);
+    return res;
+}
+
+static PyObject *
+load_object(CacheReader *r)
+{
+    r->strings = PyList_New(0);
+    if (r->strings == NULL) {
+        return NULL;
+    }
+    PyObject *v = r_object(r);
+    Py_CLEAR(r->strings);
+    if (v != NULL && r->ptr != r->end) {
+        Py_DECREF(v);
+        bad_data();
+        return NULL;
+    }
+    return v;
+}
+
+PyObject *
+_PyCodeCache_Loads(const char *data, Py_ssize_t size)
+{
+    CacheReader r = {
+        .ptr = (const unsigned char *)data,
+        .end = (const unsigned char *)data + size,
+    };
+    return load_object(&r);
+}
+
+
+/* --- Cache files ------------------------------------------------------- */
+
+/* Write the cache directory into buf.  Return 0 if there is none. */
+static int
+cache_dir(char *buf, size_t size)
+{
+    PyObject *prefix = PySys_GetObject("pycache_prefix");
+    if (prefix != NULL && PyString_Check(prefix)) {
+        return PyOS_snprintf(buf, size, "%s", PyString_AsChar(prefix))
+               < (int)size;
+    }
+
+    const char *base = getenv("XDG_CACHE_HOME");
+    if (base != NULL && base[0] == '/') {
+        return PyOS_snprintf(buf, size, "%s/python-codecache", base)
+               < (int)size;
+    }
+    base = getenv("HOME");
+    if (base != NULL && base[0] == '/') {
+        return PyOS_snprintf(buf, size, "%s/.cache/python-codecache", base)
+               < (int)size;
+    }
+    return 0;
+}
+
+/* Get the cache file path of the source file 'abspath' */
+static int
+cache_path(const char *abspath, char *buf, size_t size)
+{
+    char dir[MAXPATHLEN];
+    if (!cache_dir(dir, sizeof(dir))) {
+        return 0;
+    }
+
+    /* FNV-1a: must not depend on the randomized string hash */
+    uint64_t hash = 14695981039346656037ULL;
+    for (const unsigned char *p = (const unsigned char *)abspath; *p; p++) {
+        hash = (hash ^ *p) * 1099511628211ULL;
+    }
+    return PyOS_snprintf(buf, size, "%s/%016llx.pyc", dir,
+                         (unsigned long long)hash) < (int)size;
+}
+
+static uint64_t
+stat_mtime_nsec(const struct _Py_stat_struct *st)
+{
+#ifdef HAVE_STAT_TV_NSEC
+    return st->st_mtim.tv_nsec;
+#else
+    return 0;
+#endif
+}
+
+static PyObject *
+cache_load(const char *abspath, const struct _Py_stat_struct *st)
+{
+    char path[MAXPATHLEN];
+    if (!cache_path(abspath, path, sizeof(path))) {
+        return NULL;
+    }
+    int fd = _Py_open_noraise(path, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    PyObject *v = NULL;
+    char *data = NULL;
+    struct _Py_stat_struct cst;
+    if (_Py_fstat_noraise(fd, &cst) < 0 || cst.st_size <= 0) {
+        goto done;
+    }
+    data = PyMem_Malloc(cst.st_size);
+    if (data == NULL) {
+        goto done;
+    }
+    if (_Py_read(fd, data, cst.st_size) != cst.st_size) {
+        goto done;
+    }
+
+    CacheReader r = {
+        .ptr = (const unsigned char *)data,
+        .end = (const unsigned char *)data + cst.st_size,
+    };
+    const unsigned char *tag = r_bytes(&r, 4);
+    uint64_t magic, mtime, mtime_nsec, size;
+    Py_ssize_t pathlen;
+    const unsigned char *srcpath;
+    if (tag == NULL || memcmp(tag, "PYCC", 4) != 0
+        || r_uint(&r, 4, &magic) < 0 || magic != CODECACHE_MAGIC
+        || r_uint(&r, 8, &mtime) < 0 || mtime != (uint64_t)st->st_mtime
+        || r_uint(&r, 4, &mtime_nsec) < 0 || mtime_nsec != stat_mtime_nsec(st)
+        || r_uint(&r, 8, &size) < 0 || size != (uint64_t)st->st_size
+        || r_size(&r, &pathlen) < 0 || (srcpath = r_bytes(&r, pathlen)) == NULL
+        || pathlen != (Py_ssize_t)strlen(abspath)
+        || memcmp(srcpath, abspath, pathlen) != 0)
+    {
+        goto done;
+    }
+    v = load_object(&r);
+    if (v != NULL && !PyCode_Check(v)) {
+        Py_CLEAR(v);
+    }
+
+done:
+    close(fd);
+    PyMem_Free(data);
+    return v;
+}
+
+/* Create the directories of path, like "mkdir -p" on its dirname */
+static int
+make_parents(char *path)
+{
+    for (char *p = path + 1; *p; p++) {
+        if (*p != '/') {
+            continue;
+        }
+        *p = '\0';
+        int res = mkdir(path, 0700);
+        *p = '/';
+        if (res < 0 && errno != EEXIST) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int
+cache_store(const char *abspath, const struct _Py_stat_struct *st,
+            PyObject *code)
+{
+    PyObject *flag = PySys_GetObject("dont_write_bytecode");
+    if (flag != NULL && PyObject_IsTrue(flag)) {
+        return 0;
+    }
+
+    char path[MAXPATHLEN], tmp[MAXPATHLEN + 32];
+    if (!cache_path(abspath, path, sizeof(path))) {
+        return 0;
+    }
+
+    CacheWriter w = {0};
+    size_t pathlen = strlen(abspath);
+    int res = -1;
+    if (w_bytes(&w, "PYCC", 4) < 0
+        || w_uint(&w, CODECACHE_MAGIC, 4) < 0
+        || w_uint(&w, (uint64_t)st->st_mtime, 8) < 0
+        || w_uint(&w, stat_mtime_nsec(st), 4) < 0
+        || w_uint(&w, (uint64_t)st->st_size, 8) < 0
+        || w_varint(&w, pathlen) < 0
+        || w_bytes(&w, abspath, pathlen) < 0
+        || dump_object(&w, code) < 0)
+    {
+        goto done;
+    }
+
+    /* Write a temporary file and rename it, so that a concurrent reader
+       never sees a partial file */
+    PyOS_snprintf(tmp, sizeof(tmp), "%s.%ld.tmp", path, (long)getpid());
+    if (make_parents(tmp) < 0) {
+        goto done;
+    }
+    int fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        goto done;
+    }
+    Py_ssize_t n = _Py_write_noraise(fd, w.buf, w.len);
+    if (close(fd) < 0 || n != w.len || rename(tmp, path) < 0) {
+        unlink(tmp);
+        goto done;
+    }
+    res = 0;
+
+done:
+    writer_clear(&w);
+    return res;
+}
+
+
+/* Return the cached code object of the source file 'filename', or NULL if
+   there is no valid cache entry.  Never raises. */
+PyObject *
+_PyCodeCache_Load(const char *filename, const struct _Py_stat_struct *st)
+{
+    char *abspath;
+    if (_Py_abspath(filename, &abspath) < 0 || abspath == NULL) {
+        PyErr_Clear();
+        return NULL;
+    }
+
+    PyObject *type, *value, *traceback;
+    PyErr_Fetch(&type, &value, &traceback);
+    PyObject *code = cache_load(abspath, st);
+    PyErr_Clear();
+    PyErr_Restore(type, value, traceback);
+    PyMem_Free(abspath);
+    return code;
+}
+
+/* Store the code object compiled from the source file 'filename'.  Errors
+   are ignored: the module is simply compiled again next time. */
+void
+_PyCodeCache_Store(const char *filename, const struct _Py_stat_struct *st,
+                   PyObject *code)
+{
+    char *abspath;
+    if (_Py_abspath(filename, &abspath) < 0 || abspath == NULL) {
+        PyErr_Clear();
+        return;
+    }
+
+    PyObject *type, *value, *traceback;
+    PyErr_Fetch(&type, &value, &traceback);
+    (void)cache_store(abspath, st, code);
+    PyErr_Clear();
+    PyErr_Restore(type, value, traceback);
+    PyMem_Free(abspath);
+}
@@ -29,6 +29,9 @@
 #include "symtable.h"
 #include "opcode.h"
 #include "wordcode_helpers.h"
+#include "pycore_compile.h"       // _PyCompile_StageStart()
+
+#include <time.h>                 // clock_gettime()
 
 #define DEFAULT_BLOCK_SIZE 16
 #define DEFAULT_BLOCKS 8
@@ -298,6 +301,77 @@ compiler_init(struct compiler *c)
     return 1;
 }
 
+/* Compilation statistics (see pycore_compile.h) */
+
+static struct {
+    long calls;
+    int64_t time[_PyCompile_NSTAGES];
+} compile_stats;
+
+static const char * const compile_stage_names[_PyCompile_NSTAGES] = {
+    "tokenize", "parse", "optimize", "symtable", "codegen", "assemble",
+};
+
+int _PyCompile_stats_enabled = 0;
+
+int64_t
+_PyCompile_StageStart(void)
+{
+    if (!_PyCompile_stats_enabled) {
+        return 0;
+    }
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+void
+_PyCompile_StageEnd(_PyCompile_Stage stage, int64_t start)
+{
+    if (_PyCompile_stats_enabled) {
+        compile_stats.time[stage] += _PyCompile_StageStart() - start;
+    }
+}
+
+void
+_PyCompile_SetStats(int enabled)
+{
+    memset(&compile_stats, 0, sizeof(compile_stats));
+    _PyCompile_stats_enabled = enabled;
+}
+
+PyObject *
+_PyCompile_GetStats(void)
+{
+    PyObject *stats = PyDict_New();
+    if (stats == NULL) {
+        return NULL;
+    }
+    for (int i = 0; i < _PyCompile_NSTAGES; i++) {
+        int64_t t = compile_stats.time[i];
+        if (i == _PyCompile_CODEGEN) {
+            t -= compile_stats.time[_PyCompile_ASSEMBLE];
+        }
+        PyObject *value = PyFloat_FromDouble(t / 1e9);
+        if (value == NULL ||
+            PyDict_SetItemString(stats, compile_stage_names[i], value) < 0)
+        {
+            Py_XDECREF(value);
+            Py_DECREF(stats);
+            return NULL;
+        }
+        Py_DECREF(value);
+    }
+    PyObject *calls = PyLong_FromLong(compile_stats.calls);
+    if (calls == NULL || PyDict_SetItemString(stats, "calls", calls) < 0) {
+        Py_XDECREF(calls);
+        Py_DECREF(stats);
+        return NULL;
+    }
+    Py_DECREF(calls);
+    return stats;
+}
+
 PyCodeObject *
 PyAST_CompileObject(mod_ty mod, PyObject *filename, PyCompilerFlags *flags,
 		    int optimize)
@@ -328,18 +402,27 @@ PyAST_CompileObject(mod_ty mod, PyObject *filename, PyCompilerFlags *flags,
     state.optimize = c.c_optimize;
     state.ff_features = flags->cf_flags;
 
+    int64_t start = _PyCompile_StageStart();
     if (!_PyAST_Optimize(mod, &state)) {
         goto finally;
     }
+    _PyCompile_StageEnd(_PyCompile_OPTIMIZE, start);
 
+    start = _PyCompile_StageStart();
     c.c_st = PySymtable_BuildObject(mod, filename);  // , c.c_future);
     if (c.c_st == NULL) {
         if (!PyErr_Occurred())
             PyErr_SetString(PyExc_SystemError, "no symtable");
         goto finally;
     }
+    _PyCompile_StageEnd(_PyCompile_SYMTABLE, start);
 
+    start = _PyCompile_StageStart();
     co = compiler_mod(&c, mod);
+    _PyCompile_StageEnd(_PyCompile_CODEGEN, start);
+    if (_PyCompile_stats_enabled) {
+        compile_stats.calls++;
+    }
 
  finally:
     compiler_free(&c);
@@ -347,6 +430,7 @@ PyAST_CompileObject(mod_ty mod, PyObject *filename, PyCompilerFlags *flags,
     return co;
 }
 
+
 PyCodeObject *
 PyAST_CompileEx(mod_ty mod, const char *filename_str, PyCompilerFlags *flags,
                 int optimize)
@@ -1046,6 +1130,7 @@ stack_effect(int opcode, int oparg, int jump)
         case LOAD_ASSERTION_ERROR:
             return 1;
         case LIST_TO_TUPLE:
+        case RESERVE_FROM_HINT:
             return 0;
         case LIST_EXTEND:
         case SET_UPDATE:
@@ -4086,6 +4171,12 @@ compiler_sync_comprehension_generator(struct compiler *c,
         /* Receive outermost iter as an implicit argument */
         c->u->u_argcount = 1;
         ADDOP_I(c, LOAD_FAST, 0);
+        /* With a single loop and no condition, the result has as many
+           items as the iterator: presize it from its length hint */
+        if (type != COMP_GENEXP && asdl_seq_LEN(generators) == 1
+            && asdl_seq_LEN(gen->ifs) == 0) {
+            ADDOP(c, RESERVE_FROM_HINT);
+        }
     }
     else {
         /* Sub-iter - calculate on the fly */
@@ -5285,6 +5376,7 @@ assemble(struct compiler *c, int addNone)
     basicblock *b, *entryblock;
     struct assembler a;
     int i, j, nblocks;
+    int64_t start;
     PyCodeObject *co = NULL;
 
     /* Make sure every block that falls off the end returns None.
@@ -5298,6 +5390,7 @@ assemble(struct compiler *c, int addNone)
         ADDOP(c, RETURN_VALUE);
     }
 
+    start = _PyCompile_StageStart();
     nblocks = 0;
     entryblock = NULL;
     for (b = c->u->u_blocks; b != NULL; b = b->b_list) {
@@ -5335,6 +5428,7 @@ assemble(struct compiler *c, int addNone)
     co = makecode(c, &a);
  error:
     assemble_free(&a);
+    _PyCompile_StageEnd(_PyCompile_ASSEMBLE, start);
     return co;
 }
 
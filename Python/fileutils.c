@@ -14,6 +14,10 @@
 #include <fcntl.h>
 #endif /* HAVE_FCNTL_H */
 
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
+
 #ifdef O_CLOEXEC
 /* Does open() support the O_CLOEXEC flag? Possible values:
 
@@ -748,3 +752,65 @@ error:
     PyErr_SetFromErrno(PyExc_OSError);
     return -1;
 }
+
+
+/* Files smaller than this are read: for them, read() into the heap costs
+   less than mmap(), the page faults and munmap(). */
+#define SOURCE_MAP_MIN_SIZE (64 * 1024)
+
+/* Memory-map a source file, so that the tokenizer scans the page cache
+   directly instead of a copy of the file.
+
+   The tokenizer needs a NUL-terminated string: the mapping is only used
+   when the file does not end on a page boundary, so that the zero-filled
+   tail of the last page terminates the text. */
+int
+_Py_MapSourceFile(int fd, off_t offset, off_t file_size,
+                  _Py_SourceMapping *map)
+{
+#if defined(HAVE_MMAP) && defined(HAVE_SYS_MMAN_H)
+    static long page_size = 0;
+    if (page_size == 0) {
+        page_size = sysconf(_SC_PAGESIZE);
+        if (page_size <= 0) {
+            page_size = -1;
+        }
+    }
+    if (page_size < 0
+        || offset < 0 || offset > file_size
+        || file_size - offset < SOURCE_MAP_MIN_SIZE
+        || (size_t)file_size != (unsigned long long)file_size
+        || file_size % page_size == 0)
+    {
+        return 0;
+    }
+
+    /* MAP_PRIVATE: the file is never modified, whatever the process does
+       with the pages */
+    void *addr = mmap(NULL, (size_t)file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr == MAP_FAILED) {
+        return 0;
+    }
+#ifdef MADV_SEQUENTIAL
+    (void)madvise(addr, (size_t)file_size, MADV_SEQUENTIAL);
+#endif
+    map->addr = addr;
+    map->length = (size_t)file_size;
+    map->text = (const char *)addr + offset;
+    map->size = (Py_ssize_t)(file_size - offset);
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+void
+_Py_UnmapSourceFile(_Py_SourceMapping *map)
+{
+#if defined(HAVE_MMAP) && defined(HAVE_SYS_MMAN_H)
+    if (map->addr != NULL) {
+        (void)munmap(map->addr, map->length);
+        map->addr = NULL;
+    }
+#endif
+}
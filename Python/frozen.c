@@ -0,0 +1,36 @@
+/* Frozen modules
+
+   The core Lib modules imported at every startup are compiled at build time
+   by Programs/_freeze_module and linked into the interpreter as serialized
+   code objects (see Python/codecache.c).  The import system looks them up
+   here before searching sys.path, unless -X frozen_modules=off is given.
+
+   To add a module, add it to FROZEN_FILES_IN/FROZEN_FILES_OUT and give it a
+   rule in Makefile.pre.in, then include its header and add an entry below.
+*/
+
+#include "Python.h"
+
+#include "Python/frozen_modules/genericpath.h"
+#include "Python/frozen_modules/io.h"
+#include "Python/frozen_modules/os.h"
+#include "Python/frozen_modules/posixpath.h"
+#include "Python/frozen_modules/site.h"
+#include "Python/frozen_modules/stat.h"
+
+#define FROZEN(NAME) {#NAME, _Py_M__##NAME, (int)sizeof(_Py_M__##NAME)}
+
+static const struct _frozen _PyImport_FrozenModules[] = {
+    FROZEN(genericpath),
+    FROZEN(io),
+    FROZEN(os),
+    FROZEN(posixpath),
+    FROZEN(site),
+    FROZEN(stat),
+    {0, 0, 0} /* sentinel */
+};
+
+/* Embedding apps may change this pointer to point to their favorite
+   collection of frozen modules: */
+
+const struct _frozen *PyImport_FrozenModules = _PyImport_FrozenModules;
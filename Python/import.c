@@ -4,6 +4,9 @@
 
 #include "Python-ast.h"
 #undef Yield   /* undefine macro conflicting with <winbase.h> */
+#include "pycore_codecache.h"     // _PyCodeCache_Load()
+#include "pycore_fileutils.h"     // _Py_MapSourceFile()
+#include "pycore_import.h"        // _PyImportTimer
 #include "pycore_initconfig.h"
 #include "pycore_pyerrors.h"
 #include "pycore_pyhash.h"
@@ -17,13 +20,90 @@
 #ifdef HAVE_FCNTL_H
 #include <fcntl.h>
 #endif
+#include <time.h>                 // clock_gettime()
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/* -X importtime: time imports and initialization phases
+
+   Each timed section prints one line when it ends, nested sections are
+   indented below their parent's line.  Initialization phases are shown
+   between angle brackets:
+
+       import time: self [us] | cumulative | imported package
+       import time:        43 |         43 |       _io
+       import time:        72 |        115 |     io
+       import time:        16 |        131 |   <init_sys_streams>
+
+   "self" excludes the time spent in nested sections. */
+
+static struct {
+    FILE *file;                 /* NULL if disabled */
+    int level;                  /* nesting depth */
+    int64_t accumulated;        /* time of the nested sections ended so far */
+} import_time;
+
+static int64_t
+import_time_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+void
+_PyImport_InitTiming(const PyConfig *config)
+{
+    if (!config->import_time || import_time.file != NULL) {
+        return;
+    }
+    if (config->import_time_file != NULL) {
+        import_time.file = fopen(config->import_time_file, "w");
+        if (import_time.file == NULL) {
+            fprintf(stderr, "-X importtime: cannot open %s: %s\n",
+                    config->import_time_file, strerror(errno));
+            return;
+        }
+    }
+    else {
+        import_time.file = stderr;
+    }
+    fputs("import time: self [us] | cumulative | imported package\n",
+          import_time.file);
+}
+
+void
+_PyImport_TimerStart(_PyImportTimer *timer)
+{
+    if (import_time.file == NULL) {
+        return;
+    }
+    timer->accumulated = import_time.accumulated;
+    import_time.accumulated = 0;
+    import_time.level++;
+    timer->start = import_time_now();
+}
+
+void
+_PyImport_TimerStop(_PyImportTimer *timer, const char *name)
+{
+    if (import_time.file == NULL) {
+        return;
+    }
+    int64_t cum = import_time_now() - timer->start;
+    import_time.level--;
+    fprintf(import_time.file, "import time: %9ld | %10ld | %*s%s\n",
+            (long)((cum - import_time.accumulated + 999) / 1000),
+            (long)((cum + 999) / 1000),
+            import_time.level * 2, "", name);
+    import_time.accumulated = timer->accumulated + cum;
+}
+
 /* Forward references */
 static PyObject *import_add_module(PyThreadState *tstate, PyObject *name);
+static void path_listings_clear(void);
 
 /* See _PyImport_FixupExtensionObject() below */
 static PyObject *extensions = NULL;
@@ -37,6 +117,10 @@ static struct _inittab *inittab_copy = NULL;
 void
 _PyImport_Fini(void)
 {
+    if (import_time.file != NULL && import_time.file != stderr) {
+        fclose(import_time.file);
+    }
+    import_time.file = NULL;
 }
 
 void
@@ -147,6 +231,8 @@ _PyImport_Cleanup(PyThreadState *tstate)
         return;
     }
 
+    path_listings_clear();
+
     /* Delete some special variables first.  These are common
        places where user values hide and people complain when their
        destructors fail.  Since the modules containing them are
@@ -554,6 +640,109 @@ is_builtin(PyObject *name)
 }
 
 
+/* Frozen modules */
+
+/* Remove a module whose body failed from sys.modules, keeping the error */
+static void
+remove_module(PyThreadState *tstate, PyObject *name)
+{
+    PyObject *type, *value, *traceback;
+    _PyErr_Fetch(tstate, &type, &value, &traceback);
+    if (PyMapping_DelItem(tstate->interp->modules, name) < 0) {
+        _PyErr_Clear(tstate);
+    }
+    _PyErr_Restore(tstate, type, value, traceback);
+}
+
+static const struct _frozen *
+find_frozen(PyThreadState *tstate, PyObject *name)
+{
+    const struct _frozen *p;
+
+    if (name == NULL || PyImport_FrozenModules == NULL) {
+        return NULL;
+    }
+    if (!_PyInterpreterState_GetConfig(tstate->interp)->use_frozen_modules) {
+        return NULL;
+    }
+    for (p = PyImport_FrozenModules; p->name != NULL; p++) {
+        if (_PyString_EqualToASCIIString(name, p->name)) {
+            return p;
+        }
+    }
+    return NULL;
+}
+
+/* Initialize a frozen module.
+   Return 1 for success, 0 if the module is not found, and -1 with
+   an exception set if the initialization failed. */
+
+int
+PyImport_ImportFrozenModuleObject(PyObject *name)
+{
+    PyThreadState *tstate = PyThreadState_Get();
+    const struct _frozen *p;
+    PyObject *co, *m, *d, *v;
+
+    p = find_frozen(tstate, name);
+    if (p == NULL) {
+        return 0;
+    }
+    if (p->code == NULL) {
+        _PyErr_Format(tstate, PyExc_ImportError,
+                      "Excluded frozen object named %R",
+                      name);
+        return -1;
+    }
+    co = _PyCodeCache_Loads((const char *)p->code, p->size);
+    if (co == NULL) {
+        return -1;
+    }
+    if (!PyCode_Check(co)) {
+        _PyErr_Format(tstate, PyExc_TypeError,
+                      "frozen object %R is not a code object",
+                      name);
+        goto err_return;
+    }
+    m = import_add_module(tstate, name);
+    if (m == NULL) {
+        goto err_return;
+    }
+    d = PyModule_GetDict(m);
+    if (PyDict_GetItemString(d, "__builtins__") == NULL &&
+        PyDict_SetItemString(d, "__builtins__",
+                             tstate->interp->builtins) < 0) {
+        goto err_return;
+    }
+    v = PyEval_EvalCode(co, d, d);
+    if (v == NULL) {
+        remove_module(tstate, name);
+        goto err_return;
+    }
+    Py_DECREF(co);
+    Py_DECREF(v);
+    return 1;
+
+err_return:
+    Py_DECREF(co);
+    return -1;
+}
+
+int
+PyImport_ImportFrozenModule(const char *name)
+{
+    PyObject *nameobj;
+    int ret;
+    nameobj = PyString_FromString(name);
+    if (nameobj == NULL) {
+        return -1;
+    }
+    ret = PyImport_ImportFrozenModuleObject(nameobj);
+    Py_DECREF(nameobj);
+    return ret;
+}
+
+
 /* Return a finder object for a sys.path/pkg.__path__ item 'p',
    possibly by fetching it from the path_importer_cache dict. If it
    wasn't yet cached, traverse path_hooks until a hook is found
@@ -725,27 +914,222 @@ done:
 
 #include "osdefs.h"
 
+/* sys.path directory listings
+
+   Finding a module used to cost one open() per sys.path entry until one
+   succeeded.  Instead, the names of the .py files of each entry are listed
+   once and kept in path_listings, which maps an entry to a capsule of a
+   struct path_listing.
+
+   A listing is checked against a stat() of the directory, and re-read when
+   the directory was replaced or modified, once per import pass: the
+   outermost import and the imports it triggers while the module runs.
+   Within a pass a lookup is only a set probe.  A directory modified less
+   than PATH_LISTING_RACY_NS before it was listed may change again within
+   the same mtime tick, so such a listing is checked on every lookup and
+   re-read.  The whole cache is dropped whenever sys.path changes. */
+
+#ifdef HAVE_DIRENT_H
+#include <dirent.h>
+#endif
+
+#define PATH_LISTING_RACY_NS 2000000000LL
+#define PATH_LISTING_CAPSULE "import.path_listing"
+
+struct path_listing {
+    long long dev;
+    long long ino;
+    long long mtime;            /* ns, or -1 if the listing may be racy */
+    unsigned long pass;         /* import pass it was last checked in */
+    PyObject *names;            /* set of module names */
+};
+
+static PyObject *path_listings = NULL;  /* dict: see above */
+static PyObject *path_snapshot = NULL;  /* copy of sys.path */
+static unsigned long path_pass = 0;     /* current import pass */
+static int path_import_depth = 0;       /* nesting of import_load() */
+
+static void
+path_listings_clear(void)
+{
+    Py_CLEAR(path_listings);
+    Py_CLEAR(path_snapshot);
+}
+
+/* Drop the cache if sys.path is not the list it was filled for */
+static int
+path_listings_check(PyObject *sys_path)
+{
+    if (path_snapshot != NULL) {
+        int eq = PyObject_RichCompareBool(path_snapshot, sys_path, Py_EQ);
+        if (eq < 0) {
+            return -1;
+        }
+        if (eq) {
+            return 0;
+        }
+        path_listings_clear();
+    }
+    path_snapshot = PySequence_List(sys_path);
+    if (path_snapshot == NULL) {
+        return -1;
+    }
+    path_listings = PyDict_New();
+    if (path_listings == NULL) {
+        Py_CLEAR(path_snapshot);
+        return -1;
+    }
+    return 0;
+}
+
+static long long
+stat_mtime_ns(const struct _Py_stat_struct *st)
+{
+#ifdef HAVE_STAT_TV_NSEC
+    return (long long)st->st_mtim.tv_sec * 1000000000LL + st->st_mtim.tv_nsec;
+#else
+    return (long long)st->st_mtime * 1000000000LL;
+#endif
+}
+
+#ifdef HAVE_DIRENT_H
+/* Return the set of module names of the .py files in dirname, or NULL.
+   Set *oserror and don't raise if the directory cannot be read. */
 static PyObject *
-import_find_and_load(PyThreadState *tstate, PyObject *abs_name)
+list_modules(const char *dirname, int *oserror)
+{
+    DIR *dirp = opendir(dirname);
+    if (dirp == NULL) {
+        *oserror = 1;
+        return NULL;
+    }
+    PyObject *names = PySet_New(NULL);
+    if (names == NULL) {
+        closedir(dirp);
+        return NULL;
+    }
+    struct dirent *ep;
+    while ((ep = readdir(dirp)) != NULL) {
+        size_t len = strlen(ep->d_name);
+        if (len <= 3 || strcmp(ep->d_name + len - 3, ".py") != 0) {
+            continue;
+        }
+        PyObject *name = PyString_FromStringAndSize(ep->d_name, len - 3);
+        if (name == NULL || PySet_Add(names, name) < 0) {
+            Py_XDECREF(name);
+            Py_DECREF(names);
+            closedir(dirp);
+            return NULL;
+        }
+        Py_DECREF(name);
+    }
+    closedir(dirp);
+    return names;
+}
+#endif
+
+#ifdef HAVE_DIRENT_H
+static void
+path_listing_free(PyObject *capsule)
+{
+    struct path_listing *pl = PyCapsule_GetPointer(capsule,
+                                                   PATH_LISTING_CAPSULE);
+    Py_DECREF(pl->names);
+    PyMem_Free(pl);
+}
+#endif
+
+/* Return 1 if the sys.path entry may contain the module abs_name, 0 if it
+   doesn't, and -1 with an exception set on error. */
+static int
+path_listing_contains(PyObject *entry, PyObject *abs_name)
+{
+#ifdef HAVE_DIRENT_H
+    if (!PyString_Check(entry)) {
+        return 0;
+    }
+    PyObject *capsule = PyDict_GetItemWithError(path_listings, entry);
+    if (capsule == NULL && PyErr_Occurred()) {
+        return -1;
+    }
+    struct path_listing *pl = NULL;
+    if (capsule != NULL) {
+        pl = PyCapsule_GetPointer(capsule, PATH_LISTING_CAPSULE);
+        if (pl->pass == path_pass && pl->mtime != -1) {
+            return PySet_Contains(pl->names, abs_name);
+        }
+    }
+
+    const char *dirname = PyString_AsChar(entry);
+    if (dirname[0] == '\0') {
+        dirname = ".";
+    }
+    struct _Py_stat_struct st;
+    if (stat(dirname, &st) != 0 || !S_ISDIR(st.st_mode)) {
+        return 0;
+    }
+    long long mtime = stat_mtime_ns(&st);
+    if (pl != NULL && pl->dev == (long long)st.st_dev
+        && pl->ino == (long long)st.st_ino && pl->mtime == mtime) {
+        pl->pass = path_pass;
+        return PySet_Contains(pl->names, abs_name);
+    }
+
+    int oserror = 0;
+    PyObject *names = list_modules(dirname, &oserror);
+    if (names == NULL) {
+        /* Unreadable directory: let open() decide */
+        return oserror ? 1 : -1;
+    }
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    if ((long long)now.tv_sec * 1000000000LL + now.tv_nsec - mtime
+        < PATH_LISTING_RACY_NS) {
+        mtime = -1;
+    }
+    pl = PyMem_Malloc(sizeof(struct path_listing));
+    if (pl == NULL) {
+        Py_DECREF(names);
+        PyErr_NoMemory();
+        return -1;
+    }
+    pl->dev = (long long)st.st_dev;
+    pl->ino = (long long)st.st_ino;
+    pl->mtime = mtime;
+    pl->pass = path_pass;
+    pl->names = names;
+    capsule = PyCapsule_New(pl, PATH_LISTING_CAPSULE, path_listing_free);
+    if (capsule == NULL) {
+        Py_DECREF(names);
+        PyMem_Free(pl);
+        return -1;
+    }
+    int res = PyDict_SetItem(path_listings, entry, capsule);
+    if (res == 0) {
+        res = PySet_Contains(pl->names, abs_name);
+    }
+    Py_DECREF(capsule);
+    return res;
+#else
+    return 1;
+#endif
+}
+
+static PyObject *
+import_load(PyThreadState *tstate, PyObject *abs_name)
 {
     PyObject *mod = NULL;
     PyObject *sys_path = PySys_GetObject("path");
 
-    /* Replacement for the import statement */
-    /* See if the module is in the module cache */
-    mod = import_get_module(tstate, abs_name);
-    if (mod) {
-      return mod;
-    }
-    PyErr_Clear();
-    
     /* Built-in modules */
     if (is_builtin(abs_name)) {
       struct _inittab *p;
       for (p = PyImport_Inittab; p->name != NULL; p++) {
 	if (_PyString_EqualToASCIIString(abs_name, p->name)) {
 	  if (p->initfunc == 0) {
+	    /* PyImport_AddModule() returns a borrowed reference */
 	    mod = PyImport_AddModule(PyString_AsChar(abs_name));
+	    Py_XINCREF(mod);
 	    return mod;
 	  }
 	  mod = (*p->initfunc)();
@@ -766,13 +1150,34 @@ import_find_and_load(PyThreadState *tstate, PyObject *abs_name)
 	}
       }
     }
+    /* Frozen modules: found before anything is read from sys.path */
+    {
+      int ret = PyImport_ImportFrozenModuleObject(abs_name);
+      if (ret < 0) {
+	return NULL;
+      }
+      if (ret > 0) {
+	return import_get_module(tstate, abs_name);
+      }
+    }
     /* Python modules */
     {
       Py_ssize_t n = 0;
       Py_ssize_t len = PyList_Size(sys_path);
+      if (path_listings_check(sys_path) < 0) {
+	return NULL;
+      }
       for (n = 0; n < len; n++) {
 	char name[MAXPATHLEN];
 	PyObject *p = PySequence_GetItem(sys_path, n);
+	int found = path_listing_contains(p, abs_name);
+	if (found <= 0) {
+	  Py_XDECREF(p);
+	  if (found < 0) {
+	    return NULL;
+	  }
+	  continue;
+	}
 	if (PyString_Size(p) < MAXPATHLEN - PyString_Size(abs_name) - 5) {
 	  int fd;
 	  struct _Py_stat_struct stat;
@@ -786,23 +1191,70 @@ import_find_and_load(PyThreadState *tstate, PyObject *abs_name)
 	  strcat(name, ".py");
 	  fd = _Py_open(name, O_RDONLY);
 	  if (fd > 0) {
-	    PyObject *src;
 	    PyObject *dict;
+	    PyObject *code;
 	    PyObject *v;
+	    Py_DECREF(p);
 	    _Py_fstat(fd, &stat);
-	    src = PyString_New(stat.st_size);
-	    _Py_read(fd, (char *) PyString_AsChar(src), stat.st_size);
-	    close(fd);
 	    mod = PyImport_AddModuleObject(abs_name);
 	    if (mod == NULL) {
+	      close(fd);
 	      return NULL;
 	    }
 	    dict = PyModule_GetDict(mod);
-	    PyDict_SetItemString(dict, "__file__", PyString_FromString(name));
-	    v = PyRun_StringFlags(PyString_AsChar(src), Py_file_input, dict, dict, NULL);
+	    v = PyString_FromString(name);
+	    if (v == NULL || PyDict_SetItemString(dict, "__file__", v) < 0) {
+	      Py_XDECREF(v);
+	      close(fd);
+	      return NULL;
+	    }
+	    Py_DECREF(v);
+	    if (PyDict_GetItemString(dict, "__builtins__") == NULL &&
+		PyDict_SetItemString(dict, "__builtins__",
+				     tstate->interp->builtins) < 0) {
+	      close(fd);
+	      return NULL;
+	    }
+	    /* Only parse and compile the source if the code cache has no
+	       up to date entry for this file */
+	    code = _PyCodeCache_Load(name, &stat);
+	    if (code == NULL) {
+	      _Py_SourceMapping map;
+	      PyCompilerFlags cf = _PyCompilerFlags_INIT;
+	      cf.cf_flags = _PyCF_FOLD_BUILTINS;
+	      if (_Py_MapSourceFile(fd, 0, stat.st_size, &map)) {
+		/* Large module: the tokenizer scans the mapping */
+		close(fd);
+		code = Py_CompileStringExFlags(map.text, name,
+					       Py_file_input, &cf, -1);
+		_Py_UnmapSourceFile(&map);
+	      } else {
+		PyObject *src = PyString_New(stat.st_size);
+		if (src == NULL) {
+		  close(fd);
+		  return NULL;
+		}
+		_Py_read(fd, (char *) PyString_AsChar(src), stat.st_size);
+		close(fd);
+		code = Py_CompileStringExFlags(PyString_AsChar(src), name,
+					       Py_file_input, &cf, -1);
+		Py_DECREF(src);
+	      }
+	      if (code == NULL) {
+		return NULL;
+	      }
+	      _PyCodeCache_Store(name, &stat, code);
+	    } else {
+	      close(fd);
+	    }
+	    v = PyEval_EvalCode(code, dict, dict);
+	    Py_DECREF(code);
 	    if (v == NULL) {
 	      return NULL;
 	    }
+	    Py_DECREF(v);
+	    /* mod is borrowed from sys.modules; return a new reference */
+	    Py_INCREF(mod);
 	    return mod;
 	  } else {
 	    _PyErr_Clear(tstate);
@@ -816,6 +1268,31 @@ import_find_and_load(PyThreadState *tstate, PyObject *abs_name)
     return NULL;
 }
 
+static PyObject *
+import_find_and_load(PyThreadState *tstate, PyObject *abs_name)
+{
+    PyObject *mod;
+    _PyImportTimer timer = {0};
+
+    /* Replacement for the import statement */
+    /* See if the module is in the module cache */
+    mod = import_get_module(tstate, abs_name);
+    if (mod) {
+      return mod;
+    }
+    PyErr_Clear();
+
+    _PyImport_TimerStart(&timer);
+    /* sys.path listings are checked once per outermost import */
+    if (path_import_depth++ == 0) {
+        path_pass++;
+    }
+    mod = import_load(tstate, abs_name);
+    path_import_depth--;
+    _PyImport_TimerStop(&timer, PyString_AsChar(abs_name));
+    return mod;
+}
+
 PyObject *
 PyImport_GetModule(PyObject *name)
 {
@@ -26,7 +26,7 @@ static const char usage_1[] = "\
 Options and arguments (and corresponding environment variables):\n\
 -b     : issue warnings about str(bytes_instance), str(bytearray_instance)\n\
          and comparing bytes/bytearray with str. (-bb: issue errors)\n\
--B     : don't write .pyc files on import; also PYTHONDONTWRITEBYTECODE=x\n\
+-B     : don't write the code cache on import; also PYTHONDONTWRITEBYTECODE=x\n\
 -c cmd : program passed in as string (terminates option list)\n\
 -d     : debug output from parser; also PYTHONDEBUG=x\n\
 -E     : ignore PYTHON* environment variables (such as PYTHONPATH)\n\
@@ -63,6 +63,19 @@ static const char usage_3[] = "\
                 * Enable asyncio debug mode\n\
                 * Set the dev_mode attribute of sys.flags to True\n\
                 * io.IOBase destructor logs close() exceptions\n\
+         -X perf: give every Python function a native trampoline and write\n\
+             /tmp/perf-<pid>.map so that Linux perf can show Python frames;\n\
+             also PYTHONPERFSUPPORT=1\n\
+         -X frozen_modules=[on|off]: whether to import the core modules\n\
+             compiled into the interpreter (default) or those in Lib/\n\
+         -X importtime[=PATH]: show how long each import and initialization\n\
+             phase takes, on stderr or in PATH; also PYTHONPROFILEIMPORTTIME=x\n\
+         -X lazy_imports: defer module-level imports until the imported name\n\
+             is first used; also PYTHONLAZYIMPORTS=1\n\
+         -X pycache_prefix=PATH: store the code cache of imported modules\n\
+             in PATH instead of ~/.cache/python-codecache\n\
+         -X pathconfig_cache: reuse the path configuration computed by a\n\
+             previous run of the same executable; also PYTHONPATHCONFIGCACHE=1\n\
 \n\
 --check-hash-based-pycs always|default|never:\n\
     control how Python invalidates hash-based .pyc files\n\
@@ -94,7 +107,12 @@ static const char usage_6[] =
 "   hooks.\n"
 "PYTHONBREAKPOINT: if this variable is set to 0, it disables the default\n"
 "   debugger. It can be set to the callable of your debugger of choice.\n"
-"PYTHONDEVMODE: enable the development mode.\n";
+"PYTHONDEVMODE: enable the development mode.\n"
+"PYTHONLAZYIMPORTS: if set to 1, defer module-level imports (-X lazy_imports).\n"
+"PYTHONPATHCONFIGCACHE: if set to 1, cache the path configuration\n"
+"   (-X pathconfig_cache).\n"
+"PYTHONPERFSUPPORT: if set to 1, enable the Linux perf trampolines (-X perf).\n"
+"PYTHONPYCACHEPREFIX: root directory for the code cache (-X pycache_prefix).\n";
 
 #define PYTHONHOMEHELP "<prefix>/lib/pythonX.X"
 
@@ -465,6 +483,7 @@ PyConfig_Clear(PyConfig *config)
     CLEAR(config->program_name);
 
     _PyStringList_Clear(&config->argv);
+    _PyStringList_Clear(&config->xoptions);
     _PyStringList_Clear(&config->module_search_paths);
     config->module_search_paths_set = 0;
 
@@ -475,6 +494,8 @@ PyConfig_Clear(PyConfig *config)
     CLEAR(config->exec_prefix);
     CLEAR(config->base_exec_prefix);
     CLEAR(config->platlibdir);
+    CLEAR(config->pycache_prefix);
+    CLEAR(config->import_time_file);
     CLEAR(config->run_command);
     CLEAR(config->run_module);
     CLEAR(config->run_filename);
@@ -497,6 +518,10 @@ _PyConfig_InitCompatConfig(PyConfig *config)
     config->quiet = -1;
     config->configure_c_stdio = 0;
     config->buffered_stdio = -1;
+    config->write_bytecode = -1;
+    config->use_frozen_modules = -1;
+    config->lazy_imports = -1;
+    config->perf_profiling = -1;
     config->_install_importlib = 1;
     config->pathconfig_warnings = -1;
     config->_init_main = 1;
@@ -513,6 +538,7 @@ config_init_defaults(PyConfig *config)
     config->interactive = 0;
     config->quiet = 0;
     config->buffered_stdio = 1;
+    config->write_bytecode = 1;
     config->pathconfig_warnings = 1;
 }
 
@@ -664,11 +690,20 @@ _PyConfig_Copy(PyConfig *config, const PyConfig *config2)
     COPY_ATTR(quiet);
     COPY_ATTR(configure_c_stdio);
     COPY_ATTR(buffered_stdio);
+    COPY_ATTR(write_bytecode);
+    COPY_CHAR_ATTR(pycache_prefix);
+    COPY_ATTR(use_frozen_modules);
+    COPY_ATTR(lazy_imports);
+    COPY_ATTR(import_time);
+    COPY_CHAR_ATTR(import_time_file);
+    COPY_CHARLIST(xoptions);
+    COPY_ATTR(perf_profiling);
     COPY_ATTR(skip_source_first_line);
     COPY_CHAR_ATTR(run_command);
     COPY_CHAR_ATTR(run_module);
     COPY_CHAR_ATTR(run_filename);
     COPY_ATTR(pathconfig_warnings);
+    COPY_ATTR(pathconfig_cache);
     COPY_ATTR(_init_main);
     COPY_CHARLIST(_orig_argv);
 
@@ -751,12 +786,21 @@ config_as_dict(const PyConfig *config)
     SET_ITEM_INT(quiet);
     SET_ITEM_INT(configure_c_stdio);
     SET_ITEM_INT(buffered_stdio);
+    SET_ITEM_INT(write_bytecode);
+    SET_ITEM_CHAR(pycache_prefix);
+    SET_ITEM_INT(use_frozen_modules);
+    SET_ITEM_INT(lazy_imports);
+    SET_ITEM_INT(import_time);
+    SET_ITEM_CHAR(import_time_file);
+    SET_ITEM_CHARLIST(xoptions);
+    SET_ITEM_INT(perf_profiling);
     SET_ITEM_INT(skip_source_first_line);
     SET_ITEM_CHAR(run_command);
     SET_ITEM_CHAR(run_module);
     SET_ITEM_CHAR(run_filename);
     SET_ITEM_INT(_install_importlib);
     SET_ITEM_INT(pathconfig_warnings);
+    SET_ITEM_INT(pathconfig_cache);
     SET_ITEM_INT(_init_main);
     SET_ITEM_CHARLIST(_orig_argv);
 
@@ -999,6 +1043,41 @@ config_read_env_vars(PyConfig *config)
         config->buffered_stdio = 0;
     }
 
+    int dont_write_bytecode = 0;
+    _Py_get_env_flag(use_env, &dont_write_bytecode, "PYTHONDONTWRITEBYTECODE");
+    if (dont_write_bytecode) {
+        config->write_bytecode = 0;
+    }
+
+    if (config->pycache_prefix == NULL) {
+        status = CONFIG_GET_ENV_DUP(config, &config->pycache_prefix,
+                                    "PYTHONPYCACHEPREFIX",
+                                    "PYTHONPYCACHEPREFIX");
+        if (_PyStatus_EXCEPTION(status)) {
+            return status;
+        }
+    }
+
+    _Py_get_env_flag(use_env, &config->import_time, "PYTHONPROFILEIMPORTTIME");
+    _Py_get_env_flag(use_env, &config->pathconfig_cache,
+                     "PYTHONPATHCONFIGCACHE");
+
+    if (config->lazy_imports < 0) {
+        int lazy_imports = 0;
+        _Py_get_env_flag(use_env, &lazy_imports, "PYTHONLAZYIMPORTS");
+        if (lazy_imports) {
+            config->lazy_imports = 1;
+        }
+    }
+
+    if (config->perf_profiling < 0) {
+        int perf_profiling = 0;
+        _Py_get_env_flag(use_env, &perf_profiling, "PYTHONPERFSUPPORT");
+        if (perf_profiling) {
+            config->perf_profiling = 1;
+        }
+    }
+
     if (config->pythonpath_env == NULL) {
         status = CONFIG_GET_ENV_DUP(config, &config->pythonpath_env,
                                     "PYTHONPATH", "PYTHONPATH");
@@ -1025,11 +1104,84 @@ config_read_env_vars(PyConfig *config)
     return _PyStatus_OK();
 }
 
+/* Get the value of a -X option: return the whole "name" or "name=value"
+   string, or NULL if the option was not given. */
+static const char*
+config_get_xoption(const PyConfig *config, const char *name)
+{
+    size_t name_len = strlen(name);
+    for (Py_ssize_t i = 0; i < config->xoptions.length; i++) {
+        const char *option = config->xoptions.items[i];
+        const char *sep = strchr(option, '=');
+        size_t len = (sep != NULL) ? (size_t)(sep - option) : strlen(option);
+        if (len == name_len && strncmp(option, name, len) == 0) {
+            return option;
+        }
+    }
+    return NULL;
+}
+
+
 static PyStatus
 config_read(PyConfig *config)
 {
     PyStatus status;
 
+    if (config_get_xoption(config, "perf")) {
+        config->perf_profiling = 1;
+    }
+    if (config_get_xoption(config, "lazy_imports")) {
+        config->lazy_imports = 1;
+    }
+    if (config_get_xoption(config, "pathconfig_cache")) {
+        config->pathconfig_cache = 1;
+    }
+
+    const char *import_time = config_get_xoption(config, "importtime");
+    if (import_time != NULL) {
+        const char *sep = strchr(import_time, '=');
+        config->import_time = 1;
+        if (sep != NULL && sep[1] != '\0' && config->import_time_file == NULL) {
+            status = PyConfig_SetChar(config, &config->import_time_file,
+                                      sep + 1);
+            if (_PyStatus_EXCEPTION(status)) {
+                return status;
+            }
+        }
+    }
+
+    if (config->pycache_prefix == NULL) {
+        const char *prefix = config_get_xoption(config, "pycache_prefix");
+        if (prefix != NULL) {
+            const char *sep = strchr(prefix, '=');
+            /* "-X pycache_prefix" without a value: use the default */
+            if (sep != NULL && sep[1] != '\0') {
+                status = PyConfig_SetChar(config, &config->pycache_prefix,
+                                          sep + 1);
+                if (_PyStatus_EXCEPTION(status)) {
+                    return status;
+                }
+            }
+        }
+    }
+
+    if (config->use_frozen_modules < 0) {
+        const char *value = config_get_xoption(config, "frozen_modules");
+        if (value != NULL) {
+            const char *sep = strchr(value, '=');
+            if (sep != NULL && strcmp(sep + 1, "off") == 0) {
+                config->use_frozen_modules = 0;
+            }
+            else if (sep != NULL && strcmp(sep + 1, "on") == 0) {
+                config->use_frozen_modules = 1;
+            }
+            else {
+                return _PyStatus_ERR("-X frozen_modules: invalid value, "
+                                     "expected 'on' or 'off'");
+            }
+        }
+    }
+
     if (config->use_environment) {
         status = config_read_env_vars(config);
         if (_PyStatus_EXCEPTION(status)) {
@@ -1082,6 +1234,18 @@ config_read(PyConfig *config)
     if (config->configure_c_stdio < 0) {
         config->configure_c_stdio = 1;
     }
+    if (config->write_bytecode < 0) {
+        config->write_bytecode = 1;
+    }
+    if (config->use_frozen_modules < 0) {
+        config->use_frozen_modules = 1;
+    }
+    if (config->lazy_imports < 0) {
+        config->lazy_imports = 0;
+    }
+    if (config->perf_profiling < 0) {
+        config->perf_profiling = 0;
+    }
 
     return _PyStatus_OK();
 }
@@ -1243,6 +1407,10 @@ config_parse_cmdline(PyConfig *config,
             config->buffered_stdio = 0;
             break;
 
+        case 'B':
+            config->write_bytecode = 0;
+            break;
+
         case 'x':
             config->skip_source_first_line = 1;
             break;
@@ -0,0 +1,311 @@
+/* Linux perf trampolines
+
+   perf unwinds native stacks, so every Python function shows up as
+   _PyEval_EvalFrameDefault.  When enabled (-X perf, PYTHONPERFSUPPORT=1 or
+   sys.activate_stack_trampoline("perf")), every code object gets its own
+   copy of a tiny stub (Python/asm_trampoline.S) which just calls the eval
+   loop.  The address range of each copy is written to /tmp/perf-PID.map
+   with the function's qualified name and filename:
+
+       7f3a2c001000 b py::Spam.eggs:/path/to/spam.py
+
+   perf resolves the stub's frame in each call chain to that name, so the
+   Python functions appear interleaved with the C frames around them.
+
+   The trampoline of a code object is kept in a co_extra slot.  Functions
+   register their qualname when they are created; other code objects
+   (modules, class bodies, code run before activation) get a trampoline the
+   first time they are evaluated, named after co_name.
+
+   The stubs live in arenas which are filled with copies up front and then
+   made executable, so memory is never writable and executable at once.
+   Arenas are only released by _PyPerfTrampoline_Fini(), since a stub may
+   still be on the C stack. */
+
+#include "Python.h"
+#include "pycore_ceval.h"         // _PyPerfTrampoline_SetActive()
+#include "pycore_interp.h"        // PyInterpreterState.eval_frame
+#include "pycore_pystate.h"       // _PyInterpreterState_GET()
+#include "frameobject.h"          // PyFrameObject
+
+#ifdef PY_HAVE_PERF_TRAMPOLINE
+
+#include <fcntl.h>                // open()
+#include <sys/mman.h>             // mmap()
+#include <unistd.h>               // sysconf()
+
+typedef PyObject *(*py_evaluator)(PyThreadState *, PyFrameObject *, int);
+typedef PyObject *(*py_trampoline)(PyThreadState *, PyFrameObject *, int,
+                                   py_evaluator);
+
+/* Python/asm_trampoline.S */
+extern void *_Py_trampoline_func_start;
+extern void *_Py_trampoline_func_end;
+
+/* Number of pages mapped per arena */
+#define PERF_ARENA_PAGES 16
+
+/* Every copy starts on this boundary */
+#define PERF_CODE_ALIGN 16
+
+typedef struct _perfarena {
+    char *start;
+    char *current;
+    size_t size;
+    size_t size_left;
+    struct _perfarena *prev;
+} PerfArena;
+
+static struct {
+    int active;
+    Py_ssize_t extra_index;       /* co_extra slot, -1 until first use */
+    _PyFrameEvalFunction prev_eval_frame;
+    FILE *map_file;
+    PerfArena *arenas;            /* most recent first */
+    size_t code_size;             /* size of one stub */
+    size_t code_stride;           /* code_size rounded up to PERF_CODE_ALIGN */
+} perf = {
+    .extra_index = -1,
+};
+
+
+static int
+perf_new_arena(void)
+{
+    long page_size = sysconf(_SC_PAGESIZE);
+    size_t size = (size_t)(page_size > 0 ? page_size : 4096) * PERF_ARENA_PAGES;
+
+    char *memory = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+        return -1;
+    }
+
+    const char *code = (const char *)&_Py_trampoline_func_start;
+    size_t ncopies = size / perf.code_stride;
+    for (size_t i = 0; i < ncopies; i++) {
+        memcpy(memory + i * perf.code_stride, code, perf.code_size);
+    }
+    if (mprotect(memory, size, PROT_READ | PROT_EXEC) < 0) {
+        munmap(memory, size);
+        return -1;
+    }
+    __builtin___clear_cache(memory, memory + size);
+
+    PerfArena *arena = PyMem_Malloc(sizeof(PerfArena));
+    if (arena == NULL) {
+        munmap(memory, size);
+        return -1;
+    }
+    arena->start = memory;
+    arena->current = memory;
+    arena->size = size;
+    arena->size_left = ncopies * perf.code_stride;
+    arena->prev = perf.arenas;
+    perf.arenas = arena;
+    return 0;
+}
+
+
+static void
+perf_write_entry(const void *code, PyCodeObject *co, PyObject *qualname)
+{
+    if (perf.map_file == NULL) {
+        return;
+    }
+    if (qualname == NULL || !PyString_Check(qualname)) {
+        qualname = co->co_name;
+    }
+    const char *name = PyString_AsChar(qualname);
+    const char *filename = PyString_AsChar(co->co_filename);
+    if (name == NULL || filename == NULL) {
+        PyErr_Clear();
+        return;
+    }
+    fprintf(perf.map_file, "%" PRIxPTR " %zx py::%s:%s\n",
+            (uintptr_t)code, perf.code_size, name, filename);
+    fflush(perf.map_file);
+}
+
+
+/* Return the trampoline of co, creating it if needed.  Never raises: on
+   failure return NULL and the caller runs the code without a trampoline. */
+static py_trampoline
+perf_get_trampoline(PyCodeObject *co, PyObject *qualname)
+{
+    PyObject *type, *value, *traceback;
+    void *extra = NULL;
+
+    PyErr_Fetch(&type, &value, &traceback);
+    if (_PyCode_GetExtra((PyObject *)co, perf.extra_index, &extra) < 0) {
+        PyErr_Clear();
+        extra = NULL;
+        goto done;
+    }
+    if (extra != NULL) {
+        goto done;
+    }
+
+    if (perf.arenas == NULL || perf.arenas->size_left < perf.code_stride) {
+        if (perf_new_arena() < 0) {
+            goto done;
+        }
+    }
+    PerfArena *arena = perf.arenas;
+    if (_PyCode_SetExtra((PyObject *)co, perf.extra_index,
+                         arena->current) < 0) {
+        PyErr_Clear();
+        goto done;
+    }
+    extra = arena->current;
+    arena->current += perf.code_stride;
+    arena->size_left -= perf.code_stride;
+    perf_write_entry(extra, co, qualname);
+
+done:
+    PyErr_Restore(type, value, traceback);
+    return (py_trampoline)extra;
+}
+
+
+static PyObject *
+perf_eval_frame(PyThreadState *tstate, PyFrameObject *f, int throwflag)
+{
+    py_trampoline trampoline = perf_get_trampoline(f->f_code, NULL);
+    if (trampoline == NULL) {
+        return perf.prev_eval_frame(tstate, f, throwflag);
+    }
+    return trampoline(tstate, f, throwflag, perf.prev_eval_frame);
+}
+
+
+static int
+perf_open_map_file(void)
+{
+    char filename[100];
+    PyOS_snprintf(filename, sizeof(filename), "/tmp/perf-%ld.map",
+                  (long)getpid());
+    int fd = open(filename, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        PyErr_SetFromErrnoWithFilename(PyExc_OSError, filename);
+        return -1;
+    }
+    perf.map_file = fdopen(fd, "a");
+    if (perf.map_file == NULL) {
+        PyErr_SetFromErrnoWithFilename(PyExc_OSError, filename);
+        close(fd);
+        return -1;
+    }
+    return 0;
+}
+
+
+int
+_PyPerfTrampoline_SetActive(PyInterpreterState *interp, int active)
+{
+    if (!active) {
+        if (perf.active) {
+            if (interp->eval_frame == perf_eval_frame) {
+                interp->eval_frame = perf.prev_eval_frame;
+            }
+            perf.active = 0;
+        }
+        return 0;
+    }
+    if (perf.active) {
+        return 0;
+    }
+
+    if (perf.extra_index < 0) {
+        /* Trampolines are owned by the arenas, not by the code objects */
+        perf.extra_index = _PyEval_RequestCodeExtraIndex(NULL);
+        if (perf.extra_index < 0) {
+            PyErr_SetString(PyExc_RuntimeError,
+                            "no free co_extra slot for the perf trampolines");
+            return -1;
+        }
+        const char *start = (const char *)&_Py_trampoline_func_start;
+        const char *end = (const char *)&_Py_trampoline_func_end;
+        perf.code_size = end - start;
+        perf.code_stride = (perf.code_size + PERF_CODE_ALIGN - 1)
+                           & ~(size_t)(PERF_CODE_ALIGN - 1);
+    }
+    if (perf.map_file == NULL && perf_open_map_file() < 0) {
+        return -1;
+    }
+
+    perf.prev_eval_frame = interp->eval_frame;
+    interp->eval_frame = perf_eval_frame;
+    perf.active = 1;
+    return 0;
+}
+
+
+int
+_PyPerfTrampoline_IsActive(void)
+{
+    return perf.active;
+}
+
+
+void
+_PyPerfTrampoline_RegisterCode(PyCodeObject *co, PyObject *qualname)
+{
+    if (perf.active) {
+        (void)perf_get_trampoline(co, qualname);
+    }
+}
+
+
+/* Called once no more Python code can run: the interpreter is gone */
+void
+_PyPerfTrampoline_Fini(void)
+{
+    perf.active = 0;
+    perf.prev_eval_frame = NULL;
+    perf.extra_index = -1;
+    if (perf.map_file != NULL) {
+        fclose(perf.map_file);
+        perf.map_file = NULL;
+    }
+    while (perf.arenas != NULL) {
+        PerfArena *arena = perf.arenas;
+        perf.arenas = arena->prev;
+        munmap(arena->start, arena->size);
+        PyMem_Free(arena);
+    }
+}
+
+#else   /* !PY_HAVE_PERF_TRAMPOLINE */
+
+int
+_PyPerfTrampoline_SetActive(PyInterpreterState *interp, int active)
+{
+    if (active) {
+        PyErr_SetString(PyExc_ValueError,
+                        "perf trampolines are not supported on this platform");
+        return -1;
+    }
+    return 0;
+}
+
+
+int
+_PyPerfTrampoline_IsActive(void)
+{
+    return 0;
+}
+
+
+void
+_PyPerfTrampoline_RegisterCode(PyCodeObject *co, PyObject *qualname)
+{
+}
+
+
+void
+_PyPerfTrampoline_Fini(void)
+{
+}
+
+#endif   /* PY_HAVE_PERF_TRAMPOLINE */
@@ -94,6 +94,13 @@ _PyPreCmdline_SetConfig(const _PyPreCmdline *cmdline, PyConfig *config)
 #define COPY_ATTR(ATTR) \
     config->ATTR = cmdline->ATTR
     COPY_ATTR(use_environment);
+
+    /* -X options are parsed here and only interpreted by PyConfig_Read() */
+    PyStatus status = _PyStringList_Extend(&config->xoptions,
+                                           &cmdline->xoptions);
+    if (_PyStatus_EXCEPTION(status)) {
+        return status;
+    }
     return _PyStatus_OK();
 
 #undef COPY_ATTR
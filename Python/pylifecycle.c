@@ -284,23 +284,34 @@ pycore_interp_init(PyThreadState *tstate)
 {
     PyStatus status;
     PyObject *sysmod = NULL;
+    _PyImportTimer timer = {0}, phase = {0};
 
+    _PyImport_InitTiming(_PyInterpreterState_GetConfig(tstate->interp));
+    _PyImport_TimerStart(&timer);
+
+    _PyImport_TimerStart(&phase);
     status = pycore_init_types(tstate);
+    _PyImport_TimerStop(&phase, "<pycore_init_types>");
     if (_PyStatus_EXCEPTION(status)) {
         goto done;
     }
 
+    _PyImport_TimerStart(&phase);
     status = _PySys_Create(tstate, &sysmod);
+    _PyImport_TimerStop(&phase, "<_PySys_Create>");
     if (_PyStatus_EXCEPTION(status)) {
         goto done;
     }
 
+    _PyImport_TimerStart(&phase);
     status = pycore_init_builtins(tstate);
+    _PyImport_TimerStop(&phase, "<pycore_init_builtins>");
     if (_PyStatus_EXCEPTION(status)) {
         goto done;
     }
     
 done:
+    _PyImport_TimerStop(&timer, "<pycore_interp_init>");
     /* sys.modules['sys'] contains a strong reference to the module */
     Py_XDECREF(sysmod);
     return status;
@@ -534,25 +545,42 @@ init_interp_main(PyThreadState *tstate)
         return _PyStatus_OK();
     }
 
-    if (_PySys_InitMain(tstate) < 0) {
+    _PyImportTimer phase = {0};
+
+    _PyImport_TimerStart(&phase);
+    int res = _PySys_InitMain(tstate);
+    _PyImport_TimerStop(&phase, "<_PySys_InitMain>");
+    if (res < 0) {
         return _PyStatus_ERR("can't finish initializing sys");
     }
     
+    _PyImport_TimerStart(&phase);
     status = init_sys_streams(tstate);
+    _PyImport_TimerStop(&phase, "<init_sys_streams>");
     if (_PyStatus_EXCEPTION(status)) {
         return status;
     }
 
+    _PyImport_TimerStart(&phase);
     status = init_set_builtins_open();
+    _PyImport_TimerStop(&phase, "<init_set_builtins_open>");
     if (_PyStatus_EXCEPTION(status)) {
         return status;
     }
 
+    _PyImport_TimerStart(&phase);
     status = add_main_module(interp);
+    _PyImport_TimerStop(&phase, "<add_main_module>");
     if (_PyStatus_EXCEPTION(status)) {
         return status;
     }
 
+    if (config->perf_profiling) {
+        if (_PyPerfTrampoline_SetActive(interp, 1) < 0) {
+            return _PyStatus_ERR("can't enable the perf trampolines");
+        }
+    }
+
 
     
     if (is_main_interp) {
@@ -600,7 +628,10 @@ pyinit_main(PyThreadState *tstate)
         return _Py_ReconfigureMainInterpreter(tstate);
     }
 
+    _PyImportTimer timer = {0};
+    _PyImport_TimerStart(&timer);
     PyStatus status = init_interp_main(tstate);
+    _PyImport_TimerStop(&timer, "<init_interp_main>");
     if (_PyStatus_EXCEPTION(status)) {
         return status;
     }
@@ -861,6 +892,8 @@ Py_FinalizeEx(void)
 
     call_ll_exitfuncs(runtime);
 
+    _PyPerfTrampoline_Fini();
+
     _PyRuntime_Finalize();
     return status;
 }
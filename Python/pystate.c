@@ -151,6 +151,9 @@ new_threadstate(PyInterpreterState *interp, int init)
     tstate->frame = NULL;
     tstate->async_exc = NULL;
 
+    tstate->c_profilefunc = NULL;
+    tstate->c_profileobj = NULL;
+
     tstate->dict = NULL;
 
     tstate->curexc_type = NULL;
@@ -331,6 +334,9 @@ PyThreadState_Clear(PyThreadState *tstate)
     Py_CLEAR(tstate->dict);
     Py_CLEAR(tstate->async_exc);
 
+    tstate->c_profilefunc = NULL;
+    Py_CLEAR(tstate->c_profileobj);
+
     Py_CLEAR(tstate->curexc_type);
     Py_CLEAR(tstate->curexc_value);
     Py_CLEAR(tstate->curexc_traceback);
@@ -13,6 +13,7 @@
 #include "Python-ast.h"
 #undef Yield   /* undefine macro conflicting with <winbase.h> */
 
+#include "pycore_fileutils.h"     // _Py_MapSourceFile()
 #include "pycore_interp.h"        // PyInterpreterState.importlib
 #include "pycore_object.h"        // _PyDebug_PrintTotalRefs()
 #include "pycore_pyerrors.h"      // _PyErr_Fetch
@@ -893,6 +894,25 @@ PyRun_StringFlags(const char *str, int start, PyObject *globals,
     return ret;
 }
 
+/* Memory-map the rest of the regular file fp: the script is then tokenized
+   in place rather than copied line by line out of the FILE buffer.
+   Return 1 on success, 0 if fp must be read. */
+static int
+map_source_file(FILE *fp, _Py_SourceMapping *map)
+{
+    struct _Py_stat_struct st;
+    int fd = fileno(fp);
+    if (fd < 0 || _Py_fstat_noraise(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        return 0;
+    }
+    /* The first line may have been skipped already (-x option) */
+    long offset = ftell(fp);
+    if (offset < 0) {
+        return 0;
+    }
+    return _Py_MapSourceFile(fd, offset, st.st_size, map);
+}
+
 PyObject *
 PyRun_FileExFlags(FILE *fp, const char *filename_str, int start, PyObject *globals,
                   PyObject *locals, int closeit, PyCompilerFlags *flags)
@@ -907,8 +927,15 @@ PyRun_FileExFlags(FILE *fp, const char *filename_str, int start, PyObject *globa
         goto exit;
 
 
-    mod = PyPegen_ASTFromFileObject(fp, filename, start, NULL, NULL, 
+    _Py_SourceMapping map;
+    if (map_source_file(fp, &map)) {
+        mod = PyPegen_ASTFromStringObject(map.text, filename, start, flags);
+        _Py_UnmapSourceFile(&map);
+    }
+    else {
+        mod = PyPegen_ASTFromFileObject(fp, filename, start, NULL, NULL,
                                         flags, NULL);
+    }
 
     if (closeit)
         fclose(fp);
@@ -18,12 +18,14 @@ Data members:
 #include "code.h"
 #include "frameobject.h"          // PyFrame_GetBack()
 #include "pycore_ceval.h"         // _Py_RecursionLimitLowerWaterMark()
+#include "pycore_compile.h"       // _PyCompile_GetStats()
 #include "pycore_initconfig.h"
 #include "pycore_object.h"
 #include "pycore_pathconfig.h"
 #include "pycore_pyerrors.h"
 #include "pycore_pylifecycle.h"
 #include "pycore_pystate.h"       // PyThreadState_Get()
+#include "pegen_interface.h"      // _PyPegen_get_memo_statistics()
 
 #include "osdefs.h"               // DELIM
 #include <locale.h>
@@ -727,19 +729,226 @@ sys_is_finalizing_impl(PyObject *module)
 }
 
 
+static PyObject *
+sys_activate_stack_trampoline(PyObject *module, PyObject *backend)
+{
+    if (!PyString_Check(backend)) {
+        PyErr_Format(PyExc_TypeError,
+                     "activate_stack_trampoline() argument must be str, "
+                     "not %.200s", Py_TYPE(backend)->tp_name);
+        return NULL;
+    }
+    if (strcmp(PyString_AsChar(backend), "perf") != 0) {
+        PyErr_Format(PyExc_ValueError,
+                     "invalid backend: %R", backend);
+        return NULL;
+    }
+    if (_PyPerfTrampoline_SetActive(_PyInterpreterState_GET(), 1) < 0) {
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(activate_stack_trampoline_doc,
+"activate_stack_trampoline(backend, /)\n\
+\n\
+Give every Python function a native trampoline so that native profilers\n\
+can see it.  The only backend is \"perf\", which describes the\n\
+trampolines in /tmp/perf-PID.map for the Linux perf profiler.");
+
+
+static PyObject *
+sys_deactivate_stack_trampoline(PyObject *module, PyObject *Py_UNUSED(ignored))
+{
+    if (_PyPerfTrampoline_SetActive(_PyInterpreterState_GET(), 0) < 0) {
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(deactivate_stack_trampoline_doc,
+"deactivate_stack_trampoline()\n\
+\n\
+Stop entering Python functions through their trampolines.");
+
+
+static PyObject *
+sys_is_stack_trampoline_active(PyObject *module, PyObject *Py_UNUSED(ignored))
+{
+    return PyBool_FromLong(_PyPerfTrampoline_IsActive());
+}
+
+PyDoc_STRVAR(is_stack_trampoline_active_doc,
+"is_stack_trampoline_active() -> bool\n\
+\n\
+Return True if a stack profiler trampoline is active.");
+
+
+#ifdef Py_OPCODE_STATS
+static PyObject *
+sys_opcode_stats_on(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"cycles", 0};
+    int cycles = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|p:_opcode_stats_on",
+                                     kwlist, &cycles)) {
+        return NULL;
+    }
+    _PyEval_SetOpcodeStats(1, cycles);
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(opcode_stats_on_doc,
+"_opcode_stats_on(cycles=False)\n\
+\n\
+Start counting executed opcodes.  If cycles is true, also charge the\n\
+timestamp counter delta between two opcodes to the first one.");
+
+
+static PyObject *
+sys_opcode_stats_off(PyObject *module, PyObject *Py_UNUSED(ignored))
+{
+    _PyEval_SetOpcodeStats(0, 0);
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(opcode_stats_off_doc,
+"_opcode_stats_off()\n\
+\n\
+Stop counting executed opcodes.  The counts are kept.");
+
+
+static PyObject *
+sys_opcode_stats_clear(PyObject *module, PyObject *Py_UNUSED(ignored))
+{
+    _PyEval_ClearOpcodeStats();
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(opcode_stats_clear_doc,
+"_opcode_stats_clear()\n\
+\n\
+Reset the opcode counts to zero.");
+
+
+static PyObject *
+sys_get_opcode_stats(PyObject *module, PyObject *Py_UNUSED(ignored))
+{
+    return _PyEval_GetOpcodeStats();
+}
+
+PyDoc_STRVAR(get_opcode_stats_doc,
+"_get_opcode_stats() -> dict\n\
+\n\
+Return {opcode: (count, cycles)} for every opcode executed while\n\
+counting was on.  Include/opcode.h names the opcodes.");
+#endif
+
+
+static PyObject *
+sys_get_memo_stats(PyObject *module, PyObject *Py_UNUSED(ignored))
+{
+    long lookups, hits;
+    PyObject *skipped = _PyPegen_get_memo_statistics();
+    if (skipped == NULL) {
+        return NULL;
+    }
+    _PyPegen_get_memo_hits(&lookups, &hits);
+    return Py_BuildValue("llN", lookups, hits, skipped);
+}
+
+PyDoc_STRVAR(get_memo_stats_doc,
+"_get_memo_stats() -> (lookups, hits, skipped)\n\
+\n\
+Return the number of memo lookups and hits of the parser, and the list\n\
+of the number of tokens skipped by the hits, indexed by rule type.");
+
+
+static PyObject *
+sys_clear_memo_stats(PyObject *module, PyObject *Py_UNUSED(ignored))
+{
+    _PyPegen_clear_memo_statistics();
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(clear_memo_stats_doc,
+"_clear_memo_stats()\n\
+\n\
+Reset the parser memo statistics to zero.");
+
+
+static PyObject *
+sys_set_compile_stats(PyObject *module, PyObject *arg)
+{
+    int enabled = PyObject_IsTrue(arg);
+    if (enabled < 0) {
+        return NULL;
+    }
+    _PyCompile_SetStats(enabled);
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(set_compile_stats_doc,
+"_set_compile_stats(flag)\n\
+\n\
+Start or stop timing the stages of compiling source code, and reset the\n\
+times to zero.  While on, the source given to compile() as a string is\n\
+also tokenized on its own first, to time the tokenizer.");
+
+
+static PyObject *
+sys_get_compile_stats(PyObject *module, PyObject *Py_UNUSED(ignored))
+{
+    return _PyCompile_GetStats();
+}
+
+PyDoc_STRVAR(get_compile_stats_doc,
+"_get_compile_stats() -> dict\n\
+\n\
+Return the seconds spent in each stage of compiling source code, and\n\
+the number of compilations, since _set_compile_stats() was called.");
+
+
 static PyMethodDef sys_methods[] = {
     /* Might as well keep this in alphabetic order */
     SYS__CLEAR_TYPE_CACHE_METHODDEF
+    {"_clear_memo_stats", sys_clear_memo_stats, METH_NOARGS,
+     clear_memo_stats_doc},
+    {"activate_stack_trampoline", sys_activate_stack_trampoline,
+     METH_O, activate_stack_trampoline_doc},
+    {"deactivate_stack_trampoline", sys_deactivate_stack_trampoline,
+     METH_NOARGS, deactivate_stack_trampoline_doc},
     SYS_DISPLAYHOOK_METHODDEF
     SYS_EXC_INFO_METHODDEF
     SYS_EXCEPTHOOK_METHODDEF
     SYS_EXIT_METHODDEF
+    {"_get_compile_stats", sys_get_compile_stats, METH_NOARGS,
+     get_compile_stats_doc},
+    {"_get_memo_stats", sys_get_memo_stats, METH_NOARGS,
+     get_memo_stats_doc},
     SYS_GETREFCOUNT_METHODDEF
+#ifdef Py_OPCODE_STATS
+    {"_get_opcode_stats", sys_get_opcode_stats, METH_NOARGS,
+     get_opcode_stats_doc},
+#endif
     {"getsizeof",   (PyCFunction)(void(*)(void))sys_getsizeof,
      METH_VARARGS | METH_KEYWORDS, getsizeof_doc},
     SYS__GETFRAME_METHODDEF
     SYS_INTERN_METHODDEF
     SYS_IS_FINALIZING_METHODDEF
+#ifdef Py_OPCODE_STATS
+    {"_opcode_stats_clear", sys_opcode_stats_clear, METH_NOARGS,
+     opcode_stats_clear_doc},
+    {"_opcode_stats_off", sys_opcode_stats_off, METH_NOARGS,
+     opcode_stats_off_doc},
+    {"_opcode_stats_on", (PyCFunction)(void(*)(void))sys_opcode_stats_on,
+     METH_VARARGS | METH_KEYWORDS, opcode_stats_on_doc},
+#endif
+    {"is_stack_trampoline_active", sys_is_stack_trampoline_active,
+     METH_NOARGS, is_stack_trampoline_active_doc},
+    {"_set_compile_stats", sys_set_compile_stats, METH_O,
+     set_compile_stats_doc},
     SYS_UNRAISABLEHOOK_METHODDEF
     {NULL,              NULL}           /* sentinel */
 };
@@ -978,8 +1187,17 @@ _PySys_InitMain(PyThreadState *tstate)
     SET_SYS_FROM_CHAR("base_exec_prefix", config->base_exec_prefix);
     SET_SYS_FROM_CHAR("platlibdir", config->platlibdir);
 
+    if (config->pycache_prefix != NULL) {
+        SET_SYS_FROM_CHAR("pycache_prefix", config->pycache_prefix);
+    } else {
+        SET_SYS_FROM_STRING_BORROW("pycache_prefix", Py_None);
+    }
+
     COPY_LIST("argv", config->argv);
 
+    SET_SYS_FROM_STRING("dont_write_bytecode",
+                        PyBool_FromLong(!config->write_bytecode));
+
 #undef COPY_LIST
 #undef SET_SYS_FROM_WSTR
     
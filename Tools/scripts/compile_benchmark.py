@@ -0,0 +1,171 @@
+"""Time the stages of compile() over a corpus of Python source files.
+
+Usage: compile_benchmark.py [-n REPEAT] [--save FILE] [--baseline FILE] PATH...
+
+Each PATH is a source file or a directory searched for *.py files, and is
+reported on its own line.  The sources are read once, then compiled
+REPEAT times (default 3) with sys._set_compile_stats() on; the fastest
+run of each stage is shown, with how far the resident memory of the
+process peaked above its size before the runs (Linux only).  --save writes the results to FILE, and --baseline
+compares them with the results saved in FILE earlier.
+
+"make compilebench" runs it on the bundled corpus: xxl.py (extracted
+from Tools/peg_generator/data/xxl.zip), cprog.py and Lib/.
+
+The script only relies on builtins, sys, os and stat (not os.path), so
+it runs on the interpreter being measured.
+"""
+
+import os
+import stat
+import sys
+
+STAGES = ("tokenize", "parse", "optimize", "symtable", "codegen", "assemble")
+
+
+def usage(msg):
+    sys.stderr.write("%s\n%s" % (msg, __doc__.split("\n\n")[1]))
+    sys.exit(2)
+
+
+def isdir(path):
+    return stat.S_ISDIR(os.stat(path).st_mode)
+
+
+def find_sources(path):
+    if not isdir(path):
+        return [path]
+    sources = []
+    for name in sorted(os.listdir(path)):
+        child = path.rstrip(os.sep) + os.sep + name
+        if isdir(child):
+            sources.extend(find_sources(child))
+        elif name.endswith(".py"):
+            sources.append(child)
+    return sources
+
+
+def read_sources(path):
+    sources = []
+    for filename in find_sources(path):
+        with open(filename) as f:
+            sources.append((filename, f.read()))
+    return sources
+
+
+def reset_peak_memory():
+    # Linux only: writing 5 resets VmHWM to the current resident size
+    try:
+        with open("/proc/self/clear_refs", "w") as f:
+            f.write("5")
+    except OSError:
+        pass
+
+
+def memory_status(field):
+    """Return a memory size of /proc/self/status in KiB, or 0 if unknown."""
+    try:
+        with open("/proc/self/status") as f:
+            for line in f:
+                if line.startswith(field + ":"):
+                    return int(line.split()[1])
+    except OSError:
+        pass
+    return 0
+
+
+def run(sources, repeat):
+    best = None
+    skipped = 0
+    reset_peak_memory()
+    start_size = memory_status("VmRSS")
+    for _ in range(repeat):
+        sys._set_compile_stats(True)
+        skipped = 0
+        for filename, text in sources:
+            try:
+                compile(text, filename, "exec")
+            except SyntaxError:
+                # The corpus may use syntax this interpreter lacks
+                skipped += 1
+        stats = sys._get_compile_stats()
+        sys._set_compile_stats(False)
+        if best is None:
+            best = stats
+        else:
+            for stage in STAGES:
+                best[stage] = min(best[stage], stats[stage])
+    best["total"] = sum(best[stage] for stage in STAGES[1:])
+    best["peak"] = max(memory_status("VmHWM") - start_size, 0)
+    best["files"] = len(sources) - skipped
+    return best
+
+
+def load_baseline(filename):
+    baseline = {}
+    with open(filename) as f:
+        for line in f:
+            name, key, value = line.split()
+            baseline.setdefault(name, {})[key] = float(value)
+    return baseline
+
+
+def save_results(filename, results):
+    with open(filename, "w") as f:
+        for name, stats in results:
+            for key in STAGES + ("total", "peak"):
+                f.write("%s %s %r\n" % (name, key, stats[key]))
+
+
+def format_row(name, files, values):
+    return "%-16s %5s " % (name, files) + " ".join("%9s" % v for v in values)
+
+
+def change(new, old):
+    if not old:
+        return "-"
+    return "%+.1f%%" % ((new - old) * 100.0 / old)
+
+
+def main(args):
+    repeat = 3
+    save = baseline_file = None
+    paths = []
+    while args:
+        arg = args.pop(0)
+        if arg == "-n" and args:
+            repeat = int(args.pop(0))
+        elif arg == "--save" and args:
+            save = args.pop(0)
+        elif arg == "--baseline" and args:
+            baseline_file = args.pop(0)
+        elif arg.startswith("-"):
+            usage("unknown option: %s" % arg)
+        else:
+            paths.append(arg)
+    if not paths or repeat < 1:
+        usage("no source given")
+    baseline = load_baseline(baseline_file) if baseline_file else {}
+
+    keys = STAGES + ("total", "peak")
+    print("Times in ms (tokenize is a separate pass; parse includes it again),")
+    print("peak memory growth in MiB, best of %d runs" % repeat)
+    print(format_row("corpus", "files", keys))
+    results = []
+    for path in paths:
+        name = path.rstrip(os.sep).rsplit(os.sep, 1)[-1] or path
+        stats = run(read_sources(path), repeat)
+        results.append((name, stats))
+        values = ["%.1f" % (stats[key] * 1e3) for key in keys[:-1]]
+        values.append("%.1f" % (stats["peak"] / 1024))
+        print(format_row(name, stats["files"], values))
+        if name in baseline:
+            old = baseline[name]
+            print(format_row("  vs baseline", "",
+                             [change(stats[key], old.get(key)) for key in keys]))
+    if save:
+        save_results(save, results)
+
+
+if __name__ == "__main__":
+    main(sys.argv[1:])